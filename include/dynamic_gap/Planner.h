@@ -6,10 +6,18 @@
 #include <boost/shared_ptr.hpp>
 #include <Eigen/Core>
 #include <Eigen/Geometry>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <numeric>
 #include <iostream>
 #include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+#include <memory>
+#include <thread>
+#include <unordered_map>
 // #include <map>
 
 #include <math.h>
@@ -20,10 +28,18 @@
 // #include <std_msgs/Header.h>
 #include <nav_msgs/Odometry.h>
 
+#include <dynamic_gap/utils/AgentTable.h>
+#include <dynamic_gap/utils/Checkpoint.h>
 #include <dynamic_gap/utils/Gap.h>
+#include <dynamic_gap/utils/GapSetSnapshot.h>
 #include <dynamic_gap/utils/Trajectory.h>
 #include <dynamic_gap/utils/Utils.h>
+#include <dynamic_gap/utils/WorkerPool.h>
+#include <dynamic_gap/gap_estimation/EgoMotionBuffer.h>
+#include <dynamic_gap/gap_estimation/EgoMotionTimeline.h>
 #include <dynamic_gap/gap_estimation/GapAssociator.h>
+#include <dynamic_gap/gap_estimation/GapTrackRegistry.h>
+#include <dynamic_gap/gap_estimation/KalmanFilterBatch.h>
 #include <dynamic_gap/gap_detection/GapDetector.h>
 #include <dynamic_gap/config/DynamicGapConfig.h>
 #include <dynamic_gap/visualization/GapVisualizer.h>
@@ -31,6 +47,7 @@
 #include <dynamic_gap/visualization/TrajectoryVisualizer.h>
 #include <dynamic_gap/global_plan_management/GlobalPlanManager.h>
 #include <dynamic_gap/scan_processing/DynamicScanPropagator.h>
+#include <dynamic_gap/scan_processing/ScanQueue.h>
 #include <dynamic_gap/trajectory_evaluation/TrajectoryEvaluator.h>
 #include <dynamic_gap/trajectory_generation/GapManipulator.h>
 #include <dynamic_gap/trajectory_tracking/TrajectoryController.h>
@@ -44,7 +61,6 @@
 #include <message_filters/synchronizer.h>
 #include <message_filters/sync_policies/approximate_time.h>
 
-#include <boost/thread/mutex.hpp>
 #include <boost/circular_buffer.hpp>
 
 #include <pedsim_msgs/AgentStates.h>
@@ -137,27 +153,23 @@ namespace dynamic_gap
             /**
             * \brief Function for updating the gap models
             * \param gaps set of gaps whose models we are updating
-            * \param intermediateRbtVels intermediate robot velocity values between last model update and current model update
-            * \param intermediateRbtAccs intermediate robot acceleration values between last model update and current model update
+            * \param egoMotionTimeline ego-robot motion between last model update and current model update
             * \param tCurrentFilterUpdate time step for current estimator update
             */
             void updateModels(std::vector<dynamic_gap::Gap *> & gaps, 
-                                const std::vector<geometry_msgs::TwistStamped> & intermediateRbtVels,
-                                const std::vector<geometry_msgs::TwistStamped> & intermediateRbtAccs,
+                                const dynamic_gap::EgoMotionTimeline & egoMotionTimeline,
                                 const ros::Time & tCurrentFilterUpdate);
 
             /**
             * \brief Function for updating a single gap's models
             * \param idx index of gap whose models we must update
             * \param gaps set of gaps whose models we are updating
-            * \param intermediateRbtVels intermediate robot velocity values between last model update and current model update
-            * \param intermediateRbtAccs intermediate robot acceleration values between last model update and current model update
+            * \param egoMotionTimeline ego-robot motion between last model update and current model update
             * \param tCurrentFilterUpdate time step for current estimator update
             */
             void updateModel(const int & idx, 
                                 std::vector<dynamic_gap::Gap *> & gaps, 
-                                const std::vector<geometry_msgs::TwistStamped> & intermediateRbtVels,
-                                const std::vector<geometry_msgs::TwistStamped> & intermediateRbtAccs,
+                                const dynamic_gap::EgoMotionTimeline & egoMotionTimeline,
                                 const ros::Time & tCurrentFilterUpdate);
 
             /**
@@ -173,11 +185,30 @@ namespace dynamic_gap
             void mpcOutputCB(boost::shared_ptr<geometry_msgs::PoseArray> mpcOutput);
 
             /**
-            * \brief Call back function to robot laser scan
+            * \brief Call back function to robot laser scan, hands scan off to perception thread
             * \param scan incoming laser scan msg
             */
             void laserScanCB(boost::shared_ptr<sensor_msgs::LaserScan> scan);
 
+            /**
+            * \brief Perception thread loop, processes queued laser scans until scan queue is shut down
+            */
+            void runPerception();
+
+            /**
+            * \brief Run gap detection, association, estimation, and simplification on laser scan,
+            * then publish resulting gap set for planning loop
+            * \param scan laser scan to process
+            */
+            void processScan(boost::shared_ptr<sensor_msgs::LaserScan> scan);
+
+            /**
+            * \brief Switch planning loop over to its own copy of a newly published gap set, updating all
+            * member objects with gap set's scan
+            * \param gapSet newly published gap set
+            */
+            void adoptGapSet(const std::shared_ptr<const dynamic_gap::GapSetSnapshot> & gapSet);
+
             /**
             * \brief Joint call back function for robot pose (position + velocity) and robot acceleration messages
             * \param rbtOdomMsg incoming robot odometry message
@@ -226,14 +257,127 @@ namespace dynamic_gap
             * \param generatedTrajs set of generated trajectories
             * \param pathPoseScores set of posewise scores for all paths
             * \param pathTerminalPoseScores set of terminal pose scores for all paths
-            * \param futureScans set of propagated scans to use during scoring
+            * \param futureEgoCircle future egocircle view to use during scoring
             * \return Vector of pose-wise scores for the generated trajectories
             */
             void generateGapTrajs(std::vector<dynamic_gap::Gap *> & gaps, 
                                     std::vector<dynamic_gap::Trajectory> & generatedTrajs,
                                     std::vector<std::vector<float>> & pathPoseScores,
                                     std::vector<float> & pathTerminalPoseScores,
-                                    const std::vector<sensor_msgs::LaserScan> & futureScans);
+                                    const dynamic_gap::FutureEgoCircle & futureEgoCircle);
+
+            /**
+            * \brief Results of planning through one gap, only written by the task that plans through it
+            */
+            struct GapPipelineSlot
+            {
+                bool manipulated = false; /**< Flag for if gap was successfully manipulated */
+                bool feasible = false; /**< Flag for if trajectory should be generated through gap */
+                bool generated = false; /**< Flag for if trajectory was generated through gap */
+                bool pruned = false; /**< Flag for if gap was skipped because its cost lower bound exceeded lowest cost found */
+                dynamic_gap::Gap * trajGap = NULL; /**< Gap that trajectory is generated through */
+                dynamic_gap::Trajectory traj; /**< Generated trajectory */
+                std::vector<float> poseCosts; /**< Posewise costs of generated trajectory */
+                float terminalPoseCost = 0.0; /**< Terminal pose cost of generated trajectory */
+            };
+
+            /**
+            * \brief Function for generating and scoring candidate trajectory through a single gap,
+            * keeping cheaper of go to goal and pursuit guidance trajectories
+            * \param gap gap through which we want to generate trajectory
+            * \param traj generated trajectory
+            * \param poseScores posewise scores for generated trajectory
+            * \param terminalPoseScore terminal pose score for generated trajectory
+            * \param futureEgoCircle future egocircle view to use during scoring
+            */
+            void generateGapTraj(dynamic_gap::Gap * gap,
+                                    dynamic_gap::Trajectory & traj,
+                                    std::vector<float> & poseScores,
+                                    float & terminalPoseScore,
+                                    const dynamic_gap::FutureEgoCircle & futureEgoCircle);
+
+            /**
+            * \brief Function for generating and scoring idling trajectory
+            * \param traj generated idling trajectory
+            * \param poseScores posewise scores for idling trajectory
+            * \param terminalPoseScore terminal pose score for idling trajectory
+            * \param futureEgoCircle future egocircle view to use during scoring
+            */
+            void generateIdlingTraj(dynamic_gap::Trajectory & traj,
+                                    std::vector<float> & poseScores,
+                                    float & terminalPoseScore,
+                                    const dynamic_gap::FutureEgoCircle & futureEgoCircle);
+
+            /**
+            * \brief Function for running each gap's propagation, manipulation, feasibility check and
+            * trajectory generation as one task on the planning pool, with idling trajectory as one more task.
+            * Tasks write into their own preallocated slots, which are gathered in gap order afterwards,
+            * so outputs match running the stages one after another over all gaps.
+            * \param planningGaps set of gaps we will use to plan
+            * \param unmanipulatedGaps copies of simplified gaps that trajectories go through when feasibility checking is off
+            * \param manipulatedGaps set of successfully manipulated gaps
+            * \param feasibleGaps set of feasible gaps, one per generated gap trajectory
+            * \param isCurrentGapFeasible boolean for if the gap the robot is currently traveling through is feasible
+            * \param generatedTrajs set of generated trajectories, idling trajectory last
+            * \param pathPoseScores set of posewise scores for all paths
+            * \param pathTerminalPoseScores set of terminal pose scores for all paths
+            * \param futureEgoCircle future egocircle view to use during scoring
+            */
+            void runGapPipelines(const std::vector<dynamic_gap::Gap *> & planningGaps,
+                                    const std::vector<dynamic_gap::Gap *> & unmanipulatedGaps,
+                                    std::vector<dynamic_gap::Gap *> & manipulatedGaps,
+                                    std::vector<dynamic_gap::Gap *> & feasibleGaps,
+                                    bool & isCurrentGapFeasible,
+                                    std::vector<dynamic_gap::Trajectory> & generatedTrajs,
+                                    std::vector<std::vector<float>> & pathPoseScores,
+                                    std::vector<float> & pathTerminalPoseScores,
+                                    const dynamic_gap::FutureEgoCircle & futureEgoCircle);
+
+            /**
+            * \brief Function for bounding how far from robot any pose of a trajectory through gap can be.
+            * Pursuit guidance drives at maximum speed until gap closes or horizon ends, and go to goal
+            * heads straight at global goal without overshooting it.
+            * \param gap gap through which trajectory would be generated
+            * \return upper bound on distance between robot and any pose of trajectory through gap
+            */
+            float gapTrajectoryReach(dynamic_gap::Gap * gap);
+
+            /**
+            * \brief Function for generating trajectories through feasible slots in order of increasing lower bound
+            * on trajectory cost, skipping gaps whose bound exceeds lowest cost found so far. Skipped gaps cannot
+            * hold lowest cost trajectory, so trajectory selection is unchanged.
+            * \param slots slots of gaps, trajectories are only generated for feasible slots
+            * \param incumbentCost cost of trajectory that is already available, such as idling trajectory
+            * \param futureEgoCircle future egocircle view to use during scoring
+            * \return number of gaps skipped
+            */
+            int generateBoundedGapTrajs(std::vector<GapPipelineSlot> & slots,
+                                        const float & incumbentCost,
+                                        const dynamic_gap::FutureEgoCircle & futureEgoCircle);
+
+            /**
+            * \brief Function for finishing off slots once every gap has been run through, with idling trajectory in last slot.
+            * With cost bounding, trajectories left for bounding are generated against idling trajectory's cost first.
+            * \param slots slots of gaps followed by idling slot
+            * \param trajGaps set of gaps, one per generated gap trajectory
+            * \param generatedTrajs set of generated trajectories in gap order, idling trajectory last
+            * \param pathPoseScores set of posewise scores for all paths
+            * \param pathTerminalPoseScores set of terminal pose scores for all paths
+            * \param futureEgoCircle future egocircle view to use during scoring
+            */
+            void gatherGapTrajs(std::vector<GapPipelineSlot> & slots,
+                                std::vector<dynamic_gap::Gap *> & trajGaps,
+                                std::vector<dynamic_gap::Trajectory> & generatedTrajs,
+                                std::vector<std::vector<float>> & pathPoseScores,
+                                std::vector<float> & pathTerminalPoseScores,
+                                const dynamic_gap::FutureEgoCircle & futureEgoCircle);
+
+            /**
+            * \brief Function for propagating current laser scan forward over trajectory horizon
+            * \param rawGaps set of raw gaps whose models move dynamic rays
+            * \return future egocircle view with every slice that will be scored against built
+            */
+            std::shared_ptr<const dynamic_gap::FutureEgoCircle> propagateFutureEgoCircle(const std::vector<dynamic_gap::Gap *> & rawGaps);
 
             /**
             * \brief Function for selecting the best trajectory out of the set of recently generated trajectories
@@ -265,7 +409,7 @@ namespace dynamic_gap
             * \param lowestCostTrajIdx index of lowest cost trajectory
             * \param trajFlag flag for if robot is idling or moving
             * \param isIncomingGapFeasible boolean for if the incoming gap is feasible 
-            * \param futureScans set of propagated scans to use during scoring
+            * \param futureEgoCircle future egocircle view to use during scoring
             * \return the trajectory that the robot will track
             */
             dynamic_gap::Trajectory compareToCurrentTraj(const std::vector<dynamic_gap::Gap *> & feasibleGaps, 
@@ -273,7 +417,7 @@ namespace dynamic_gap
                                                             const int & lowestCostTrajIdx,
                                                             const int & trajFlag,
                                                             const bool & isIncomingGapFeasible,
-                                                            const std::vector<sensor_msgs::LaserScan> & futureScans);
+                                                            const dynamic_gap::FutureEgoCircle & futureEgoCircle);
 
             /**
             * \brief Function for getting index of closest pose in trajectory
@@ -283,13 +427,38 @@ namespace dynamic_gap
             int getClosestTrajectoryPoseIdx(const geometry_msgs::PoseArray & currTrajRbtFrame);
 
             /**
-            * \brief Function for deep copying simplified gaps
+            * \brief Function for advancing gap point models of copied gaps from scan time to start of planning loop
+            * using odometry received since scan (predict only, no measurement)
+            * \param copiedRawGaps deep copied raw gaps
+            * \param planningGaps deep copied simplified gaps
+            * \param tPlanning time to advance gap point models to
+            */
+            void predictGapModels(const std::vector<dynamic_gap::Gap *> & copiedRawGaps,
+                                  const std::vector<dynamic_gap::Gap *> & planningGaps,
+                                  const ros::Time & tPlanning);
+
+            /**
+            * \brief Write tracker state (gaps, gap point estimators, ego-robot motion history, 
+            * and current trajectory) into checkpoint file. Only called by perception thread.
+            * \param path path of checkpoint file
+            */
+            void writeCheckpoint(const std::string & path);
+
+            /**
+            * \brief Restore tracker state from checkpoint file, must be called before perception thread 
+            * and odometry callback start
+            * \param path path of checkpoint file
+            */
+            void readCheckpoint(const std::string & path);
+
+            /**
+            * \brief Function for deep copying simplified gaps of gap set that planning loop is working from
             * \return Deep copied simplified gaps
             */
             std::vector<dynamic_gap::Gap *> deepCopyCurrentSimplifiedGaps();
 
             /**
-            * \brief Function for deep copying raw gaps
+            * \brief Function for deep copying raw gaps of gap set that planning loop is working from
             * \return Deep copied raw gaps
             */
             std::vector<dynamic_gap::Gap *> deepCopyCurrentRawGaps();
@@ -298,7 +467,11 @@ namespace dynamic_gap
             * \brief Setter for current trajectory
             * \param currentTraj incoming trajectory that robot is going to start tracking
             */
-            void setCurrentTraj(const dynamic_gap::Trajectory & currentTraj) { currentTraj_ = currentTraj; }
+            void setCurrentTraj(const dynamic_gap::Trajectory & currentTraj) 
+            { 
+                currentTraj_ = currentTraj; 
+                std::atomic_store(&checkpointTraj_, std::make_shared<const dynamic_gap::Trajectory>(currentTraj));
+            }
 
             /**
             * \brief Getter for current trajectory
@@ -344,8 +517,8 @@ namespace dynamic_gap
             */
             float computeAverageTimeTaken(const float & timeTaken, const int & planningStepIdx);
 
-            boost::mutex gapMutex_; /**< Current set of gaps mutex */
-            dynamic_gap::DynamicGapConfig cfg_; /**< Planner hyperparameter config list */
+            dynamic_gap::DynamicGapConfig cfg_; /**< Planner hyperparameter config list, scan parameters are taken from gap set that planning loop works from */
+            dynamic_gap::DynamicGapConfig perceptionCfg_; /**< Copy of planner hyperparameter config list for perception thread, scan parameters are taken from each incoming scan */
 
             ros::NodeHandle nh_; /**< ROS node handle for local path planner */
             ros::Publisher currentTrajectoryPublisher_; /**< ROS publisher for currently tracked trajectory */
@@ -382,9 +555,7 @@ namespace dynamic_gap
             tf2_ros::TransformListener * tfListener_ = NULL; /**< ROS transform listener */
 
             std::vector<int> rawAssocation_; /**< Association vector for current set of raw gaps */
-            std::vector<int> simpAssociation_; /**< Association vector for current set of simplified gaps */
-            std::vector<std::vector<float>> rawDistMatrix_; /**< Distance matrix for current set of raw gaps */
-            std::vector<std::vector<float>> simpDistMatrix_; /**< Distance matrix for current set of raw gaps */
+            Eigen::MatrixXf rawDistMatrix_; /**< Distance matrix for current set of raw gaps */
 
             // Goals and stuff
             geometry_msgs::PoseStamped globalGoalOdomFrame_; /**< Global goal in odometry frame */
@@ -392,10 +563,16 @@ namespace dynamic_gap
             geometry_msgs::PoseStamped globalPathLocalWaypointOdomFrame_; /**< Global path local waypoint in odometry frame */
 
             // Gaps
-            std::vector<dynamic_gap::Gap *> currRawGaps_; /**< Current set of raw gaps */
-            std::vector<dynamic_gap::Gap *> currSimplifiedGaps_; /**< Current set of simplified gaps */
-            std::vector<dynamic_gap::Gap *> prevRawGaps_; /**< Previous set of raw gaps */
-            std::vector<dynamic_gap::Gap *> prevSimplifiedGaps_; /**< Previous set of simplified gaps */
+            std::shared_ptr<const dynamic_gap::GapSetSnapshot> gapSetSnapshot_; /**< Latest gap set published by perception thread, only accessed through std::atomic_load and std::atomic_store */
+            std::shared_ptr<const dynamic_gap::GapSetSnapshot> planningGapSet_; /**< Planning loop's own copy of gap set that it is currently working from */
+            std::weak_ptr<const dynamic_gap::GapSetSnapshot> adoptedGapSet_; /**< Published gap set that planningGapSet_ was copied from, not kept alive by planning loop */
+            dynamic_gap::EgoMotionTimeline predictionTimeline_; /**< Ego-robot motion between gap set's scan and start of planning loop */
+
+            std::vector<dynamic_gap::Gap *> currRawGaps_; /**< Current set of raw gaps, handed over to gap set once scan is processed */
+            std::vector<dynamic_gap::Gap *> currSimplifiedGaps_; /**< Current set of simplified gaps, handed over to gap set once scan is processed */
+            std::vector<dynamic_gap::Gap *> prevRawGaps_; /**< Previous set of raw gaps, owned by previous gap set and only modified once no one else holds that set */
+            std::vector<dynamic_gap::Gap *> prevSimplifiedGaps_; /**< Previous set of simplified gaps, owned by previous gap set */
+            std::shared_ptr<const dynamic_gap::GapSetSnapshot> prevGapSet_; /**< Gap set that previous gaps belong to, perception thread only */
 
             int currentLeftGapPtModelID = -1; /**< Model ID for estimator of current gap's left point */
             int currentRightGapPtModelID = -1; /**< Model ID for estimator of current gap's right point */
@@ -414,23 +591,31 @@ namespace dynamic_gap
 
             // Trajectories
             dynamic_gap::Trajectory currentTraj_; /**< Trajectory that robot is currently tracking */
+            std::shared_ptr<const dynamic_gap::Trajectory> checkpointTraj_; /**< Copy of current trajectory, written by planning loop and read by perception thread for checkpoints */
+            ros::Time tLastCheckpoint_; /**< Scan time of last written checkpoint, perception thread only */
 
             int targetTrajectoryPoseIdx_ = 0; /**< Index of closest pose along the robot's current trajectory */
 
             int trajectoryChangeCount_ = 0; /**< Counter for times that planner has switched local trajectories */
 
             // Scans
-            boost::shared_ptr<sensor_msgs::LaserScan const> scan_; /**< Current laser scan */
+            boost::shared_ptr<sensor_msgs::LaserScan const> scan_; /**< Laser scan of gap set that planning loop is currently working from */
+
+            dynamic_gap::ScanQueue * scanQueue_ = NULL; /**< Queue of incoming laser scans, written by scan callback and read by perception thread */
+            std::thread perceptionThread_; /**< Thread that turns queued laser scans into gap sets */
+            uint64_t reportedDroppedScans_ = 0; /**< Number of dropped scans already reported by perception thread */
 
             geometry_msgs::Twist mpcTwist_; /**< Command velocity output for MPC */
 
             bool haveTFs = false; /**< Flag for if transforms have been received */
 
-            std::map<std::string, geometry_msgs::Pose> currentTrueAgentPoses_; /**< Ground truth poses of agents currently in local environment */
-            std::map<std::string, geometry_msgs::Vector3Stamped> currentTrueAgentVels_; /**< Ground truth velocities of agents currently in local environment */
+            std::shared_ptr<const dynamic_gap::AgentTable> agentTable_; /**< Ground truth states of agents currently in local environment, written by agent callback and read by perception thread */
+            std::shared_ptr<const dynamic_gap::AgentTable> scanAgentTable_; /**< Ground truth agent states used for model updates of current scan, perception thread only */
+            std::unordered_map<std::string, int> agentIDs_; /**< Integer IDs assigned to agents by name, agent callback only */
 
             dynamic_gap::GapDetector * gapDetector_ = NULL; /**< Gap detector */
-            dynamic_gap::GapVisualizer * gapVisualizer_ = NULL; /**< Gap visualizer */
+            dynamic_gap::GapVisualizer * gapVisualizer_ = NULL; /**< Gap visualizer for perception thread */
+            dynamic_gap::GapVisualizer * manipGapVisualizer_ = NULL; /**< Gap visualizer for manipulated gaps of planning loop */
             dynamic_gap::GlobalPlanManager * globalPlanManager_ = NULL; /**< Goal selector */
             dynamic_gap::TrajectoryVisualizer * trajVisualizer_ = NULL; /**< Trajectory visualizer */
             dynamic_gap::GoalVisualizer * goalVisualizer_ = NULL; /**< Goal visualizer */
@@ -440,6 +625,10 @@ namespace dynamic_gap
             dynamic_gap::GapManipulator * gapManipulator_ = NULL; /**< Gap manipulator */
             dynamic_gap::TrajectoryController * trajController_ = NULL; /**< Trajectory controller */
             dynamic_gap::GapAssociator * gapAssociator_ = NULL; /**< Gap associator */
+            dynamic_gap::GapTrackRegistry * gapTrackRegistry_ = NULL; /**< Registry of tracked gap points shared by raw and simplified gaps */
+            dynamic_gap::KalmanFilterBatch * kalmanFilterBatch_ = NULL; /**< Batched updater for gap point filters */
+            dynamic_gap::WorkerPool * modelUpdatePool_ = NULL; /**< Persistent worker threads for gap point model updates */
+            dynamic_gap::WorkerPool * planningPool_ = NULL; /**< Persistent worker threads for planning loop, separate from perception thread's pool */
             dynamic_gap::GapFeasibilityChecker * gapFeasibilityChecker_ = NULL; /**< Gap feasibility checker */
 
             // Status
@@ -455,8 +644,11 @@ namespace dynamic_gap
             geometry_msgs::TwistStamped currentRbtVel_; /**< Current robot velocity */
             geometry_msgs::TwistStamped currentRbtAcc_; /**< Current robot acceleration */
 
-            std::vector<geometry_msgs::TwistStamped> intermediateRbtVels_; /**< Intermediate robot velocities between last model update and upcoming model update */
-            std::vector<geometry_msgs::TwistStamped> intermediateRbtAccs_; /**< Intermediate robot accelerations between last model update and upcoming model update */
+            dynamic_gap::EgoMotionBuffer * egoMotionBuffer_ = NULL; /**< History of robot velocities and accelerations, written by odometry callback and read by scan callback */
+
+            dynamic_gap::EgoMotionTimeline egoMotionTimeline_; /**< Ego-robot motion between last model update and current model update, shared by all gap point models */
+            std::vector<int> unbatchedModelIdxs_; /**< Gap point models updated on their own rather than in filter batch */
+            static constexpr int modelsPerUpdateChunk_ = 4; /**< Number of unbatched gap point models updated per parallel chunk */
 
             // Timekeeping
             float totalGapDetectionTimeTaken = 0.0f; /**< Total time taken for gap detection */
@@ -486,6 +678,12 @@ namespace dynamic_gap
             float totalScanPropagationTimeTaken = 0.0f; /**< Total time taken for scan propagation */
             int scanPropagationCalls = 0; /**< Total number of calls for scan propagation */
 
+            float totalGapPipelineTimeTaken = 0.0f; /**< Total time taken for per-gap planning pipelines */
+            int gapPipelineCalls = 0; /**< Total number of calls for per-gap planning pipelines */
+
+            int totalBoundedGaps = 0; /**< Total number of gaps considered for trajectory generation with cost bounding */
+            int totalPrunedGaps = 0; /**< Total number of gaps skipped by cost bounding */
+
             float totalGenerateGapTrajTimeTaken = 0.0f; /**< Total time taken for gap trajectory synthesis */
             int generateGapTrajCalls = 0; /**< Total number of calls for gap trajetory synthesis */
 
@@ -38,6 +38,8 @@ namespace dynamic_gap
             */
             struct Scan
             {
+                int queue_size = 1; /**< Number of scans waiting for perception thread before oldest is dropped */
+
                 // will get overriden in updateParamFromScan
                 float angle_min = -M_PI; /**< minimum angle value in scan */
                 float angle_max = M_PI; /**< maximum angle value in scan */
@@ -59,10 +61,20 @@ namespace dynamic_gap
                 bool heading = true; /**< Boolean for if robot tracks path headings or not */
                 bool future_scan_propagation = true; /**< Flag for enacting future scan propagation */
                 bool egocircle_prop_cheat = false; /**< Flag for enacting future scan propagation through cheating */
+                float cheat_agent_radius = 0.35; /**< Radius of ground truth agent discs ray-cast into future scans when cheating */
+                bool dynamic_segment_clearance = false; /**< Flag for scoring poses against moving line segments fit to dynamic rays instead of propagated rays */
+                float dynamic_segment_tolerance = 0.05; /**< Maximum distance between a dynamic ray's scan point and the moving segment fit to it */
                 bool projection_operator = true; /**< Boolean for if planner should apply projection operator */
                 bool gap_feasibility_check = true; /**< Flag for enacting gap feasibility checking */
+                bool analytic_gap_lifespan = true; /**< Solve gap lifespans in closed form instead of stepping gap points forward */
+                bool validate_gap_lifespan = false; /**< Also step gap points forward and warn when closed-form lifespan disagrees */
                 bool perfect_gap_models = false; /**< Flag for using perfect gap models */
                 int halt_size = 5; /**< Size of command velocity buffer */
+                int num_planning_threads = 1; /**< Number of threads that run planning loop work, including planning thread */
+                bool gap_cost_bounding = true; /**< Flag for generating trajectories in order of cost lower bound and skipping gaps that cannot beat lowest cost found */
+                bool per_gap_pipeline = true; /**< Flag for running each gap's propagation, manipulation, feasibility check and trajectory generation as one task instead of stage by stage */
+                bool gap_feasibility_cache = false; /**< Flag for reusing gap lifespans and feasibility results across planning loops while gap point models barely change */
+                float gap_feasibility_cache_tolerance = 0.02; /**< Largest change in gap point states, manipulated gap points, gap goal or terminal goal scan range for which cached results are reused */
             } planning;            
 
             /**
@@ -92,8 +104,23 @@ namespace dynamic_gap
             struct GapAssociation 
             {
                 float assoc_thresh = 0.50; /**< Distance threshold for gap association */
+                bool banded_association = false; /**< Only associate gap points within an angular band of each other */
+                float assoc_band_angle = 0.35; /**< Half-width of angular band for banded gap association (rad) */
+                int assoc_band_max_points = 32; /**< Largest group of banded candidates before falling back to full association */
             } gap_assoc;           
 
+            /**
+            * \brief Hyperparameters for gap estimation
+            */
+            struct GapEstimation 
+            {
+                bool batched_update = true; /**< Update all gap point filters that share the scan's ego-motion timeline together */
+                bool joseph_form = false; /**< Use Joseph form covariance update in gap point filters */
+                int num_update_threads = 1; /**< Number of threads that update gap point models, including perception thread */
+                bool planning_time_prediction = true; /**< Advance gap point models from scan time to start of planning loop with odometry */
+                float agent_hash_cell_size = 1.5; /**< Side length of spatial hash cells for ground truth nearest-agent queries (in meters) */
+            } gap_est;
+
             /**
             * \brief Hyperparameters for gap manipulation
             */
@@ -139,6 +166,16 @@ namespace dynamic_gap
                 float r_zero = 1.0; /**< Robot to environment distance at which projection operator takes on a value of 0 */
             } projection;
 
+            /**
+            * \brief Hyperparameters for tracker checkpoints
+            */
+            struct Checkpoint
+            {
+                std::string save_dir = ""; /**< Directory to periodically write tracker checkpoints into (empty to disable) */
+                float save_period = 5.0; /**< Scan time between consecutive tracker checkpoints (in seconds) */
+                std::string load_file = ""; /**< Tracker checkpoint to restore on startup (empty to start fresh) */
+            } checkpoint;
+
             /**
             * \brief Load in planner hyperparameters from node handle (specified in launch file and yamls)
             */
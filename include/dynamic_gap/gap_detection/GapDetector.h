@@ -36,6 +36,7 @@ namespace dynamic_gap
         
             /**
             * \brief Condense raw set of gaps into a smaller set of simplified gaps more amenable for navigation.
+            * Simplified gaps share estimator models with raw gaps rather than owning copies of them.
             * 
             * \param rawGaps set of raw gaps
             * \return set of simplified gaps
@@ -110,12 +111,45 @@ namespace dynamic_gap
             * \brief Iterate backwards through simplified gaps to see if/where
             * a raw radial gap should be merged 
             *
+            * Only simplified gaps that are still eligible for merging are visited. Because raw gaps
+            * arrive in increasing scan order, the scan interval between a simplified gap and any later raw gap
+            * only grows, so a simplified gap that fails the intergap distance test once can never pass it again
+            * and is permanently dropped from the merge candidates. Every candidate visited is either dropped,
+            * erased by the resulting merge, or ends the search, so simplification is linear in the number of gaps.
+            *
             * \param rawGap queried raw radial gap
             * \param simplifiedGaps existing set of simplified gaps
+            * \param mergeCandidates increasing indices of simplified gaps that are still eligible for merging
             * \return index within simplified gaps that should be merged
             */
             int checkSimplifiedGapsMergeability(dynamic_gap::Gap * rawGap, 
-                                                const std::vector<dynamic_gap::Gap *> & simplifiedGaps);
+                                                const std::vector<dynamic_gap::Gap *> & simplifiedGaps,
+                                                std::vector<int> & mergeCandidates);
+
+            /**
+            * \brief Register the last simplified gap as a merge candidate if it can be merged into
+            * 
+            * \param simplifiedGaps existing set of simplified gaps
+            * \param mergeCandidates increasing indices of simplified gaps that are still eligible for merging
+            */
+            void pushMergeCandidate(const std::vector<dynamic_gap::Gap *> & simplifiedGaps,
+                                    std::vector<int> & mergeCandidates);
+
+            /**
+            * \brief Precompute block-wise range minima over current laser scan so that
+            * minimum intergap ranges can be queried in constant time
+            */
+            void buildIntergapRangeQueries();
+
+            /**
+            * \brief Query minimum range within scan interval [startIdx, endIdx).
+            * An empty interval yields the range at startIdx.
+            * 
+            * \param startIdx first scan index of interval
+            * \param endIdx one past last scan index of interval
+            * \return minimum range within scan interval
+            */
+            float minIntergapRange(const int & startIdx, const int & endIdx);
 
             sensor_msgs::LaserScan scan_; /**< Current laser scan */
             const DynamicGapConfig* cfg_ = NULL; /**< Planner hyperparameter config list */
@@ -124,5 +158,11 @@ namespace dynamic_gap
             float halfScanRayCount_ = 0.0; /**< Half of number of rays within scan (float) */
             int fullScanRayCount_ = 0; /**< Number of rays within scan (int) */
 
+            static const int rangeQueryBlockSize_ = 32; /**< Number of scan rays per block of range minimum queries */
+            std::vector<float> blockPrefixMinRanges_; /**< Minimum range from start of block up to each scan index */
+            std::vector<float> blockSuffixMinRanges_; /**< Minimum range from each scan index up to end of block */
+            std::vector<std::vector<float>> blockMinRangesTable_; /**< Sparse table of minimum ranges over runs of 2^k blocks */
+            std::vector<int> blockCountLog2_; /**< Floor of log2 for block counts */
+
     };
 }
\ No newline at end of file
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <ros/ros.h>
+
+#include <atomic>
+#include <vector>
+#include <stdint.h>
+
+#include <geometry_msgs/TwistStamped.h>
+
+#include <dynamic_gap/config/DynamicGapConfig.h>
+
+namespace dynamic_gap 
+{
+    /**
+    * \brief Ego-robot velocity and acceleration received together from odometry and acceleration callback
+    */
+    struct EgoMotionSample
+    {
+        ros::Time velStamp; /**< time stamp of ego-robot velocity */
+        float vx = 0.0; /**< ego-robot linear x-velocity in robot frame */
+        float vy = 0.0; /**< ego-robot linear y-velocity in robot frame */
+        float omega = 0.0; /**< ego-robot angular velocity */
+
+        ros::Time accStamp; /**< time stamp of ego-robot acceleration */
+        float ax = 0.0; /**< ego-robot linear x-acceleration in robot frame */
+        float ay = 0.0; /**< ego-robot linear y-acceleration in robot frame */
+    };
+
+    /**
+    * \brief Fixed-capacity ring buffer of ego-robot motion history. A single producer (the odometry callback) 
+    * appends samples without ever waiting on readers, and any number of readers take time-indexed views 
+    * through binary search over the stamps. Readers only look at the newest half of the ring, 
+    * so the producer has half a ring's worth of samples to write before it can overwrite an in-progress read, 
+    * and a reader that gets lapped simply retries.
+    */
+    class EgoMotionBuffer
+    {
+        public:
+            /**
+            * \brief Constructor with planner config 
+            * \param cfg config file for planner parameters
+            */
+            EgoMotionBuffer(const DynamicGapConfig& cfg) { cfg_ = &cfg; }
+
+            /**
+            * \brief Append newest sample. Must only be called from a single producer thread.
+            * \param sample ego-robot velocity and acceleration
+            */
+            void push(const EgoMotionSample & sample);
+
+            /**
+            * \brief Copy out all ego-robot velocities and accelerations stamped after a given time, 
+            * skipping repeated stamps. Warns if given time is older than the oldest readable sample,
+            * as samples in between have already been dropped.
+            * \param tSince time after which to copy samples
+            * \param rbtVels sequence of ego-robot velocities stamped after tSince
+            * \param rbtAccs sequence of ego-robot accelerations stamped after tSince
+            */
+            void copySince(const ros::Time & tSince,
+                           std::vector<geometry_msgs::TwistStamped> & rbtVels,
+                           std::vector<geometry_msgs::TwistStamped> & rbtAccs) const;
+
+            /**
+            * \brief Linearly interpolate ego-robot velocity and acceleration at an arbitrary time,
+            * holding first and last samples outside of buffered span
+            * \param t time to interpolate at
+            * \param sample interpolated ego-robot velocity and acceleration
+            * \return boolean for if buffer held any samples to interpolate between
+            */
+            bool interpolate(const ros::Time & t, EgoMotionSample & sample) const;
+
+            /**
+            * \brief Copy out all readable samples, oldest first
+            * \param samples buffered ego-robot velocities and accelerations
+            */
+            void copySamples(std::vector<EgoMotionSample> & samples) const;
+
+        private:
+            friend class EgoMotionBufferTest;
+
+            /**
+            * \brief Find first buffered sample whose velocity (or acceleration) is stamped after a given time
+            * \param lo oldest absolute sample index to search
+            * \param hi one past newest absolute sample index to search
+            * \param t time to search for
+            * \param acc boolean for searching acceleration stamps instead of velocity stamps
+            * \return absolute index of first sample stamped after t (hi if none)
+            */
+            uint64_t firstAfter(uint64_t lo, uint64_t hi, const ros::Time & t, const bool & acc) const;
+
+            /**
+            * \brief Oldest absolute sample index that readers may look at given newest absolute sample index
+            * \param head one past newest absolute sample index
+            * \return oldest readable absolute sample index
+            */
+            uint64_t readableTail(const uint64_t & head) const { return head > (capacity_ / 2) ? head - (capacity_ / 2) : 0; }
+
+            /**
+            * \brief Check that samples at or after an absolute index have not been overwritten since they were read
+            * \param tail oldest absolute sample index that was read
+            * \return boolean for if read is still valid
+            */
+            bool readIntact(const uint64_t & tail) const;
+
+            const DynamicGapConfig* cfg_ = NULL; /**< Planner hyperparameter config list */
+
+            static const int capacity_ = 512; /**< number of samples held in ring */
+            EgoMotionSample samples_[capacity_]; /**< ring of samples, absolute index i lives at i % capacity_ */
+            std::atomic<uint64_t> head_{0}; /**< number of samples ever pushed (one past newest absolute sample index) */
+    };
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <ros/ros.h>
+
+#include <vector>
+#include <cmath>
+
+#include <geometry_msgs/TwistStamped.h>
+
+#include <Eigen/Core>
+#include <Eigen/Dense>
+#include <Eigen/StdVector>
+
+namespace dynamic_gap 
+{
+    /**
+    * \brief Ego-robot motion between two consecutive gap estimator updates. Intermediate robot velocities 
+    * and accelerations are aligned onto a shared sequence of timesteps that starts at the time of the last update 
+    * and ends at the time of the incoming scan, and the per-step state transition matrices and discretized 
+    * covariance noise matrices of the rotating frame dynamics are computed alongside. 
+    * Built once per scan and consumed read-only by every gap estimator that was last updated at the start time.
+    */
+    class EgoMotionTimeline
+    {
+        public:
+            /**
+            * \brief Build timeline from intermediate ego-robot velocities and accelerations
+            * \param rbtVels sequence of ego-robot velocities received since last model update
+            * \param rbtAccs sequence of ego-robot accelerations received since last model update
+            * \param tStart time of last model update
+            * \param startRbtVel ego-robot velocity at time of last model update
+            * \param startRbtAcc ego-robot acceleration at time of last model update
+            * \param tEnd time of current model update
+            * \param Q continuous covariance noise matrix to discretize along timeline
+            */
+            void build(const std::vector<geometry_msgs::TwistStamped> & rbtVels,
+                       const std::vector<geometry_msgs::TwistStamped> & rbtAccs,
+                       const ros::Time & tStart,
+                       const geometry_msgs::TwistStamped & startRbtVel,
+                       const geometry_msgs::TwistStamped & startRbtAcc,
+                       const ros::Time & tEnd,
+                       const Eigen::Matrix4f & Q);
+
+            /**
+            * \brief Check if timeline was built for an estimator in the given condition
+            * \param tStart time of estimator's last update
+            * \param startRbtVel estimator's ego-robot velocity from last update
+            * \param startRbtAcc estimator's ego-robot acceleration from last update
+            * \param tEnd time of current model update
+            * \param Q estimator's continuous covariance noise matrix
+            * \return boolean for if estimator can consume this timeline
+            */
+            bool matches(const ros::Time & tStart,
+                         const geometry_msgs::TwistStamped & startRbtVel,
+                         const geometry_msgs::TwistStamped & startRbtAcc,
+                         const ros::Time & tEnd,
+                         const Eigen::Matrix4f & Q) const;
+
+            /**
+            * \brief Getter for whether aligned velocities and accelerations can be used for an update
+            * \return boolean for if timeline is usable
+            */
+            bool valid() const { return valid_; }
+
+            /**
+            * \brief Getter for number of aligned timesteps
+            * \return number of aligned timesteps
+            */
+            int size() const { return rbtVels_.size(); }
+
+            /**
+            * \brief Getter for unaligned ego-robot velocities that timeline was built from
+            * \return unaligned ego-robot velocities
+            */
+            const std::vector<geometry_msgs::TwistStamped> & rawRbtVels() const { return rawRbtVels_; }
+
+            /**
+            * \brief Getter for unaligned ego-robot accelerations that timeline was built from
+            * \return unaligned ego-robot accelerations
+            */
+            const std::vector<geometry_msgs::TwistStamped> & rawRbtAccs() const { return rawRbtAccs_; }
+
+            /**
+            * \brief Getter for aligned ego-robot velocities
+            * \return aligned ego-robot velocities
+            */
+            const std::vector<geometry_msgs::TwistStamped> & rbtVels() const { return rbtVels_; }
+
+            /**
+            * \brief Getter for aligned ego-robot accelerations
+            * \return aligned ego-robot accelerations
+            */
+            const std::vector<geometry_msgs::TwistStamped> & rbtAccs() const { return rbtAccs_; }
+
+            /**
+            * \brief Getter for duration of intermediate step
+            * \param idx index of intermediate step
+            * \return duration of intermediate step in seconds
+            */
+            float dt(const int & idx) const { return dts_[idx]; }
+
+            /**
+            * \brief Getter for state transition matrix of intermediate step
+            * \param idx index of intermediate step
+            * \return state transition matrix of intermediate step
+            */
+            const Eigen::Matrix4f & STM(const int & idx) const { return STMs_[idx]; }
+
+            /**
+            * \brief Getter for discretized covariance noise matrix of intermediate step
+            * \param idx index of intermediate step
+            * \return discretized covariance noise matrix of intermediate step
+            */
+            const Eigen::Matrix4f & dQ(const int & idx) const { return dQs_[idx]; }
+
+        private:
+            /**
+            * \brief Sequence intermediate robot velocities and accelerations so that intermediate model
+            * updates start from time of last update and end at time of incoming sensor measurement
+            */
+            void alignEgoRobotVelsAndAccs();
+
+            /**
+            * \brief helper function for interpolating intermediate vel/acc measurements
+            * so that during model update, we have vel/acc measurements at all intermediate timesteps
+            *
+            * \param vectorI vector which we want to *add* interpolated values to
+            * \param vectorJ vector which we base interpolation off of 
+            */
+            void interpolateIntermediateValues(std::vector<geometry_msgs::TwistStamped> & vectorI,
+                                               const std::vector<geometry_msgs::TwistStamped> & vectorJ);
+
+            /**
+            * \brief Compute state transition matrix and discretized covariance noise matrix for each intermediate step
+            */
+            void discretizeDynamics();
+
+            std::vector<geometry_msgs::TwistStamped> rawRbtVels_; /**< unaligned ego-robot velocities */
+            std::vector<geometry_msgs::TwistStamped> rawRbtAccs_; /**< unaligned ego-robot accelerations */
+            std::vector<geometry_msgs::TwistStamped> rbtVels_; /**< ego-robot velocities aligned onto shared timesteps */
+            std::vector<geometry_msgs::TwistStamped> rbtAccs_; /**< ego-robot accelerations aligned onto shared timesteps */
+
+            std::vector<float> dts_; /**< duration of each intermediate step */
+            std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > STMs_; /**< state transition matrix of each intermediate step */
+            std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > dQs_; /**< discretized covariance noise matrix of each intermediate step */
+
+            ros::Time tStart_; /**< time of last model update */
+            ros::Time tEnd_; /**< time of current model update */
+            geometry_msgs::TwistStamped startRbtVel_; /**< ego-robot velocity at time of last model update */
+            geometry_msgs::TwistStamped startRbtAcc_; /**< ego-robot acceleration at time of last model update */
+            Eigen::Matrix4f Q_ = Eigen::Matrix4f::Zero(); /**< continuous covariance noise matrix */
+
+            bool valid_ = false; /**< flag for if aligned velocities and accelerations can be used for an update */
+    };
+}
@@ -12,6 +12,10 @@
 #include <Eigen/Core>
 #include <Eigen/Dense>
 
+#include <dynamic_gap/gap_estimation/EgoMotionTimeline.h>
+#include <dynamic_gap/utils/AgentTable.h>
+#include <dynamic_gap/utils/Checkpoint.h>
+
 namespace dynamic_gap 
 {
     /**
@@ -43,8 +47,6 @@ namespace dynamic_gap
             Eigen::Matrix2f R_temp_; /**<  Measurement noise matrix */
             Eigen::Matrix4f Q_temp_; /**< Covariance noise matrix */
 
-            std::vector<geometry_msgs::TwistStamped> intermediateRbtVels_; /**< sequence of ego-robot velocities received since last model update */
-            std::vector<geometry_msgs::TwistStamped> intermediateRbtAccs_; /**< sequence of ego-robot accelerations received since last model update */     
             geometry_msgs::TwistStamped lastRbtVel_; /**< most recent ego-robot velocity from last model update */
             geometry_msgs::TwistStamped lastRbtAcc_; /**< most recent ego-robot acceleration from last model update */   
 
@@ -52,8 +54,11 @@ namespace dynamic_gap
             ros::Time tLastUpdate_; /**< time of last model update */
 
             bool manip_ = false; /**< Flag for if gap model is attached to manipulated point  */
+            bool josephForm_ = false; /**< Flag for if covariance is corrected in Joseph form */
             Eigen::Vector2f manipPosition; /**< Manipulated gap point position */
 
+            virtual ~Estimator() {}
+
             /**
             * \brief Virtual function for initializing estimator, must be overridden by desired model class
             * \param side Gap side for model (left or right)
@@ -78,290 +83,49 @@ namespace dynamic_gap
             /**
             * \brief Virtual function for updating estimator based on new sensor measurements
             * \param measurement new sensor measurement
-		    * \param intermediateRbtVels sequence of ego-robot velocities received since last model update
-		    * \param intermediateRbtAccs sequence of ego-robot accelerations received since last model update            
-            * \param agentPoses poses of all agents in environment (ground truth information used for certain estimator classes)
-            * \param agentVels velocities of all agents in environment (ground truth information used for certain estimator classes)
+            * \param egoMotionTimeline ego-robot motion since last model update, shared across estimators for current scan
+            * \param agents ground truth states of all agents in environment (used for certain estimator classes)
             * \param tUpdate time of current model update
             */
             virtual void update(const Eigen::Vector2f & measurement, 
-                                const std::vector<geometry_msgs::TwistStamped> & intermediateRbtVels, 
-                                const std::vector<geometry_msgs::TwistStamped> & intermediateRbtAccs, 
-                                const std::map<std::string, geometry_msgs::Pose> & agentPoses,
-                                const std::map<std::string, geometry_msgs::Vector3Stamped> & agentVels,
+                                const EgoMotionTimeline & egoMotionTimeline, 
+                                const AgentTable & agents,
                                 const ros::Time & tUpdate) = 0;
 
             /**
-            * \brief Sequence intermediate robot velocities and accelerations so that intermediate model
-            * updates start from time of last update and end at time of incoming sensor measurement
+            * \brief Virtual function for advancing estimator to a later time without a sensor measurement.
+            * Estimators without a motion model keep the state from their last update.
+            * \param egoMotionTimeline ego-robot motion since last model update
+            * \param tPredict time to advance estimator to
+            */
+            virtual void predict(const EgoMotionTimeline & egoMotionTimeline, const ros::Time & tPredict) {}
+
+            /**
+            * \brief Check if estimator can be updated along shared ego-robot motion timeline as-is
+            * \param egoMotionTimeline ego-robot motion since last model update, shared across estimators for current scan
             * \param tUpdate time of current model update
+            * \return boolean for if shared timeline starts at this estimator's last update
             */
-            void processEgoRobotVelsAndAccs(const ros::Time & tUpdate)
+            bool sharesEgoMotionTimeline(const EgoMotionTimeline & egoMotionTimeline, const ros::Time & tUpdate) const
             {
-                // Printing original dt values from intermediate odom measurements
-                // ROS_INFO_STREAM_NAMED("GapEstimation", "   t_0 - tLastUpdate_ difference:" << (intermediateRbtVels_[0].header.stamp - tLastUpdate_).toSec() << " sec");
-
-                // for (int i = 0; i < (intermediateRbtVels_.size() - 1); i++)
-                // {
-                //     ROS_INFO_STREAM_NAMED("GapEstimation", "   t_" << (i+1) << " - t_" << i << " difference: " << (intermediateRbtVels_[i + 1].header.stamp - intermediateRbtVels_[i].header.stamp).toSec() << " sec");
-                // }
-
-                // ROS_INFO_STREAM_NAMED("GapEstimation", "   tUpdate" << " - t_" << (intermediateRbtVels_.size() - 1) << " difference:" << (tUpdate - intermediateRbtVels_[intermediateRbtVels_.size() - 1].header.stamp).toSec() << " sec");
-
-                // Tweaking ego robot velocities/acceleration to make sure that updates:
-                //      1. Are never negative (backwards in time)
-                //      2. Always start from time of last update
-                //      3. Always at end at time of incoming laser scan measurement
-
-                // Erasing odometry measurements that are from *before* the last update 
-                while (!intermediateRbtVels_.empty() && tLastUpdate_ > intermediateRbtVels_[0].header.stamp)
-                    intermediateRbtVels_.erase(intermediateRbtVels_.begin());
-
-                while (!intermediateRbtAccs_.empty() && tLastUpdate_ > intermediateRbtAccs_[0].header.stamp)
-                    intermediateRbtAccs_.erase(intermediateRbtAccs_.begin());
-
-                // Inserting placeholder odometry to represent the time of the last update
-                // intermediateRbtVels_.insert(intermediateRbtVels_.begin(), lastRbtVel_);
-                // intermediateRbtVels_[0].header.stamp = tLastUpdate_;
-                bool velValueAtScanTime = false;
-                for (int i = 0; i < intermediateRbtVels_.size(); i++)
-                {
-                    if (intermediateRbtVels_.at(i).header.stamp == tLastUpdate_)
-                    {
-                        velValueAtScanTime = true;
-                        break;
-                    }
-                }
-                if (!velValueAtScanTime)
-                {
-                    intermediateRbtVels_.insert(intermediateRbtVels_.begin(), lastRbtVel_);
-                    intermediateRbtVels_[0].header.stamp = tLastUpdate_;
-                }
-
-                // intermediateRbtAccs_.insert(intermediateRbtAccs_.begin(), lastRbtAcc_);
-                // intermediateRbtAccs_[0].header.stamp = tLastUpdate_;
-                bool accValueAtScanTime = false;
-                for (int i = 0; i < intermediateRbtAccs_.size(); i++)
-                {
-                    if (intermediateRbtAccs_.at(i).header.stamp == tLastUpdate_)
-                    {
-                        accValueAtScanTime = true;
-                        break;
-                    }
-                }
-                if (!accValueAtScanTime)
-                {
-                    intermediateRbtAccs_.insert(intermediateRbtAccs_.begin(), lastRbtAcc_);
-                    intermediateRbtAccs_[0].header.stamp = tLastUpdate_;
-                }
-
-                // Erasing odometry measurements that occur *after* the incoming laser scan was received
-                while (!intermediateRbtVels_.empty() && tUpdate < intermediateRbtVels_[intermediateRbtVels_.size() - 1].header.stamp)
-                    intermediateRbtVels_.erase(intermediateRbtVels_.end() - 1);
-
-                while (!intermediateRbtAccs_.empty() && tUpdate < intermediateRbtAccs_[intermediateRbtAccs_.size() - 1].header.stamp)
-                    intermediateRbtAccs_.erase(intermediateRbtAccs_.end() - 1);
-
-                // Inserting placeholder odometry to represent the time that the incoming laser scan was received
-                bool lastVelValueAtScanTime = false;
-                for (int i = 0; i < intermediateRbtVels_.size(); i++)
-                {
-                    if (intermediateRbtVels_.at(i).header.stamp == tUpdate)
-                    {
-                        lastVelValueAtScanTime = true;
-                        break;
-                    }
-                }
-                if (!lastVelValueAtScanTime)
-                {
-                    if (!intermediateRbtVels_.empty())
-                        intermediateRbtVels_.push_back(intermediateRbtVels_.back());
-                    else
-                        intermediateRbtVels_.push_back(lastRbtVel_);
-
-                    intermediateRbtVels_.back().header.stamp = tUpdate;
-                }
-                
-                bool lastAccValueAtScanTime = false;
-                for (int i = 0; i < intermediateRbtAccs_.size(); i++)
-                {
-                    if (intermediateRbtAccs_.at(i).header.stamp == tUpdate)
-                    {
-                        lastAccValueAtScanTime = true;
-                        break;
-                    }
-                }
-                if (!lastAccValueAtScanTime)
-                {
-                    if (!intermediateRbtAccs_.empty())
-                        intermediateRbtAccs_.push_back(intermediateRbtAccs_.back());
-                    else
-                        intermediateRbtAccs_.push_back(lastRbtAcc_);
-
-                    intermediateRbtAccs_.back().header.stamp = tUpdate;
-                }
-
-                // Interpolating to make sure that vels and accs share all of the same time steps
-                // std::vector<geometry_msgs::TwistStamped> testIntermediateRbtVels_ = intermediateRbtVels_;
-                // std::vector<geometry_msgs::TwistStamped> testIntermediateRbtAccs_ = intermediateRbtAccs_;
-
-                // ROS_INFO_STREAM("incoming testIntermediateRbtVels_: ");
-                // for (int i = 0; i < testIntermediateRbtVels_.size(); i++)
-                // {
-                //     ROS_INFO_STREAM("   " << i << ": ");                
-                //     ROS_INFO_STREAM("       header.stamp: " << testIntermediateRbtVels_[i].header.stamp);
-                //     ROS_INFO_STREAM("       linear: ");
-                //     ROS_INFO_STREAM("           x: " << testIntermediateRbtVels_[i].twist.linear.x);
-                //     ROS_INFO_STREAM("           y: " << testIntermediateRbtVels_[i].twist.linear.y);                 
-                // }
-
-                // ROS_INFO_STREAM("incoming testIntermediateRbtAccs_: ");
-                // for (int i = 0; i < testIntermediateRbtAccs_.size(); i++)
-                // {
-                //     ROS_INFO_STREAM("   " << i << ": ");                
-                //     ROS_INFO_STREAM("       header.stamp: " << testIntermediateRbtAccs_[i].header.stamp);
-                //     ROS_INFO_STREAM("       linear: ");
-                //     ROS_INFO_STREAM("           x: " << testIntermediateRbtAccs_[i].twist.linear.x);
-                //     ROS_INFO_STREAM("           y: " << testIntermediateRbtAccs_[i].twist.linear.y);
-                // }
-
-                if (intermediateRbtVels_.size() > 0 && intermediateRbtAccs_.size() > 0)
-                    interpolateIntermediateValues(intermediateRbtVels_, intermediateRbtAccs_);
-                
-                if (intermediateRbtAccs_.size() > 0 && intermediateRbtVels_.size() > 0)
-                    interpolateIntermediateValues(intermediateRbtAccs_, intermediateRbtVels_);
-
-                // ROS_INFO_STREAM("outgoing testIntermediateRbtVels_: ");
-                // for (int i = 0; i < testIntermediateRbtVels_.size(); i++)
-                // {
-                //     ROS_INFO_STREAM("   " << i << ": ");                
-                //     ROS_INFO_STREAM("       header.stamp: " << testIntermediateRbtVels_[i].header.stamp);
-                //     ROS_INFO_STREAM("       linear: ");
-                //     ROS_INFO_STREAM("           x: " << testIntermediateRbtVels_[i].twist.linear.x);
-                //     ROS_INFO_STREAM("           y: " << testIntermediateRbtVels_[i].twist.linear.y);                 
-                // }
-
-                // ROS_INFO_STREAM("outgoing testIntermediateRbtAccs_: ");
-                // for (int i = 0; i < testIntermediateRbtAccs_.size(); i++)
-                // {
-                //     ROS_INFO_STREAM("   " << i << ": ");                
-                //     ROS_INFO_STREAM("       header.stamp: " << testIntermediateRbtAccs_[i].header.stamp);
-                //     ROS_INFO_STREAM("       linear: ");
-                //     ROS_INFO_STREAM("           x: " << testIntermediateRbtAccs_[i].twist.linear.x);
-                //     ROS_INFO_STREAM("           y: " << testIntermediateRbtAccs_[i].twist.linear.y);
-                // }
-
-                for (int i = 0; i < (intermediateRbtVels_.size() - 1); i++)
-                {
-                    float dt = (intermediateRbtVels_[i + 1].header.stamp - intermediateRbtVels_[i].header.stamp).toSec();
-                    
-                    // ROS_INFO_STREAM_NAMED("GapEstimation", "   t_" << (i+1) << " - t_" << i << " difference: " << dt << " sec");
-                    
-                    ROS_WARN_STREAM_COND_NAMED(dt < 0, "GapEstimation", "ERROR IN TIMESTEP CALCULATION, SHOULD NOT BE NEGATIVE");
-
-                }
-
-                // ROS_INFO_STREAM("intermediateRbtVels_: ");
-                // for (int i = 0; i < intermediateRbtVels_.size(); i++)
-                // {
-                //     ROS_INFO_STREAM("   " << i << ": ");                
-                //     ROS_INFO_STREAM("       header.stamp: " << intermediateRbtVels_[i].header.stamp);
-                //     ROS_INFO_STREAM("       linear: ");
-                //     ROS_INFO_STREAM("           x: " << intermediateRbtVels_[i].twist.linear.x);
-                //     ROS_INFO_STREAM("           y: " << intermediateRbtVels_[i].twist.linear.y);                 
-                // }
-
-                // ROS_INFO_STREAM("intermediateRbtAccs_: ");
-                // for (int i = 0; i < intermediateRbtAccs_.size(); i++)
-                // {
-                //     ROS_INFO_STREAM("   " << i << ": ");                
-                //     ROS_INFO_STREAM("       header.stamp: " << intermediateRbtAccs_[i].header.stamp);
-                //     ROS_INFO_STREAM("       linear: ");
-                //     ROS_INFO_STREAM("           x: " << intermediateRbtAccs_[i].twist.linear.x);
-                //     ROS_INFO_STREAM("           y: " << intermediateRbtAccs_[i].twist.linear.y);
-                // }
+                return egoMotionTimeline.matches(tLastUpdate_, lastRbtVel_, lastRbtAcc_, tUpdate, Q_k_);
             }
 
             /**
-            * \brief helper function for interpolating intermediate vel/acc measurements
-            * so that during model update, we have vel/acc measurements at all intermediate timesteps
-            *
-            * \param vectorI vector which we want to *add* interpolated values to
-            * \param vectorJ vector which we base interpolation off of 
+            * \brief Obtain ego-robot motion to update estimator along. Shared timeline is used as-is if it was built
+            * from this estimator's last update, otherwise it is re-aligned to start from this estimator's last update.
+            * \param egoMotionTimeline ego-robot motion since last model update, shared across estimators for current scan
+            * \param tUpdate time of current model update
+            * \return ego-robot motion timeline that starts at this estimator's last update
             */
-            void interpolateIntermediateValues(std::vector<geometry_msgs::TwistStamped> & vectorI,
-                                               const std::vector<geometry_msgs::TwistStamped> & vectorJ)
+            const EgoMotionTimeline & alignEgoMotionTimeline(const EgoMotionTimeline & egoMotionTimeline, const ros::Time & tUpdate)
             {
-                // filling in velocities first
-                for (int j = 0; j < vectorJ.size(); j++)
-                {
-                    // see if acceleration's timestamp is present
-                    int timeJLowerBoundIthIdx = -1; // largest timestamp in i smaller than j
-                    int timeJUpperBoundIthIdx = -1; // smallest timestamp in i bigger than j
-
-                    int timeJIthIndex = -1;
-                    for (int i = 0; i < vectorI.size(); i++)
-                    {
-                        if (vectorJ[j].header.stamp > vectorI[i].header.stamp)
-                            timeJLowerBoundIthIdx = i;
-
-                        if (timeJUpperBoundIthIdx < 0 && vectorJ[j].header.stamp < vectorI[i].header.stamp)
-                            timeJUpperBoundIthIdx = i;
-
-                        if (vectorJ[j].header.stamp == vectorI[i].header.stamp)
-                        {
-                            timeJIthIndex = i;
-                            break;
-                        }
-                    }
-
-                    if (timeJIthIndex > 0) // acceleration's timestamp is present, we don't need to do anything
-                    {
-                        // ROS_INFO_STREAM("       timeJIthIndex: " << timeJIthIndex);
-                        continue;
-                    } else
-                    {
-                        // ROS_INFO_STREAM("       timeJLowerBoundIthIdx: " << timeJLowerBoundIthIdx);
-                        // ROS_INFO_STREAM("       timeJUpperBoundIthIdx: " << timeJUpperBoundIthIdx);
-
-                        if (timeJLowerBoundIthIdx == -1 && timeJUpperBoundIthIdx == -1) // lower bound is -1 and upper bound is -1
-                        {
-                            //      only if one array is empty, should not happen
-                            // ROS_INFO_STREAM("lower and upper bounds are -1, should not happen");
-                        } else if (timeJLowerBoundIthIdx == -1 && timeJUpperBoundIthIdx >= 0) // lower bound is -1 and upper bound is >=0
-                        {
-                            // nothing in i is smaller than j, just re-add first element of i
-                            vectorI.insert(vectorI.begin(), vectorI.at(0));
-                            vectorI.at(0).header.stamp = vectorJ.at(j).header.stamp;
-                        } else if (timeJLowerBoundIthIdx >= 0 && timeJUpperBoundIthIdx == -1) // lower bound is >=0 and upper bound is -1
-                        {
-                            // nothing in i is bigger than j, just re-add last element of i
-                            vectorI.insert(vectorI.end(), vectorI.at(vectorI.size() - 1));
-                            vectorI.at(vectorI.size() - 1).header.stamp = vectorJ.at(j).header.stamp;
-                        } else if (timeJLowerBoundIthIdx >= 0 && timeJUpperBoundIthIdx >= 0) // lower bound is >=0 and upper bound is >=0
-                        {
-                            geometry_msgs::TwistStamped interpTwist;
-                            interpTwist.header.frame_id = vectorJ.at(j).header.frame_id;
-                            interpTwist.header.stamp = vectorJ.at(j).header.stamp;
-
-                            float linear_x_diff = (vectorI.at(timeJUpperBoundIthIdx).twist.linear.x - vectorI.at(timeJLowerBoundIthIdx).twist.linear.x);
-                            float linear_y_diff = (vectorI.at(timeJUpperBoundIthIdx).twist.linear.y - vectorI.at(timeJLowerBoundIthIdx).twist.linear.y);
-                            float angular_z_diff = (vectorI.at(timeJUpperBoundIthIdx).twist.angular.z - vectorI.at(timeJLowerBoundIthIdx).twist.angular.z);
-
-                            float time_diff_num = (interpTwist.header.stamp - vectorI.at(timeJLowerBoundIthIdx).header.stamp).toSec();
-                            float time_diff_denom = (vectorI.at(timeJUpperBoundIthIdx).header.stamp - vectorI.at(timeJLowerBoundIthIdx).header.stamp).toSec();
-
-                            interpTwist.twist.linear.x = vectorI.at(timeJLowerBoundIthIdx).twist.linear.x +
-                                                            linear_x_diff * time_diff_num / time_diff_denom; 
-                            interpTwist.twist.linear.y = vectorI.at(timeJLowerBoundIthIdx).twist.linear.y +
-                                                            linear_y_diff * time_diff_num / time_diff_denom; 
-                            interpTwist.twist.angular.z = vectorI.at(timeJLowerBoundIthIdx).twist.angular.z +
-                                                            angular_z_diff * time_diff_num / time_diff_denom;
-
-                            vectorI.insert(vectorI.begin() + timeJUpperBoundIthIdx, interpTwist);
-                        }
-                    }
-                }                
+                if (sharesEgoMotionTimeline(egoMotionTimeline, tUpdate))
+                    return egoMotionTimeline;
+
+                privateEgoMotionTimeline_.build(egoMotionTimeline.rawRbtVels(), egoMotionTimeline.rawRbtAccs(),
+                                                tLastUpdate_, lastRbtVel_, lastRbtAcc_, tUpdate, Q_k_);
+                return privateEgoMotionTimeline_;
             }
 
             /**
@@ -495,6 +259,83 @@ namespace dynamic_gap
                 xRewind_ = xRewindProp_; 
             }
 
+            /**
+            * \brief Virtual function for writing estimator state into planner checkpoint,
+            * must be extended by model classes that keep state of their own
+            * \param writer checkpoint writer
+            */
+            virtual void writeCheckpoint(CheckpointWriter & writer) const
+            {
+                writer.write(modelID_);
+                writer.write(side_);
+
+                writer.write(x_hat_kmin1_plus_);
+                writer.write(x_hat_k_minus_);
+                writer.write(x_hat_k_plus_);
+                writer.write(P_kmin1_plus_);
+                writer.write(P_k_minus_);
+                writer.write(P_k_plus_);
+
+                writer.write(xFrozen_);
+                writer.write(xRewind_);
+
+                writer.write(G_k_);
+                writer.write(xTilde_);
+
+                writer.write(R_k_);
+                writer.write(Q_k_);
+                writer.write(R_temp_);
+                writer.write(Q_temp_);
+
+                writer.writeMessage(lastRbtVel_);
+                writer.writeMessage(lastRbtAcc_);
+
+                writer.write(tStart_);
+                writer.write(tLastUpdate_);
+
+                writer.write(manip_);
+                writer.write(josephForm_);
+                writer.write(manipPosition);
+            }
+
+            /**
+            * \brief Virtual function for restoring estimator state from planner checkpoint
+            * \param reader checkpoint reader
+            */
+            virtual void readCheckpoint(CheckpointReader & reader)
+            {
+                reader.read(modelID_);
+                reader.read(side_);
+
+                reader.read(x_hat_kmin1_plus_);
+                reader.read(x_hat_k_minus_);
+                reader.read(x_hat_k_plus_);
+                reader.read(P_kmin1_plus_);
+                reader.read(P_k_minus_);
+                reader.read(P_k_plus_);
+
+                reader.read(xFrozen_);
+                reader.read(xRewind_);
+
+                reader.read(G_k_);
+                reader.read(xTilde_);
+
+                reader.read(R_k_);
+                reader.read(Q_k_);
+                reader.read(R_temp_);
+                reader.read(Q_temp_);
+
+                reader.readMessage(lastRbtVel_);
+                reader.readMessage(lastRbtAcc_);
+
+                reader.read(tStart_);
+                reader.read(tLastUpdate_);
+
+                reader.read(manip_);
+                reader.read(josephForm_);
+                reader.read(manipPosition);
+            }
+
             void setManip() { manip_ = true; }
             void setNewPosition(const float & newTheta, const float & newRange) 
             { 
@@ -502,5 +343,7 @@ namespace dynamic_gap
                                  newRange * std::sin(newTheta); 
             }
 
+        private:
+            EgoMotionTimeline privateEgoMotionTimeline_; /**< ego-robot motion re-aligned for estimators that cannot use the shared timeline */
     };
 }
\ No newline at end of file
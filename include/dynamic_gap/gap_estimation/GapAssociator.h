@@ -1,7 +1,3 @@
-
-/**
-* Adapted from https://github.com/mcximing/hungarian-algorithm-cpp/blob/master/Hungarian.h
-*/
 #pragma once
 
 #include <ros/ros.h>
@@ -12,7 +8,7 @@
 #include <iostream>
 #include <vector>
 #include <stdlib.h>
-#include <cfloat> // for DBL_MAX
+#include <cfloat> // for FLT_MAX
 #include <cmath>  // for fabs()
 #include <chrono>
 
@@ -40,31 +36,43 @@ namespace dynamic_gap
 		* \param previousGaps previous set of gaps
 		* \return distance matrix: 2D matrix with entries that represent distance between gap points at corresponding indices 
 		*/		
-		std::vector<std::vector<float>> obtainDistMatrix(const std::vector<dynamic_gap::Gap *> & currentGaps, 
-														 const std::vector<dynamic_gap::Gap *> & previousGaps);
+		Eigen::MatrixXf obtainDistMatrix(const std::vector<dynamic_gap::Gap *> & currentGaps, 
+										 const std::vector<dynamic_gap::Gap *> & previousGaps);
 		
 		/**
 		* \brief Obtain minimum distance association between current gap points and previous gap points 
 		* \param distMatrix populated distance matrix
 		* \return minimum distance association
 		*/				
-		std::vector<int> associateGaps(const std::vector< std::vector<float> > & distMatrix);
+		std::vector<int> associateGaps(const Eigen::MatrixXf & distMatrix);
+
+		/**
+		* \brief Obtain minimum distance association between current gap points and previous gap points
+		* while only considering pairs of points within an angular band of each other. Gap points are swept
+		* in bearing order (wrapping around at +/- pi) to collect candidate pairs, and each connected group
+		* of candidates is solved on its own. Falls back to the full solver if a group grows too large.
+		* \param currentGaps current set of gaps
+		* \param previousGaps previous set of gaps
+		* \return minimum distance association
+		*/
+		std::vector<int> associateGapsBanded(const std::vector<dynamic_gap::Gap *> & currentGaps, 
+											 const std::vector<dynamic_gap::Gap *> & previousGaps);
         
 		/**
 		* \brief Function for handling the transfer of gap estimator models from previous gaps to current gaps
 		* \param association minimum distance association
-		* \param distMatrix populated distance matrix
 		* \param currentGaps current set of gaps
 		* \param previousGaps previous set of gaps		
+		* \param ownsPreviousGaps whether nothing else can be reading previous gaps, so that their models can be moved
 		* \param currentModelIdx counter for model ID
 		* \param scanTime ROS timestamp at which scan is read in to assign to models
 		* \param intermediateRbtVels sequence of ego-robot velocities received since last model update
 		* \param intermediateRbtAccs sequence of ego-robot accelerations received since last model update
 		*/				
 		void assignModels(const std::vector<int> & association, 
-						  const std::vector< std::vector<float> > & distMatrix, 
 						  std::vector<dynamic_gap::Gap *>& currentGaps, 
 						  const std::vector<dynamic_gap::Gap *> & previousGaps,
+						  const bool & ownsPreviousGaps,
 						  int & currentModelIdx,
 						  const ros::Time & scanTime, 
 						  const std::vector<geometry_msgs::TwistStamped> & intermediateRbtVels, 
@@ -80,14 +88,43 @@ namespace dynamic_gap
 		std::vector< std::vector<float>> obtainGapPoints(const std::vector<dynamic_gap::Gap *> & gaps);
 
 		/**
-		* \brief Helper function for handing off a model from a previous gap point to a current gap point
+		* \brief Compute bearings of gap points and order gap points by bearing
+		* \param gapPoints vector of gap points
+		* \param bearings bearing of each gap point
+		* \param bearingOrder indices of gap points sorted by increasing bearing
+		*/
+		void sortGapPointsByBearing(const std::vector< std::vector<float>> & gapPoints,
+									std::vector<float> & bearings,
+									std::vector<int> & bearingOrder);
+
+		/**
+		* \brief Distance between a current gap point and a previous gap point
+		* \param i index of current gap point
+		* \param j index of previous gap point
+		* \return distance between gap points
+		*/
+		float gapPointDist(const int & i, const int & j);
+
+		/**
+		* \brief Find representative of candidate group that a gap point belongs to
+		* \param node gap point node (current points first, then previous points)
+		* \return representative node of group
+		*/
+		int findBandGroup(int node);
+
+		/**
+		* \brief Helper function for handing off a model from a previous gap point to a current gap point.
+		* Model is moved to current gap without copying, unless previous gaps may still be read elsewhere
+		* or previous gap point has already been handed off.
 		* \param pair pair of indices for associated previous and current gap points
 		* \param currentGaps current set of gaps
 		* \param previousGaps previous set of gaps	
+		* \param ownsPreviousGaps whether nothing else can be reading previous gaps
 		*/		
 		void handOffModel(const std::vector<int> & pair,
 						  const std::vector<dynamic_gap::Gap *> & currentGaps, 
-						  const std::vector<dynamic_gap::Gap *> & previousGaps);	
+						  const std::vector<dynamic_gap::Gap *> & previousGaps,
+						  const bool & ownsPreviousGaps);	
 		
 		/**
 		* \brief Helper function for instantiating a new model for a current gap point
@@ -107,60 +144,81 @@ namespace dynamic_gap
 
 		/**
 		* \brief A single function wrapper for solving rectangular assignment problem
-		* \param DistMatrix populated distance matrix
-		* \param Assignment minimum distance association
+		* \param distMatrix populated distance matrix
+		* \param assignment minimum distance association
 		* \return total "cost" of minimum distance association
 		*/
-		float Solve(const std::vector <std::vector<float> >& DistMatrix, std::vector<int>& Assignment);
+		float Solve(const Eigen::MatrixXf & distMatrix, std::vector<int> & assignment);
 
 		/**
-		* \brief Solve optimal solution for assignment problem using Munkres algorithm, also known as Hungarian Algorithm.
-		* \param assignment minimum distance association
-		* \param cost total "cost" of minimum distance association
-		* \param distMatrix populated distance matrix
-		* \param nOfRows number of rows in distMatrix
-		* \param nOfColumns number of columns in distMatrix
+		* \brief Solve rectangular assignment problem of either orientation on column-major cost matrix
+		* \param costs column-major cost matrix, entry (i, j) lives at i + nOfRows * j
+		* \param nOfRows number of rows in cost matrix
+		* \param nOfColumns number of columns in cost matrix
+		* \param assignment column assigned to each row (-1 if unassigned)
+		* \return total "cost" of assignment
 		*/
-		void assignmentoptimal(int *assignment, float *cost, float *distMatrix, int nOfRows, int nOfColumns);
-		
+		float solveAssignment(const float * costs, const int & nOfRows, const int & nOfColumns, int * assignment);
+
 		/**
-		* \brief Inner contents of Hungarian algorithm.
+		* \brief Solve rectangular assignment problem with shortest augmenting paths (Jonker-Volgenant).
+		* Cost matrix is read in place with arbitrary strides, and must have no more rows than columns.
+		* Entries beyond association threshold are forbidden, and rows left with only forbidden
+		* entries are unassigned.
+		* \param costs pointer to first entry of cost matrix
+		* \param rowStride offset between consecutive rows in cost matrix
+		* \param colStride offset between consecutive columns in cost matrix
+		* \param nOfRows number of rows in cost matrix
+		* \param nOfColumns number of columns in cost matrix
+		* \param colForRow column assigned to each row (-1 if unassigned)
+		* \return total "cost" of assignment
 		*/
-		void buildassignmentvector(int *assignment, bool *starMatrix, int nOfRows, int nOfColumns);
-		
-		/**
-		* \brief Inner contents of Hungarian algorithm.
-		*/		
-		void computeassignmentcost(int *assignment, float *cost, float *distMatrix, int nOfRows);
-		
-		/**
-		* \brief Inner contents of Hungarian algorithm.
-		*/		
-		void step2a(int *assignment, float *distMatrix, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, int nOfRows, int nOfColumns, int minDim);
-		
-		/**
-		* \brief Inner contents of Hungarian algorithm.
-		*/		
-		void step2b(int *assignment, float *distMatrix, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, int nOfRows, int nOfColumns, int minDim);
-		
-		/**
-		* \brief Inner contents of Hungarian algorithm.
-		*/		
-		void step3(int *assignment, float *distMatrix, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, int nOfRows, int nOfColumns, int minDim);
-		
-		/**
-		* \brief Inner contents of Hungarian algorithm.
-		*/		
-		void step4(int *assignment, float *distMatrix, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, int nOfRows, int nOfColumns, int minDim, int row, int col);
-		
+		float solveShortestAugmentingPaths(const float * costs, const int & rowStride, const int & colStride, 
+										   const int & nOfRows, const int & nOfColumns, int * colForRow);
+
 		/**
-		* \brief Inner contents of Hungarian algorithm.
-		*/		
-		void step5(int *assignment, float *distMatrix, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, int nOfRows, int nOfColumns, int minDim);
+		* \brief Grow solver workspace so that it fits a problem of given size. Workspace is never shrunk.
+		* \param nOfRows number of rows in cost matrix
+		* \param nOfColumns number of columns in cost matrix
+		*/
+		void reserveWorkspace(const int & nOfRows, const int & nOfColumns);
 	
 		std::vector< std::vector<float>> previousGapPoints; /**< sequence of points within previous gaps */
 		std::vector< std::vector<float>> currentGapPoints; /**< sequence of points within current gaps */
 		const DynamicGapConfig* cfg_ = NULL; /**< Planner hyperparameter config list */
 		float assocThresh; /**<  maximum distance threshold for which we will consider an association between models valid */
+		std::vector<Estimator *> handedOffModels_; /**< model each previous gap point has been moved into during current hand off (NULL if not yet moved) */
+
+		// assignment solver workspace, kept across calls
+		std::vector<float> rowPotentials_; /**< dual variables for rows of cost matrix */
+		std::vector<float> colPotentials_; /**< dual variables for columns of cost matrix */
+		std::vector<float> shortestPathCosts_; /**< reduced cost of shortest alternating path to each column */
+		std::vector<int> pathRows_; /**< predecessor row of each column along shortest alternating path */
+		std::vector<int> colForRow_; /**< column currently assigned to each row */
+		std::vector<int> rowForCol_; /**< row currently assigned to each column */
+		std::vector<int> remainingCols_; /**< columns not yet scanned in current augmentation */
+		std::vector<char> scannedRows_; /**< rows scanned in current augmentation */
+		std::vector<char> scannedCols_; /**< columns scanned in current augmentation */
+
+		// banded association workspace, kept across calls
+		std::vector<float> currentBearings_; /**< bearings of current gap points */
+		std::vector<float> previousBearings_; /**< bearings of previous gap points */
+		std::vector<int> currentBearingOrder_; /**< current gap points sorted by bearing */
+		std::vector<int> previousBearingOrder_; /**< previous gap points sorted by bearing */
+		std::vector<int> bandEdgeRows_; /**< current gap point of each candidate pair */
+		std::vector<int> bandEdgeCols_; /**< previous gap point of each candidate pair */
+		std::vector<float> bandEdgeDists_; /**< distance of each candidate pair */
+		std::vector<int> bandGroupParents_; /**< union-find parents over current then previous gap points */
+		std::vector<int> bandGroupIDs_; /**< group of each gap point */
+		std::vector<int> bandLocalIndices_; /**< position of each gap point within its group's rows or columns */
+		std::vector<int> bandGroupRowCounts_; /**< number of current gap points in each group */
+		std::vector<int> bandGroupColCounts_; /**< number of previous gap points in each group */
+		std::vector<int> bandGroupCostOffsets_; /**< offset of each group's cost matrix within bandCosts_ */
+		std::vector<int> bandGroupRows_; /**< current gap points of all groups, grouped contiguously */
+		std::vector<int> bandGroupRowOffsets_; /**< offset of each group's current gap points within bandGroupRows_ */
+		std::vector<int> bandGroupCols_; /**< previous gap points of all groups, grouped contiguously */
+		std::vector<int> bandGroupColOffsets_; /**< offset of each group's previous gap points within bandGroupCols_ */
+		std::vector<float> bandCosts_; /**< column-major cost matrices of all groups */
+		std::vector<int> bandAssignment_; /**< assignment within a group */
 	};
 }
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <ros/ros.h>
+#include <vector>
+
+#include <dynamic_gap/utils/Gap.h>
+#include <dynamic_gap/config/DynamicGapConfig.h>
+#include <dynamic_gap/gap_estimation/Estimator.h>
+
+namespace dynamic_gap
+{
+    /**
+    * \brief Class responsible for keeping a single registry of tracked gap points
+    * keyed by scan index so that raw and simplified gaps share gap point estimators.
+    * Raw gaps own the tracked gap point estimators, and every simplified gap point is
+    * a raw gap point, so simplified gaps only need handles into the registry.
+    */
+    class GapTrackRegistry
+    {
+        public:
+            /**
+            * \brief Constructor with planner config 
+            * \param cfg config file for planner parameters
+            */
+            GapTrackRegistry(const DynamicGapConfig& cfg) { cfg_ = &cfg; }
+
+            /**
+            * \brief Register gap point estimators of raw gaps under their scan indices, 
+            * replacing whatever was registered for the previous scan
+            * \param rawGaps set of raw gaps that own gap point estimators
+            */
+            void registerTracks(const std::vector<dynamic_gap::Gap *> & rawGaps);
+
+            /**
+            * \brief Point simplified gaps at the registered gap point estimators found at their scan indices
+            * \param simplifiedGaps set of simplified gaps
+            */
+            void bindTracks(const std::vector<dynamic_gap::Gap *> & simplifiedGaps);
+
+        private:
+            const DynamicGapConfig* cfg_ = NULL; /**< Planner hyperparameter config list */
+
+            std::vector<Estimator *> leftTracks_; /**< Left gap point estimators indexed by scan index */
+            std::vector<Estimator *> rightTracks_; /**< Right gap point estimators indexed by scan index */
+            std::vector<int> registeredIndices_; /**< Scan indices currently holding an estimator */
+    };
+}
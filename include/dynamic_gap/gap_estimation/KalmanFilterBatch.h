@@ -0,0 +1,111 @@
+#pragma once
+
+#include <ros/ros.h>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <dynamic_gap/config/DynamicGapConfig.h>
+#include <dynamic_gap/gap_estimation/EgoMotionTimeline.h>
+#include <dynamic_gap/gap_estimation/RotatingFrameCartesianKalmanFilter.h>
+#include <dynamic_gap/utils/WorkerPool.h>
+
+namespace dynamic_gap
+{
+    /**
+    * \brief Class responsible for updating many rotating frame Kalman filters in lockstep.
+    * Filters that share the scan's ego-motion timeline are gathered into structure-of-arrays form
+    * (one contiguous column per state, covariance, and gain entry), run through predict, innovation, 
+    * gain, and covariance update together so that every step vectorizes across filters, and scattered back.
+    * Filters only ever touch their own row, so the batch is split into fixed-size row chunks that run in parallel.
+    */
+    class KalmanFilterBatch
+    {
+        public:
+            /**
+            * \brief Constructor with planner config 
+            * \param cfg config file for planner parameters
+            */
+            KalmanFilterBatch(const DynamicGapConfig& cfg) { cfg_ = &cfg; }
+
+            /**
+            * \brief Queue filter for next batched update
+            * \param filter filter to update, must share ego-motion timeline that batch is updated along
+            * \param measurement new sensor measurement for filter
+            */
+            void add(RotatingFrameCartesianKalmanFilter * filter, const Eigen::Vector2f & measurement);
+
+            /**
+            * \brief Update all queued filters along shared ego-motion timeline and clear queue
+            * \param egoMotionTimeline ego-robot motion since last model update, shared by all queued filters
+            * \param tUpdate time of current model update
+            * \param workerPool pool that row chunks of batch are run on
+            */
+            void update(const EgoMotionTimeline & egoMotionTimeline, const ros::Time & tUpdate, WorkerPool * workerPool);
+
+            /**
+            * \brief Drop all queued filters without updating them
+            */
+            void clear();
+
+        private:
+            /**
+            * \brief Grow batch workspace so that it fits given number of filters. Workspace is never shrunk.
+            * \param nFilters number of filters in batch
+            */
+            void reserveWorkspace(const int & nFilters);
+
+            /**
+            * \brief Copy filter states, covariances, gains, noisy measurements, and covariance modes into batch
+            * \param begin first row of chunk
+            * \param nRows number of rows in chunk
+            */
+            void gather(const int & begin, const int & nRows);
+
+            /**
+            * \brief Propagate states and covariances along every intermediate step of ego-motion timeline
+            * \param egoMotionTimeline ego-robot motion since last model update
+            * \param begin first row of chunk
+            * \param nRows number of rows in chunk
+            */
+            void predict(const EgoMotionTimeline & egoMotionTimeline, const int & begin, const int & nRows);
+
+            /**
+            * \brief Correct propagated states and covariances with measurements, using closed-form 2x2 innovation inverse.
+            * Covariances of filters set to Joseph form are corrected in Joseph form.
+            * \param begin first row of chunk
+            * \param nRows number of rows in chunk
+            */
+            void correct(const int & begin, const int & nRows);
+
+            /**
+            * \brief Copy updated states, covariances, and gains back into filters
+            * \param egoMotionTimeline ego-robot motion since last model update
+            * \param tUpdate time of current model update
+            * \param begin first row of chunk
+            * \param nRows number of rows in chunk
+            */
+            void scatter(const EgoMotionTimeline & egoMotionTimeline, const ros::Time & tUpdate, const int & begin, const int & nRows);
+
+            const DynamicGapConfig* cfg_ = NULL; /**< Planner hyperparameter config list */
+
+            static constexpr int rowsPerChunk_ = 64; /**< number of filters in each parallel row chunk, fixed so results do not depend on thread count */
+
+            std::vector<RotatingFrameCartesianKalmanFilter *> filters_; /**< filters queued for next batched update */
+            std::vector<Eigen::Vector2f> measurements_; /**< sensor measurement of each queued filter */
+
+            // structure-of-arrays workspace, one row per filter, kept across calls. 
+            // Matrix entry (r, c) lives in column r + rows * c
+            Eigen::ArrayXXf predictedStates_; /**< states propagated along ego-motion timeline (4 columns) */
+            Eigen::ArrayXXf correctedStates_; /**< states after correction (4 columns) */
+            Eigen::ArrayXXf stateScratch_; /**< placeholding states during propagation (4 columns) */
+            Eigen::ArrayXXf predictedCovariances_; /**< covariances propagated along ego-motion timeline (16 columns) */
+            Eigen::ArrayXXf correctedCovariances_; /**< covariances after correction (16 columns) */
+            Eigen::ArrayXXf covarianceScratch_; /**< placeholding covariances during propagation (16 columns) */
+            Eigen::ArrayXXf gains_; /**< Kalman gains (8 columns) */
+            Eigen::ArrayXXf measurementNoises_; /**< measurement noise matrices (4 columns) */
+            Eigen::ArrayXXf noisyMeasurements_; /**< sensor measurements with filter noise applied (2 columns) */
+            Eigen::ArrayXXf innovationInverses_; /**< inverses of innovation covariances (4 columns) */
+            Eigen::Array<bool, Eigen::Dynamic, 1> josephForms_; /**< Joseph form covariance update flag of each filter */
+    };
+}
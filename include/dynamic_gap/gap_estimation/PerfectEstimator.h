@@ -24,10 +24,6 @@ namespace dynamic_gap
     */
     class PerfectEstimator : public Estimator 
     {
-        private:            
-            std::map<std::string, geometry_msgs::Pose> agentPoses_; /**< poses of all agents in environment (ground truth information used for certain estimator classes */
-            std::map<std::string, geometry_msgs::Vector3Stamped> agentVels_; /**< velocities of all agents in environment (ground truth information used for certain estimator classes) */
-
         public:
 
             PerfectEstimator();
@@ -40,10 +36,8 @@ namespace dynamic_gap
             void transfer(const Estimator & incomingModel);
 
             void update(const Eigen::Vector2f & measurement, 
-                        const std::vector<geometry_msgs::TwistStamped> & intermediateRbtVels, 
-                        const std::vector<geometry_msgs::TwistStamped> & intermediateRbtAccs, 
-                        const std::map<std::string, geometry_msgs::Pose> & agentPoses,
-                        const std::map<std::string, geometry_msgs::Vector3Stamped> & agentVels,
+                        const EgoMotionTimeline & egoMotionTimeline, 
+                        const AgentTable & agents,
                         const ros::Time & tUpdate);
  
             /**
@@ -54,10 +48,10 @@ namespace dynamic_gap
 
             /**
             * \brief use ground truth information on agent poses and velocities to perfectly update model state
-
+            * \param agents ground truth states of all agents in environment
             * \return updated model state
             */
-            Eigen::Vector4f updateStateFromEnv();
+            Eigen::Vector4f updateStateFromEnv(const AgentTable & agents);
 
             float min_dist_thresh = 1.5;
 
@@ -9,6 +9,7 @@
 #include <Eigen/Dense>
 #include <unsupported/Eigen/MatrixFunctions>
 #include <random>
+#include <sstream>
 
 #include <dynamic_gap/config/DynamicGapConfig.h>
 #include <dynamic_gap/gap_estimation/Estimator.h>
@@ -24,27 +25,20 @@ namespace dynamic_gap
             Eigen::Matrix<float, 2, 4> H_; /**< Observation matrix */
             Eigen::Matrix<float, 4, 2> H_transpose_; /**< Transposed observation matrix */
 
-            Eigen::Matrix4f dQ_; /**< Discretized covariance noise matrix */
-
-            Eigen::Matrix4f Q_1_; /**< 1st order approximation of discretized covariance noise matrix */
-            Eigen::Matrix4f Q_2_; /**< 2nd order approximation of discretized covariance noise matrix */ 
-            Eigen::Matrix4f Q_3_; /**< 3rd order approximation of discretized covariance noise matrix */
-
             float R_scalar = 0.0; /**< Scalar value used to populate R matrix*/
             float Q_scalar = 0.0; /**< Scalar value used to populate Q matrix*/
 
             float alpha_R = 0.3; /**< Adaptive R parameter */
             float alpha_Q = 0.3; /**< Adaptie Q parameter */
 
-            Eigen::Matrix4f A_; /**< Continuous form of autonomous dynamics term */
-            Eigen::Matrix4f STM_; /**< Discrete form of autonomous dynamics term */
-
             Eigen::Matrix4f eyes; /**< 4x4 identity matrix */
 
             Eigen::Vector2f innovation_; /**< innovation term from Kalman filter update loop */
             Eigen::Vector2f residual_; /**< residual term from Kalman filter update loop */
 
             Eigen::Matrix2f tmp_mat; /**< place holder for inverse calculations */
+            Eigen::Matrix2f tmp_mat_inverse; /**< closed-form inverse of innovation covariance */
+            Eigen::Matrix4f I_minus_GH; /**< place holder for Joseph form covariance update */
 
             Eigen::Matrix4f P_intermediate; /**< placeholding variable for covariance matrix during updates */
             Eigen::Matrix4f new_P; /**< placeholding variable for covariance matrix during updates */
@@ -57,6 +51,12 @@ namespace dynamic_gap
 
             RotatingFrameCartesianKalmanFilter();
 
+            /**
+            * \brief Continuous form of covariance noise matrix that filters are constructed with
+            * \return covariance noise matrix
+            */
+            static Eigen::Matrix4f initialQ();
+
             void initialize(const std::string & side, const int & modelID, 
                             const float & gapPtX, const float & gapPtY,
                             const ros::Time & t_update, const geometry_msgs::TwistStamped & lastRbtVel,
@@ -64,34 +64,45 @@ namespace dynamic_gap
             void transfer(const Estimator & placeholder);
 
             void update(const Eigen::Vector2f & measurement, 
-                        const std::vector<geometry_msgs::TwistStamped> & intermediateRbtVels, 
-                        const std::vector<geometry_msgs::TwistStamped> & intermediateRbtAccs, 
-                        const std::map<std::string, geometry_msgs::Pose> & agentPoses,
-                        const std::map<std::string, geometry_msgs::Vector3Stamped> & agentVels,
+                        const EgoMotionTimeline & egoMotionTimeline, 
+                        const AgentTable & agents,
                         const ros::Time & tUpdate);
 
+            /**
+            * \brief Advance state and covariance along ego-robot motion without correcting them,
+            * shifting last measurement along with predicted position
+            * \param egoMotionTimeline ego-robot motion since last model update
+            * \param tPredict time to advance estimator to
+            */
+            void predict(const EgoMotionTimeline & egoMotionTimeline, const ros::Time & tPredict);
+
             /**
             * \brief Helper function for integrating estimator state forward in time
+            * \param egoMotionTimeline ego-robot motion to integrate along
             * \return Propagated estimator state
             */     
-            Eigen::Vector4f integrate();
+            Eigen::Vector4f integrate(const EgoMotionTimeline & egoMotionTimeline);
 
             /**
-            * \brief Helper function for linearizing nonlinear estimator dynamics
-            * \param idx index of intermediate update to linearize for 
-            */                 
-            void linearize(const int & idx);
+            * \brief Helper function for propagating covariance from last update along ego-robot motion into P_k_minus_
+            * \param egoMotionTimeline ego-robot motion to propagate along
+            */
+            void propagateCovariance(const EgoMotionTimeline & egoMotionTimeline);
 
             /**
-            * \brief Helper function for discretizing continuous form of covariance noise matrix
-            * \param idx index of intermediate update to discretize for 
-            */                 
-            void discretizeQ(const int & idx); 
+            * \brief Apply filter's measurement noise to incoming sensor measurement
+            * \param measurement new sensor measurement
+            * \return noisy sensor measurement
+            */
+            Eigen::Vector2f perturbMeasurement(const Eigen::Vector2f & measurement);
 
             /**
             * \brief Getter function for relative estimator state
             * \return relative (gap-robot) estimator state
             */     
             Eigen::Vector4f getState();
+
+            void writeCheckpoint(CheckpointWriter & writer) const;
+            void readCheckpoint(CheckpointReader & reader);
      };
 }
\ No newline at end of file
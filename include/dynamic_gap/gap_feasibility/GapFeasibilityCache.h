@@ -0,0 +1,139 @@
+#pragma once
+
+#include <ros/ros.h>
+#include <map>
+#include <mutex>
+#include <utility>
+
+#include <sensor_msgs/LaserScan.h>
+
+#include <Eigen/Core>
+
+#include <dynamic_gap/utils/Gap.h>
+#include <dynamic_gap/utils/Utils.h>
+#include <dynamic_gap/config/DynamicGapConfig.h>
+
+namespace dynamic_gap
+{
+    /**
+    * \brief Cache of gap lifespans and feasibility results that persists across planning loops, keyed by the
+    * IDs of a gap's left and right gap point models. The same pair of models usually bounds a gap for many
+    * planning loops with only small changes in state, so results are reused until the frozen gap point states,
+    * the manipulated gap or the scan range around the terminal goal drift past a tolerance.
+    * Safe to use from several gaps' feasibility checks at once.
+    */
+    class GapFeasibilityCache
+    {
+        public:
+            /**
+            * \brief Constructor with planner config
+            * \param cfg config file for planner parameters
+            */
+            GapFeasibilityCache(const DynamicGapConfig& cfg) { cfg_ = &cfg; }
+
+            /**
+            * \brief Look up gap lifespan and end condition, setting them on gap if cached entry is still valid
+            * \param gap gap whose lifespan we want
+            * \return whether gap lifespan was found
+            */
+            bool lookupLifespan(dynamic_gap::Gap * gap);
+
+            /**
+            * \brief Store gap lifespan and end condition, invalidating any cached feasibility result for gap
+            * \param gap gap whose lifespan was just computed
+            */
+            void storeLifespan(dynamic_gap::Gap * gap);
+
+            /**
+            * \brief Look up feasibility of gap, setting intercept solution and terminal goal on gap if
+            * cached entry is still valid
+            * \param gap manipulated gap whose feasibility we want
+            * \param scan current laser scan
+            * \param isGapFeasible cached feasibility of gap
+            * \return whether feasibility of gap was found
+            */
+            bool lookupFeasibility(dynamic_gap::Gap * gap,
+                                    const sensor_msgs::LaserScan & scan,
+                                    bool & isGapFeasible);
+
+            /**
+            * \brief Store feasibility, intercept solution and terminal goal of gap
+            * \param gap manipulated gap whose feasibility was just checked
+            * \param scan current laser scan
+            * \param isGapFeasible feasibility of gap
+            */
+            void storeFeasibility(dynamic_gap::Gap * gap,
+                                    const sensor_msgs::LaserScan & scan,
+                                    const bool & isGapFeasible);
+
+            /**
+            * \brief Report hit rates of current planning loop and evict entries that it did not use
+            */
+            void endCycle();
+
+        private:
+            /**
+            * \brief Cached results for one pair of gap point models
+            */
+            struct Entry
+            {
+                Eigen::Vector4f leftGapState; /**< Frozen left gap point state when lifespan was computed */
+                Eigen::Vector4f rightGapState; /**< Frozen right gap point state when lifespan was computed */
+                int leftIdx = 0; /**< Left gap point scan index when lifespan was computed */
+                int rightIdx = 0; /**< Right gap point scan index when lifespan was computed */
+
+                float gapLifespan = 0.0; /**< Gap lifespan */
+                int endCondition = -1; /**< Gap end condition */
+
+                bool hasFeasibility = false; /**< Flag for if feasibility was checked with cached lifespan */
+                Eigen::Vector2f manipLeftPt; /**< Manipulated left gap point when feasibility was checked */
+                Eigen::Vector2f manipRightPt; /**< Manipulated right gap point when feasibility was checked */
+                Eigen::Vector4f goal; /**< Gap goal position and velocity when feasibility was checked */
+                bool rgc = false; /**< Swept gap flag when feasibility was checked */
+                float terminalGoalRange = 0.0; /**< Scan range at terminal goal bearing when feasibility was checked */
+
+                bool isGapFeasible = false; /**< Gap feasibility */
+                float tInterceptLeft = 0.0; /**< Intercept time for left gap point */
+                float gammaInterceptLeft = 0.0; /**< Intercept angle for left gap point */
+                float tInterceptRight = 0.0; /**< Intercept time for right gap point */
+                float gammaInterceptRight = 0.0; /**< Intercept angle for right gap point */
+                float tInterceptGoal = 0.0; /**< Intercept time for gap goal point */
+                float gammaInterceptGoal = 0.0; /**< Intercept angle for gap goal point */
+                Eigen::Vector2f terminalGoal; /**< Terminal goal */
+
+                unsigned long lastUsedCycle = 0; /**< Planning loop in which entry was last looked up or stored */
+            };
+
+            /**
+            * \brief Check if cached frozen gap point states and scan indices still describe gap
+            * \param entry cached entry
+            * \param gap gap to check entry against
+            * \return whether entry is still valid for gap
+            */
+            bool matchesGapDynamics(const Entry & entry, dynamic_gap::Gap * gap);
+
+            /**
+            * \brief Get scan range at bearing of terminal goal
+            * \param terminalGoal terminal goal
+            * \param scan current laser scan
+            * \return scan range at terminal goal bearing
+            */
+            float terminalGoalRange(const Eigen::Vector2f & terminalGoal, const sensor_msgs::LaserScan & scan);
+
+            const DynamicGapConfig* cfg_ = NULL; /**< Planner hyperparameter config list */
+
+            std::mutex mutex_; /**< mutex guarding entries and hit counts */
+            std::map<std::pair<int, int>, Entry> entries_; /**< Cached entries keyed by left and right gap point model IDs */
+            unsigned long cycle_ = 0; /**< Number of planning loops ended so far */
+
+            int lifespanLookups_ = 0; /**< Lifespan lookups in current planning loop */
+            int lifespanHits_ = 0; /**< Lifespan hits in current planning loop */
+            int feasibilityLookups_ = 0; /**< Feasibility lookups in current planning loop */
+            int feasibilityHits_ = 0; /**< Feasibility hits in current planning loop */
+
+            long totalLifespanLookups_ = 0; /**< Lifespan lookups over all planning loops */
+            long totalLifespanHits_ = 0; /**< Lifespan hits over all planning loops */
+            long totalFeasibilityLookups_ = 0; /**< Feasibility lookups over all planning loops */
+            long totalFeasibilityHits_ = 0; /**< Feasibility hits over all planning loops */
+    };
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <ros/ros.h>
+#include <algorithm>
 #include <vector>
 #include <math.h>
 
@@ -13,6 +14,7 @@
 #include <dynamic_gap/utils/Gap.h>
 #include <dynamic_gap/utils/Utils.h>
 #include <dynamic_gap/config/DynamicGapConfig.h>
+#include <dynamic_gap/gap_feasibility/GapFeasibilityCache.h>
 
 
 namespace dynamic_gap 
@@ -25,7 +27,7 @@ namespace dynamic_gap
     class GapFeasibilityChecker 
     {
         public: 
-            GapFeasibilityChecker(const dynamic_gap::DynamicGapConfig& cfg) {cfg_ = &cfg;};
+            GapFeasibilityChecker(const dynamic_gap::DynamicGapConfig& cfg);
 
             void updateEgoCircle(boost::shared_ptr<sensor_msgs::LaserScan const> scan);
 
@@ -43,7 +45,78 @@ namespace dynamic_gap
             */   
             bool pursuitGuidanceAnalysis(dynamic_gap::Gap * gap);
 
+            /**
+            * \brief Close out current planning loop in feasibility cache, if caching is on
+            */
+            void endCacheCycle();
+
         private:
+            /**
+            * \brief Compute gap lifespan and end condition, stepping gap points or solving in closed form
+            * \param gap incoming gap whose points we want to propagate
+            */
+            void estimateGapLifespan(dynamic_gap::Gap * gap);
+
+            /**
+            * \brief Dispatch gap to configured pursuit guidance feasibility check
+            * \param gap incoming gap whose feasibility we want to evaluate
+            */
+            bool runPursuitGuidance(dynamic_gap::Gap * gap);
+
+            /**
+            * \brief Step gap points forward in time until gap crosses, overlaps, or times out,
+            * setting gap lifespan and end condition
+            * \param gap incoming gap whose points we want to propagate
+            */
+            void stepGapPoints(dynamic_gap::Gap * gap);
+
+            /**
+            * \brief Solve for gap lifespan and end condition in closed form. Under constant velocity,
+            * the cross product of the gap points is quadratic in time, and the stepped end conditions
+            * can only trigger at the first step, at the first step after one of its roots, or at a step
+            * over which a gap point's bearing swings by a quarter turn or more, so only those steps are checked.
+            * \param gap incoming gap whose lifespan we want to solve for
+            * \param gapLifespan solved gap lifespan
+            * \param endCondition solved end condition
+            */
+            void solveGapLifespan(dynamic_gap::Gap * gap, float & gapLifespan, int & endCondition);
+
+            /**
+            * \brief Check stepped crossing and overlapping end conditions at a single step
+            * \param gap incoming gap
+            * \param leftGapState initial gap-only state of left gap point
+            * \param rightGapState initial gap-only state of right gap point
+            * \param step index of step
+            * \return 1 if gap crosses at step, 2 if gap overlaps at step, -1 otherwise
+            */
+            int checkEndConditionAtStep(dynamic_gap::Gap * gap,
+                                        const Eigen::Vector4f & leftGapState,
+                                        const Eigen::Vector4f & rightGapState,
+                                        const int & step);
+
+            /**
+            * \brief Closed-form counterpart of rewindGapPoints: find last step before crossing at which
+            * robot can fit through gap, starting from step at which gap separation reaches inflated diameter
+            * \param leftGapState initial gap-only state of left gap point
+            * \param rightGapState initial gap-only state of right gap point
+            * \param crossingStep index of step at which gap crossed
+            * \return last point in time in which robot can fit through gap
+            */
+            float solveRewindTime(const Eigen::Vector4f & leftGapState,
+                                  const Eigen::Vector4f & rightGapState,
+                                  const int & crossingStep);
+
+            /**
+            * \brief Check if gap is open wide enough for robot at given time
+            * \param leftGapState initial gap-only state of left gap point
+            * \param rightGapState initial gap-only state of right gap point
+            * \param t time to check gap at
+            * \return whether gap is open wide enough for robot
+            */
+            bool isGapOpenAtTime(const Eigen::Vector4f & leftGapState,
+                                 const Eigen::Vector4f & rightGapState,
+                                 const float & t);
+
             /**
             * \brief Rewind crossed gap to find last point in time in which
             * robot can fit through gap 
@@ -82,6 +155,10 @@ namespace dynamic_gap
 
             const DynamicGapConfig* cfg_; /**< Planner hyperparameter config list */
 
+            int propagationStepCount_ = 0; /**< Number of steps taken when stepping gap points over the full horizon */
+
+            dynamic_gap::GapFeasibilityCache feasibilityCache_; /**< Gap lifespans and feasibility results carried across planning loops */
+
             boost::shared_ptr<sensor_msgs::LaserScan const> scan_; /**< Current laser scan */            
     };
 }
\ No newline at end of file
@@ -1,9 +1,13 @@
 #pragma once
 #include <Eigen/Core>
 #include <Eigen/Geometry>
-#include <map>
+#include <algorithm>
+#include <memory>
+#include <vector>
 
+#include <dynamic_gap/utils/AgentTable.h>
 #include <dynamic_gap/utils/Gap.h>
+#include <dynamic_gap/scan_processing/FutureEgoCircle.h>
 #include <sensor_msgs/LaserScan.h>
 #include <dynamic_gap/config/DynamicGapConfig.h>
 
@@ -28,12 +32,35 @@ namespace dynamic_gap
             * \brief propagate laser scan forward in time using raw gap models
 
             * \param rawGaps set of current raw gaps to extract models from to determine what parts of scan are dynamic
-            * \return set of propagated laser scans for scoring
+            * \return future egocircle view for scoring
             * */
-            std::vector<sensor_msgs::LaserScan> propagateCurrentLaserScan(const std::vector<dynamic_gap::Gap *> & rawGaps);
+            std::shared_ptr<const FutureEgoCircle> propagateCurrentLaserScan(const std::vector<dynamic_gap::Gap *> & rawGaps);
+
+            /**
+            * \brief propagate laser scan forward in time using ground truth agent states,
+            * wiping rays that currently land on agents and ray-casting agents as moving discs
+            * \param agents ground truth agent states in robot frame
+            * \return future egocircle view for scoring
+            * */
+            std::shared_ptr<const FutureEgoCircle> propagateCurrentLaserScanCheat(const dynamic_gap::AgentTable & agents);
 
 
         private:
+            /**
+            * \brief Fit moving line segments to a run of neighboring dynamic rays attached to the same model,
+            * splitting the run until every scan point lies within tolerance of a segment
+            * \param futureEgoCircle future egocircle view to add segments to
+            * \param runPts cartesian scan points of dynamic rays
+            * \param firstPt first point of run
+            * \param lastPt last point of run
+            * \param vel velocity of model attached to run
+            */
+            void fitDynamicSegments(FutureEgoCircle & futureEgoCircle,
+                                    const std::vector<Eigen::Vector2f> & runPts,
+                                    const int & firstPt,
+                                    const int & lastPt,
+                                    const Eigen::Vector2f & vel);
+
 
             /**
             * \brief function for publishing propagated laser scans
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <Eigen/Core>
+#include <boost/shared_ptr.hpp>
+#include <geometry_msgs/Pose.h>
+#include <sensor_msgs/LaserScan.h>
+
+#include <dynamic_gap/utils/WorkerPool.h>
+
+namespace dynamic_gap
+{
+    /**
+    * \brief Lazy, time-indexed view of the current laser scan propagated forward over the trajectory
+    * horizon. Static rays are stored once. Only rays attached to dynamic gap point models are propagated,
+    * and each time slice is only built the first time it is asked for. Slices are built under std::call_once,
+    * so one view can be read by several trajectory evaluations at once.
+    * Dynamic rays can also be summarized as moving line segments, in which case clearance is computed
+    * analytically against the segments instead of against the propagated rays. Moving discs (ground
+    * truth agents) are ray-cast into each slice analytically.
+    */
+    class FutureEgoCircle
+    {
+        public:
+            /**
+            * \brief Constructor for view in which every ray is static until dynamic rays are added
+            * \param scan current laser scan, used as the slice at time index 0
+            * \param sliceCount number of time slices in view
+            * \param timeStep time between consecutive slices
+            * \param wipedRange range that dynamic rays are set to in static part of scan
+            */
+            FutureEgoCircle(const boost::shared_ptr<sensor_msgs::LaserScan const> & scan,
+                            const int & sliceCount,
+                            const float & timeStep,
+                            const float & wipedRange);
+
+            FutureEgoCircle(const FutureEgoCircle &) = delete;
+            FutureEgoCircle & operator=(const FutureEgoCircle &) = delete;
+
+            /**
+            * \brief Wipe ray from static part of scan for all future slices without propagating it.
+            * Must be called before any slices are read.
+            * \param scanIdx index of ray in scan
+            */
+            void wipeRay(const int & scanIdx);
+
+            /**
+            * \brief Mark ray as dynamic, wiping it from static part of scan for all future slices.
+            * Must be called before any slices are read.
+            * \param scanIdx index of ray in scan
+            * \param pt cartesian scan point of ray
+            * \param vel velocity of gap point model attached to ray
+            */
+            void addDynamicRay(const int & scanIdx, const Eigen::Vector2f & pt, const Eigen::Vector2f & vel);
+
+            /**
+            * \brief Add moving line segment fit to dynamic rays. Once a view has segments,
+            * clearance is measured to the segments rather than to the propagated dynamic rays.
+            * Must be called before any clearances are computed.
+            * \param start cartesian start point of segment
+            * \param end cartesian end point of segment
+            * \param vel velocity of segment
+            */
+            void addDynamicSegment(const Eigen::Vector2f & start, const Eigen::Vector2f & end, const Eigen::Vector2f & vel);
+
+            /**
+            * \brief Add moving disc that is ray-cast into every future slice.
+            * Must be called before any slices are read.
+            * \param center cartesian center of disc
+            * \param vel velocity of disc
+            * \param radius radius of disc
+            */
+            void addDynamicDisc(const Eigen::Vector2f & center, const Eigen::Vector2f & vel, const float & radius);
+
+            /**
+            * \brief Getter for ranges of slice, building slice if needed
+            * \param timeIdx time index of slice
+            * \return ranges of slice
+            */
+            const std::vector<float> & ranges(const int & timeIdx) const;
+
+            /**
+            * \brief Build every slice up front, spreading slices across worker pool.
+            * Does nothing if nothing is moving or if clearance is measured to moving segments.
+            * \param pool worker pool to build slices on
+            */
+            void buildSlices(dynamic_gap::WorkerPool * pool) const;
+
+            /**
+            * \brief Compute minimum distance between robot pose and slice, or between robot pose
+            * and static rays and moving segments if view has segments
+            * \param timeIdx time index of slice
+            * \param pose robot pose
+            * \return distance from robot pose to closest point of slice
+            */
+            float clearance(const int & timeIdx, const geometry_msgs::Pose & pose) const;
+
+            /**
+            * \brief Getter for number of time slices in view
+            * \return number of time slices
+            */
+            int sliceCount() const { return sliceCount_; }
+
+            /**
+            * \brief Getter for number of moving segments in view
+            * \return number of moving segments
+            */
+            int segmentCount() const { return segmentStarts_.size(); }
+
+            /**
+            * \brief Getter for time between consecutive slices
+            * \return time between consecutive slices
+            */
+            float timeStep() const { return timeStep_; }
+
+        private:
+            /**
+            * \brief Propagate dynamic rays onto static part of scan for a single slice
+            * \param timeIdx time index of slice
+            */
+            void buildSlice(const int & timeIdx) const;
+
+            /**
+            * \brief Compute minimum distance between robot pose and static rays and moving segments
+            * \param timeIdx time index of slice
+            * \param pose robot pose
+            * \return distance from robot pose to closest static ray or moving segment
+            */
+            float segmentClearance(const int & timeIdx, const geometry_msgs::Pose & pose) const;
+
+            /**
+            * \brief Ray-cast moving discs into slice, only visiting rays within each disc's angular span
+            * \param t time of slice
+            * \param slice ranges of slice
+            */
+            void castDiscs(const float & t, std::vector<float> & slice) const;
+
+            boost::shared_ptr<sensor_msgs::LaserScan const> scan_; /**< Current laser scan */
+            int sliceCount_ = 0; /**< Number of time slices in view */
+            float timeStep_ = 0.0; /**< Time between consecutive slices */
+            float wipedRange_ = 0.0; /**< Range that dynamic rays are set to in static part of scan */
+
+            std::vector<float> staticRanges_; /**< Current ranges with dynamic rays wiped, empty while there are no dynamic rays */
+            std::vector<float> dynamicXs_; /**< Cartesian x-coordinates of dynamic rays' scan points */
+            std::vector<float> dynamicYs_; /**< Cartesian y-coordinates of dynamic rays' scan points */
+            std::vector<float> dynamicVxs_; /**< x-velocities of dynamic rays */
+            std::vector<float> dynamicVys_; /**< y-velocities of dynamic rays */
+
+            std::vector<Eigen::Vector2f> segmentStarts_; /**< Cartesian start points of moving segments */
+            std::vector<Eigen::Vector2f> segmentEnds_; /**< Cartesian end points of moving segments */
+            std::vector<Eigen::Vector2f> segmentVels_; /**< Velocities of moving segments */
+
+            std::vector<Eigen::Vector2f> discCenters_; /**< Cartesian centers of moving discs */
+            std::vector<Eigen::Vector2f> discVels_; /**< Velocities of moving discs */
+            std::vector<float> discRadii_; /**< Radii of moving discs */
+
+            mutable std::vector<std::vector<float>> slices_; /**< Propagated ranges of each slice, empty until built */
+            mutable std::unique_ptr<std::once_flag[]> sliceFlags_; /**< Flags guarding building of each slice */
+
+            static constexpr int slicesPerBuildChunk_ = 4; /**< Number of slices built per parallel chunk */
+    };
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+
+#include <boost/shared_ptr.hpp>
+#include <sensor_msgs/LaserScan.h>
+#include <dynamic_gap/config/DynamicGapConfig.h>
+
+namespace dynamic_gap
+{
+    /**
+    * \brief Bounded single-producer single-consumer queue that hands laser scans from the
+    * scan callback to the perception thread. Each slot holds an atomically exchanged pointer,
+    * so pushing never blocks: once the queue is full, the incoming scan replaces the oldest one,
+    * and stale scans never back up behind a slow perception step.
+    */
+    class ScanQueue
+    {
+        public:
+            /**
+            * \brief Constructor with planner config
+            * \param cfg config file for planner parameters
+            */
+            ScanQueue(const DynamicGapConfig& cfg);
+
+            ~ScanQueue();
+
+            /**
+            * \brief Enqueue scan, dropping oldest queued scan if queue is full. Only called by scan callback.
+            * \param scan incoming laser scan
+            */
+            void push(const boost::shared_ptr<sensor_msgs::LaserScan> & scan);
+
+            /**
+            * \brief Dequeue oldest queued scan, waiting for one to arrive if queue is empty.
+            * Only called by perception thread.
+            * \param scan dequeued laser scan
+            * \return false if queue has been shut down, true otherwise
+            */
+            bool pop(boost::shared_ptr<sensor_msgs::LaserScan> & scan);
+
+            /**
+            * \brief Wake up and release perception thread waiting in pop
+            */
+            void shutdown();
+
+            /**
+            * \brief Getter for number of scans dropped so far without being processed
+            * \return number of dropped scans
+            */
+            uint64_t droppedScans() const { return droppedScans_.load(std::memory_order_relaxed); }
+
+        private:
+            /**
+            * \brief Queued scan along with its position in the sequence of pushed scans
+            */
+            struct ScanNode
+            {
+                uint64_t seq; /**< position of scan in sequence of pushed scans */
+                boost::shared_ptr<sensor_msgs::LaserScan> scan; /**< queued laser scan */
+            };
+
+            /**
+            * \brief Dequeue oldest queued scan without waiting
+            * \param scan dequeued laser scan
+            * \return true if a scan was dequeued
+            */
+            bool tryPop(boost::shared_ptr<sensor_msgs::LaserScan> & scan);
+
+            const DynamicGapConfig* cfg_ = NULL; /**< Planner hyperparameter config list */
+
+            int capacity_ = 1; /**< number of slots in queue */
+            std::unique_ptr<std::atomic<ScanNode *>[]> slots_; /**< ring of slots, scan k lives in slot k % capacity_ (NULL once taken) */
+            std::atomic<uint64_t> head_; /**< number of scans pushed so far, written by scan callback */
+            uint64_t tail_ = 0; /**< next scan to dequeue, owned by perception thread */
+            std::atomic<uint64_t> droppedScans_; /**< number of scans dropped without being processed */
+
+            std::atomic<bool> stopping_; /**< flag for releasing perception thread */
+            std::mutex waitMutex_; /**< mutex that perception thread sleeps on while queue is empty, never taken by scan callback */
+            std::condition_variable scanCondition_; /**< signals perception thread that a scan has arrived or queue is shutting down */
+    };
+}
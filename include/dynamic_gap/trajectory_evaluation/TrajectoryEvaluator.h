@@ -5,6 +5,7 @@
 #include <dynamic_gap/utils/Gap.h>
 #include <dynamic_gap/utils/Trajectory.h>
 #include <dynamic_gap/config/DynamicGapConfig.h>
+#include <dynamic_gap/scan_processing/FutureEgoCircle.h>
 #include <vector>
 #include <numeric>
 
@@ -51,11 +52,26 @@ namespace dynamic_gap
             /**
             * \brief Function for evaluating pose-wise scores along candidate trajectory
             * \param traj candidate trajectory to score
+            * \param posewiseCosts pose-wise costs of candidate trajectory
+            * \param terminalPoseCost terminal pose cost of candidate trajectory
+            * \param futureEgoCircle future egocircle view to score poses against
             */
             void evaluateTrajectory(const dynamic_gap::Trajectory & traj,
                                     std::vector<float> & posewiseCosts,
                                     float & terminalPoseCost,
-                                    const std::vector<sensor_msgs::LaserScan> & futureScans);
+                                    const dynamic_gap::FutureEgoCircle & futureEgoCircle);
+
+            /**
+            * \brief Function for computing lower bounds on total cost of candidate trajectories whose poses
+            * stay within given distances of robot. Every processed trajectory starts at robot's current pose
+            * and pose-wise costs are non-negative, so each bound is cost of current pose plus terminal
+            * cost of closest terminal pose that could be reached.
+            * \param reaches upper bounds on distance between robot and any pose of each candidate trajectory
+            * \param futureEgoCircle future egocircle view to score poses against
+            * \return lower bounds on total cost of each candidate trajectory
+            */
+            std::vector<float> trajectoryCostLowerBounds(const std::vector<float> & reaches,
+                                                         const dynamic_gap::FutureEgoCircle & futureEgoCircle);
             
         private:
             /**
@@ -68,10 +84,13 @@ namespace dynamic_gap
             /**
             * \brief function for evaluating intermediate cost of pose for candidate trajectory (in static environment)
             * \param pose pose within candidate trajectory to evaluate
+            * \param futureEgoCircle future egocircle view to score pose against
+            * \param timeIdx time index of pose within candidate trajectory
             * \return intermediate cost of pose
             */
             float evaluatePose(const geometry_msgs::Pose & pose,
-                                const sensor_msgs::LaserScan scan_k) ;
+                                const dynamic_gap::FutureEgoCircle & futureEgoCircle,
+                                const int & timeIdx);
             
             /**
             * \brief function for calculating intermediate trajectory cost (in static environment)
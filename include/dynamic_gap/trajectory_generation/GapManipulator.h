@@ -89,10 +89,35 @@ namespace dynamic_gap
                                         const float & leftToWaypointAngle, 
                                         const float & rightToWaypointAngle);
 
+            /**
+            * \brief find scan point within search window that is closest to near gap point using the law of cosines.
+            * Window is walked in contiguous blocks of squared distances on the stack, so nothing is allocated
+            * and the distance loop vectorizes.
+            * \param ranges current scan ranges
+            * \param nearRange range of near gap point
+            * \param scanSearchStartIdx scan index at which window starts
+            * \param scanSearchSize number of scan indices in window
+            * \param startIdxSpan index span between near gap point and first scan index in window
+            * \param minDist distance between near gap point and closest scan point
+            * \return scan index of closest scan point
+            */
+            int findClosestScanIdx(const std::vector<float> & ranges,
+                                    const float & nearRange,
+                                    const int & scanSearchStartIdx,
+                                    const int & scanSearchSize,
+                                    const int & startIdxSpan,
+                                    float & minDist);
+
             const DynamicGapConfig* cfg_ = NULL; /**< Planner hyperparameter config list */
 
             boost::mutex scanMutex_; /**< mutex locking thread for updating current scan */
 
             boost::shared_ptr<sensor_msgs::LaserScan const> scan_; /**< Current laser scan */
+            float minScanRange_ = 0.0; /**< Minimum range in current laser scan */
+
+            std::vector<float> spanCos_; /**< Cosine of angle spanned by each index span, from zero up to two full scans */
+            float spanCosAngleIncrement_ = 0.0; /**< Angular increment that index span cosines were computed with */
+
+            static constexpr int scanSearchBlockSize_ = 64; /**< Number of scan indices per block of window search */
     };
 }
\ No newline at end of file
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <vector>
+
+#include <geometry_msgs/Pose.h>
+#include <geometry_msgs/Vector3Stamped.h>
+
+namespace dynamic_gap
+{
+    /**
+    * \brief Flat table of ground truth agent states (robot frame) received in a single agent message,
+    * keyed by integer agent ID. Agents are bucketed into a uniform spatial hash once the table is filled,
+    * so that nearest-agent queries only look at agents in the cells around the query point.
+    * Tables are built by the agent callback and are read-only once published.
+    */
+    class AgentTable
+    {
+        public:
+            /**
+            * \brief Constructor with spatial hash cell size
+            * \param cellSize side length of spatial hash cells (in meters)
+            */
+            AgentTable(const float & cellSize);
+
+            /**
+            * \brief Add agent state to table
+            * \param id integer ID of agent
+            * \param pose pose of agent in robot frame
+            * \param vel velocity of agent in robot frame
+            */
+            void addAgent(const int & id,
+                          const geometry_msgs::Pose & pose,
+                          const geometry_msgs::Vector3Stamped & vel);
+
+            /**
+            * \brief Bucket all added agents into spatial hash, must be called before nearest-agent queries
+            */
+            void buildSpatialHash();
+
+            /**
+            * \brief Find agent closest to query point within a maximum distance
+            * \param x x-coordinate of query point in robot frame
+            * \param y y-coordinate of query point in robot frame
+            * \param maxDist maximum distance between query point and agent
+            * \return slot of closest agent in table, -1 if no agent is within maximum distance
+            */
+            int findNearestAgent(const float & x, const float & y, const float & maxDist) const;
+
+            /**
+            * \brief Look up slot of agent in table by its ID
+            * \param id integer ID of agent
+            * \return slot of agent in table, -1 if agent is not in table
+            */
+            int findAgent(const int & id) const;
+
+            /**
+            * \brief Getter for number of agents in table
+            * \return number of agents
+            */
+            int size() const { return ids_.size(); }
+
+            /**
+            * \brief Getter for ID of agent in slot
+            * \param slot slot of agent in table
+            * \return integer ID of agent
+            */
+            int id(const int & slot) const { return ids_[slot]; }
+
+            /**
+            * \brief Getter for pose of agent in slot
+            * \param slot slot of agent in table
+            * \return pose of agent in robot frame
+            */
+            const geometry_msgs::Pose & pose(const int & slot) const { return poses_[slot]; }
+
+            /**
+            * \brief Getter for velocity of agent in slot
+            * \param slot slot of agent in table
+            * \return velocity of agent in robot frame
+            */
+            const geometry_msgs::Vector3Stamped & vel(const int & slot) const { return vels_[slot]; }
+
+        private:
+            /**
+            * \brief Compute spatial hash cell of coordinate
+            * \param coord x- or y-coordinate in robot frame
+            * \return integer cell coordinate
+            */
+            int cellCoord(const float & coord) const;
+
+            /**
+            * \brief Map spatial hash cell to bucket
+            * \param cellX integer x-coordinate of cell
+            * \param cellY integer y-coordinate of cell
+            * \return bucket index
+            */
+            int bucketIdx(const int & cellX, const int & cellY) const;
+
+            float cellSize_ = 1.0; /**< side length of spatial hash cells */
+
+            std::vector<int> ids_; /**< integer IDs of agents, by slot */
+            std::vector<geometry_msgs::Pose> poses_; /**< poses of agents in robot frame, by slot */
+            std::vector<geometry_msgs::Vector3Stamped> vels_; /**< velocities of agents in robot frame, by slot */
+            std::vector<int> idSlots_; /**< slot of each agent ID, -1 for IDs not in table */
+
+            std::vector<int> bucketStarts_; /**< start of each bucket's slots in bucketSlots_ (one past the end for last entry) */
+            std::vector<int> bucketSlots_; /**< agent slots sorted by bucket */
+    };
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <ros/ros.h>
+#include <ros/serialization.h>
+
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <Eigen/Core>
+
+namespace dynamic_gap
+{
+    /**
+    * \brief Writer for compact binary planner checkpoints. Plain values are written as raw bytes,
+    * ROS messages through ROS serialization, so checkpoints are only meant to be read back
+    * on the same platform by the same planner version.
+    */
+    class CheckpointWriter
+    {
+        public:
+            /**
+            * \brief Constructor that opens checkpoint file and writes checkpoint header
+            * \param path path of checkpoint file
+            */
+            CheckpointWriter(const std::string & path);
+
+            /**
+            * \brief Flush checkpoint file, throwing if any write failed
+            */
+            void close();
+
+            /**
+            * \brief Write plain value
+            * \param value value to write
+            */
+            template <typename T>
+            void write(const T & value)
+            {
+                static_assert(std::is_arithmetic<T>::value, "only arithmetic values can be written as raw bytes");
+                stream_.write(reinterpret_cast<const char *>(&value), sizeof(T));
+            }
+
+            /**
+            * \brief Write string
+            * \param value string to write
+            */
+            void write(const std::string & value);
+
+            /**
+            * \brief Write time stamp
+            * \param value time stamp to write
+            */
+            void write(const ros::Time & value);
+
+            /**
+            * \brief Write fixed-size Eigen matrix
+            * \param value matrix to write
+            */
+            template <typename Scalar, int Rows, int Cols>
+            void write(const Eigen::Matrix<Scalar, Rows, Cols> & value)
+            {
+                stream_.write(reinterpret_cast<const char *>(value.data()), sizeof(Scalar) * Rows * Cols);
+            }
+
+            /**
+            * \brief Write vector of plain values
+            * \param values vector to write
+            */
+            template <typename T>
+            void write(const std::vector<T> & values)
+            {
+                write(static_cast<uint32_t>(values.size()));
+                for (const T & value : values)
+                    write(value);
+            }
+
+            /**
+            * \brief Write ROS message
+            * \param msg message to write
+            */
+            template <typename M>
+            void writeMessage(const M & msg)
+            {
+                uint32_t length = ros::serialization::serializationLength(msg);
+                buffer_.resize(length);
+                ros::serialization::OStream msgStream(buffer_.data(), length);
+                ros::serialization::serialize(msgStream, msg);
+
+                write(length);
+                stream_.write(reinterpret_cast<const char *>(buffer_.data()), length);
+            }
+
+        private:
+            std::ofstream stream_; /**< checkpoint file */
+            std::vector<uint8_t> buffer_; /**< scratch buffer for serialized messages */
+    };
+
+    /**
+    * \brief Reader for compact binary planner checkpoints written by CheckpointWriter.
+    * Throws std::runtime_error on files that are truncated or were not written as checkpoints.
+    */
+    class CheckpointReader
+    {
+        public:
+            /**
+            * \brief Constructor that opens checkpoint file and checks checkpoint header
+            * \param path path of checkpoint file
+            */
+            CheckpointReader(const std::string & path);
+
+            /**
+            * \brief Read plain value
+            * \param value value to read into
+            */
+            template <typename T>
+            void read(T & value)
+            {
+                static_assert(std::is_arithmetic<T>::value, "only arithmetic values can be read as raw bytes");
+                readBytes(reinterpret_cast<char *>(&value), sizeof(T));
+            }
+
+            /**
+            * \brief Read string
+            * \param value string to read into
+            */
+            void read(std::string & value);
+
+            /**
+            * \brief Read time stamp
+            * \param value time stamp to read into
+            */
+            void read(ros::Time & value);
+
+            /**
+            * \brief Read fixed-size Eigen matrix
+            * \param value matrix to read into
+            */
+            template <typename Scalar, int Rows, int Cols>
+            void read(Eigen::Matrix<Scalar, Rows, Cols> & value)
+            {
+                readBytes(reinterpret_cast<char *>(value.data()), sizeof(Scalar) * Rows * Cols);
+            }
+
+            /**
+            * \brief Read vector of plain values
+            * \param values vector to read into
+            */
+            template <typename T>
+            void read(std::vector<T> & values)
+            {
+                values.resize(readCount());
+                for (T & value : values)
+                    read(value);
+            }
+
+            /**
+            * \brief Read element count, checking it against remaining file size
+            * \return element count
+            */
+            uint32_t readCount();
+
+            /**
+            * \brief Read ROS message
+            * \param msg message to read into
+            */
+            template <typename M>
+            void readMessage(M & msg)
+            {
+                uint32_t length = readCount();
+                buffer_.resize(length);
+                readBytes(reinterpret_cast<char *>(buffer_.data()), length);
+
+                ros::serialization::IStream msgStream(buffer_.data(), length);
+                ros::serialization::deserialize(msgStream, msg);
+            }
+
+        private:
+            /**
+            * \brief Read raw bytes, throwing if file ends first
+            * \param data destination of bytes
+            * \param size number of bytes to read
+            */
+            void readBytes(char * data, const std::streamsize & size);
+
+            std::ifstream stream_; /**< checkpoint file */
+            std::streamsize remaining_ = 0; /**< number of unread bytes in checkpoint file */
+            std::vector<uint8_t> buffer_; /**< scratch buffer for serialized messages */
+    };
+}
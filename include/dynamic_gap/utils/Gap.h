@@ -37,7 +37,15 @@ namespace dynamic_gap
                 // rightGapPtModel_ = new PerfectEstimator();
             };
 
-            Gap(const dynamic_gap::Gap & otherGap)
+            Gap(const dynamic_gap::Gap & otherGap) : Gap(otherGap, false) {}
+
+            /**
+            * \brief Copy constructor that can either deep copy other gap's estimator models,
+            * or point to them without taking ownership (for gaps whose points are tracked by other gaps)
+            * \param otherGap gap to copy
+            * \param shareModels whether to share other gap's models instead of deep copying them
+            */
+            Gap(const dynamic_gap::Gap & otherGap, const bool & shareModels)
             {
                 // ROS_INFO_STREAM_NAMED("Gap", "in copy constructor");
                 gapLifespan_ = otherGap.gapLifespan_;
@@ -55,16 +63,24 @@ namespace dynamic_gap
 
                 terminalGoal = otherGap.terminalGoal;
 
-                // deep copy for new models
-                // Here, you can define what type of model you want to use
-                leftGapPtModel_ = new RotatingFrameCartesianKalmanFilter();
-                rightGapPtModel_ = new RotatingFrameCartesianKalmanFilter();
-                // leftGapPtModel_ = new PerfectEstimator();
-                // rightGapPtModel_ = new PerfectEstimator();
-
-                // transfer models (need to deep copy the models, not just the pointers)
-                leftGapPtModel_->transfer(*otherGap.leftGapPtModel_);
-                rightGapPtModel_->transfer(*otherGap.rightGapPtModel_);
+                if (shareModels)
+                {
+                    leftGapPtModel_ = otherGap.leftGapPtModel_;
+                    rightGapPtModel_ = otherGap.rightGapPtModel_;
+                    ownsModels_ = false;
+                } else
+                {
+                    // deep copy for new models
+                    // Here, you can define what type of model you want to use
+                    leftGapPtModel_ = new RotatingFrameCartesianKalmanFilter();
+                    rightGapPtModel_ = new RotatingFrameCartesianKalmanFilter();
+                    // leftGapPtModel_ = new PerfectEstimator();
+                    // rightGapPtModel_ = new PerfectEstimator();
+
+                    // transfer models (need to deep copy the models, not just the pointers)
+                    leftGapPtModel_->transfer(*otherGap.leftGapPtModel_);
+                    rightGapPtModel_->transfer(*otherGap.rightGapPtModel_);
+                }
 
                 globalGoalWithin = otherGap.globalGoalWithin;
 
@@ -89,9 +105,136 @@ namespace dynamic_gap
 
             ~Gap() 
             {
-                delete leftGapPtModel_;
-                delete rightGapPtModel_;
+                if (ownsModels_)
+                {
+                    delete leftGapPtModel_;
+                    delete rightGapPtModel_;
+                }
             };
+
+            /**
+            * \brief Point gap at estimator models owned elsewhere, releasing any models this gap owns
+            * \param leftModel left gap point estimator
+            * \param rightModel right gap point estimator
+            */
+            void shareModels(Estimator * leftModel, Estimator * rightModel)
+            {
+                if (ownsModels_)
+                {
+                    if (leftGapPtModel_ != leftModel)
+                        delete leftGapPtModel_;
+                    if (rightGapPtModel_ != rightModel)
+                        delete rightGapPtModel_;
+                }
+
+                leftGapPtModel_ = leftModel;
+                rightGapPtModel_ = rightModel;
+                ownsModels_ = false;
+            }
+
+            /**
+            * \brief Getter for whether gap owns its estimator models
+            * \return whether gap owns its estimator models
+            */
+            bool ownsModels() const { return ownsModels_; }
+
+            /**
+            * \brief Take ownership of estimator models, releasing any models this gap owns
+            * \param leftModel left gap point estimator
+            * \param rightModel right gap point estimator
+            */
+            void adoptModels(Estimator * leftModel, Estimator * rightModel)
+            {
+                shareModels(leftModel, rightModel);
+                ownsModels_ = true;
+            }
+
+            /**
+            * \brief Write gap into planner checkpoint. Estimator models are written separately
+            * so that models shared between gaps are only written once.
+            * \param writer checkpoint writer
+            */
+            void writeCheckpoint(CheckpointWriter & writer) const
+            {
+                writer.write(gapLifespan_);
+                writer.write(minSafeDist_);
+                writer.write(extendedGapOrigin_);
+                writer.write(termExtendedGapOrigin_);
+
+                writer.write(frame_);
+                writer.write(radial_);
+                writer.write(rightType_);
+                writer.write(rgc_);
+
+                writer.write(goal.x_);
+                writer.write(goal.y_);
+                writer.write(goal.vx_);
+                writer.write(goal.vy_);
+                writer.write(terminalGoal.x_);
+                writer.write(terminalGoal.y_);
+
+                writer.write(globalGoalWithin);
+                writer.write(t_intercept_left);
+                writer.write(gamma_intercept_left);
+                writer.write(t_intercept_right);
+                writer.write(gamma_intercept_right);
+                writer.write(t_intercept_goal);
+                writer.write(gamma_intercept_goal);
+                writer.write(end_condition);
+
+                writer.write(leftIdx_);
+                writer.write(leftRange_);
+                writer.write(rightIdx_);
+                writer.write(rightRange_);
+
+                writer.write(manip.leftIdx_);
+                writer.write(manip.leftRange_);
+                writer.write(manip.rightIdx_);
+                writer.write(manip.rightRange_);
+            }
+
+            /**
+            * \brief Restore gap from planner checkpoint, leaving estimator models untouched
+            * \param reader checkpoint reader
+            */
+            void readCheckpoint(CheckpointReader & reader)
+            {
+                reader.read(gapLifespan_);
+                reader.read(minSafeDist_);
+                reader.read(extendedGapOrigin_);
+                reader.read(termExtendedGapOrigin_);
+
+                reader.read(frame_);
+                reader.read(radial_);
+                reader.read(rightType_);
+                reader.read(rgc_);
+
+                reader.read(goal.x_);
+                reader.read(goal.y_);
+                reader.read(goal.vx_);
+                reader.read(goal.vy_);
+                reader.read(terminalGoal.x_);
+                reader.read(terminalGoal.y_);
+
+                reader.read(globalGoalWithin);
+                reader.read(t_intercept_left);
+                reader.read(gamma_intercept_left);
+                reader.read(t_intercept_right);
+                reader.read(gamma_intercept_right);
+                reader.read(t_intercept_goal);
+                reader.read(gamma_intercept_goal);
+                reader.read(end_condition);
+
+                reader.read(leftIdx_);
+                reader.read(leftRange_);
+                reader.read(rightIdx_);
+                reader.read(rightRange_);
+
+                reader.read(manip.leftIdx_);
+                reader.read(manip.leftRange_);
+                reader.read(manip.rightIdx_);
+                reader.read(manip.rightRange_);
+            }
             
             /**
             * \brief Getter for initial left gap point index
@@ -490,6 +633,8 @@ namespace dynamic_gap
 
         private:
 
+            bool ownsModels_ = true; /**< Flag for if gap is responsible for deleting its estimator models */
+
             int leftIdx_ = 511; /**< Initial left gap point index */
             float leftRange_ = 5; /**< Initial left gap point range */
 
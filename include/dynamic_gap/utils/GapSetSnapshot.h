@@ -0,0 +1,125 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <sensor_msgs/LaserScan.h>
+#include <geometry_msgs/TwistStamped.h>
+#include <dynamic_gap/config/DynamicGapConfig.h>
+#include <dynamic_gap/utils/Gap.h>
+
+namespace dynamic_gap
+{
+    /**
+    * \brief Immutable gap set produced from a single laser scan. Built by the perception thread,
+    * which hands its gaps over to the snapshot. Perception keeps reading them as previous gaps for the
+    * next scan's association, and the planning loop only holds on to the snapshot while it takes its own copy.
+    * Once perception holds the only reference, it moves the previous gaps' estimators on to the next scan's gaps.
+    */
+    class GapSetSnapshot
+    {
+        public:
+            /**
+            * \brief Constructor that takes ownership of gaps, simplified gaps may share raw gap estimators
+            * \param scan laser scan that gaps were detected in (empty for gaps restored from checkpoint)
+            * \param scanParams scan hyperparameters loaded from laser scan
+            * \param rawGaps current set of raw gaps
+            * \param simplifiedGaps current set of simplified gaps
+            * \param hasGaps whether gaps were detected for scan (false before planner receives a global goal)
+            * \param colliding whether robot was in collision at scan
+            * \param rbtVel ego-robot velocity that gap models were last updated with
+            * \param rbtAcc ego-robot acceleration that gap models were last updated with
+            */
+            GapSetSnapshot(const boost::shared_ptr<sensor_msgs::LaserScan const> & scan,
+                           const DynamicGapConfig::Scan & scanParams,
+                           std::vector<dynamic_gap::Gap *> && rawGaps,
+                           std::vector<dynamic_gap::Gap *> && simplifiedGaps,
+                           const bool & hasGaps,
+                           const bool & colliding,
+                           const geometry_msgs::TwistStamped & rbtVel,
+                           const geometry_msgs::TwistStamped & rbtAcc) :
+                           scan_(scan),
+                           scanParams_(scanParams),
+                           rawGaps_(std::move(rawGaps)),
+                           simplifiedGaps_(std::move(simplifiedGaps)),
+                           hasGaps_(hasGaps),
+                           colliding_(colliding),
+                           rbtVel_(rbtVel),
+                           rbtAcc_(rbtAcc)
+            {
+                rawGaps.clear();
+                simplifiedGaps.clear();
+            }
+
+            GapSetSnapshot(const GapSetSnapshot &) = delete;
+            GapSetSnapshot & operator=(const GapSetSnapshot &) = delete;
+
+            ~GapSetSnapshot()
+            {
+                // simplified gaps do not own the raw gap estimators they share
+                for (dynamic_gap::Gap * simplifiedGap : simplifiedGaps_)
+                    delete simplifiedGap;
+
+                for (dynamic_gap::Gap * rawGap : rawGaps_)
+                    delete rawGap;
+            }
+
+            /**
+            * \brief Getter for laser scan that gaps were detected in
+            * \return laser scan
+            */
+            const boost::shared_ptr<sensor_msgs::LaserScan const> & scan() const { return scan_; }
+
+            /**
+            * \brief Getter for scan hyperparameters loaded from laser scan
+            * \return scan hyperparameters
+            */
+            const DynamicGapConfig::Scan & scanParams() const { return scanParams_; }
+
+            /**
+            * \brief Getter for raw gaps, which must be deep copied before being modified
+            * \return raw gaps
+            */
+            const std::vector<dynamic_gap::Gap *> & rawGaps() const { return rawGaps_; }
+
+            /**
+            * \brief Getter for simplified gaps, which must be deep copied before being modified
+            * \return simplified gaps
+            */
+            const std::vector<dynamic_gap::Gap *> & simplifiedGaps() const { return simplifiedGaps_; }
+
+            /**
+            * \brief Getter for whether gaps were detected for scan
+            * \return whether gaps were detected for scan
+            */
+            bool hasGaps() const { return hasGaps_; }
+
+            /**
+            * \brief Getter for whether robot was in collision at scan
+            * \return whether robot was in collision at scan
+            */
+            bool colliding() const { return colliding_; }
+
+            /**
+            * \brief Getter for ego-robot velocity that gap models were last updated with
+            * \return ego-robot velocity
+            */
+            const geometry_msgs::TwistStamped & rbtVel() const { return rbtVel_; }
+
+            /**
+            * \brief Getter for ego-robot acceleration that gap models were last updated with
+            * \return ego-robot acceleration
+            */
+            const geometry_msgs::TwistStamped & rbtAcc() const { return rbtAcc_; }
+
+        private:
+            boost::shared_ptr<sensor_msgs::LaserScan const> scan_; /**< laser scan that gaps were detected in */
+            DynamicGapConfig::Scan scanParams_; /**< scan hyperparameters loaded from laser scan */
+            std::vector<dynamic_gap::Gap *> rawGaps_; /**< raw gaps, owned by snapshot */
+            std::vector<dynamic_gap::Gap *> simplifiedGaps_; /**< simplified gaps, owned by snapshot */
+            bool hasGaps_ = false; /**< whether gaps were detected for scan */
+            bool colliding_ = false; /**< whether robot was in collision at scan */
+            geometry_msgs::TwistStamped rbtVel_; /**< ego-robot velocity that gap models were last updated with */
+            geometry_msgs::TwistStamped rbtAcc_; /**< ego-robot acceleration that gap models were last updated with */
+    };
+}
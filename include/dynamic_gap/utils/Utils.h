@@ -24,7 +24,8 @@ namespace dynamic_gap
                             PLAN = 12,
                             FEEBDACK = 13,
                             PO = 14,
-                            CONTROL = 15
+                            CONTROL = 15,
+                            GAP_PIPE = 16
                             };
 
 
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dynamic_gap
+{
+    /**
+    * \brief Persistent pool of worker threads for splitting planner work into index ranges.
+    * Work is cut into fixed-size chunks whose boundaries depend only on the number of items and
+    * the chunk size, never on the number of threads or on scheduling, so work that writes only
+    * into its own range produces the same result for any thread count. The calling thread
+    * works through chunks alongside the workers.
+    */
+    class WorkerPool
+    {
+        public:
+            /**
+            * \brief Constructor with thread count
+            * \param nThreads total number of threads that run chunks, including calling thread
+            */
+            WorkerPool(const int & nThreads);
+
+            ~WorkerPool();
+
+            /**
+            * \brief Run function over chunks of index range [0, nItems) and block until all chunks are done.
+            * Not reentrant: only one thread may run a job on the pool at a time.
+            * \param nItems number of items in index range
+            * \param chunkSize number of items in each chunk (last chunk may be shorter)
+            * \param job function to run on half-open index range [begin, end) of each chunk
+            */
+            void parallelFor(const int & nItems,
+                             const int & chunkSize,
+                             const std::function<void(const int &, const int &)> & job);
+
+            /**
+            * \brief Getter for total number of threads that run chunks, including calling thread
+            * \return number of threads
+            */
+            int size() const { return workers_.size() + 1; }
+
+        private:
+            /**
+            * \brief Wait for jobs and run their chunks until pool is destroyed
+            */
+            void workerLoop();
+
+            /**
+            * \brief Claim and run chunks of current job until none are left
+            */
+            void runChunks();
+
+            std::vector<std::thread> workers_; /**< worker threads, calling thread is not included */
+
+            std::mutex mutex_; /**< mutex guarding job hand off between calling thread and workers */
+            std::condition_variable jobCondition_; /**< signals workers that a job has been posted or pool is stopping */
+            std::condition_variable doneCondition_; /**< signals calling thread that a worker has finished its chunks */
+
+            const std::function<void(const int &, const int &)> * job_ = NULL; /**< function run on each chunk of current job */
+            int nItems_ = 0; /**< number of items in current job */
+            int chunkSize_ = 1; /**< number of items in each chunk of current job */
+            int nChunks_ = 0; /**< number of chunks in current job */
+            std::atomic<int> nextChunk_; /**< next chunk of current job to be claimed */
+            int busyWorkers_ = 0; /**< number of workers still running chunks of current job */
+            unsigned long jobCount_ = 0; /**< number of jobs posted so far, lets workers tell new jobs apart */
+            bool stopping_ = false; /**< flag for workers to exit */
+            std::exception_ptr jobException_; /**< first exception thrown by a chunk of current job */
+    };
+}
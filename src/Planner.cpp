@@ -4,21 +4,28 @@ namespace dynamic_gap
 {   
     Planner::~Planner()
     {
-        // delete current raw, simplified, and selected gaps
-        for (dynamic_gap::Gap * rawGap : currRawGaps_)
-            delete rawGap;
-        currRawGaps_.clear();
+        // stop perception thread before tearing down the objects it uses
+        laserSub_.shutdown();
+        if (scanQueue_)
+            scanQueue_->shutdown();
+        if (perceptionThread_.joinable())
+            perceptionThread_.join();
 
-        for (dynamic_gap::Gap * simplifiedGap : currSimplifiedGaps_)
-            delete simplifiedGap;
-        currSimplifiedGaps_.clear();
+        // gaps are owned by gap sets, which are released along with the planner
 
         // delete objects
         delete tfListener_;
         
         delete gapDetector_;
         delete gapAssociator_;
+        delete gapTrackRegistry_;
+        delete egoMotionBuffer_;
+        delete kalmanFilterBatch_;
+        delete modelUpdatePool_;
+        delete planningPool_;
+        delete scanQueue_;
         delete gapVisualizer_;
+        delete manipGapVisualizer_;
 
         delete globalPlanManager_;
         delete goalVisualizer_;
@@ -58,9 +65,18 @@ namespace dynamic_gap
         ROS_INFO_STREAM("cfg_.map_frame_id: " << cfg_.map_frame_id);
         ROS_INFO_STREAM("cfg_.odom_frame_id: " << cfg_.odom_frame_id);
 
+        // perception thread updates scan parameters of its own copy, 
+        // planning loop picks them up along with each gap set
+        perceptionCfg_ = cfg_;
+
         // Initialize everything
-        gapDetector_ = new dynamic_gap::GapDetector(cfg_);
-        gapAssociator_ = new dynamic_gap::GapAssociator(cfg_);
+        gapDetector_ = new dynamic_gap::GapDetector(perceptionCfg_);
+        gapAssociator_ = new dynamic_gap::GapAssociator(perceptionCfg_);
+        gapTrackRegistry_ = new dynamic_gap::GapTrackRegistry(perceptionCfg_);
+        egoMotionBuffer_ = new dynamic_gap::EgoMotionBuffer(cfg_);
+        kalmanFilterBatch_ = new dynamic_gap::KalmanFilterBatch(perceptionCfg_);
+        modelUpdatePool_ = new dynamic_gap::WorkerPool(cfg_.gap_est.num_update_threads);
+        planningPool_ = new dynamic_gap::WorkerPool(cfg_.planning.num_planning_threads);
 
         globalPlanManager_ = new dynamic_gap::GlobalPlanManager(cfg_);
 
@@ -75,7 +91,8 @@ namespace dynamic_gap
         trajEvaluator_ = new dynamic_gap::TrajectoryEvaluator(cfg_);
         trajController_ = new dynamic_gap::TrajectoryController(nh_, cfg_);
 
-        gapVisualizer_ = new dynamic_gap::GapVisualizer(nh_, cfg_);
+        gapVisualizer_ = new dynamic_gap::GapVisualizer(nh_, perceptionCfg_);
+        manipGapVisualizer_ = new dynamic_gap::GapVisualizer(nh_, cfg_);
         goalVisualizer_ = new dynamic_gap::GoalVisualizer(nh_, cfg_);
         trajVisualizer_ = new dynamic_gap::TrajectoryVisualizer(nh_, cfg_);
 
@@ -84,6 +101,16 @@ namespace dynamic_gap
         
         tfSub_ = nh_.subscribe("/tf", 10, &Planner::tfCB, this);
 
+        // Perception thread
+        agentTable_ = std::make_shared<const dynamic_gap::AgentTable>(cfg_.gap_est.agent_hash_cell_size);
+        scanAgentTable_ = agentTable_;
+        checkpointTraj_ = std::make_shared<const dynamic_gap::Trajectory>(currentTraj_);
+        tPreviousModelUpdate_ = ros::Time::now();
+        if (!cfg_.checkpoint.load_file.empty())
+            readCheckpoint(cfg_.checkpoint.load_file);
+        scanQueue_ = new dynamic_gap::ScanQueue(cfg_);
+        perceptionThread_ = std::thread(&Planner::runPerception, this);
+
         rbtPoseSub_.subscribe(nh_, cfg_.odom_topic, 10);
         rbtAccSub_.subscribe(nh_, cfg_.acc_topic, 10);
         sync_.reset(new CustomSynchronizer(rbtPoseAndAccSyncPolicy(10), rbtPoseSub_, rbtAccSub_));
@@ -117,11 +144,6 @@ namespace dynamic_gap
         rbtPoseInOdomFrame_ = geometry_msgs::PoseStamped();
         globalGoalRobotFrame_ = geometry_msgs::PoseStamped();
 
-        intermediateRbtVels_.clear();
-        intermediateRbtAccs_.clear();
-
-        tPreviousModelUpdate_ = ros::Time::now();
-
         initialized_ = true;
 
         return true;
@@ -173,48 +195,67 @@ namespace dynamic_gap
 
     void Planner::laserScanCB(boost::shared_ptr<sensor_msgs::LaserScan> scan)
     {
-        boost::mutex::scoped_lock gapset(gapMutex_);
+        scanQueue_->push(scan);
+    }
+
+    void Planner::runPerception()
+    {
+        boost::shared_ptr<sensor_msgs::LaserScan> scan;
+        while (scanQueue_->pop(scan))
+        {
+            uint64_t droppedScans = scanQueue_->droppedScans();
+            if (droppedScans > reportedDroppedScans_)
+            {
+                ROS_WARN_STREAM_NAMED("Planner", "perception dropped " << (droppedScans - reportedDroppedScans_) << " stale scans");
+                reportedDroppedScans_ = droppedScans;
+            }
+
+            processScan(scan);
+        }
+    }
 
-        ROS_INFO_STREAM("[laserScanCB()]");
+    void Planner::processScan(boost::shared_ptr<sensor_msgs::LaserScan> scan)
+    {
+        ROS_INFO_STREAM("[processScan()]");
         ROS_INFO_STREAM("       timestamp: " << scan->header.stamp);
 
         // pre-process scan (turning nan's into max ranges)
         float eps = 0.00001f;
         for (int i = 0; i < scan->ranges.size(); i++)
-            scan->ranges.at(i) = (std::isnan(scan->ranges.at(i)) ? (cfg_.scan.range_max - eps) : scan->ranges.at(i));
+            scan->ranges.at(i) = (std::isnan(scan->ranges.at(i)) ? (perceptionCfg_.scan.range_max - eps) : scan->ranges.at(i));
 
         std::chrono::steady_clock::time_point scanStartTime = std::chrono::steady_clock::now();
         // ROS_INFO_STREAM_NAMED("Planner", "[laserScanCB()]");
-        
-        scan_ = scan;
 
-        float minScanDist = *std::min_element(scan_->ranges.begin(), scan_->ranges.end());
+        float minScanDist = *std::min_element(scan->ranges.begin(), scan->ranges.end());
 
+        bool scanColliding = false;
         if (minScanDist < cfg_.rbt.r_inscr)
         {
             ROS_INFO_STREAM("       in collision!");
-            colliding = true;
-        } else
-        {
-            colliding = false;
+            scanColliding = true;
         }
 
-        cfg_.updateParamFromScan(scan_);
+        perceptionCfg_.updateParamFromScan(scan);
 
-        // ROS_INFO_STREAM("scan: " << *scan_);
+        // ROS_INFO_STREAM("scan: " << *scan);
 
-        ros::Time tCurrentFilterUpdate = scan_->header.stamp;
-        if (hasGlobalGoal_)
+        ros::Time tCurrentFilterUpdate = scan->header.stamp;
+        bool hasGaps = hasGlobalGoal_;
+        if (hasGaps)
         {
             // grabbing current intermediate robot velocities and accelerations
-            std::vector<geometry_msgs::TwistStamped> intermediateRbtVels = intermediateRbtVels_;
-            std::vector<geometry_msgs::TwistStamped> intermediateRbtAccs = intermediateRbtAccs_;
+            std::vector<geometry_msgs::TwistStamped> intermediateRbtVels, intermediateRbtAccs;
+            egoMotionBuffer_->copySince(tPreviousModelUpdate_, intermediateRbtVels, intermediateRbtAccs);
+
+            // grabbing current ground truth agent states
+            scanAgentTable_ = std::atomic_load(&agentTable_);
 
             ///////////////////////////////
             //////// GAP DETECTION ////////
             ///////////////////////////////
             std::chrono::steady_clock::time_point gapDetectionStartTime = std::chrono::steady_clock::now();
-            currRawGaps_ = gapDetector_->gapDetection(scan_, globalGoalRobotFrame_);
+            currRawGaps_ = gapDetector_->gapDetection(scan, globalGoalRobotFrame_);
             float gapDetectionTimeTaken = timeTaken(gapDetectionStartTime);
             float avgGapDetectionTimeTaken = computeAverageTimeTaken(gapDetectionTimeTaken, GAP_DET);
             ROS_INFO_STREAM_NAMED("Timing", "      [Gap Detection for " << currRawGaps_.size() << " gaps took " << gapDetectionTimeTaken << " seconds]");
@@ -224,10 +265,26 @@ namespace dynamic_gap
             //////// RAW GAP ASSOCIATION ////////
             /////////////////////////////////////
             std::chrono::steady_clock::time_point rawGapAssociationStartTime = std::chrono::steady_clock::now();
-            rawDistMatrix_ = gapAssociator_->obtainDistMatrix(currRawGaps_, prevRawGaps_);
-            rawAssocation_ = gapAssociator_->associateGaps(rawDistMatrix_);
-            gapAssociator_->assignModels(rawAssocation_, rawDistMatrix_, 
-                                        currRawGaps_, prevRawGaps_, 
+            if (cfg_.gap_assoc.banded_association)
+            {
+                rawAssocation_ = gapAssociator_->associateGapsBanded(currRawGaps_, prevRawGaps_);
+            } else
+            {
+                rawDistMatrix_ = gapAssociator_->obtainDistMatrix(currRawGaps_, prevRawGaps_);
+                rawAssocation_ = gapAssociator_->associateGaps(rawDistMatrix_);
+            }
+
+            // previous gap set is withdrawn if planning loop has not picked it up yet (newer set is published below),
+            // so that once perception holds the only reference, previous estimators can be moved instead of copied
+            std::shared_ptr<const dynamic_gap::GapSetSnapshot> publishedGapSet = prevGapSet_;
+            std::atomic_compare_exchange_strong(&gapSetSnapshot_, &publishedGapSet, std::shared_ptr<const dynamic_gap::GapSetSnapshot>());
+            publishedGapSet.reset();
+            bool ownsPreviousGaps = (prevGapSet_.use_count() == 1);
+            if (ownsPreviousGaps)
+                std::atomic_thread_fence(std::memory_order_acquire); // planning loop's last reads of set happen before estimators are moved
+
+            gapAssociator_->assignModels(rawAssocation_, 
+                                        currRawGaps_, prevRawGaps_, ownsPreviousGaps,
                                         currentModelIdx_, tCurrentFilterUpdate,
                                         intermediateRbtVels, intermediateRbtAccs);
             float rawGapAssociationTimeTaken = timeTaken(rawGapAssociationStartTime);
@@ -239,8 +296,19 @@ namespace dynamic_gap
             //////// RAW GAP ESTIMATION ////////
             ////////////////////////////////////
             std::chrono::steady_clock::time_point rawGapEstimationStartTime = std::chrono::steady_clock::now();
-            updateModels(currRawGaps_, intermediateRbtVels, 
-                         intermediateRbtAccs, tCurrentFilterUpdate);
+            
+            // models updated at previous scan pick up from the end of the previous timeline
+            geometry_msgs::TwistStamped startRbtVel, startRbtAcc;
+            if (egoMotionTimeline_.valid())
+            {
+                startRbtVel = egoMotionTimeline_.rbtVels().back();
+                startRbtAcc = egoMotionTimeline_.rbtAccs().back();
+            }
+            egoMotionTimeline_.build(intermediateRbtVels, intermediateRbtAccs,
+                                     tPreviousModelUpdate_, startRbtVel, startRbtAcc,
+                                     tCurrentFilterUpdate, dynamic_gap::RotatingFrameCartesianKalmanFilter::initialQ());
+
+            updateModels(currRawGaps_, egoMotionTimeline_, tCurrentFilterUpdate);
             float rawGapEstimationTimeTaken = timeTaken(rawGapEstimationStartTime);
             float avgRawGapEstimationTimeTaken = computeAverageTimeTaken(rawGapEstimationTimeTaken, GAP_EST);
             ROS_INFO_STREAM_NAMED("Timing", "      [Raw Gap Estimation for " << currRawGaps_.size() << " gaps took " << rawGapEstimationTimeTaken << " seconds]");
@@ -256,66 +324,57 @@ namespace dynamic_gap
             ROS_INFO_STREAM_NAMED("Timing", "      [Gap Simplification for " << currSimplifiedGaps_.size() << " gaps took " << gapSimplificationTimeTaken << " seconds]");
             ROS_INFO_STREAM_NAMED("Timing", "      [Gap Simplification average time: " << avgGapSimplificationTimeTaken << " seconds (" << (1.0 / avgGapSimplificationTimeTaken) << " Hz) ]");
 
-            ////////////////////////////////////////////
-            //////// SIMPLIFIED GAP ASSOCIATION ////////
-            ////////////////////////////////////////////
-            std::chrono::steady_clock::time_point simpGapAssociationStartTime = std::chrono::steady_clock::now();
-            simpDistMatrix_ = gapAssociator_->obtainDistMatrix(currSimplifiedGaps_, prevSimplifiedGaps_);
-            simpAssociation_ = gapAssociator_->associateGaps(simpDistMatrix_); // must finish this and therefore change the association
-            gapAssociator_->assignModels(simpAssociation_, simpDistMatrix_, 
-                                        currSimplifiedGaps_, prevSimplifiedGaps_, 
-                                        currentModelIdx_, tCurrentFilterUpdate,
-                                        intermediateRbtVels, intermediateRbtAccs);
-            float simpGapAssociationTimeTaken = timeTaken(simpGapAssociationStartTime);
-            float avgSimpGapAssociationTimeTaken = computeAverageTimeTaken(simpGapAssociationTimeTaken, GAP_ASSOC);
-            ROS_INFO_STREAM_NAMED("Timing", "      [Simplified Gap Association for " << currSimplifiedGaps_.size() << " gaps took " << simpGapAssociationTimeTaken << " seconds]");
-            ROS_INFO_STREAM_NAMED("Timing", "      [Simplified Gap Association average time: " << avgSimpGapAssociationTimeTaken << " seconds (" << (1.0 / avgSimpGapAssociationTimeTaken) << " Hz) ]");
-
-            ///////////////////////////////////////////
-            //////// SIMPLIFIED GAP ESTIMATION ////////
-            ///////////////////////////////////////////     
-            std::chrono::steady_clock::time_point simpGapEstimationStartTime = std::chrono::steady_clock::now();
-            updateModels(currSimplifiedGaps_, intermediateRbtVels, 
-                         intermediateRbtAccs, tCurrentFilterUpdate);
-            float simpGapEstimationTimeTaken = timeTaken(simpGapEstimationStartTime);
-            float avgSimpGapEstimationTimeTaken = computeAverageTimeTaken(simpGapEstimationTimeTaken, GAP_EST);
-            ROS_INFO_STREAM_NAMED("Timing", "      [Simplified Gap Estimation for " << currRawGaps_.size() << " gaps took " << simpGapEstimationTimeTaken << " seconds]");
-            ROS_INFO_STREAM_NAMED("Timing", "      [Simplified Gap Estimation average time: " << avgSimpGapEstimationTimeTaken << " seconds (" << (1.0 / avgSimpGapEstimationTimeTaken) << " Hz) ]");
+            //////////////////////////////////////////////
+            //////// SIMPLIFIED GAP TRACK BINDING ////////
+            //////////////////////////////////////////////
+            // simplified gap points are raw gap points, so they reuse raw gap point 
+            // estimators instead of being associated and estimated a second time
+            gapTrackRegistry_->registerTracks(currRawGaps_);
+            gapTrackRegistry_->bindTracks(currSimplifiedGaps_);
 
             gapVisualizer_->drawGaps(currRawGaps_, std::string("raw"));
             gapVisualizer_->drawGapsModels(currRawGaps_);
             gapVisualizer_->drawGaps(currSimplifiedGaps_, std::string("simp"));
             gapVisualizer_->drawGaps(prevSimplifiedGaps_, std::string("simp_tmin1"));
             gapVisualizer_->drawGapsModels(currSimplifiedGaps_);
-
-            readyToPlan = true;
         }
-        
-        // update current scan for proper classes
-        updateEgoCircle();
 
-        // update global path local waypoint according to new scan
-        globalPlanManager_->generateGlobalPathLocalWaypoint(map2rbt_);
-        geometry_msgs::PoseStamped globalPathLocalWaypointOdomFrame = globalPlanManager_->getGlobalPathLocalWaypointOdomFrame(rbt2odom_);
-        goalVisualizer_->drawGlobalPathLocalWaypoint(globalPathLocalWaypointOdomFrame);
-        goalVisualizer_->drawGlobalGoal(globalGoalOdomFrame_);
-        trajEvaluator_->transformGlobalPathLocalWaypointToRbtFrame(globalPathLocalWaypointOdomFrame, odom2rbt_);
-        
-        // delete previous gaps
-        for (dynamic_gap::Gap * prevRawGap : prevRawGaps_)
-            delete prevRawGap;
-        prevRawGaps_.clear();
-        
-        for (dynamic_gap::Gap * prevSimplifiedGap : prevSimplifiedGaps_)
-            delete prevSimplifiedGap;
-        prevSimplifiedGaps_.clear();
+        // publish gap set for planning loop, which picks it up without waiting on perception
+        geometry_msgs::TwistStamped modelRbtVel, modelRbtAcc;
+        if (egoMotionTimeline_.valid())
+        {
+            modelRbtVel = egoMotionTimeline_.rbtVels().back();
+            modelRbtAcc = egoMotionTimeline_.rbtAccs().back();
+        }
+        // current gaps are handed over to gap set, which stays unmodified from here on
+        std::shared_ptr<const dynamic_gap::GapSetSnapshot> gapSet = 
+            std::make_shared<const dynamic_gap::GapSetSnapshot>(scan, perceptionCfg_.scan, std::move(currRawGaps_), std::move(currSimplifiedGaps_), 
+                                                                hasGaps, scanColliding, modelRbtVel, modelRbtAcc);
+        std::atomic_store(&gapSetSnapshot_, gapSet);
+
+        // gaps are only tracked once there is a goal, so scans before that leave 
+        // previous gaps (and any gaps restored from a checkpoint) as they are
+        if (hasGaps)
+        {
+            // update previous gaps, previous gap set is released here unless planning loop is still copying it
+            prevGapSet_ = gapSet;
+            prevRawGaps_ = gapSet->rawGaps();
+            prevSimplifiedGaps_ = gapSet->simplifiedGaps();
 
-        // update previous gaps
-        prevRawGaps_ = currRawGaps_;
-        prevSimplifiedGaps_ = currSimplifiedGaps_;
+            // update estimator update time
+            tPreviousModelUpdate_ = tCurrentFilterUpdate;
+        }
 
-        // update estimator update time
-        tPreviousModelUpdate_ = tCurrentFilterUpdate;
+        // periodically checkpoint tracker state so that replays can start mid-sequence
+        if (!cfg_.checkpoint.save_dir.empty() && 
+            (tCurrentFilterUpdate - tLastCheckpoint_).toSec() >= cfg_.checkpoint.save_period)
+        {
+            std::ostringstream checkpointPath;
+            checkpointPath << cfg_.checkpoint.save_dir << "/checkpoint_" << tCurrentFilterUpdate.sec << "_" 
+                           << std::setw(9) << std::setfill('0') << tCurrentFilterUpdate.nsec << ".bin";
+            writeCheckpoint(checkpointPath.str());
+            tLastCheckpoint_ = tCurrentFilterUpdate;
+        }
 
         float scanTimeTaken = timeTaken(scanStartTime);
         float avgScanTimeTaken = computeAverageTimeTaken(scanTimeTaken, SCAN);
@@ -325,23 +384,54 @@ namespace dynamic_gap
 
     // TO CHECK: DOES ASSOCIATIONS KEEP OBSERVED GAP POINTS IN ORDER (0,1,2,3...)
     void Planner::updateModels(std::vector<dynamic_gap::Gap *> & gaps, 
-                                const std::vector<geometry_msgs::TwistStamped> & intermediateRbtVels,
-                                const std::vector<geometry_msgs::TwistStamped> & intermediateRbtAccs,
+                                const dynamic_gap::EgoMotionTimeline & egoMotionTimeline,
                                 const ros::Time & tCurrentFilterUpdate) 
     {
         // ROS_INFO_STREAM_NAMED("GapEstimation", "[updateModels()]");
         
         try
         {
+            unbatchedModelIdxs_.clear();
+
             for (int i = 0; i < 2*gaps.size(); i++) 
             {
                 // ROS_INFO_STREAM_NAMED("GapEstimation", "    update gap model " << i << " of " << 2*gaps.size());
-                updateModel(i, gaps, intermediateRbtVels, intermediateRbtAccs, tCurrentFilterUpdate);
-                // ROS_INFO_STREAM_NAMED("GapEstimation", "");
+
+                // filters that share this scan's ego-motion timeline are updated together below
+                if (cfg_.gap_est.batched_update && egoMotionTimeline.valid())
+                {
+                    dynamic_gap::Gap * gap = gaps[int(i / 2.0)];
+                    dynamic_gap::RotatingFrameCartesianKalmanFilter * filter = 
+                        dynamic_cast<dynamic_gap::RotatingFrameCartesianKalmanFilter *>(i % 2 == 0 ? gap->leftGapPtModel_ : gap->rightGapPtModel_);
+
+                    if (filter && filter->sharesEgoMotionTimeline(egoMotionTimeline, tCurrentFilterUpdate))
+                    {
+                        float rX = 0.0, rY = 0.0;
+                        if (i % 2 == 0) 
+                            gap->getLCartesian(rX, rY);            
+                        else 
+                            gap->getRCartesian(rX, rY);
+
+                        kalmanFilterBatch_->add(filter, Eigen::Vector2f(rX, rY));
+                        continue;
+                    }
+                }
+
+                unbatchedModelIdxs_.push_back(i);
             }
+
+            // every gap point owns its model after association, so remaining models are updated independently in parallel chunks
+            modelUpdatePool_->parallelFor(unbatchedModelIdxs_.size(), modelsPerUpdateChunk_, [&](const int & begin, const int & end)
+            {
+                for (int j = begin; j < end; j++)
+                    updateModel(unbatchedModelIdxs_[j], gaps, egoMotionTimeline, tCurrentFilterUpdate);
+            });
+
+            kalmanFilterBatch_->update(egoMotionTimeline, tCurrentFilterUpdate, modelUpdatePool_);
         } catch (...)
         {
             ROS_WARN_STREAM_NAMED("GapEstimation", "updateModels failed");
+            kalmanFilterBatch_->clear();
         }
 
         return;
@@ -349,8 +439,7 @@ namespace dynamic_gap
 
     void Planner::updateModel(const int & idx, 
                                 std::vector<dynamic_gap::Gap *> & gaps, 
-                                const std::vector<geometry_msgs::TwistStamped> & intermediateRbtVels,
-                                const std::vector<geometry_msgs::TwistStamped> & intermediateRbtAccs,
+                                const dynamic_gap::EgoMotionTimeline & egoMotionTimeline,
                                 const ros::Time & tCurrentFilterUpdate) 
     {
 		try
@@ -372,9 +461,8 @@ namespace dynamic_gap
                 if (gap->leftGapPtModel_)
                 {
                    gap->leftGapPtModel_->update(measurement, 
-                                                intermediateRbtVels, intermediateRbtAccs, 
-                                                currentTrueAgentPoses_, 
-                                                currentTrueAgentVels_,
+                                                egoMotionTimeline, 
+                                                *scanAgentTable_,
                                                 tCurrentFilterUpdate);                    
                 } else
                 {
@@ -385,9 +473,8 @@ namespace dynamic_gap
                 if (gap->rightGapPtModel_)
                 {
                    gap->rightGapPtModel_->update(measurement, 
-                                                intermediateRbtVels, intermediateRbtAccs, 
-                                                currentTrueAgentPoses_, 
-                                                currentTrueAgentVels_,
+                                                egoMotionTimeline, 
+                                                *scanAgentTable_,
                                                 tCurrentFilterUpdate);                    
                 } else
                 {                
@@ -429,37 +516,7 @@ void Planner::jointPoseAccCB(const nav_msgs::Odometry::ConstPtr & rbtOdomMsg,
 
         try
         {
-            // ROS_INFO_STREAM("   tPreviousModelUpdate_: " << tPreviousModelUpdate_);
-
-            // deleting old sensor measurements already used in an update
-            for (int i = 0; i < intermediateRbtAccs_.size(); i++)
-            {
-                // ROS_INFO_STREAM("   intermediateRbtAccs_.at(" << i << "):");
-                // ROS_INFO_STREAM("       header.stamp: " << intermediateRbtAccs_.at(i).header.stamp);                     
-                if (intermediateRbtAccs_.at(i).header.stamp <= tPreviousModelUpdate_)
-                {
-                    // ROS_INFO_STREAM("           erasing!");
-                    intermediateRbtAccs_.erase(intermediateRbtAccs_.begin() + i);
-                    i--;
-                }
-            }
-
             currentRbtAcc_ = *rbtAccelMsg;
-            if (intermediateRbtAccs_.size() > 0 && (intermediateRbtAccs_.back().header.stamp == currentRbtAcc_.header.stamp))
-            {
-                // ROS_INFO_STREAM("   redundant timestamp, skipping currentRbtAcc_");
-            } else
-            {
-                // assuming acceleration message comes in wrt robot frame, no transforms
-                intermediateRbtAccs_.push_back(currentRbtAcc_);
-
-                // ROS_INFO_STREAM("   pushing back currentRbtAcc_: ");
-                // ROS_INFO_STREAM("       header.stamp: " << currentRbtAcc_.header.stamp);
-                // ROS_INFO_STREAM("       header.frame_id: " << currentRbtAcc_.header.frame_id);
-                // ROS_INFO_STREAM("       linear: ");
-                // ROS_INFO_STREAM("           x: " << currentRbtAcc_.twist.linear.x);
-                // ROS_INFO_STREAM("           y: " << currentRbtAcc_.twist.linear.y);
-            }
 
             //--------------- POSE -------------------//
 
@@ -494,34 +551,16 @@ void Planner::jointPoseAccCB(const nav_msgs::Odometry::ConstPtr & rbtOdomMsg,
             currentRbtVel_.twist.linear = rbtVelRbtFrame.vector;
             currentRbtVel_.twist.angular = rbtOdomMsg->twist.twist.angular; // z is same between frames
 
-            // deleting old sensor measurements already used in an update
-            for (int i = 0; i < intermediateRbtVels_.size(); i++)
-            {
-                // ROS_INFO_STREAM("   intermediateRbtVels_.at(" << i << "):");
-                // ROS_INFO_STREAM("       header.stamp: " << intermediateRbtVels_.at(i).header.stamp);                
-                if (intermediateRbtVels_.at(i).header.stamp <= tPreviousModelUpdate_)
-                {
-                    // ROS_INFO_STREAM("           erasing!");
-                    intermediateRbtVels_.erase(intermediateRbtVels_.begin() + i);
-                    i--;
-                }
-            }
-
-            if (intermediateRbtVels_.size() > 0 && (intermediateRbtVels_.back().header.stamp == currentRbtVel_.header.stamp))
-            {
-                // ROS_INFO_STREAM("   redundant timestamp, skipping currentRbtVel_");
-            } else
-            {
-                intermediateRbtVels_.push_back(currentRbtVel_);
-
-                // ROS_INFO_STREAM("   pushing back currentRbtVel_: ");
-                // ROS_INFO_STREAM("       header.stamp: " << currentRbtVel_.header.stamp);
-                // ROS_INFO_STREAM("       header.frame_id: " << currentRbtVel_.header.frame_id);
-                // ROS_INFO_STREAM("       linear: ");
-                // ROS_INFO_STREAM("           x: " << currentRbtVel_.twist.linear.x);
-                // ROS_INFO_STREAM("           y: " << currentRbtVel_.twist.linear.y);
-            }
-
+            // assuming acceleration message comes in wrt robot frame, no transforms
+            dynamic_gap::EgoMotionSample egoMotionSample;
+            egoMotionSample.velStamp = currentRbtVel_.header.stamp;
+            egoMotionSample.vx = currentRbtVel_.twist.linear.x;
+            egoMotionSample.vy = currentRbtVel_.twist.linear.y;
+            egoMotionSample.omega = currentRbtVel_.twist.angular.z;
+            egoMotionSample.accStamp = currentRbtAcc_.header.stamp;
+            egoMotionSample.ax = currentRbtAcc_.twist.linear.x;
+            egoMotionSample.ay = currentRbtAcc_.twist.linear.y;
+            egoMotionBuffer_->push(egoMotionSample);
         } catch (...)
         {
             ROS_WARN_STREAM_NAMED("Planner", "jointPoseAccCB failed");
@@ -537,53 +576,49 @@ void Planner::jointPoseAccCB(const nav_msgs::Odometry::ConstPtr & rbtOdomMsg,
         if (!haveTFs)
             return;
 
-        for (int i = 0; i < pedOdomMsg->agent_states.size(); i++)
-        {
-            pedsim_msgs::AgentState agentIState = pedOdomMsg->agent_states[i];
-            std::string source_frame = agentIState.header.frame_id; 
+        std::shared_ptr<dynamic_gap::AgentTable> agentTable = std::make_shared<dynamic_gap::AgentTable>(cfg_.gap_est.agent_hash_cell_size);
+
+        // agents are all reported in the same frame, so one transform normally covers the whole message
+        std::string transformFrame;
+        geometry_msgs::TransformStamped msgFrame2RobotFrame;
 
-            // transforming Odometry message from map_static to robotN
-            geometry_msgs::TransformStamped msgFrame2RobotFrame = tfBuffer_.lookupTransform(cfg_.robot_frame_id, 
-                                                                                            source_frame, 
-                                                                                            ros::Time(0));
+        for (const pedsim_msgs::AgentState & agentIState : pedOdomMsg->agent_states)
+        {
             geometry_msgs::PoseStamped agentPoseMsgFrame, agentPoseRobotFrame;
             geometry_msgs::Vector3Stamped agentVelMsgFrame, agentVelRobotFrame;
 
             try 
             {
+                // transforming Odometry message from map_static to robotN
+                if (agentIState.header.frame_id != transformFrame)
+                {
+                    msgFrame2RobotFrame = tfBuffer_.lookupTransform(cfg_.robot_frame_id, 
+                                                                    agentIState.header.frame_id, 
+                                                                    ros::Time(0));
+                    transformFrame = agentIState.header.frame_id;
+                }
+
                 agentPoseMsgFrame.header = agentIState.header;
                 agentPoseMsgFrame.pose = agentIState.pose;
-                // ROS_INFO_STREAM_NAMED("Planner", "      incoming pose: (" << agentPoseMsgFrame.pose.position.x << ", " << agentPoseMsgFrame.pose.position.y << ")");
-
-                //std::cout << "rbt vel: " << msg->twist.twist.linear.x << ", " << msg->twist.twist.linear.y << std::endl;
                 tf2::doTransform(agentPoseMsgFrame, agentPoseRobotFrame, msgFrame2RobotFrame);
-                
-                // ROS_INFO_STREAM_NAMED("Planner", "      outgoing pose: (" << agentPoseRobotFrame.pose.position.x << ", " << agentPoseRobotFrame.pose.position.y << ")");
 
-                // ROS_INFO_STREAM("updating " << agentNamespace << " odom from " << agent_odom_vects.at(agentID)[0] << ", " << agent_odom_vects.at(agentID)[1] << " to " << odom_vect[0] << ", " << odom_vect[1]);
-                currentTrueAgentPoses_[agentIState.id] = agentPoseRobotFrame.pose;
-            } catch (...) 
-            {
-                ROS_WARN_STREAM_NAMED("Planner", "pedOdomCB odometry failed for " << agentIState.id);
-            }
-            
-            try 
-            {
-                // std::cout << "in agentOdomCB" << std::endl;
-                // std::cout << "transforming from " << source_frame << " to " << cfg_.robot_frame_id << std::endl;
                 agentVelMsgFrame.header = agentIState.header;
                 // agentVelMsgFrame.header.frame_id = source_frame; // TODO: determine if frame for position is same as frame for velocity
                 agentVelMsgFrame.vector = agentIState.twist.linear;
-                // std::cout << "incoming vector: " << agentVelMsgFrame.vector.x << ", " << agentVelMsgFrame.vector.y << std::endl;
                 tf2::doTransform(agentVelMsgFrame, agentVelRobotFrame, msgFrame2RobotFrame);
-                // std::cout << "outcoming vector: " << agentVelRobotFrame.vector.x << ", " << agentVelRobotFrame.vector.y << std::endl;
 
-                currentTrueAgentVels_[agentIState.id] = agentVelRobotFrame;
+                int agentID = agentIDs_.emplace(agentIState.id, agentIDs_.size()).first->second;
+                agentTable->addAgent(agentID, agentPoseRobotFrame.pose, agentVelRobotFrame);
             } catch (...) 
             {
-                ROS_WARN_STREAM_NAMED("Planner", "pedOdomCB velocity failed for " << agentIState.id);
-            }            
+                ROS_WARN_STREAM_NAMED("Planner", "pedOdomCB failed for " << agentIState.id);
+            }
         }
+
+        agentTable->buildSpatialHash();
+
+        // publish table for perception thread, which picks it up at next scan
+        std::atomic_store(&agentTable_, std::shared_ptr<const dynamic_gap::AgentTable>(agentTable));
     }
 
     bool Planner::setPlan(const std::vector<geometry_msgs::PoseStamped> & globalPlanMapFrame)
@@ -660,6 +695,38 @@ void Planner::jointPoseAccCB(const nav_msgs::Odometry::ConstPtr & rbtOdomMsg,
         }
     }
 
+    void Planner::adoptGapSet(const std::shared_ptr<const dynamic_gap::GapSetSnapshot> & gapSet)
+    {
+        // planning loop works from its own copy, so that published gap set is only held while it is copied
+        // and perception thread can move its models on once it is done with them
+        std::vector<dynamic_gap::Gap *> rawGaps, simplifiedGaps;
+        for (dynamic_gap::Gap * rawGap : gapSet->rawGaps())
+            rawGaps.push_back(new dynamic_gap::Gap(*rawGap));
+        for (dynamic_gap::Gap * simplifiedGap : gapSet->simplifiedGaps())
+            simplifiedGaps.push_back(new dynamic_gap::Gap(*simplifiedGap));
+
+        planningGapSet_ = std::make_shared<const dynamic_gap::GapSetSnapshot>(gapSet->scan(), gapSet->scanParams(), 
+                                                                              std::move(rawGaps), std::move(simplifiedGaps),
+                                                                              gapSet->hasGaps(), gapSet->colliding(), 
+                                                                              gapSet->rbtVel(), gapSet->rbtAcc());
+        adoptedGapSet_ = gapSet;
+
+        scan_ = gapSet->scan();
+        cfg_.scan = gapSet->scanParams();
+        colliding = gapSet->colliding();
+        readyToPlan = readyToPlan || gapSet->hasGaps();
+
+        // update current scan for proper classes
+        updateEgoCircle();
+
+        // update global path local waypoint according to new scan
+        globalPlanManager_->generateGlobalPathLocalWaypoint(map2rbt_);
+        geometry_msgs::PoseStamped globalPathLocalWaypointOdomFrame = globalPlanManager_->getGlobalPathLocalWaypointOdomFrame(rbt2odom_);
+        goalVisualizer_->drawGlobalPathLocalWaypoint(globalPathLocalWaypointOdomFrame);
+        goalVisualizer_->drawGlobalGoal(globalGoalOdomFrame_);
+        trajEvaluator_->transformGlobalPathLocalWaypointToRbtFrame(globalPathLocalWaypointOdomFrame, odom2rbt_);
+    }
+
     void Planner::updateEgoCircle()
     {
         globalPlanManager_->updateEgoCircle(scan_);
@@ -672,7 +739,6 @@ void Planner::jointPoseAccCB(const nav_msgs::Odometry::ConstPtr & rbtOdomMsg,
 
     void Planner::propagateGapPoints(const std::vector<dynamic_gap::Gap *> & planningGaps)                                             
     {
-        boost::mutex::scoped_lock gapset(gapMutex_);        
         ROS_INFO_STREAM_NAMED("GapFeasibility", "[propagateGapPoints()]");
 
         // grabbing the current set of gaps
@@ -681,7 +747,7 @@ void Planner::jointPoseAccCB(const nav_msgs::Odometry::ConstPtr & rbtOdomMsg,
         try
         {
             ROS_INFO_STREAM_NAMED("GapFeasibility", "    current raw gaps:");
-            printGapModels(currRawGaps_);
+            printGapModels(planningGapSet_->rawGaps());
 
             ROS_INFO_STREAM_NAMED("GapFeasibility", "    current simplified gaps:");
             printGapModels(planningGaps);
@@ -707,7 +773,6 @@ void Planner::jointPoseAccCB(const nav_msgs::Odometry::ConstPtr & rbtOdomMsg,
 
         ROS_INFO_STREAM_NAMED("GapManipulator", "[manipulateGaps()]");
 
-        boost::mutex::scoped_lock gapset(gapMutex_);
         std::vector<dynamic_gap::Gap *> manipulatedGaps;
 
         try
@@ -744,7 +809,6 @@ void Planner::jointPoseAccCB(const nav_msgs::Odometry::ConstPtr & rbtOdomMsg,
     std::vector<dynamic_gap::Gap *> Planner::gapSetFeasibilityCheck(const std::vector<dynamic_gap::Gap *> & manipulatedGaps, 
                                                                     bool & isCurrentGapFeasible)                                             
     {
-        boost::mutex::scoped_lock gapset(gapMutex_);        
         ROS_INFO_STREAM_NAMED("GapFeasibility", "[gapSetFeasibilityCheck()]");
         std::vector<dynamic_gap::Gap *> feasibleGaps;
 
@@ -793,11 +857,40 @@ void Planner::jointPoseAccCB(const nav_msgs::Odometry::ConstPtr & rbtOdomMsg,
                                     std::vector<dynamic_gap::Trajectory> & generatedTrajs,
                                     std::vector<std::vector<float>> & pathPoseCosts,
                                     std::vector<float> & pathTerminalPoseCosts,
-                                    const std::vector<sensor_msgs::LaserScan> & futureScans) 
+                                    const dynamic_gap::FutureEgoCircle & futureEgoCircle) 
     {
-        boost::mutex::scoped_lock gapset(gapMutex_);
-
         ROS_INFO_STREAM_NAMED("GapTrajectoryGenerator", "[generateGapTrajs()]");
+
+        if (cfg_.planning.gap_cost_bounding)
+        {
+            try
+            {
+                // last slot holds idling trajectory, which is scored first so that its cost can already prune gaps
+                std::vector<GapPipelineSlot> slots(gaps.size() + 1);
+                for (size_t i = 0; i < gaps.size(); i++)
+                {
+                    slots.at(i).feasible = true;
+                    slots.at(i).trajGap = gaps.at(i);
+                }
+
+                GapPipelineSlot & idlingSlot = slots.back();
+                generateIdlingTraj(idlingSlot.traj, idlingSlot.poseCosts, idlingSlot.terminalPoseCost, futureEgoCircle);
+                idlingSlot.generated = true;
+
+                // only keep gaps that trajectories were generated through, so gaps stay aligned with trajectories
+                std::vector<dynamic_gap::Gap *> generatedGaps;
+                gatherGapTrajs(slots, generatedGaps, generatedTrajs, pathPoseCosts, pathTerminalPoseCosts, futureEgoCircle);
+                gaps = generatedGaps;
+            } catch (...) 
+            {
+                ROS_WARN_STREAM_NAMED("GapTrajectoryGenerator", "generateGapTrajs failed");
+            }
+
+            trajVisualizer_->drawGapTrajectoryPoseScores(generatedTrajs, pathPoseCosts);
+            trajVisualizer_->drawGapTrajectories(generatedTrajs);
+
+            return;
+        }
         
         pathPoseCosts = std::vector<std::vector<float>>(gaps.size());
         pathTerminalPoseCosts = std::vector<float>(gaps.size());
@@ -807,76 +900,20 @@ void Planner::jointPoseAccCB(const nav_msgs::Odometry::ConstPtr & rbtOdomMsg,
             for (size_t i = 0; i < gaps.size(); i++) 
             {
                 ROS_INFO_STREAM_NAMED("GapTrajectoryGenerator", "    generating traj for gap: " << i);
-                // std::cout << "goal of: " << vec.at(i).goal.x << ", " << vec.at(i).goal.y << std::endl;
-                
-                // Run go to goal behavior
-                bool runGoToGoal = (gaps.at(i)->globalGoalWithin); // (vec.at(i).goal.goalwithin || vec.at(i).artificial);
-
-                dynamic_gap::Trajectory traj, goToGoalTraj, pursuitGuidanceTraj;
-                std::vector<float> goToGoalPoseCosts, pursuitGuidancePoseCosts;
-                float goToGoalTerminalPoseCost, pursuitGuidanceTerminalPoseCost;
-                float goToGoalCost, pursuitGuidancePoseCost;
 
-                if (runGoToGoal) 
-                {
-                    ROS_INFO_STREAM_NAMED("GapTrajectoryGenerator", "        running goToGoal");
-
-                    goToGoalTraj = gapTrajGenerator_->generateTrajectory(gaps.at(i), rbtPoseInSensorFrame_, 
-                                                                        currentRbtVel_, 
-                                                                        globalGoalRobotFrame_,
-                                                                        true);
-                    goToGoalTraj = gapTrajGenerator_->processTrajectory(goToGoalTraj, true);
-                    trajEvaluator_->evaluateTrajectory(goToGoalTraj, goToGoalPoseCosts, goToGoalTerminalPoseCost, futureScans);
-                    goToGoalCost = goToGoalTerminalPoseCost + std::accumulate(goToGoalPoseCosts.begin(), goToGoalPoseCosts.end(), float(0));
-                    ROS_INFO_STREAM_NAMED("GapTrajectoryGenerator", "        goToGoalCost: " << goToGoalCost);
-                }
-
-                // Run pursuit guidance behavior
-                ROS_INFO_STREAM_NAMED("GapTrajectoryGenerator", "        running pursuit guidance");
-                pursuitGuidanceTraj = gapTrajGenerator_->generateTrajectory(gaps.at(i), rbtPoseInSensorFrame_, 
-                                                                            currentRbtVel_, 
-                                                                            globalGoalRobotFrame_,
-                                                                            false);
-
-                pursuitGuidanceTraj = gapTrajGenerator_->processTrajectory(pursuitGuidanceTraj, true);
-                trajEvaluator_->evaluateTrajectory(pursuitGuidanceTraj, pursuitGuidancePoseCosts, pursuitGuidanceTerminalPoseCost, futureScans);
-                pursuitGuidancePoseCost = pursuitGuidanceTerminalPoseCost + std::accumulate(pursuitGuidancePoseCosts.begin(), pursuitGuidancePoseCosts.end(), float(0));
-                ROS_INFO_STREAM_NAMED("GapTrajectoryGenerator", "        pursuitGuidancePoseCost: " << pursuitGuidancePoseCost);
-
-                if (runGoToGoal && goToGoalCost < pursuitGuidancePoseCost)
-                {
-                    traj = goToGoalTraj;
-                    pathPoseCosts.at(i) = goToGoalPoseCosts;
-                    pathTerminalPoseCosts.at(i) = goToGoalTerminalPoseCost;
-                } else
-                {
-                    traj = pursuitGuidanceTraj;
-                    pathPoseCosts.at(i) = pursuitGuidancePoseCosts;
-                    pathTerminalPoseCosts.at(i) = pursuitGuidanceTerminalPoseCost;
-                }
-
-                // TRAJECTORY TRANSFORMED BACK TO ODOM FRAME
-                traj.setPathOdomFrame(gapTrajGenerator_->transformPath(traj.getPathRbtFrame(), cam2odom_));
-                // pathTimings.at(i) = std::get<1>(traj);
+                dynamic_gap::Trajectory traj;
+                generateGapTraj(gaps.at(i), traj, pathPoseCosts.at(i), pathTerminalPoseCosts.at(i), futureEgoCircle);
                 generatedTrajs.push_back(traj);
             }
 
             // push back idling trajectory as another option
             std::vector<float> idlingPoseCosts;
-            float idlingTerminalPoseCost, idlingCost;
-
+            float idlingTerminalPoseCost;
             dynamic_gap::Trajectory idlingTrajectory;
-            idlingTrajectory = gapTrajGenerator_->generateIdlingTrajectory(rbtPoseInOdomFrame_);
-            
-            idlingTrajectory = gapTrajGenerator_->processTrajectory(idlingTrajectory, false);
-            trajEvaluator_->evaluateTrajectory(idlingTrajectory, idlingPoseCosts, idlingTerminalPoseCost, futureScans);
-            idlingCost = idlingTerminalPoseCost + std::accumulate(idlingPoseCosts.begin(), idlingPoseCosts.end(), float(0));
-            ROS_INFO_STREAM_NAMED("GapTrajectoryGenerator", "        idlingCost: " << idlingCost);
+            generateIdlingTraj(idlingTrajectory, idlingPoseCosts, idlingTerminalPoseCost, futureEgoCircle);
 
             pathPoseCosts.push_back(idlingPoseCosts);
             pathTerminalPoseCosts.push_back(idlingTerminalPoseCost);
-
-            idlingTrajectory.setPathOdomFrame(gapTrajGenerator_->transformPath(idlingTrajectory.getPathRbtFrame(), cam2odom_));
             generatedTrajs.push_back(idlingTrajectory);            
 
         } catch (...) 
@@ -890,12 +927,346 @@ void Planner::jointPoseAccCB(const nav_msgs::Odometry::ConstPtr & rbtOdomMsg,
         return;
     }
 
+    void Planner::generateGapTraj(dynamic_gap::Gap * gap,
+                                    dynamic_gap::Trajectory & traj,
+                                    std::vector<float> & poseCosts,
+                                    float & terminalPoseCost,
+                                    const dynamic_gap::FutureEgoCircle & futureEgoCircle)
+    {
+        // std::cout << "goal of: " << vec.at(i).goal.x << ", " << vec.at(i).goal.y << std::endl;
+        
+        // Run go to goal behavior
+        bool runGoToGoal = (gap->globalGoalWithin); // (vec.at(i).goal.goalwithin || vec.at(i).artificial);
+
+        dynamic_gap::Trajectory goToGoalTraj, pursuitGuidanceTraj;
+        std::vector<float> goToGoalPoseCosts, pursuitGuidancePoseCosts;
+        float goToGoalTerminalPoseCost, pursuitGuidanceTerminalPoseCost;
+        float goToGoalCost, pursuitGuidancePoseCost;
+
+        if (runGoToGoal) 
+        {
+            ROS_INFO_STREAM_NAMED("GapTrajectoryGenerator", "        running goToGoal");
+
+            goToGoalTraj = gapTrajGenerator_->generateTrajectory(gap, rbtPoseInSensorFrame_, 
+                                                                currentRbtVel_, 
+                                                                globalGoalRobotFrame_,
+                                                                true);
+            goToGoalTraj = gapTrajGenerator_->processTrajectory(goToGoalTraj, true);
+            trajEvaluator_->evaluateTrajectory(goToGoalTraj, goToGoalPoseCosts, goToGoalTerminalPoseCost, futureEgoCircle);
+            goToGoalCost = goToGoalTerminalPoseCost + std::accumulate(goToGoalPoseCosts.begin(), goToGoalPoseCosts.end(), float(0));
+            ROS_INFO_STREAM_NAMED("GapTrajectoryGenerator", "        goToGoalCost: " << goToGoalCost);
+        }
+
+        // Run pursuit guidance behavior
+        ROS_INFO_STREAM_NAMED("GapTrajectoryGenerator", "        running pursuit guidance");
+        pursuitGuidanceTraj = gapTrajGenerator_->generateTrajectory(gap, rbtPoseInSensorFrame_, 
+                                                                    currentRbtVel_, 
+                                                                    globalGoalRobotFrame_,
+                                                                    false);
+
+        pursuitGuidanceTraj = gapTrajGenerator_->processTrajectory(pursuitGuidanceTraj, true);
+        trajEvaluator_->evaluateTrajectory(pursuitGuidanceTraj, pursuitGuidancePoseCosts, pursuitGuidanceTerminalPoseCost, futureEgoCircle);
+        pursuitGuidancePoseCost = pursuitGuidanceTerminalPoseCost + std::accumulate(pursuitGuidancePoseCosts.begin(), pursuitGuidancePoseCosts.end(), float(0));
+        ROS_INFO_STREAM_NAMED("GapTrajectoryGenerator", "        pursuitGuidancePoseCost: " << pursuitGuidancePoseCost);
+
+        if (runGoToGoal && goToGoalCost < pursuitGuidancePoseCost)
+        {
+            traj = goToGoalTraj;
+            poseCosts = goToGoalPoseCosts;
+            terminalPoseCost = goToGoalTerminalPoseCost;
+        } else
+        {
+            traj = pursuitGuidanceTraj;
+            poseCosts = pursuitGuidancePoseCosts;
+            terminalPoseCost = pursuitGuidanceTerminalPoseCost;
+        }
+
+        // TRAJECTORY TRANSFORMED BACK TO ODOM FRAME
+        traj.setPathOdomFrame(gapTrajGenerator_->transformPath(traj.getPathRbtFrame(), cam2odom_));
+    }
+
+    void Planner::generateIdlingTraj(dynamic_gap::Trajectory & traj,
+                                        std::vector<float> & poseCosts,
+                                        float & terminalPoseCost,
+                                        const dynamic_gap::FutureEgoCircle & futureEgoCircle)
+    {
+        traj = gapTrajGenerator_->generateIdlingTrajectory(rbtPoseInOdomFrame_);
+        
+        traj = gapTrajGenerator_->processTrajectory(traj, false);
+        trajEvaluator_->evaluateTrajectory(traj, poseCosts, terminalPoseCost, futureEgoCircle);
+        float idlingCost = terminalPoseCost + std::accumulate(poseCosts.begin(), poseCosts.end(), float(0));
+        ROS_INFO_STREAM_NAMED("GapTrajectoryGenerator", "        idlingCost: " << idlingCost);
+
+        traj.setPathOdomFrame(gapTrajGenerator_->transformPath(traj.getPathRbtFrame(), cam2odom_));
+    }
+
+    void Planner::runGapPipelines(const std::vector<dynamic_gap::Gap *> & planningGaps,
+                                    const std::vector<dynamic_gap::Gap *> & unmanipulatedGaps,
+                                    std::vector<dynamic_gap::Gap *> & manipulatedGaps,
+                                    std::vector<dynamic_gap::Gap *> & feasibleGaps,
+                                    bool & isCurrentGapFeasible,
+                                    std::vector<dynamic_gap::Trajectory> & generatedTrajs,
+                                    std::vector<std::vector<float>> & pathPoseCosts,
+                                    std::vector<float> & pathTerminalPoseCosts,
+                                    const dynamic_gap::FutureEgoCircle & futureEgoCircle)
+    {
+        ROS_INFO_STREAM_NAMED("Planner", "[runGapPipelines()]");
+
+        int gapCount = planningGaps.size();
+        bool boundGapCosts = cfg_.planning.gap_cost_bounding;
+        geometry_msgs::PoseStamped globalPathLocalWaypointRobotFrame = globalPlanManager_->getGlobalPathLocalWaypointRobotFrame();
+
+        // last slot holds idling trajectory
+        std::vector<GapPipelineSlot> slots(gapCount + 1);
+
+        // one task per chunk, so idle threads keep claiming whichever gaps are left
+        planningPool_->parallelFor(gapCount + 1, 1, [&](const int & begin, const int & end)
+        {
+            for (int i = begin; i < end; i++)
+            {
+                GapPipelineSlot & slot = slots.at(i);
+
+                if (i == gapCount)
+                {
+                    try
+                    {
+                        generateIdlingTraj(slot.traj, slot.poseCosts, slot.terminalPoseCost, futureEgoCircle);
+                        slot.generated = true;
+                    } catch (...)
+                    {
+                        ROS_WARN_STREAM_NAMED("GapTrajectoryGenerator", "   idling trajectory generation failed");
+                    }
+                    continue;
+                }
+
+                dynamic_gap::Gap * gap = planningGaps.at(i);
+
+                try
+                {
+                    ROS_INFO_STREAM_NAMED("Planner", "    running pipeline for gap " << i);
+
+                    // propagate gap forward in time to determine lifespan
+                    gapFeasibilityChecker_->propagateGapPoints(gap);
+
+                    // MANIPULATE POINTS AT T=0
+                    gapManipulator_->convertRadialGap(gap);
+
+                    if (gapManipulator_->inflateGapSides(gap))
+                    {
+                        gapManipulator_->setGapGoal(gap, 
+                                                    globalPathLocalWaypointRobotFrame,
+                                                    globalGoalRobotFrame_);
+                        slot.manipulated = true;
+                    }
+
+                    // without feasibility checking, every simplified gap is planned through as is
+                    if (cfg_.planning.gap_feasibility_check)
+                    {
+                        if (!slot.manipulated || !gapFeasibilityChecker_->pursuitGuidanceAnalysis(gap))
+                            continue;
+
+                        slot.trajGap = gap;
+                    } else
+                    {
+                        slot.trajGap = unmanipulatedGaps.at(i);
+                    }
+                    slot.feasible = true;
+
+                    // with cost bounding, trajectories are only generated once every gap has a bound
+                    if (boundGapCosts)
+                        continue;
+
+                    generateGapTraj(slot.trajGap, slot.traj, slot.poseCosts, slot.terminalPoseCost, futureEgoCircle);
+                    slot.generated = true;
+                } catch (...)
+                {
+                    ROS_WARN_STREAM_NAMED("Planner", "   pipeline failed for gap " << i);
+                }
+            }
+        });
+
+        // gather slots in gap order
+        int currentLeftGapPtModelID = getCurrentLeftGapPtModelID();
+        int currentRightGapPtModelID = getCurrentRightGapPtModelID();
+
+        isCurrentGapFeasible = false;
+
+        for (int i = 0; i < gapCount; i++)
+        {
+            GapPipelineSlot & slot = slots.at(i);
+
+            if (slot.manipulated)
+                manipulatedGaps.push_back(planningGaps.at(i)); // shallow copy
+
+            if (slot.feasible && cfg_.planning.gap_feasibility_check &&
+                slot.trajGap->leftGapPtModel_->getID() == currentLeftGapPtModelID && 
+                slot.trajGap->rightGapPtModel_->getID() == currentRightGapPtModelID) 
+            {
+                isCurrentGapFeasible = true;
+            }
+        }
+
+        gatherGapTrajs(slots, feasibleGaps, generatedTrajs, pathPoseCosts, pathTerminalPoseCosts, futureEgoCircle);
+
+        trajVisualizer_->drawGapTrajectoryPoseScores(generatedTrajs, pathPoseCosts);
+        trajVisualizer_->drawGapTrajectories(generatedTrajs);
+    }
+
+    void Planner::gatherGapTrajs(std::vector<GapPipelineSlot> & slots,
+                                    std::vector<dynamic_gap::Gap *> & trajGaps,
+                                    std::vector<dynamic_gap::Trajectory> & generatedTrajs,
+                                    std::vector<std::vector<float>> & pathPoseCosts,
+                                    std::vector<float> & pathTerminalPoseCosts,
+                                    const dynamic_gap::FutureEgoCircle & futureEgoCircle)
+    {
+        int gapCount = slots.size() - 1;
+
+        if (cfg_.planning.gap_cost_bounding)
+        {
+            GapPipelineSlot & idlingSlot = slots.back();
+            float idlingCost = idlingSlot.generated ? 
+                                idlingSlot.terminalPoseCost + std::accumulate(idlingSlot.poseCosts.begin(), idlingSlot.poseCosts.end(), float(0)) :
+                                std::numeric_limits<float>::infinity();
+
+            generateBoundedGapTrajs(slots, idlingCost, futureEgoCircle);
+        }
+
+        for (int i = 0; i < gapCount + 1; i++)
+        {
+            GapPipelineSlot & slot = slots.at(i);
+
+            if (!slot.generated)
+                continue;
+
+            if (i < gapCount)
+                trajGaps.push_back(slot.trajGap); // shallow copy
+
+            generatedTrajs.push_back(slot.traj);
+            pathPoseCosts.push_back(slot.poseCosts);
+            pathTerminalPoseCosts.push_back(slot.terminalPoseCost);
+        }
+    }
+
+    float Planner::gapTrajectoryReach(dynamic_gap::Gap * gap)
+    {
+        float startDist = std::sqrt(pow(rbtPoseInSensorFrame_.pose.position.x, 2) + pow(rbtPoseInSensorFrame_.pose.position.y, 2));
+
+        // pursuit guidance moves at maximum speed until gap closes or horizon ends, integration may take one extra step
+        float pursuitTime = std::max(0.0f, std::min(gap->gapLifespan_, cfg_.traj.integrate_maxt)) + cfg_.traj.integrate_stept;
+        float reach = startDist + cfg_.rbt.vx_absmax * pursuitTime;
+
+        if (gap->globalGoalWithin)
+        {
+            // go to goal covers a fraction of remaining distance to goal per step, which only overshoots goal for steps over a second
+            if (cfg_.traj.integrate_stept > 1.0)
+                return std::numeric_limits<float>::infinity();
+
+            float goalDist = std::sqrt(pow(globalGoalRobotFrame_.pose.position.x, 2) + pow(globalGoalRobotFrame_.pose.position.y, 2));
+            reach = std::max(reach, std::max(startDist, goalDist));
+        }
+
+        // slack for rounding during integration
+        return reach + 1e-3;
+    }
+
+    int Planner::generateBoundedGapTrajs(std::vector<GapPipelineSlot> & slots,
+                                            const float & incumbentCost,
+                                            const dynamic_gap::FutureEgoCircle & futureEgoCircle)
+    {
+        std::vector<int> candidateSlotIdxs;
+        std::vector<float> reaches;
+        for (int i = 0; i < slots.size(); i++)
+        {
+            if (!slots.at(i).feasible || slots.at(i).generated)
+                continue;
+
+            candidateSlotIdxs.push_back(i);
+            reaches.push_back(gapTrajectoryReach(slots.at(i).trajGap));
+        }
+
+        std::vector<float> lowerBounds = trajEvaluator_->trajectoryCostLowerBounds(reaches, futureEgoCircle);
+
+        // most promising gaps first, ties kept in gap order
+        std::vector<int> candidateOrder(candidateSlotIdxs.size());
+        std::iota(candidateOrder.begin(), candidateOrder.end(), 0);
+        std::stable_sort(candidateOrder.begin(), candidateOrder.end(), [&](const int & a, const int & b)
+        {
+            return lowerBounds.at(a) < lowerBounds.at(b);
+        });
+
+        std::atomic<float> lowestCost(incumbentCost);
+        std::atomic<int> prunedCount(0);
+
+        // chunks are claimed in order, so gaps are started in order of their bounds
+        planningPool_->parallelFor(candidateOrder.size(), 1, [&](const int & begin, const int & end)
+        {
+            for (int k = begin; k < end; k++)
+            {
+                int candidateIdx = candidateOrder.at(k);
+                GapPipelineSlot & slot = slots.at(candidateSlotIdxs.at(candidateIdx));
+
+                // trajectory through gap costs at least its bound, so it can never be picked over a cheaper one
+                if (lowerBounds.at(candidateIdx) > lowestCost.load())
+                {
+                    ROS_INFO_STREAM_NAMED("GapTrajectoryGenerator", "    pruning gap with cost bound " << lowerBounds.at(candidateIdx));
+                    slot.pruned = true;
+                    prunedCount++;
+                    continue;
+                }
+
+                try
+                {
+                    generateGapTraj(slot.trajGap, slot.traj, slot.poseCosts, slot.terminalPoseCost, futureEgoCircle);
+                    slot.generated = true;
+
+                    float cost = slot.terminalPoseCost + std::accumulate(slot.poseCosts.begin(), slot.poseCosts.end(), float(0));
+                    float currentLowestCost = lowestCost.load();
+                    while (cost < currentLowestCost && !lowestCost.compare_exchange_weak(currentLowestCost, cost)) {}
+                } catch (...)
+                {
+                    ROS_WARN_STREAM_NAMED("GapTrajectoryGenerator", "   trajectory generation failed for gap with cost bound " << lowerBounds.at(candidateIdx));
+                }
+            }
+        });
+
+        totalBoundedGaps += candidateOrder.size();
+        totalPrunedGaps += prunedCount;
+        ROS_INFO_STREAM_NAMED("GapTrajectoryGenerator", "    pruned " << prunedCount << " of " << candidateOrder.size() << " gaps by cost bound (" << 
+                                                        totalPrunedGaps << " of " << totalBoundedGaps << " overall)");
+
+        return prunedCount;
+    }
+
+    std::shared_ptr<const dynamic_gap::FutureEgoCircle> Planner::propagateFutureEgoCircle(const std::vector<dynamic_gap::Gap *> & rawGaps)
+    {
+        std::shared_ptr<const dynamic_gap::FutureEgoCircle> futureEgoCircle;
+
+        if (cfg_.planning.future_scan_propagation)
+        {
+            if (cfg_.planning.egocircle_prop_cheat)
+            {
+                std::shared_ptr<const dynamic_gap::AgentTable> agentTable = std::atomic_load(&agentTable_);
+                futureEgoCircle = dynamicScanPropagator_->propagateCurrentLaserScanCheat(*agentTable);
+            } else
+                futureEgoCircle = dynamicScanPropagator_->propagateCurrentLaserScan(rawGaps);        
+
+            futureEgoCircle->buildSlices(planningPool_);
+        } else 
+        {
+            // every ray is static, so every slice is the current scan
+            futureEgoCircle = std::make_shared<dynamic_gap::FutureEgoCircle>(scan_, 
+                                                                             int(cfg_.traj.integrate_maxt/cfg_.traj.integrate_stept) + 1,
+                                                                             cfg_.traj.integrate_stept,
+                                                                             cfg_.scan.range_max);
+        }
+
+        return futureEgoCircle;
+    }
+
     int Planner::pickTraj(const std::vector<dynamic_gap::Trajectory> & trajs, 
                           const std::vector<std::vector<float>> & pathPoseCosts, 
                           const std::vector<float> & pathTerminalPoseCosts) 
     {
-        boost::mutex::scoped_lock gapset(gapMutex_);
-
         ROS_INFO_STREAM_NAMED("GapTrajectoryGenerator", "[pickTraj()]");
         
         int lowestCostTrajIdx = -1;        
@@ -1004,10 +1375,9 @@ void Planner::jointPoseAccCB(const nav_msgs::Odometry::ConstPtr & rbtOdomMsg,
                                                             const int & lowestCostTrajIdx,
                                                             const int & trajFlag,
                                                             const bool & isIncomingGapFeasible,
-                                                            const std::vector<sensor_msgs::LaserScan> & futureScans) // bool isIncomingGapAssociated,
+                                                            const dynamic_gap::FutureEgoCircle & futureEgoCircle) // bool isIncomingGapAssociated,
     {
         ROS_INFO_STREAM_NAMED("GapTrajectoryGenerator", "[compareToCurrentTraj()]");
-        boost::mutex::scoped_lock gapset(gapMutex_);
         
         dynamic_gap::Gap * incomingGap = (trajFlag == 0 ? feasibleGaps.at(lowestCostTrajIdx) : nullptr);
         dynamic_gap::Trajectory incomingTraj = trajs.at(lowestCostTrajIdx);
@@ -1032,7 +1402,7 @@ void Planner::jointPoseAccCB(const nav_msgs::Odometry::ConstPtr & rbtOdomMsg,
             ROS_INFO_STREAM_NAMED("GapTrajectoryGenerator", "    evaluating incoming trajectory");
             std::vector<float> incomingPathPoseCosts;
             float incomingPathTerminalPoseCost;
-            trajEvaluator_->evaluateTrajectory(incomingTraj, incomingPathPoseCosts, incomingPathTerminalPoseCost, futureScans);
+            trajEvaluator_->evaluateTrajectory(incomingTraj, incomingPathPoseCosts, incomingPathTerminalPoseCost, futureEgoCircle);
 
             float incomingPathCost = incomingPathTerminalPoseCost + std::accumulate(incomingPathPoseCosts.begin(), incomingPathPoseCosts.end(), float(0));
             ROS_INFO_STREAM_NAMED("GapTrajectoryGenerator", "    incoming trajectory received a cost of: " << incomingPathCost);
@@ -1112,7 +1482,7 @@ void Planner::jointPoseAccCB(const nav_msgs::Odometry::ConstPtr & rbtOdomMsg,
             dynamic_gap::Trajectory reducedCurrentTraj(reducedCurrentPathRobotFrame, reducedCurrentPathTiming);
             std::vector<float> currentPathPoseCosts;
             float currentPathTerminalPoseCost;
-            trajEvaluator_->evaluateTrajectory(reducedCurrentTraj, currentPathPoseCosts, currentPathTerminalPoseCost, futureScans);
+            trajEvaluator_->evaluateTrajectory(reducedCurrentTraj, currentPathPoseCosts, currentPathTerminalPoseCost, futureEgoCircle);
             float currentPathSubCost = currentPathTerminalPoseCost + std::accumulate(currentPathPoseCosts.begin(), currentPathPoseCosts.begin() + poseCheckCount, float(0));
             ROS_INFO_STREAM_NAMED("GapTrajectoryGenerator", "    current trajectory received a subcost of: " << currentPathSubCost);
 
@@ -1162,13 +1532,255 @@ void Planner::jointPoseAccCB(const nav_msgs::Odometry::ConstPtr & rbtOdomMsg,
         return std::min(minPoseNormIdx, int(currTrajRbtFrame.poses.size() - 1));
     }
 
-    std::vector<dynamic_gap::Gap *> Planner::deepCopyCurrentRawGaps()
+    void Planner::writeCheckpoint(const std::string & path)
     {
-        boost::mutex::scoped_lock gapset(gapMutex_);
+        try
+        {
+            // written under temporary name so that replays never pick up a partially written checkpoint
+            std::string tmpPath = path + ".tmp";
+            dynamic_gap::CheckpointWriter writer(tmpPath);
+
+            writer.write(tPreviousModelUpdate_);
+            writer.write(currentModelIdx_);
+
+            // gap point estimators, written once even when shared between raw and simplified gaps
+            std::vector<dynamic_gap::Estimator *> models;
+            std::unordered_map<dynamic_gap::Estimator *, int> modelIdxs;
+            modelIdxs[NULL] = -1;
+            for (const std::vector<dynamic_gap::Gap *> * gaps : {&prevRawGaps_, &prevSimplifiedGaps_})
+            {
+                for (dynamic_gap::Gap * gap : *gaps)
+                {
+                    if (modelIdxs.emplace(gap->leftGapPtModel_, models.size()).second)
+                        models.push_back(gap->leftGapPtModel_);
+                    if (modelIdxs.emplace(gap->rightGapPtModel_, models.size()).second)
+                        models.push_back(gap->rightGapPtModel_);
+                }
+            }
+
+            writer.write(static_cast<uint32_t>(models.size()));
+            for (dynamic_gap::Estimator * model : models)
+                model->writeCheckpoint(writer);
+
+            // gaps, along with which estimators they point at and own
+            for (const std::vector<dynamic_gap::Gap *> * gaps : {&prevRawGaps_, &prevSimplifiedGaps_})
+            {
+                writer.write(static_cast<uint32_t>(gaps->size()));
+                for (dynamic_gap::Gap * gap : *gaps)
+                {
+                    gap->writeCheckpoint(writer);
+                    writer.write(modelIdxs[gap->leftGapPtModel_]);
+                    writer.write(modelIdxs[gap->rightGapPtModel_]);
+                    writer.write(gap->ownsModels());
+                }
+            }
+
+            // ego-robot motion history
+            std::vector<dynamic_gap::EgoMotionSample> egoMotionSamples;
+            egoMotionBuffer_->copySamples(egoMotionSamples);
+            writer.write(static_cast<uint32_t>(egoMotionSamples.size()));
+            for (const dynamic_gap::EgoMotionSample & sample : egoMotionSamples)
+            {
+                writer.write(sample.velStamp);
+                writer.write(sample.vx);
+                writer.write(sample.vy);
+                writer.write(sample.omega);
+                writer.write(sample.accStamp);
+                writer.write(sample.ax);
+                writer.write(sample.ay);
+            }
+
+            // trajectory that robot is currently tracking
+            std::shared_ptr<const dynamic_gap::Trajectory> traj = std::atomic_load(&checkpointTraj_);
+            writer.writeMessage(traj->getPathRbtFrame());
+            writer.writeMessage(traj->getPathOdomFrame());
+            writer.write(traj->getPathTiming());
+
+            writer.close();
+
+            if (std::rename(tmpPath.c_str(), path.c_str()) != 0)
+                throw std::runtime_error("could not move checkpoint into place");
+
+            ROS_INFO_STREAM_NAMED("Planner", "wrote checkpoint " << path << " (" << prevRawGaps_.size() << " raw gaps, " 
+                                                                   << models.size() << " models)");
+        } catch (const std::exception & e)
+        {
+            ROS_WARN_STREAM_NAMED("Planner", "writeCheckpoint to " << path << " failed: " << e.what());
+        }
+    }
+
+    void Planner::readCheckpoint(const std::string & path)
+    {
+        std::vector<dynamic_gap::Estimator *> models;
+        std::vector<bool> modelsOwned;
+        std::vector<dynamic_gap::Gap *> rawGaps, simplifiedGaps;
+
+        try
+        {
+            dynamic_gap::CheckpointReader reader(path);
+
+            ros::Time tPreviousModelUpdate;
+            int currentModelIdx = 0;
+            reader.read(tPreviousModelUpdate);
+            reader.read(currentModelIdx);
+
+            // gap point estimators
+            models.resize(reader.readCount(), NULL);
+            modelsOwned.resize(models.size(), false);
+            for (dynamic_gap::Estimator * & model : models)
+            {
+                model = new dynamic_gap::RotatingFrameCartesianKalmanFilter();
+                model->readCheckpoint(reader);
+            }
 
+            // gaps, first gap to own an estimator takes it over
+            for (std::vector<dynamic_gap::Gap *> * gaps : {&rawGaps, &simplifiedGaps})
+            {
+                uint32_t gapCount = reader.readCount();
+                for (uint32_t i = 0; i < gapCount; i++)
+                {
+                    dynamic_gap::Gap * gap = new dynamic_gap::Gap(cfg_.sensor_frame_id, 0, 0.0, false, 0.0);
+                    gaps->push_back(gap);
+                    gap->readCheckpoint(reader);
+
+                    int leftModelIdx = -1, rightModelIdx = -1;
+                    bool ownsModels = false;
+                    reader.read(leftModelIdx);
+                    reader.read(rightModelIdx);
+                    reader.read(ownsModels);
+
+                    if (leftModelIdx < -1 || leftModelIdx >= (int) models.size() || 
+                        rightModelIdx < -1 || rightModelIdx >= (int) models.size())
+                        throw std::runtime_error("checkpoint gap points at missing model");
+
+                    dynamic_gap::Estimator * leftModel = (leftModelIdx >= 0) ? models[leftModelIdx] : NULL;
+                    dynamic_gap::Estimator * rightModel = (rightModelIdx >= 0) ? models[rightModelIdx] : NULL;
+
+                    if (ownsModels && leftModel && rightModel && leftModel != rightModel &&
+                        !modelsOwned[leftModelIdx] && !modelsOwned[rightModelIdx])
+                    {
+                        gap->adoptModels(leftModel, rightModel);
+                        modelsOwned[leftModelIdx] = true;
+                        modelsOwned[rightModelIdx] = true;
+                    } else
+                    {
+                        gap->shareModels(leftModel, rightModel);
+                    }
+                }
+            }
+
+            // a gap sharing an estimator that no gap owns would be left pointing at a deleted estimator
+            for (const std::vector<dynamic_gap::Gap *> * gaps : {&rawGaps, &simplifiedGaps})
+            {
+                for (dynamic_gap::Gap * gap : *gaps)
+                {
+                    for (dynamic_gap::Estimator * model : {gap->leftGapPtModel_, gap->rightGapPtModel_})
+                    {
+                        if (model && !modelsOwned[std::find(models.begin(), models.end(), model) - models.begin()])
+                            throw std::runtime_error("checkpoint gap shares model that no gap owns");
+                    }
+                }
+            }
+
+            // ego-robot motion history
+            std::vector<dynamic_gap::EgoMotionSample> egoMotionSamples(reader.readCount());
+            for (dynamic_gap::EgoMotionSample & sample : egoMotionSamples)
+            {
+                reader.read(sample.velStamp);
+                reader.read(sample.vx);
+                reader.read(sample.vy);
+                reader.read(sample.omega);
+                reader.read(sample.accStamp);
+                reader.read(sample.ax);
+                reader.read(sample.ay);
+            }
+
+            // trajectory that robot was tracking
+            geometry_msgs::PoseArray pathRbtFrame, pathOdomFrame;
+            std::vector<float> pathTiming;
+            reader.readMessage(pathRbtFrame);
+            reader.readMessage(pathOdomFrame);
+            reader.read(pathTiming);
+
+            // checkpoint read in full, hand state over to planner
+            tPreviousModelUpdate_ = tPreviousModelUpdate;
+            currentModelIdx_ = currentModelIdx;
+
+            // restored gaps are only previous gaps, current gaps are detected from next scan
+            prevGapSet_ = std::make_shared<const dynamic_gap::GapSetSnapshot>(boost::shared_ptr<sensor_msgs::LaserScan const>(), perceptionCfg_.scan,
+                                                                              std::move(rawGaps), std::move(simplifiedGaps), 
+                                                                              false, false, geometry_msgs::TwistStamped(), geometry_msgs::TwistStamped());
+            prevRawGaps_ = prevGapSet_->rawGaps();
+            prevSimplifiedGaps_ = prevGapSet_->simplifiedGaps();
+
+            for (const dynamic_gap::EgoMotionSample & sample : egoMotionSamples)
+                egoMotionBuffer_->push(sample);
+
+            dynamic_gap::Trajectory traj(pathRbtFrame, pathTiming);
+            traj.setPathOdomFrame(pathOdomFrame);
+            setCurrentTraj(traj);
+
+            ROS_INFO_STREAM_NAMED("Planner", "restored checkpoint " << path << " (" << prevRawGaps_.size() << " raw gaps, " 
+                                                                     << models.size() << " models)");
+        } catch (const std::exception & e)
+        {
+            ROS_WARN_STREAM_NAMED("Planner", "readCheckpoint from " << path << " failed, starting fresh: " << e.what());
+
+            for (dynamic_gap::Gap * gap : rawGaps)
+                delete gap;
+            for (dynamic_gap::Gap * gap : simplifiedGaps)
+                delete gap;
+            rawGaps.clear();
+            simplifiedGaps.clear();
+        }
+
+        // estimators not taken over by any gap
+        for (int i = 0; i < modelsOwned.size(); i++)
+        {
+            if (!modelsOwned[i])
+                delete models[i];
+        }
+    }
+
+    void Planner::predictGapModels(const std::vector<dynamic_gap::Gap *> & copiedRawGaps,
+                                   const std::vector<dynamic_gap::Gap *> & planningGaps,
+                                   const ros::Time & tPlanning)
+    {
+        try
+        {
+            ros::Time tScan = planningGapSet_->scan()->header.stamp;
+            if (tPlanning <= tScan)
+                return;
+
+            std::vector<geometry_msgs::TwistStamped> rbtVelsSinceScan, rbtAccsSinceScan;
+            egoMotionBuffer_->copySince(tScan, rbtVelsSinceScan, rbtAccsSinceScan);
+
+            predictionTimeline_.build(rbtVelsSinceScan, rbtAccsSinceScan,
+                                      tScan, planningGapSet_->rbtVel(), planningGapSet_->rbtAcc(),
+                                      tPlanning, dynamic_gap::RotatingFrameCartesianKalmanFilter::initialQ());
+
+            if (!predictionTimeline_.valid())
+                return;
+
+            for (const std::vector<dynamic_gap::Gap *> * gaps : {&copiedRawGaps, &planningGaps})
+            {
+                for (dynamic_gap::Gap * gap : *gaps)
+                {
+                    gap->leftGapPtModel_->predict(predictionTimeline_, tPlanning);
+                    gap->rightGapPtModel_->predict(predictionTimeline_, tPlanning);
+                }
+            }
+        } catch (...)
+        {
+            ROS_WARN_STREAM_NAMED("GapEstimation", "predictGapModels failed");
+        }
+    }
+
+    std::vector<dynamic_gap::Gap *> Planner::deepCopyCurrentRawGaps()
+    {
         std::vector<dynamic_gap::Gap *> copiedRawGaps;
 
-        for (dynamic_gap::Gap * currRawGap : currRawGaps_)
+        for (dynamic_gap::Gap * currRawGap : planningGapSet_->rawGaps())
             copiedRawGaps.push_back(new dynamic_gap::Gap(*currRawGap));
 
         return copiedRawGaps;
@@ -1176,11 +1788,9 @@ void Planner::jointPoseAccCB(const nav_msgs::Odometry::ConstPtr & rbtOdomMsg,
 
     std::vector<dynamic_gap::Gap *> Planner::deepCopyCurrentSimplifiedGaps()
     {
-        boost::mutex::scoped_lock gapset(gapMutex_);
-
         std::vector<dynamic_gap::Gap *> planningGaps;
 
-        for (dynamic_gap::Gap * currSimplifiedGap : currSimplifiedGaps_)
+        for (dynamic_gap::Gap * currSimplifiedGap : planningGapSet_->simplifiedGaps())
             planningGaps.push_back(new dynamic_gap::Gap(*currSimplifiedGap));
 
         return planningGaps;
@@ -1190,6 +1800,13 @@ void Planner::jointPoseAccCB(const nav_msgs::Odometry::ConstPtr & rbtOdomMsg,
     {
         ROS_INFO_STREAM_NAMED("Planner", "[runPlanningLoop()]: count " << planningLoopCalls);
 
+        // pick up latest gap set published by perception thread, comparing by owner since adopted gap set may be gone
+        {
+            std::shared_ptr<const dynamic_gap::GapSetSnapshot> gapSet = std::atomic_load(&gapSetSnapshot_);
+            if (gapSet && (adoptedGapSet_.owner_before(gapSet) || gapSet.owner_before(adoptedGapSet_)))
+                adoptGapSet(gapSet);
+        }
+
         if (!readyToPlan || colliding)
         {
             chosenTraj = dynamic_gap::Trajectory();
@@ -1203,118 +1820,140 @@ void Planner::jointPoseAccCB(const nav_msgs::Odometry::ConstPtr & rbtOdomMsg,
         std::vector<dynamic_gap::Gap *> copiedRawGaps = deepCopyCurrentRawGaps();
         std::vector<dynamic_gap::Gap *> planningGaps = deepCopyCurrentSimplifiedGaps();
 
+        // without feasibility checking, trajectories go through gaps as they were simplified. Gap set 
+        // is reused by later planning loops until a new one is published, so those gaps are copied as well
+        std::vector<dynamic_gap::Gap *> unmanipulatedGaps;
+        if (!cfg_.planning.gap_feasibility_check)
+            unmanipulatedGaps = deepCopyCurrentSimplifiedGaps();
+
+        // gap set is as old as its scan, so bring gap point models up to now
+        if (cfg_.gap_est.planning_time_prediction)
+            predictGapModels(copiedRawGaps, planningGaps, ros::Time::now());
+
         std::chrono::steady_clock::time_point planningLoopStartTime = std::chrono::steady_clock::now();
 
-        ///////////////////////////
-        // GAP POINT PROPAGATION //
-        ///////////////////////////
         int gapCount = planningGaps.size();
 
-        std::chrono::steady_clock::time_point gapPropagateStartTime = std::chrono::steady_clock::now();
-        propagateGapPoints(planningGaps);
-        float gapPropagateTimeTaken = timeTaken(gapPropagateStartTime);
-        float avgGapPropagationTimeTaken = computeAverageTimeTaken(gapPropagateTimeTaken, GAP_PROP);
-        ROS_INFO_STREAM_NAMED("Timing", "       [Gap Propagation for " << gapCount << " gaps took " << gapPropagateTimeTaken << " seconds]");
-        ROS_INFO_STREAM_NAMED("Timing", "       [Gap Propagation average time: " << avgGapPropagationTimeTaken << " seconds (" << (1.0 / avgGapPropagationTimeTaken) << " Hz) ]");
-
-        //////////////////////
-        // GAP MANIPULATION //
-        //////////////////////
-        std::chrono::steady_clock::time_point manipulateGapsStartTime = std::chrono::steady_clock::now();
-        std::vector<dynamic_gap::Gap *> manipulatedGaps = manipulateGaps(planningGaps);
-        float gapManipulationTimeTaken = timeTaken(manipulateGapsStartTime);
-        float avgGapManipulationTimeTaken = computeAverageTimeTaken(gapManipulationTimeTaken, GAP_MANIP);
-        ROS_INFO_STREAM_NAMED("Timing", "       [Gap Manipulation for " << gapCount << " gaps took " << gapManipulationTimeTaken << " seconds]");
-        ROS_INFO_STREAM_NAMED("Timing", "       [Gap Manipulation average time: " << avgGapManipulationTimeTaken << " seconds (" << (1.0 / avgGapManipulationTimeTaken) << " Hz) ]");
-
-        ///////////////////////////
-        // GAP FEASIBILITY CHECK //
-        ///////////////////////////
+        /////////////////////////////
+        // FUTURE SCAN PROPAGATION //
+        /////////////////////////////
+        // only depends on raw gaps, so every gap's trajectory can be scored as soon as it is generated
+        std::chrono::steady_clock::time_point scanPropagationStartTime = std::chrono::steady_clock::now();
+        std::shared_ptr<const dynamic_gap::FutureEgoCircle> futureEgoCircle = propagateFutureEgoCircle(copiedRawGaps);
+        float scanPropagationTimeTaken = timeTaken(scanPropagationStartTime);
+        float avgScanPropagationTimeTaken = computeAverageTimeTaken(scanPropagationTimeTaken, SCAN_PROP);
+        ROS_INFO_STREAM_NAMED("Timing", "       [Future Scan Propagation for " << gapCount << " gaps took " << scanPropagationTimeTaken << " seconds]");
+        ROS_INFO_STREAM_NAMED("Timing", "       [Future Scan Propagation average time: " << avgScanPropagationTimeTaken << " seconds (" << (1.0 / avgScanPropagationTimeTaken) << " Hz) ]");
+
         bool isCurrentGapFeasible = false;
+        std::vector<dynamic_gap::Gap *> manipulatedGaps;
         std::vector<dynamic_gap::Gap *> feasibleGaps;
-        std::chrono::steady_clock::time_point feasibilityStartTime = std::chrono::steady_clock::now();
-        if (cfg_.planning.gap_feasibility_check)
+        std::vector<dynamic_gap::Trajectory> trajs;
+        std::vector<std::vector<float>> pathPoseCosts; 
+        std::vector<float> pathTerminalPoseCosts; 
+
+        if (cfg_.planning.per_gap_pipeline)
         {
-            feasibleGaps = gapSetFeasibilityCheck(manipulatedGaps, isCurrentGapFeasible);
+            ///////////////////////
+            // PER-GAP PIPELINES //
+            ///////////////////////
+            std::chrono::steady_clock::time_point gapPipelineStartTime = std::chrono::steady_clock::now();
+            runGapPipelines(planningGaps, unmanipulatedGaps, manipulatedGaps, feasibleGaps, isCurrentGapFeasible, 
+                            trajs, pathPoseCosts, pathTerminalPoseCosts, *futureEgoCircle);
+            float gapPipelineTimeTaken = timeTaken(gapPipelineStartTime);
+            float avgGapPipelineTimeTaken = computeAverageTimeTaken(gapPipelineTimeTaken, GAP_PIPE);
+            ROS_INFO_STREAM_NAMED("Timing", "       [Gap Pipelines for " << gapCount << " gaps took " << gapPipelineTimeTaken << " seconds]");
+            ROS_INFO_STREAM_NAMED("Timing", "       [Gap Pipelines average time: " << avgGapPipelineTimeTaken << " seconds (" << (1.0 / avgGapPipelineTimeTaken) << " Hz) ]");
+
+            manipGapVisualizer_->drawManipGaps(manipulatedGaps, std::string("manip"));
+            goalVisualizer_->drawGapGoals(manipulatedGaps);
         } else
         {
-            for (dynamic_gap::Gap * currSimplifiedGap : currSimplifiedGaps_)
-                feasibleGaps.push_back(currSimplifiedGap);
-                // feasibleGaps.push_back(new dynamic_gap::Gap(*currSimplifiedGap));
-            // TODO: need to set feasible to true for all gaps as well
-        }
-        float feasibilityTimeTaken = timeTaken(feasibilityStartTime);
-        float avgFeasibilityTimeTaken = computeAverageTimeTaken(feasibilityTimeTaken, GAP_FEAS);
-        ROS_INFO_STREAM_NAMED("Timing", "       [Gap Feasibility Analysis for " << gapCount << " gaps took " << feasibilityTimeTaken << " seconds]");
-        ROS_INFO_STREAM_NAMED("Timing", "       [Gap Feasibility Analysis average time: " << avgFeasibilityTimeTaken << " seconds (" << (1.0 / avgFeasibilityTimeTaken) << " Hz) ]");
+            ///////////////////////////
+            // GAP POINT PROPAGATION //
+            ///////////////////////////
+            std::chrono::steady_clock::time_point gapPropagateStartTime = std::chrono::steady_clock::now();
+            propagateGapPoints(planningGaps);
+            float gapPropagateTimeTaken = timeTaken(gapPropagateStartTime);
+            float avgGapPropagationTimeTaken = computeAverageTimeTaken(gapPropagateTimeTaken, GAP_PROP);
+            ROS_INFO_STREAM_NAMED("Timing", "       [Gap Propagation for " << gapCount << " gaps took " << gapPropagateTimeTaken << " seconds]");
+            ROS_INFO_STREAM_NAMED("Timing", "       [Gap Propagation average time: " << avgGapPropagationTimeTaken << " seconds (" << (1.0 / avgGapPropagationTimeTaken) << " Hz) ]");
+
+            //////////////////////
+            // GAP MANIPULATION //
+            //////////////////////
+            std::chrono::steady_clock::time_point manipulateGapsStartTime = std::chrono::steady_clock::now();
+            manipulatedGaps = manipulateGaps(planningGaps);
+            float gapManipulationTimeTaken = timeTaken(manipulateGapsStartTime);
+            float avgGapManipulationTimeTaken = computeAverageTimeTaken(gapManipulationTimeTaken, GAP_MANIP);
+            ROS_INFO_STREAM_NAMED("Timing", "       [Gap Manipulation for " << gapCount << " gaps took " << gapManipulationTimeTaken << " seconds]");
+            ROS_INFO_STREAM_NAMED("Timing", "       [Gap Manipulation average time: " << avgGapManipulationTimeTaken << " seconds (" << (1.0 / avgGapManipulationTimeTaken) << " Hz) ]");
+
+            ///////////////////////////
+            // GAP FEASIBILITY CHECK //
+            ///////////////////////////
+            std::chrono::steady_clock::time_point feasibilityStartTime = std::chrono::steady_clock::now();
+            if (cfg_.planning.gap_feasibility_check)
+            {
+                feasibleGaps = gapSetFeasibilityCheck(manipulatedGaps, isCurrentGapFeasible);
+            } else
+            {
+                for (dynamic_gap::Gap * unmanipulatedGap : unmanipulatedGaps)
+                    feasibleGaps.push_back(unmanipulatedGap);
+                    // feasibleGaps.push_back(new dynamic_gap::Gap(*currSimplifiedGap));
+                // TODO: need to set feasible to true for all gaps as well
+            }
+            float feasibilityTimeTaken = timeTaken(feasibilityStartTime);
+            float avgFeasibilityTimeTaken = computeAverageTimeTaken(feasibilityTimeTaken, GAP_FEAS);
+            ROS_INFO_STREAM_NAMED("Timing", "       [Gap Feasibility Analysis for " << gapCount << " gaps took " << feasibilityTimeTaken << " seconds]");
+            ROS_INFO_STREAM_NAMED("Timing", "       [Gap Feasibility Analysis average time: " << avgFeasibilityTimeTaken << " seconds (" << (1.0 / avgFeasibilityTimeTaken) << " Hz) ]");
 
-        // Have to run here because terminal gap goals are set during feasibility check
-        gapVisualizer_->drawManipGaps(manipulatedGaps, std::string("manip"));
+            // Have to run here because terminal gap goals are set during feasibility check
+            manipGapVisualizer_->drawManipGaps(manipulatedGaps, std::string("manip"));
         
-        /*
-            // gapManipulator_->radialExtendGap(manipulatedGaps.at(i)); // to set s
-            gapManipulator_->setGapGoal(planningGaps.at(i), 
-                                        globalPlanManager_->getGlobalPathLocalWaypointRobotFrame(),
-                                        globalGoalRobotFrame_);
+            /*
+                // gapManipulator_->radialExtendGap(manipulatedGaps.at(i)); // to set s
+                gapManipulator_->setGapGoal(planningGaps.at(i), 
+                                            globalPlanManager_->getGlobalPathLocalWaypointRobotFrame(),
+                                            globalGoalRobotFrame_);
 
-            Eigen::Vector2f terminalGoal = p_target + v_target * gap->t_intercept;
+                Eigen::Vector2f terminalGoal = p_target + v_target * gap->t_intercept;
 
-            // clip at scan
-            float terminalGoalTheta = std::atan2(terminalGoal[1], terminalGoal[0]);
-            int terminalGoalScanIdx = theta2idx(terminalGoalTheta);
+                // clip at scan
+                float terminalGoalTheta = std::atan2(terminalGoal[1], terminalGoal[0]);
+                int terminalGoalScanIdx = theta2idx(terminalGoalTheta);
 
-            // if terminal goal lives beyond scan
-            if (scan_->ranges.at(terminalGoalScanIdx) < (terminalGoal.norm() + cfg_->traj.max_pose_to_scan_dist))
-            {
-                float newTerminalGoalRange = scan_->ranges.at(terminalGoalScanIdx) - cfg_->traj.max_pose_to_scan_dist;
-                terminalGoal << newTerminalGoalRange * std::cos(terminalGoalTheta),
-                                newTerminalGoalRange * std::sin(terminalGoalTheta);
-            }
+                // if terminal goal lives beyond scan
+                if (scan_->ranges.at(terminalGoalScanIdx) < (terminalGoal.norm() + cfg_->traj.max_pose_to_scan_dist))
+                {
+                    float newTerminalGoalRange = scan_->ranges.at(terminalGoalScanIdx) - cfg_->traj.max_pose_to_scan_dist;
+                    terminalGoal << newTerminalGoalRange * std::cos(terminalGoalTheta),
+                                    newTerminalGoalRange * std::sin(terminalGoalTheta);
+                }
 
 
-            gap->setTerminalGoal(terminalGoal);
+                gap->setTerminalGoal(terminalGoal);
 
-        */
+            */
         
         
-        goalVisualizer_->drawGapGoals(manipulatedGaps);
+            goalVisualizer_->drawGapGoals(manipulatedGaps);
+
+            ///////////////////////////////////////////
+            // GAP TRAJECTORY GENERATION AND SCORING //
+            ///////////////////////////////////////////
+            std::chrono::steady_clock::time_point generateGapTrajsStartTime = std::chrono::steady_clock::now();
+            generateGapTrajs(feasibleGaps, trajs, pathPoseCosts, pathTerminalPoseCosts, *futureEgoCircle);
+            float generateGapTrajsTimeTaken = timeTaken(generateGapTrajsStartTime);
+            float avgGenerateGapTrajsTimeTaken = computeAverageTimeTaken(generateGapTrajsTimeTaken, TRAJ_GEN);
+            ROS_INFO_STREAM_NAMED("Timing", "       [Gap Trajectory Generation for " << feasibleGaps.size() << " gaps took " << generateGapTrajsTimeTaken << " seconds]");
+            ROS_INFO_STREAM_NAMED("Timing", "       [Gap Trajectory Generation average time: " << avgGenerateGapTrajsTimeTaken << " seconds (" << (1.0 / avgGenerateGapTrajsTimeTaken) << " Hz) ]");
+        }
+
+        gapFeasibilityChecker_->endCacheCycle();
 
         gapCount = feasibleGaps.size();
 
-        /////////////////////////////
-        // FUTURE SCAN PROPAGATION //
-        /////////////////////////////
-        std::vector<sensor_msgs::LaserScan> futureScans;
-        std::chrono::steady_clock::time_point scanPropagationStartTime = std::chrono::steady_clock::now();
-        if (cfg_.planning.future_scan_propagation)
-        {
-            if (cfg_.planning.egocircle_prop_cheat)
-                throw std::runtime_error("cheat not implemented"); // futureScans = dynamicScanPropagator_->propagateCurrentLaserScanCheat(currentTrueAgentPoses_, currentTrueAgentVels_);
-            else
-                futureScans = dynamicScanPropagator_->propagateCurrentLaserScan(copiedRawGaps);        
-        } else 
-        {
-            sensor_msgs::LaserScan currentScan = *scan_.get();
-            futureScans = std::vector<sensor_msgs::LaserScan>(int(cfg_.traj.integrate_maxt/cfg_.traj.integrate_stept) + 1, currentScan);
-        }
-        float scanPropagationTimeTaken = timeTaken(scanPropagationStartTime);
-        float avgScanPropagationTimeTaken = computeAverageTimeTaken(scanPropagationTimeTaken, SCAN_PROP);
-        ROS_INFO_STREAM_NAMED("Timing", "       [Future Scan Propagation for " << gapCount << " gaps took " << scanPropagationTimeTaken << " seconds]");
-        ROS_INFO_STREAM_NAMED("Timing", "       [Future Scan Propagation average time: " << avgScanPropagationTimeTaken << " seconds (" << (1.0 / avgScanPropagationTimeTaken) << " Hz) ]");
-    
-        ///////////////////////////////////////////
-        // GAP TRAJECTORY GENERATION AND SCORING //
-        ///////////////////////////////////////////
-        std::vector<dynamic_gap::Trajectory> trajs;
-        std::vector<std::vector<float>> pathPoseCosts; 
-        std::vector<float> pathTerminalPoseCosts; 
-        std::chrono::steady_clock::time_point generateGapTrajsStartTime = std::chrono::steady_clock::now();
-        generateGapTrajs(feasibleGaps, trajs, pathPoseCosts, pathTerminalPoseCosts, futureScans);
-        float generateGapTrajsTimeTaken = timeTaken(generateGapTrajsStartTime);
-        float avgGenerateGapTrajsTimeTaken = computeAverageTimeTaken(generateGapTrajsTimeTaken, TRAJ_GEN);
-        ROS_INFO_STREAM_NAMED("Timing", "       [Gap Trajectory Generation for " << gapCount << " gaps took " << generateGapTrajsTimeTaken << " seconds]");
-        ROS_INFO_STREAM_NAMED("Timing", "       [Gap Trajectory Generation average time: " << avgGenerateGapTrajsTimeTaken << " seconds (" << (1.0 / avgGenerateGapTrajsTimeTaken) << " Hz) ]");
-    
         //////////////////////////////
         // GAP TRAJECTORY SELECTION //
         //////////////////////////////
@@ -1347,7 +1986,7 @@ void Planner::jointPoseAccCB(const nav_msgs::Odometry::ConstPtr & rbtOdomMsg,
                                             lowestCostTrajIdx,
                                             trajFlag,
                                             isCurrentGapFeasible,
-                                            futureScans);
+                                            *futureEgoCircle);
 
             float compareToCurrentTrajTimeTaken = timeTaken(compareToCurrentTrajStartTime);
             float avgCompareToCurrentTrajTimeTaken = computeAverageTimeTaken(compareToCurrentTrajTimeTaken, TRAJ_COMP);        
@@ -1423,6 +2062,9 @@ void Planner::jointPoseAccCB(const nav_msgs::Odometry::ConstPtr & rbtOdomMsg,
         for (dynamic_gap::Gap * copiedRawGap : copiedRawGaps)
             delete copiedRawGap;
 
+        for (dynamic_gap::Gap * unmanipulatedGap : unmanipulatedGaps)
+            delete unmanipulatedGap;
+
         return;
     }
 
@@ -1701,6 +2343,11 @@ void Planner::jointPoseAccCB(const nav_msgs::Odometry::ConstPtr & rbtOdomMsg,
                 controlCalls++;
                 averageTimeTaken = (totalControlTimeTaken / controlCalls);
                 break;                                                                   
+            case GAP_PIPE:
+                totalGapPipelineTimeTaken += timeTaken;
+                gapPipelineCalls++;
+                averageTimeTaken = (totalGapPipelineTimeTaken / gapPipelineCalls);
+                break;
         }
 
         return averageTimeTaken;
@@ -30,15 +30,26 @@ namespace dynamic_gap
 
             // Scan
             nh.param("max_range", scan.range_max, scan.range_max);
+            nh.param("scan_queue_size", scan.queue_size, scan.queue_size);
 
             // Planning Information
             nh.param("projection_operator", planning.projection_operator, planning.projection_operator);
             nh.param("egocircle_prop_cheat", planning.egocircle_prop_cheat, planning.egocircle_prop_cheat);
+            nh.param("cheat_agent_radius", planning.cheat_agent_radius, planning.cheat_agent_radius);
             nh.param("heading", planning.heading, planning.heading);
             ROS_INFO_STREAM("       setting heading to " << planning.heading);
             nh.param("gap_feasibility_check", planning.gap_feasibility_check, planning.gap_feasibility_check);
+            nh.param("analytic_gap_lifespan", planning.analytic_gap_lifespan, planning.analytic_gap_lifespan);
+            nh.param("validate_gap_lifespan", planning.validate_gap_lifespan, planning.validate_gap_lifespan);
             nh.param("perfect_gap_models", planning.perfect_gap_models, planning.perfect_gap_models);
             nh.param("future_scan_propagation", planning.future_scan_propagation, planning.future_scan_propagation);
+            nh.param("dynamic_segment_clearance", planning.dynamic_segment_clearance, planning.dynamic_segment_clearance);
+            nh.param("dynamic_segment_tolerance", planning.dynamic_segment_tolerance, planning.dynamic_segment_tolerance);
+            nh.param("num_planning_threads", planning.num_planning_threads, planning.num_planning_threads);
+            nh.param("per_gap_pipeline", planning.per_gap_pipeline, planning.per_gap_pipeline);
+            nh.param("gap_cost_bounding", planning.gap_cost_bounding, planning.gap_cost_bounding);
+            nh.param("gap_feasibility_cache", planning.gap_feasibility_cache, planning.gap_feasibility_cache);
+            nh.param("gap_feasibility_cache_tolerance", planning.gap_feasibility_cache_tolerance, planning.gap_feasibility_cache_tolerance);
 
             // Manual Control
             nh.param("man_ctrl", ctrl.man_ctrl, ctrl.man_ctrl);
@@ -50,6 +61,16 @@ namespace dynamic_gap
 
             // Gap Association
             nh.param("assoc_thresh", gap_assoc.assoc_thresh, gap_assoc.assoc_thresh);
+            nh.param("banded_association", gap_assoc.banded_association, gap_assoc.banded_association);
+            nh.param("assoc_band_angle", gap_assoc.assoc_band_angle, gap_assoc.assoc_band_angle);
+            nh.param("assoc_band_max_points", gap_assoc.assoc_band_max_points, gap_assoc.assoc_band_max_points);
+
+            // Gap Estimation
+            nh.param("batched_update", gap_est.batched_update, gap_est.batched_update);
+            nh.param("joseph_form", gap_est.joseph_form, gap_est.joseph_form);
+            nh.param("num_update_threads", gap_est.num_update_threads, gap_est.num_update_threads);
+            nh.param("planning_time_prediction", gap_est.planning_time_prediction, gap_est.planning_time_prediction);
+            nh.param("agent_hash_cell_size", gap_est.agent_hash_cell_size, gap_est.agent_hash_cell_size);
 
             // Gap Manipulation
             nh.param("epsilon1", gap_manip.epsilon1, gap_manip.epsilon1);
@@ -74,6 +95,11 @@ namespace dynamic_gap
             nh.param("k_po_x", projection.k_po_x, projection.k_po_x);
             nh.param("r_unity", projection.r_unity, projection.r_unity);
             nh.param("r_zero", projection.r_zero, projection.r_zero);
+
+            // Checkpoint Params
+            nh.param("checkpoint_save_dir", checkpoint.save_dir, checkpoint.save_dir);
+            nh.param("checkpoint_save_period", checkpoint.save_period, checkpoint.save_period);
+            nh.param("checkpoint_load_file", checkpoint.load_file, checkpoint.load_file);
         } else
         {
             throw std::runtime_error("Model " + model + " not implemented!");
@@ -176,35 +176,126 @@ namespace dynamic_gap
 
     ////////////////// GAP SIMPLIFICATION ///////////////////////
 
+    void GapDetector::buildIntergapRangeQueries()
+    {
+        const int blockCount = (fullScanRayCount_ + rangeQueryBlockSize_ - 1) / rangeQueryBlockSize_;
+
+        blockPrefixMinRanges_.resize(fullScanRayCount_);
+        blockSuffixMinRanges_.resize(fullScanRayCount_);
+
+        for (int i = 0; i < fullScanRayCount_; i++)
+        {
+            if (i % rangeQueryBlockSize_ == 0)
+                blockPrefixMinRanges_[i] = scan_.ranges[i];
+            else
+                blockPrefixMinRanges_[i] = std::min(blockPrefixMinRanges_[i - 1], scan_.ranges[i]);
+        }
+
+        for (int i = (fullScanRayCount_ - 1); i >= 0; i--)
+        {
+            if (i % rangeQueryBlockSize_ == (rangeQueryBlockSize_ - 1) || i == (fullScanRayCount_ - 1))
+                blockSuffixMinRanges_[i] = scan_.ranges[i];
+            else
+                blockSuffixMinRanges_[i] = std::min(blockSuffixMinRanges_[i + 1], scan_.ranges[i]);
+        }
+
+        blockCountLog2_.assign(blockCount + 1, 0);
+        for (int i = 2; i <= blockCount; i++)
+            blockCountLog2_[i] = blockCountLog2_[i / 2] + 1;
+
+        // level k holds minimum range over 2^k consecutive blocks
+        const int levelCount = blockCountLog2_[blockCount] + 1;
+        blockMinRangesTable_.resize(levelCount);
+        blockMinRangesTable_[0].resize(blockCount);
+        for (int b = 0; b < blockCount; b++)
+            blockMinRangesTable_[0][b] = blockSuffixMinRanges_[b * rangeQueryBlockSize_];
+
+        for (int k = 1; k < levelCount; k++)
+        {
+            const int halfSpan = 1 << (k - 1);
+            blockMinRangesTable_[k].resize(blockCount - 2 * halfSpan + 1);
+            for (int b = 0; b < blockMinRangesTable_[k].size(); b++)
+                blockMinRangesTable_[k][b] = std::min(blockMinRangesTable_[k - 1][b], blockMinRangesTable_[k - 1][b + halfSpan]);
+        }
+    }
+
+    float GapDetector::minIntergapRange(const int & startIdx, const int & endIdx)
+    {
+        if (endIdx <= startIdx)
+            return scan_.ranges.at(startIdx);
+
+        const int lastIdx = endIdx - 1;
+        const int startBlock = startIdx / rangeQueryBlockSize_;
+        const int lastBlock = lastIdx / rangeQueryBlockSize_;
+
+        // interval within a single block, bounded by block size
+        if (startBlock == lastBlock)
+            return *std::min_element(scan_.ranges.begin() + startIdx, scan_.ranges.begin() + endIdx);
+
+        float minRange = std::min(blockSuffixMinRanges_[startIdx], blockPrefixMinRanges_[lastIdx]);
+
+        const int innerBlockCount = lastBlock - startBlock - 1;
+        if (innerBlockCount > 0)
+        {
+            const int k = blockCountLog2_[innerBlockCount];
+            minRange = std::min(minRange, std::min(blockMinRangesTable_[k][startBlock + 1], 
+                                                   blockMinRangesTable_[k][lastBlock - (1 << k)]));
+        }
+
+        return minRange;
+    }
+
+    void GapDetector::pushMergeCandidate(const std::vector<dynamic_gap::Gap *> & simplifiedGaps,
+                                         std::vector<int> & mergeCandidates)
+    {
+        // only simplified gaps that are either right dist < left dist or swept can be merged into
+        if (simplifiedGaps.back()->isRightType() || !simplifiedGaps.back()->isRadial())
+            mergeCandidates.push_back(simplifiedGaps.size() - 1);
+    }
+
     int GapDetector::checkSimplifiedGapsMergeability(dynamic_gap::Gap * rawGap, 
-                                                     const std::vector<dynamic_gap::Gap *> & simplifiedGaps)
+                                                     const std::vector<dynamic_gap::Gap *> & simplifiedGaps,
+                                                     std::vector<int> & mergeCandidates)
     {
         int lastMergeable = -1;
 
+        const int backIdx = simplifiedGaps.size() - 1;
         int startIdx = -1, endIdx = -1;
+        
+        // survivors are compacted towards the back of mergeCandidates as we go
+        int readPos = mergeCandidates.size() - 1;
+        int writePos = mergeCandidates.size() - 1;
         // // ROS_INFO_STREAM_NAMED("GapDetector", "attempting merge with raw gap: (" << rawGaps.at(i).RIdx() << ", " << rawGaps.at(i).RRange() << ") to (" << rawGaps.at(i).LIdx() << ", " << rawGaps.at(i).LRange() << ")");
-        for (int j = (simplifiedGaps.size() - 1); j >= 0; j--)
+        for (; readPos >= 0; readPos--)
         {
+            int j = mergeCandidates[readPos];
             // // ROS_INFO_STREAM_NAMED("GapDetector", "on simplified gap " << j << " of " << simplifiedGaps.size() << ": ");
             // // ROS_INFO_STREAM_NAMED("GapDetector", "points: (" << simplifiedGaps.at(j).RIdx() << ", " << simplifiedGaps.at(j).RRange() << ") to (" << simplifiedGaps.at(j).LIdx() << ", " << simplifiedGaps.at(j).LRange() << ")");
             startIdx = std::min(simplifiedGaps.at(j)->LIdx(), rawGap->RIdx());
             endIdx = std::max(simplifiedGaps.at(j)->LIdx(), rawGap->RIdx());
-            float minIntergapRange = *std::min_element(scan_.ranges.begin() + startIdx, scan_.ranges.begin() + endIdx);
-            float inflatedMinIntergapRange = minIntergapRange - 2 * cfg_->rbt.r_inscr;
+            float inflatedMinIntergapRange = minIntergapRange(startIdx, endIdx) - 2 * cfg_->rbt.r_inscr;
 
-            // 1. Checking if raw gap left and simplified gap right (widest distances, encompassing both gaps) dist 
-            //    is less than the dist of whatever separates the two gaps
-            bool intergapDistTest = rawGap->LRange() <= inflatedMinIntergapRange && 
-                                    simplifiedGaps.at(j)->RRange() <= inflatedMinIntergapRange;
-            
-            // 2. Checking if current simplified gap is either right dist < left dist or swept 
-            bool rightTypeOrSweptGap = simplifiedGaps.at(j)->isRightType() || !simplifiedGaps.at(j)->isRadial();
+            // 1. Checking if simplified gap right dist is less than the dist of whatever separates the two gaps. 
+            //    This interval only grows for later raw gaps, so a failing simplified gap is dropped for good
+            if (!(simplifiedGaps.at(j)->RRange() <= inflatedMinIntergapRange))
+                continue;
 
-            // // ROS_INFO_STREAM_NAMED("GapDetector", "simp_left_raw_right_dist_test: " << simp_left_raw_right_dist_test << ", rightTypeOrSweptGap: " << rightTypeOrSweptGap << ", mergedGapSizeCheck: " << mergedGapSizeCheck);
-            if (intergapDistTest && rightTypeOrSweptGap)
+            // 2. Checking if raw gap left dist is less than the dist of whatever separates the two gaps
+            if (rawGap->LRange() <= inflatedMinIntergapRange)
+            {
                 lastMergeable = j;
+            } else if (j != backIdx)
+            {
+                // intervals of earlier simplified gaps contain this one, so they fail as well.
+                // (last simplified gap may share its left point with raw gap right point, so it is exempt)
+                break;
+            }
+
+            mergeCandidates[writePos--] = j;
         }
 
+        mergeCandidates.erase(mergeCandidates.begin() + readPos + 1, mergeCandidates.begin() + writePos + 1);
+
         return lastMergeable;
     }
 
@@ -232,6 +323,11 @@ namespace dynamic_gap
 
             // float curr_left_dist = 0.0;
             int lastMergeable = -1;
+
+            std::vector<int> mergeCandidates;
+            mergeCandidates.reserve(rawGaps.size());
+
+            buildIntergapRangeQueries();
             
             for (dynamic_gap::Gap * rawGap : rawGaps)
             {
@@ -246,20 +342,23 @@ namespace dynamic_gap
                         markToStart = false;
                     }
 
-                    // creating a separate set of Gap objects for simplifiedGaps
-                    simplifiedGaps.push_back(new dynamic_gap::Gap(*rawGap));
+                    // creating a separate set of Gap objects for simplifiedGaps 
+                    // (gap point models stay owned by raw gaps)
+                    simplifiedGaps.push_back(new dynamic_gap::Gap(*rawGap, true));
+                    pushMergeCandidate(simplifiedGaps, mergeCandidates);
                 } else {
                     if (rawGap->isRadial()) // if gap is radial
                     {
                         if (rawGap->isRightType()) // if right dist < left dist
                         {
                             // ROS_INFO_STREAM_NAMED("GapDetector", "adding raw gap (radial, right<left)");
-                            simplifiedGaps.push_back(new dynamic_gap::Gap(*rawGap));
+                            simplifiedGaps.push_back(new dynamic_gap::Gap(*rawGap, true));
+                            pushMergeCandidate(simplifiedGaps, mergeCandidates);
                         }
                         else
                         {
                             // curr_left_dist = rawGap->LRange();
-                            lastMergeable = checkSimplifiedGapsMergeability(rawGap, simplifiedGaps);
+                            lastMergeable = checkSimplifiedGapsMergeability(rawGap, simplifiedGaps, mergeCandidates);
 
                             if (lastMergeable != -1) 
                             {
@@ -267,13 +366,17 @@ namespace dynamic_gap
                                 for (auto gapIter = simplifiedGaps.begin() + lastMergeable + 1; gapIter != simplifiedGaps.end(); gapIter++)
                                     delete *gapIter;
                                 simplifiedGaps.erase(simplifiedGaps.begin() + lastMergeable + 1, simplifiedGaps.end());
-                                
+                                while (!mergeCandidates.empty() && mergeCandidates.back() >= lastMergeable)
+                                    mergeCandidates.pop_back();
+
                                 simplifiedGaps.back()->addLeftInformation(rawGap->LIdx(), rawGap->LRange());
+                                pushMergeCandidate(simplifiedGaps, mergeCandidates);
                                 // // ROS_INFO_STREAM_NAMED("GapDetector", "merging last simplified gap into (" << simplifiedGaps.back().RIdx() << ", " << simplifiedGaps.back().RRange() << ") to (" << simplifiedGaps.back().LIdx() << ", " << simplifiedGaps.back().LRange() << ")");
                             } else 
                             {
                                 // ROS_INFO_STREAM_NAMED("GapDetector", "no merge, adding raw gap (swept, left<right)");                            
-                                simplifiedGaps.push_back(new dynamic_gap::Gap(*rawGap));
+                                simplifiedGaps.push_back(new dynamic_gap::Gap(*rawGap, true));
+                                pushMergeCandidate(simplifiedGaps, mergeCandidates);
                             }
                         }
                     }
@@ -282,12 +385,17 @@ namespace dynamic_gap
                         // curr_left_dist = rawGap->LRange();
                         if (mergeSweptGapCondition(rawGap, simplifiedGaps))
                         {
+                            if (!mergeCandidates.empty() && mergeCandidates.back() == (simplifiedGaps.size() - 1))
+                                mergeCandidates.pop_back();
+
                             simplifiedGaps.back()->addLeftInformation(rawGap->LIdx(), rawGap->LRange());
+                            pushMergeCandidate(simplifiedGaps, mergeCandidates);
                             // // ROS_INFO_STREAM_NAMED("GapDetector", "merging last simplifed gap to (" << simplifiedGaps.back().RIdx() << ", " << simplifiedGaps.back().RRange() << ") to (" << simplifiedGaps.back().LIdx() << ", " << simplifiedGaps.back().LRange() << ")");
                         } else 
                         {
                             // ROS_INFO_STREAM_NAMED("GapDetector", "adding raw gap (swept)");                            
-                            simplifiedGaps.push_back(new dynamic_gap::Gap(*rawGap));
+                            simplifiedGaps.push_back(new dynamic_gap::Gap(*rawGap, true));
+                            pushMergeCandidate(simplifiedGaps, mergeCandidates);
                         }
                     }
                 }
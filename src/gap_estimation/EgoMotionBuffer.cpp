@@ -0,0 +1,157 @@
+#include <dynamic_gap/gap_estimation/EgoMotionBuffer.h>
+
+namespace dynamic_gap 
+{
+    void EgoMotionBuffer::push(const EgoMotionSample & sample)
+    {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        samples_[head % capacity_] = sample;
+
+        // publish sample to readers
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    bool EgoMotionBuffer::readIntact(const uint64_t & tail) const
+    {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t head = head_.load(std::memory_order_relaxed);
+
+        // producer may currently be writing absolute index head, which overwrites head - capacity_
+        return head < capacity_ || tail > head - capacity_;
+    }
+
+    uint64_t EgoMotionBuffer::firstAfter(uint64_t lo, uint64_t hi, const ros::Time & t, const bool & acc) const
+    {
+        while (lo < hi)
+        {
+            uint64_t mid = lo + (hi - lo) / 2;
+            const EgoMotionSample & sample = samples_[mid % capacity_];
+            
+            if ((acc ? sample.accStamp : sample.velStamp) > t)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+
+        return lo;
+    }
+
+    void EgoMotionBuffer::copySince(const ros::Time & tSince,
+                                    std::vector<geometry_msgs::TwistStamped> & rbtVels,
+                                    std::vector<geometry_msgs::TwistStamped> & rbtAccs) const
+    {
+        geometry_msgs::TwistStamped rbtVel, rbtAcc;
+        rbtVel.header.frame_id = cfg_->robot_frame_id;
+        rbtAcc.header.frame_id = cfg_->robot_frame_id;
+
+        while (true)
+        {
+            rbtVels.clear();
+            rbtAccs.clear();
+
+            uint64_t head = head_.load(std::memory_order_acquire);
+            uint64_t tail = readableTail(head);
+
+            // samples older than readable tail have been given up on, so anything between tSince and tail is lost
+            ros::Time tOldest = (tail < head) ? samples_[tail % capacity_].velStamp : ros::Time();
+            bool missingSamples = (tail > 0 && tOldest > tSince);
+
+            for (uint64_t i = firstAfter(tail, head, tSince, false); i < head; i++)
+            {
+                const EgoMotionSample & sample = samples_[i % capacity_];
+                
+                // redundant timestamp, skipping
+                if (rbtVels.size() > 0 && rbtVels.back().header.stamp == sample.velStamp)
+                    continue;
+
+                rbtVel.header.stamp = sample.velStamp;
+                rbtVel.twist.linear.x = sample.vx;
+                rbtVel.twist.linear.y = sample.vy;
+                rbtVel.twist.angular.z = sample.omega;
+                rbtVels.push_back(rbtVel);
+            }
+
+            for (uint64_t i = firstAfter(tail, head, tSince, true); i < head; i++)
+            {
+                const EgoMotionSample & sample = samples_[i % capacity_];
+                
+                // redundant timestamp, skipping
+                if (rbtAccs.size() > 0 && rbtAccs.back().header.stamp == sample.accStamp)
+                    continue;
+
+                rbtAcc.header.stamp = sample.accStamp;
+                rbtAcc.twist.linear.x = sample.ax;
+                rbtAcc.twist.linear.y = sample.ay;
+                rbtAccs.push_back(rbtAcc);
+            }
+
+            if (readIntact(tail))
+            {
+                ROS_WARN_STREAM_COND_NAMED(missingSamples, "GapEstimation", "ego-motion buffer only reaches back " << (tOldest - tSince).toSec() << 
+                                                                             " seconds short of requested time, odometry in between is missing");
+                return;
+            }
+
+            ROS_WARN_STREAM_NAMED("GapEstimation", "ego-motion buffer lapped during read, retrying");
+        }
+    }
+
+    bool EgoMotionBuffer::interpolate(const ros::Time & t, EgoMotionSample & sample) const
+    {
+        while (true)
+        {
+            uint64_t head = head_.load(std::memory_order_acquire);
+            uint64_t tail = readableTail(head);
+
+            if (head == tail)
+                return false;
+
+            // velocity
+            uint64_t upper = firstAfter(tail, head, t, false);
+            const EgoMotionSample & velLower = samples_[(upper > tail ? upper - 1 : upper) % capacity_];
+            const EgoMotionSample & velUpper = samples_[(upper < head ? upper : head - 1) % capacity_];
+
+            float velDenom = (velUpper.velStamp - velLower.velStamp).toSec();
+            float velWeight = velDenom > 0.0 ? (t - velLower.velStamp).toSec() / velDenom : 0.0;
+
+            sample.velStamp = t;
+            sample.vx = velLower.vx + (velUpper.vx - velLower.vx) * velWeight;
+            sample.vy = velLower.vy + (velUpper.vy - velLower.vy) * velWeight;
+            sample.omega = velLower.omega + (velUpper.omega - velLower.omega) * velWeight;
+
+            // acceleration
+            upper = firstAfter(tail, head, t, true);
+            const EgoMotionSample & accLower = samples_[(upper > tail ? upper - 1 : upper) % capacity_];
+            const EgoMotionSample & accUpper = samples_[(upper < head ? upper : head - 1) % capacity_];
+
+            float accDenom = (accUpper.accStamp - accLower.accStamp).toSec();
+            float accWeight = accDenom > 0.0 ? (t - accLower.accStamp).toSec() / accDenom : 0.0;
+
+            sample.accStamp = t;
+            sample.ax = accLower.ax + (accUpper.ax - accLower.ax) * accWeight;
+            sample.ay = accLower.ay + (accUpper.ay - accLower.ay) * accWeight;
+
+            if (readIntact(tail))
+                return true;
+        }
+    }
+
+    void EgoMotionBuffer::copySamples(std::vector<EgoMotionSample> & samples) const
+    {
+        while (true)
+        {
+            samples.clear();
+
+            uint64_t head = head_.load(std::memory_order_acquire);
+            uint64_t tail = readableTail(head);
+
+            for (uint64_t i = tail; i < head; i++)
+                samples.push_back(samples_[i % capacity_]);
+
+            if (readIntact(tail))
+                return;
+
+            ROS_WARN_STREAM_NAMED("GapEstimation", "ego-motion buffer lapped during read, retrying");
+        }
+    }
+}
@@ -0,0 +1,300 @@
+#include <dynamic_gap/gap_estimation/EgoMotionTimeline.h>
+
+namespace dynamic_gap 
+{
+    void EgoMotionTimeline::build(const std::vector<geometry_msgs::TwistStamped> & rbtVels,
+                                  const std::vector<geometry_msgs::TwistStamped> & rbtAccs,
+                                  const ros::Time & tStart,
+                                  const geometry_msgs::TwistStamped & startRbtVel,
+                                  const geometry_msgs::TwistStamped & startRbtAcc,
+                                  const ros::Time & tEnd,
+                                  const Eigen::Matrix4f & Q)
+    {
+        rawRbtVels_ = rbtVels;
+        rawRbtAccs_ = rbtAccs;
+        rbtVels_ = rbtVels;
+        rbtAccs_ = rbtAccs;
+
+        tStart_ = tStart;
+        tEnd_ = tEnd;
+        startRbtVel_ = startRbtVel;
+        startRbtAcc_ = startRbtAcc;
+        Q_ = Q;
+
+        dts_.clear();
+        STMs_.clear();
+        dQs_.clear();
+
+        valid_ = false;
+
+        // estimators do not update without intermediate odometry
+        if (rbtVels_.size() == 0 || rbtAccs_.size() == 0)
+            return;
+
+        alignEgoRobotVelsAndAccs();
+
+        if (rbtVels_.size() != rbtAccs_.size())
+        {
+            // ROS_INFO_STREAM("    rbtVels_ is of size " << rbtVels_.size() << " while rbtAccs_ is of size " << rbtAccs_.size());
+            return;
+        }
+
+        discretizeDynamics();
+
+        valid_ = true;
+    }
+
+    bool EgoMotionTimeline::matches(const ros::Time & tStart,
+                                    const geometry_msgs::TwistStamped & startRbtVel,
+                                    const geometry_msgs::TwistStamped & startRbtAcc,
+                                    const ros::Time & tEnd,
+                                    const Eigen::Matrix4f & Q) const
+    {
+        // placeholder odometry at start of timeline must be exactly what the estimator would have inserted
+        return tStart == tStart_ && tEnd == tEnd_ &&
+               startRbtVel.twist.linear.x == startRbtVel_.twist.linear.x &&
+               startRbtVel.twist.linear.y == startRbtVel_.twist.linear.y &&
+               startRbtVel.twist.angular.z == startRbtVel_.twist.angular.z &&
+               startRbtAcc.twist.linear.x == startRbtAcc_.twist.linear.x &&
+               startRbtAcc.twist.linear.y == startRbtAcc_.twist.linear.y &&
+               startRbtAcc.twist.angular.z == startRbtAcc_.twist.angular.z &&
+               Q == Q_;
+    }
+
+    void EgoMotionTimeline::alignEgoRobotVelsAndAccs()
+    {
+        // Tweaking ego robot velocities/acceleration to make sure that updates:
+        //      1. Are never negative (backwards in time)
+        //      2. Always start from time of last update
+        //      3. Always at end at time of incoming laser scan measurement
+
+        // Erasing odometry measurements that are from *before* the last update 
+        while (!rbtVels_.empty() && tStart_ > rbtVels_[0].header.stamp)
+            rbtVels_.erase(rbtVels_.begin());
+
+        while (!rbtAccs_.empty() && tStart_ > rbtAccs_[0].header.stamp)
+            rbtAccs_.erase(rbtAccs_.begin());
+
+        // Inserting placeholder odometry to represent the time of the last update
+        bool velValueAtScanTime = false;
+        for (int i = 0; i < rbtVels_.size(); i++)
+        {
+            if (rbtVels_.at(i).header.stamp == tStart_)
+            {
+                velValueAtScanTime = true;
+                break;
+            }
+        }
+        if (!velValueAtScanTime)
+        {
+            rbtVels_.insert(rbtVels_.begin(), startRbtVel_);
+            rbtVels_[0].header.stamp = tStart_;
+        }
+
+        bool accValueAtScanTime = false;
+        for (int i = 0; i < rbtAccs_.size(); i++)
+        {
+            if (rbtAccs_.at(i).header.stamp == tStart_)
+            {
+                accValueAtScanTime = true;
+                break;
+            }
+        }
+        if (!accValueAtScanTime)
+        {
+            rbtAccs_.insert(rbtAccs_.begin(), startRbtAcc_);
+            rbtAccs_[0].header.stamp = tStart_;
+        }
+
+        // Erasing odometry measurements that occur *after* the incoming laser scan was received
+        while (!rbtVels_.empty() && tEnd_ < rbtVels_[rbtVels_.size() - 1].header.stamp)
+            rbtVels_.erase(rbtVels_.end() - 1);
+
+        while (!rbtAccs_.empty() && tEnd_ < rbtAccs_[rbtAccs_.size() - 1].header.stamp)
+            rbtAccs_.erase(rbtAccs_.end() - 1);
+
+        // Inserting placeholder odometry to represent the time that the incoming laser scan was received
+        bool lastVelValueAtScanTime = false;
+        for (int i = 0; i < rbtVels_.size(); i++)
+        {
+            if (rbtVels_.at(i).header.stamp == tEnd_)
+            {
+                lastVelValueAtScanTime = true;
+                break;
+            }
+        }
+        if (!lastVelValueAtScanTime)
+        {
+            if (!rbtVels_.empty())
+                rbtVels_.push_back(rbtVels_.back());
+            else
+                rbtVels_.push_back(startRbtVel_);
+
+            rbtVels_.back().header.stamp = tEnd_;
+        }
+        
+        bool lastAccValueAtScanTime = false;
+        for (int i = 0; i < rbtAccs_.size(); i++)
+        {
+            if (rbtAccs_.at(i).header.stamp == tEnd_)
+            {
+                lastAccValueAtScanTime = true;
+                break;
+            }
+        }
+        if (!lastAccValueAtScanTime)
+        {
+            if (!rbtAccs_.empty())
+                rbtAccs_.push_back(rbtAccs_.back());
+            else
+                rbtAccs_.push_back(startRbtAcc_);
+
+            rbtAccs_.back().header.stamp = tEnd_;
+        }
+
+        // Interpolating to make sure that vels and accs share all of the same time steps
+        if (rbtVels_.size() > 0 && rbtAccs_.size() > 0)
+            interpolateIntermediateValues(rbtVels_, rbtAccs_);
+        
+        if (rbtAccs_.size() > 0 && rbtVels_.size() > 0)
+            interpolateIntermediateValues(rbtAccs_, rbtVels_);
+
+        for (int i = 0; i < (rbtVels_.size() - 1); i++)
+        {
+            float dt = (rbtVels_[i + 1].header.stamp - rbtVels_[i].header.stamp).toSec();
+            
+            // ROS_INFO_STREAM_NAMED("GapEstimation", "   t_" << (i+1) << " - t_" << i << " difference: " << dt << " sec");
+            
+            ROS_WARN_STREAM_COND_NAMED(dt < 0, "GapEstimation", "ERROR IN TIMESTEP CALCULATION, SHOULD NOT BE NEGATIVE");
+        }
+    }
+
+    void EgoMotionTimeline::interpolateIntermediateValues(std::vector<geometry_msgs::TwistStamped> & vectorI,
+                                                          const std::vector<geometry_msgs::TwistStamped> & vectorJ)
+    {
+        // filling in velocities first
+        for (int j = 0; j < vectorJ.size(); j++)
+        {
+            // see if acceleration's timestamp is present
+            int timeJLowerBoundIthIdx = -1; // largest timestamp in i smaller than j
+            int timeJUpperBoundIthIdx = -1; // smallest timestamp in i bigger than j
+
+            int timeJIthIndex = -1;
+            for (int i = 0; i < vectorI.size(); i++)
+            {
+                if (vectorJ[j].header.stamp > vectorI[i].header.stamp)
+                    timeJLowerBoundIthIdx = i;
+
+                if (timeJUpperBoundIthIdx < 0 && vectorJ[j].header.stamp < vectorI[i].header.stamp)
+                    timeJUpperBoundIthIdx = i;
+
+                if (vectorJ[j].header.stamp == vectorI[i].header.stamp)
+                {
+                    timeJIthIndex = i;
+                    break;
+                }
+            }
+
+            if (timeJIthIndex > 0) // acceleration's timestamp is present, we don't need to do anything
+            {
+                continue;
+            } else
+            {
+                if (timeJLowerBoundIthIdx == -1 && timeJUpperBoundIthIdx == -1) // lower bound is -1 and upper bound is -1
+                {
+                    //      only if one array is empty, should not happen
+                } else if (timeJLowerBoundIthIdx == -1 && timeJUpperBoundIthIdx >= 0) // lower bound is -1 and upper bound is >=0
+                {
+                    // nothing in i is smaller than j, just re-add first element of i
+                    vectorI.insert(vectorI.begin(), vectorI.at(0));
+                    vectorI.at(0).header.stamp = vectorJ.at(j).header.stamp;
+                } else if (timeJLowerBoundIthIdx >= 0 && timeJUpperBoundIthIdx == -1) // lower bound is >=0 and upper bound is -1
+                {
+                    // nothing in i is bigger than j, just re-add last element of i
+                    vectorI.insert(vectorI.end(), vectorI.at(vectorI.size() - 1));
+                    vectorI.at(vectorI.size() - 1).header.stamp = vectorJ.at(j).header.stamp;
+                } else if (timeJLowerBoundIthIdx >= 0 && timeJUpperBoundIthIdx >= 0) // lower bound is >=0 and upper bound is >=0
+                {
+                    geometry_msgs::TwistStamped interpTwist;
+                    interpTwist.header.frame_id = vectorJ.at(j).header.frame_id;
+                    interpTwist.header.stamp = vectorJ.at(j).header.stamp;
+
+                    float linear_x_diff = (vectorI.at(timeJUpperBoundIthIdx).twist.linear.x - vectorI.at(timeJLowerBoundIthIdx).twist.linear.x);
+                    float linear_y_diff = (vectorI.at(timeJUpperBoundIthIdx).twist.linear.y - vectorI.at(timeJLowerBoundIthIdx).twist.linear.y);
+                    float angular_z_diff = (vectorI.at(timeJUpperBoundIthIdx).twist.angular.z - vectorI.at(timeJLowerBoundIthIdx).twist.angular.z);
+
+                    float time_diff_num = (interpTwist.header.stamp - vectorI.at(timeJLowerBoundIthIdx).header.stamp).toSec();
+                    float time_diff_denom = (vectorI.at(timeJUpperBoundIthIdx).header.stamp - vectorI.at(timeJLowerBoundIthIdx).header.stamp).toSec();
+
+                    interpTwist.twist.linear.x = vectorI.at(timeJLowerBoundIthIdx).twist.linear.x +
+                                                    linear_x_diff * time_diff_num / time_diff_denom; 
+                    interpTwist.twist.linear.y = vectorI.at(timeJLowerBoundIthIdx).twist.linear.y +
+                                                    linear_y_diff * time_diff_num / time_diff_denom; 
+                    interpTwist.twist.angular.z = vectorI.at(timeJLowerBoundIthIdx).twist.angular.z +
+                                                    angular_z_diff * time_diff_num / time_diff_denom;
+
+                    vectorI.insert(vectorI.begin() + timeJUpperBoundIthIdx, interpTwist);
+                }
+            }
+        }                
+    }
+
+    void EgoMotionTimeline::discretizeDynamics()
+    {
+        int nSteps = rbtVels_.size() - 1;
+        dts_.resize(nSteps);
+        STMs_.resize(nSteps);
+        dQs_.resize(nSteps);
+
+        // noise only on velocity, equal along both axes
+        bool isotropicVelocityNoise = Q_.topRows(2).isZero() && Q_.leftCols(2).isZero() && 
+                                      Q_(2, 3) == 0.0 && Q_(3, 2) == 0.0 && Q_(2, 2) == Q_(3, 3);
+
+        Eigen::Matrix4f A, Q_2, Q_3;
+        for (int i = 0; i < nSteps; i++)
+        {
+            float dt = (rbtVels_[i + 1].header.stamp - rbtVels_[i].header.stamp).toSec();
+            float ang_vel_ego = rbtVels_[i].twist.angular.z;
+
+            dts_[i] = dt;
+
+            // A = [W I; 0 W] with W = [0 w; -w 0], and since W commutes with I,
+            // exp(A*dt) = [R dt*R; 0 R] where R = exp(W*dt) is a rotation by -w*dt
+            float cosTheta = std::cos(ang_vel_ego * dt);
+            float sinTheta = std::sin(ang_vel_ego * dt);
+
+            STMs_[i] << cosTheta, sinTheta, dt*cosTheta, dt*sinTheta,
+                        -sinTheta, cosTheta, -dt*sinTheta, dt*cosTheta,
+                        0.0, 0.0, cosTheta, sinTheta,
+                        0.0, 0.0, -sinTheta, cosTheta;
+
+            if (isotropicVelocityNoise)
+            {
+                // integral of exp(A*s) Q exp(A*s)^T over [0, dt]: rotations cancel against their transposes,
+                // leaving the constant velocity noise terms (identical to 3rd order series, which is exact here)
+                float q = Q_(2, 2);
+                float dQpp = q * dt * dt * dt / 3.0;
+                float dQpv = q * dt * dt / 2.0;
+                float dQvv = q * dt;
+
+                dQs_[i] << dQpp, 0.0, dQpv, 0.0,
+                           0.0, dQpp, 0.0, dQpv,
+                           dQpv, 0.0, dQvv, 0.0,
+                           0.0, dQpv, 0.0, dQvv;
+            } else
+            {
+                // linearizing rotating frame dynamics
+                A << 0.0, ang_vel_ego, 1.0, 0.0,
+                     -ang_vel_ego, 0.0, 0.0, 1.0,
+                     0.0, 0.0, 0.0, ang_vel_ego,
+                     0.0, 0.0, -ang_vel_ego, 0.0;
+
+                // discretizing continuous covariance noise matrix
+                Q_2 = A * Q_ + Q_ * A.transpose();
+                Q_3 = A * Q_2 + Q_2 * A.transpose();
+
+                dQs_[i] = (Q_ * dt) + (Q_2 * dt * dt / 2.0) + (Q_3 * dt * dt * dt / 6.0);
+            }
+        }
+    }
+}
@@ -1,14 +1,3 @@
-///////////////////////////////////////////////////////////////////////////////
-// Hungarian.cpp: Implementation file for Class HungarianAlgorithm.
-// 
-// This is a C++ wrapper with slight modification of a hungarian algorithm implementation by Markus Buehren.
-// The original implementation is a few mex-functions for use in MATLAB, found here:
-// http://www.mathworks.com/matlabcentral/fileexchange/6543-functions-for-the-rectangular-assignment-problem
-// 
-// Both this code and the orignal code are published under the BSD license.
-// by Cong Ma, 2016
-// 
-
 #include <dynamic_gap/gap_estimation/GapAssociator.h>
 
 namespace dynamic_gap 
@@ -39,10 +28,20 @@ namespace dynamic_gap
 		return points;
 	}
 
-	std::vector<std::vector<float>> GapAssociator::obtainDistMatrix(const std::vector<dynamic_gap::Gap *> & currentGaps, 
-																	const std::vector<dynamic_gap::Gap *> & previousGaps) 
+	float GapAssociator::gapPointDist(const int & i, const int & j)
 	{
-		std::vector<std::vector<float>> distMatrix(2 * currentGaps.size(), std::vector<float>(2 * previousGaps.size()));
+		float pointToPointDist = 0;
+		for (int k = 0; k < currentGapPoints.at(i).size(); k++) 
+			pointToPointDist += pow(currentGapPoints.at(i).at(k) - previousGapPoints.at(j).at(k), 2);
+
+		//std::cout << "pointToPointDist: " << pointToPointDist << std::endl;
+		return sqrt(pointToPointDist);
+	}
+
+	Eigen::MatrixXf GapAssociator::obtainDistMatrix(const std::vector<dynamic_gap::Gap *> & currentGaps, 
+													const std::vector<dynamic_gap::Gap *> & previousGaps) 
+	{
+		Eigen::MatrixXf distMatrix(2 * currentGaps.size(), 2 * previousGaps.size());
 		
 		try
 		{
@@ -55,21 +54,16 @@ namespace dynamic_gap
 			// // ROS_INFO_STREAM_NAMED("GapAssociator", "getting current points:");
 			currentGapPoints = obtainGapPoints(currentGaps);
 			
-			//std::cout << "dist matrix size: " << distMatrix.size() << ", " << distMatrix.at(0).size() << std::endl;
+			//std::cout << "dist matrix size: " << distMatrix.rows() << ", " << distMatrix.cols() << std::endl;
 			// populate distance matrix
 			// // ROS_INFO_STREAM_NAMED("GapAssociator", "Distance matrix: ");
-			for (int i = 0; i < distMatrix.size(); i++) 
+			for (int i = 0; i < distMatrix.rows(); i++) 
 			{
-				for (int j = 0; j < distMatrix.at(i).size(); j++) 
+				for (int j = 0; j < distMatrix.cols(); j++) 
 				{
-					float pointToPointDist = 0;
 					//std::cout << i << ", " << j <<std::endl;
-					for (int k = 0; k < currentGapPoints.at(i).size(); k++) 
-						pointToPointDist += pow(currentGapPoints.at(i).at(k) - previousGapPoints.at(j).at(k), 2);
-
-					//std::cout << "pointToPointDist: " << pointToPointDist << std::endl;
-					distMatrix.at(i).at(j) = sqrt(pointToPointDist);
-					// ROS_INFO_STREAM_NAMED("GapAssociator",distMatrix.at(i).at(j) << ", ");
+					distMatrix(i, j) = gapPointDist(i, j);
+					// ROS_INFO_STREAM_NAMED("GapAssociator",distMatrix(i, j) << ", ");
 				}
 				// // ROS_INFO_STREAM_NAMED("GapAssociator", "" << std::endl;
 			}
@@ -87,8 +81,7 @@ namespace dynamic_gap
 	
 	void printGapAssociations(const std::vector<dynamic_gap::Gap *> & currentGaps, 
 							  const std::vector<dynamic_gap::Gap *> & previousGaps, 
-							  const std::vector<int> & association,
-							  const std::vector<std::vector<float>> & distMatrix) 
+							  const std::vector<int> & association) 
 	{
         // std::cout << "printing associations" << std::endl;
 
@@ -124,7 +117,7 @@ namespace dynamic_gap
 					previousGapModelID = previousGaps.at(previousGapIdx)->rightGapPtModel_->getID();				
 				}
 
-                // ROS_INFO_STREAM_NAMED("GapAssociator", "From { pt: (" << prevX << ", " << prevY << "), ID: " << previousGapModelID << "} to { pt: (" << currX << ", " << currY << "), ID: " << currentGapModelID << "} with a distance of " << distMatrix.at(pair.at(0)).at(pair.at(1)));
+                // ROS_INFO_STREAM_NAMED("GapAssociator", "From { pt: (" << prevX << ", " << prevY << "), ID: " << previousGapModelID << "} to { pt: (" << currX << ", " << currY << "), ID: " << currentGapModelID << "} with a distance of " << gapPointDist(pair.at(0), pair.at(1)));
             } else 
 			{
                 // ROS_INFO_STREAM_NAMED("GapAssociator", "From NULL to { pt: (" << currX << ", " << currY << "), ID: " << currentGapModelID << "}");
@@ -135,7 +128,6 @@ namespace dynamic_gap
 
 	void printGapTransition(const std::vector<dynamic_gap::Gap *> & currentGaps, 
 							const std::vector<dynamic_gap::Gap *> & previousGaps,
-							const std::vector<std::vector<float>> & distMatrix, 
 							const std::vector<int> & pair,
 							const bool & validAssociation) 
 	{
@@ -163,7 +155,7 @@ namespace dynamic_gap
 				previousGaps.at(previousGapIdx)->getRCartesian(prevX, prevY);
 				// ROS_INFO_STREAM_NAMED("GapAssociator", "    	accepting transition of index " << previousGaps.at(previousGapIdx)->rightGapPtModel_->getID());
 			}
-			// ROS_INFO_STREAM_NAMED("GapAssociator", "    	from (" << prevX << ", " << prevY << ") to (" << currX << ", " << currY << ") with a distance of " << distMatrix.at(pair.at(0)).at(pair.at(1)));
+			// ROS_INFO_STREAM_NAMED("GapAssociator", "    	from (" << prevX << ", " << prevY << ") to (" << currX << ", " << currY << ") with a distance of " << gapPointDist(pair.at(0), pair.at(1)));
 
 		} else 
 		{
@@ -178,7 +170,7 @@ namespace dynamic_gap
 					previousGaps.at(previousGapIdx)->getRCartesian(prevX, prevY);
 					// ROS_INFO_STREAM_NAMED("GapAssociator", "    	rejecting transition of index " << previousGaps.at(previousGapIdx)->rightGapPtModel_->getID());					
 				}
-				// ROS_INFO_STREAM_NAMED("GapAssociator", "    	from (" << prevX << ", " << prevY << ") to (" << currX << ", " << currY << ") with a distance of " << distMatrix.at(pair.at(0)).at(pair.at(1)));
+				// ROS_INFO_STREAM_NAMED("GapAssociator", "    	from (" << prevX << ", " << prevY << ") to (" << currX << ", " << currY << ") with a distance of " << gapPointDist(pair.at(0), pair.at(1)));
 
 			} else 
 			{
@@ -212,33 +204,45 @@ namespace dynamic_gap
 			currentGaps.at(currentGapIdx)->rightGapPtModel_->initialize("right", currentModelIdx, gapPtX, gapPtY,
 																			scanTime, lastRbtVel, lastRbtAcc);				
 		}
+
+		Estimator * model = (i % 2 == 0) ? currentGaps.at(currentGapIdx)->leftGapPtModel_ : currentGaps.at(currentGapIdx)->rightGapPtModel_;
+		model->josephForm_ = cfg_->gap_est.joseph_form;
+
 		currentModelIdx += 1;
 	}
 
 	void GapAssociator::handOffModel(const std::vector<int> & pair,
 									 const std::vector<dynamic_gap::Gap *> & currentGaps, 
-									 const std::vector<dynamic_gap::Gap *> & previousGaps)
+									 const std::vector<dynamic_gap::Gap *> & previousGaps,
+									 const bool & ownsPreviousGaps)
 	{
 		// // ROS_INFO_STREAM_NAMED("GapAssociator", "					[handOffModel()]");
 		int currentGapIdx = int(std::floor(pair.at(0) / 2.0));
 		int previousGapIdx = int(std::floor(pair.at(1) / 2.0));
 		// // ROS_INFO_STREAM_NAMED("GapAssociator", "					currentGapIdx: " << currentGapIdx << ", previousGapIdx: " << previousGapIdx);
 
-		if (pair.at(0) % 2 == 0)  // curr left
+		dynamic_gap::Gap * currentGap = currentGaps.at(currentGapIdx);
+		dynamic_gap::Gap * previousGap = previousGaps.at(previousGapIdx);
+
+		Estimator * & currentModel = (pair.at(0) % 2 == 0) ? currentGap->leftGapPtModel_ : currentGap->rightGapPtModel_;
+		Estimator * & previousModel = (pair.at(1) % 2 == 0) ? previousGap->leftGapPtModel_ : previousGap->rightGapPtModel_;
+
+		Estimator * handedOffModel = handedOffModels_.at(pair.at(1));
+		if (handedOffModel || !ownsPreviousGaps || !currentGap->ownsModels() || !previousGap->ownsModels())
 		{
-			// // ROS_INFO_STREAM_NAMED("GapAssociator", "						transfering left");
-			currentGaps.at(currentGapIdx)->leftGapPtModel_->transfer((pair.at(1) % 2 == 0) ? *previousGaps.at(previousGapIdx)->leftGapPtModel_ :
-																			  				*previousGaps.at(previousGapIdx)->rightGapPtModel_);			
-			// currentGaps.at(currentGapIdx)->leftGapPtModel_ = (pair.at(1) % 2 == 0) ? previousGaps.at(previousGapIdx)->leftGapPtModel_ :
-			// 																  previousGaps.at(previousGapIdx)->rightGapPtModel_;
-		} else // curr right
+			// previous gap point already handed off (split), previous gaps may still be read elsewhere,
+			// or models are not ours to move: deep copy
+			// // ROS_INFO_STREAM_NAMED("GapAssociator", "						copying model");
+			currentModel->transfer(handedOffModel ? *handedOffModel : *previousModel);
+		} else
 		{
-			// // ROS_INFO_STREAM_NAMED("GapAssociator", "						transfering right");
-			currentGaps.at(currentGapIdx)->rightGapPtModel_->transfer((pair.at(1) % 2 == 0) ? *previousGaps.at(previousGapIdx)->leftGapPtModel_ :
-																			   				 *previousGaps.at(previousGapIdx)->rightGapPtModel_);		
-			// currentGaps.at(currentGapIdx)->rightGapPtModel_ = (pair.at(1) % 2 == 0) ? previousGaps.at(previousGapIdx)->leftGapPtModel_ :
-			// 																   previousGaps.at(previousGapIdx)->rightGapPtModel_;
-		} 		
+			// hand off existing model to current gap, previous gap takes current gap's unused model 
+			// and deletes it along with the rest of the previous gaps
+			// // ROS_INFO_STREAM_NAMED("GapAssociator", "						moving model");
+			std::swap(currentModel, previousModel);
+			currentModel->manip_ = false; // will set to true if we do need to manip
+			handedOffModels_.at(pair.at(1)) = currentModel;
+		}
 	}
 
 	std::string printVectorSingleLine(const std::vector<int> & vector)
@@ -256,9 +260,9 @@ namespace dynamic_gap
 	}
 
 	void GapAssociator::assignModels(const std::vector<int> & association, 
-									 const std::vector<std::vector<float>> & distMatrix, 
 									 std::vector<dynamic_gap::Gap *> & currentGaps, 
 									 const std::vector<dynamic_gap::Gap *> & previousGaps,
+									 const bool & ownsPreviousGaps,
 									 int & currentModelIdx,
                                      const ros::Time & scanTime, 
 									 const std::vector<geometry_msgs::TwistStamped> & intermediateRbtVels, 
@@ -277,7 +281,9 @@ namespace dynamic_gap
 
 			// ROS_INFO_STREAM_NAMED("GapAssociator", "	association: " << printVectorSingleLine(association));
 
-			printGapAssociations(currentGaps, previousGaps, association, distMatrix);
+			printGapAssociations(currentGaps, previousGaps, association);
+
+			handedOffModels_.assign(previousGapPoints.size(), NULL);
 
 			for (int i = 0; i < currentGapPoints.size(); i++) 
 			{
@@ -290,21 +296,21 @@ namespace dynamic_gap
 					{
 						// ROS_INFO_STREAM_NAMED("GapAssociator", "				current point: (" << currentGapPoints.at(i).at(0) << ", " << currentGapPoints.at(i).at(1) << ")");
 						// ROS_INFO_STREAM_NAMED("GapAssociator", "				previous point: (" << previousGapPoints.at(association.at(i)).at(0) << ", " << previousGapPoints.at(association.at(i)).at(1) << ")");
-						// ROS_INFO_STREAM_NAMED("GapAssociator", "				association distance: " << distMatrix.at(pair.at(0)).at(pair.at(1)));
+						// ROS_INFO_STREAM_NAMED("GapAssociator", "				association distance: " << gapPointDist(pair.at(0), pair.at(1)));
 											
 						// ROS_INFO_STREAM_NAMED("GapAssociator", "			checking association distance");
 
 						// checking if current gap pt has association under distance threshold
 						bool assoc_idx_in_range = previousGaps.size() > int(std::floor(pair.at(1) / 2.0));
 
-						bool assoc_dist_in_thresh = (distMatrix.at(pair.at(0)).at(pair.at(1)) <= assocThresh);
+						bool assoc_dist_in_thresh = (gapPointDist(pair.at(0), pair.at(1)) <= assocThresh);
 						validAssociation = assoc_dist_in_thresh;
 						if (validAssociation) 
 						{
 							// ROS_INFO_STREAM_NAMED("GapAssociator", "				association meets distance threshold");
 							//std::cout << "associating" << std::endl;	
 							//std::cout << "distance under threshold" << std::endl;
-							handOffModel(pair, currentGaps, previousGaps);
+							handOffModel(pair, currentGaps, previousGaps, ownsPreviousGaps);
 						} else
 						{
 							// ROS_INFO_STREAM_NAMED("GapAssociator", "				association does not meet distance threshold");
@@ -315,7 +321,7 @@ namespace dynamic_gap
 						// ROS_INFO_STREAM_NAMED("GapAssociator", "			current gap point not associated");
 						instantiateNewModel(i, currentGaps, currentModelIdx, scanTime, intermediateRbtVels, intermediateRbtAccs);				
 					}
-					printGapTransition(currentGaps, previousGaps, distMatrix, pair, validAssociation);
+					printGapTransition(currentGaps, previousGaps, pair, validAssociation);
 				} else
 				{
 					// ROS_INFO_STREAM_NAMED("GapAssociator", "			association does not exist");
@@ -337,7 +343,7 @@ namespace dynamic_gap
 		} catch (...)
 		{
 			ROS_WARN_STREAM_NAMED("GapAssociator", "assignModels failed");
-			ROS_WARN_STREAM_NAMED("GapAssociator", "	distMatrix size: (" << distMatrix.size() << ", " << (distMatrix.size() > 0 ? distMatrix.at(0).size() : 0 ) << ")");
+			ROS_WARN_STREAM_NAMED("GapAssociator", "	gap points size: (" << currentGapPoints.size() << ", " << previousGapPoints.size() << ")");
 			ROS_WARN_STREAM_NAMED("GapAssociator", "	association size: " << association.size());
 	
 			ROS_WARN_STREAM_NAMED("GapAssociator", "	association: " << printVectorSingleLine(association));
@@ -351,12 +357,7 @@ namespace dynamic_gap
 	}
         
 
-	//////////////////////////////////////////////////////////
-	// 	Everything below this was taken from                //
-	// https://github.com/mcximing/hungarian-algorithm-cpp  //
-	//////////////////////////////////////////////////////////
-
-	std::vector<int> GapAssociator::associateGaps(const std::vector< std::vector<float> > & distMatrix) 
+	std::vector<int> GapAssociator::associateGaps(const Eigen::MatrixXf & distMatrix) 
 	{
 		std::vector<int> association;
 
@@ -366,7 +367,7 @@ namespace dynamic_gap
 			std::chrono::steady_clock::time_point associateGapsStartTime = std::chrono::steady_clock::now();
 
 			// std::cout << "obtaining new assignment" << std::endl;
-			if (distMatrix.size() > 0 && distMatrix.at(0).size() > 0) 
+			if (distMatrix.rows() > 0 && distMatrix.cols() > 0) 
 			{
 				//std::cout << "solving" << std::endl;
 				float cost = Solve(distMatrix, association);
@@ -383,378 +384,339 @@ namespace dynamic_gap
 		return association;
     }
 	
-	//********************************************************//
-	// A single function wrapper for solving assignment problem.
-	//********************************************************//
-	float GapAssociator::Solve(const std::vector <std::vector<float> >& DistMatrix, std::vector<int>& Assignment)
+	void GapAssociator::sortGapPointsByBearing(const std::vector< std::vector<float>> & gapPoints,
+											   std::vector<float> & bearings,
+											   std::vector<int> & bearingOrder)
 	{
-		unsigned int nRows = DistMatrix.size();
-		unsigned int nCols = DistMatrix.at(0).size();
-
-		float *distMatrixIn = new float[nRows * nCols];
-		int *assignment = new int[nRows];
-		float cost = 0.0;
-
-		// Fill in the distMatrixIn. Mind the index is "i + nRows * j".
-		// Here the cost matrix of size MxN is defined as a float precision array of N*M elements. 
-		// In the solving functions matrices are seen to be saved MATLAB-internally in row-order.
-		// (i.e. the matrix [1 2; 3 4] will be stored as a vector [1 3 2 4], NOT [1 2 3 4]).
-		for (unsigned int i = 0; i < nRows; i++)
-			for (unsigned int j = 0; j < nCols; j++)
-				distMatrixIn[i + nRows * j] = DistMatrix.at(i).at(j);
-		
-		// call solving function
-		assignmentoptimal(assignment, &cost, distMatrixIn, nRows, nCols);
-
-		Assignment.clear();
-		for (unsigned int r = 0; r < nRows; r++)
-			Assignment.push_back(assignment[r]);
+		bearings.resize(gapPoints.size());
+		bearingOrder.resize(gapPoints.size());
+		for (int i = 0; i < gapPoints.size(); i++)
+		{
+			bearings.at(i) = std::atan2(gapPoints.at(i).at(1), gapPoints.at(i).at(0));
+			bearingOrder.at(i) = i;
+		}
 
-		delete[] distMatrixIn;
-		delete[] assignment;
-		return cost;
+		// gap points come out of detection nearly sorted, so this is close to linear
+		std::sort(bearingOrder.begin(), bearingOrder.end(), 
+				  [&bearings](const int & a, const int & b) { return bearings[a] < bearings[b]; });
 	}
 
-
-	//********************************************************//
-	// Solve optimal solution for assignment problem using Munkres algorithm, also known as Hungarian Algorithm.
-	//********************************************************//
-	void GapAssociator::assignmentoptimal(int *assignment, float *cost, float *distMatrixIn, int nOfRows, int nOfColumns)
+	int GapAssociator::findBandGroup(int node)
 	{
-		float *distMatrix, *distMatrixTemp, *distMatrixEnd, *columnEnd, value, minValue;
-		bool *coveredColumns, *coveredRows, *starMatrix, *newStarMatrix, *primeMatrix;
-		int nOfElements, minDim, row, col;
-
-		/* initialization */
-		*cost = 0;
-		for (row = 0; row<nOfRows; row++)
-			assignment[row] = -1;
-
-		/* generate working copy of distance Matrix */
-		/* check if all matrix elements are positive */
-		nOfElements = nOfRows * nOfColumns;
-		distMatrix = (float *)malloc(nOfElements * sizeof(float));
-		distMatrixEnd = distMatrix + nOfElements;
-
-		for (row = 0; row<nOfElements; row++)
+		while (bandGroupParents_[node] != node)
 		{
-			value = distMatrixIn[row];
-			if (value < 0)
-				std::cerr << "All matrix elements have to be non-negative." << std::endl;
-			distMatrix[row] = value;
+			bandGroupParents_[node] = bandGroupParents_[bandGroupParents_[node]];
+			node = bandGroupParents_[node];
 		}
+		return node;
+	}
 
+	std::vector<int> GapAssociator::associateGapsBanded(const std::vector<dynamic_gap::Gap *> & currentGaps, 
+														const std::vector<dynamic_gap::Gap *> & previousGaps)
+	{
+		std::vector<int> association;
 
-		/* memory allocation */
-		coveredColumns = (bool *)calloc(nOfColumns, sizeof(bool));
-		coveredRows = (bool *)calloc(nOfRows, sizeof(bool));
-		starMatrix = (bool *)calloc(nOfElements, sizeof(bool));
-		primeMatrix = (bool *)calloc(nOfElements, sizeof(bool));
-		newStarMatrix = (bool *)calloc(nOfElements, sizeof(bool)); /* used in step4 */
-
-		/* preliminary steps */
-		if (nOfRows <= nOfColumns)
+		try
 		{
-			minDim = nOfRows;
+			previousGapPoints = obtainGapPoints(previousGaps);
+			currentGapPoints = obtainGapPoints(currentGaps);
+
+			const int nRows = currentGapPoints.size();
+			const int nCols = previousGapPoints.size();
+			if (nRows == 0 || nCols == 0)
+				return association;
+
+			sortGapPointsByBearing(currentGapPoints, currentBearings_, currentBearingOrder_);
+			sortGapPointsByBearing(previousGapPoints, previousBearings_, previousBearingOrder_);
+
+			// band must stay narrower than a full revolution so that each previous point is visited at most once
+			const float bandAngle = std::min(cfg_->gap_assoc.assoc_band_angle, float(0.99 * M_PI));
 
-			for (row = 0; row<nOfRows; row++)
+			// sweep current points in bearing order over previous points unrolled three times 
+			// (shifted by -2pi, 0, +2pi) so that band wraps around at +/- pi
+			auto unrolledBearing = [&](const int & k) 
 			{
-				/* find the smallest element in the row */
-				distMatrixTemp = distMatrix + row;
-				minValue = *distMatrixTemp;
-				distMatrixTemp += nOfRows;
-				while (distMatrixTemp < distMatrixEnd)
-				{
-					value = *distMatrixTemp;
-					if (value < minValue)
-						minValue = value;
-					distMatrixTemp += nOfRows;
-				}
+				return previousBearings_[previousBearingOrder_[k % nCols]] + float(2 * M_PI) * (k / nCols - 1);
+			};
+
+			bandEdgeRows_.clear();
+			bandEdgeCols_.clear();
+			bandEdgeDists_.clear();
 
-				/* subtract the smallest element from each element of the row */
-				distMatrixTemp = distMatrix + row;
-				while (distMatrixTemp < distMatrixEnd)
+			int bandStart = 0, bandEnd = 0;
+			for (const int & i : currentBearingOrder_)
+			{
+				while (bandStart < 3 * nCols && unrolledBearing(bandStart) < currentBearings_[i] - bandAngle)
+					bandStart++;
+				if (bandEnd < bandStart)
+					bandEnd = bandStart;
+				while (bandEnd < 3 * nCols && unrolledBearing(bandEnd) <= currentBearings_[i] + bandAngle)
+					bandEnd++;
+
+				for (int k = bandStart; k < bandEnd; k++)
 				{
-					*distMatrixTemp -= minValue;
-					distMatrixTemp += nOfRows;
+					int j = previousBearingOrder_[k % nCols];
+					float dist = gapPointDist(i, j);
+					if (dist <= assocThresh)
+					{
+						bandEdgeRows_.push_back(i);
+						bandEdgeCols_.push_back(j);
+						bandEdgeDists_.push_back(dist);
+					}
 				}
 			}
 
-			/* Steps 1 and 2a */
-			for (row = 0; row<nOfRows; row++)
-				for (col = 0; col<nOfColumns; col++)
-					if (fabs(distMatrix[row + nOfRows*col]) < DBL_EPSILON)
-						if (!coveredColumns[col])
-						{
-							starMatrix[row + nOfRows*col] = true;
-							coveredColumns[col] = true;
-							break;
-						}
-		}
-		else /* if(nOfRows > nOfColumns) */
-		{
-			minDim = nOfColumns;
+			// group candidate pairs into independent subproblems
+			const int nNodes = nRows + nCols;
+			bandGroupParents_.resize(nNodes);
+			for (int n = 0; n < nNodes; n++)
+				bandGroupParents_[n] = n;
 
-			for (col = 0; col<nOfColumns; col++)
+			for (int e = 0; e < bandEdgeRows_.size(); e++)
 			{
-				/* find the smallest element in the column */
-				distMatrixTemp = distMatrix + nOfRows*col;
-				columnEnd = distMatrixTemp + nOfRows;
+				int rowGroup = findBandGroup(bandEdgeRows_[e]);
+				int colGroup = findBandGroup(nRows + bandEdgeCols_[e]);
+				if (rowGroup != colGroup)
+					bandGroupParents_[rowGroup] = colGroup;
+			}
 
-				minValue = *distMatrixTemp++;
-				while (distMatrixTemp < columnEnd)
+			bandGroupIDs_.assign(nNodes, -1);
+			bandLocalIndices_.resize(nNodes);
+			bandGroupRowCounts_.clear();
+			bandGroupColCounts_.clear();
+			for (int n = 0; n < nNodes; n++)
+			{
+				int root = findBandGroup(n);
+				if (bandGroupIDs_[root] == -1)
 				{
-					value = *distMatrixTemp++;
-					if (value < minValue)
-						minValue = value;
+					bandGroupIDs_[root] = bandGroupRowCounts_.size();
+					bandGroupRowCounts_.push_back(0);
+					bandGroupColCounts_.push_back(0);
 				}
+				int group = bandGroupIDs_[root];
+				bandGroupIDs_[n] = group;
 
-				/* subtract the smallest element from each element of the column */
-				distMatrixTemp = distMatrix + nOfRows*col;
-				while (distMatrixTemp < columnEnd)
-					*distMatrixTemp++ -= minValue;
-			}
+				if (n < nRows)
+					bandLocalIndices_[n] = bandGroupRowCounts_[group]++;
+				else
+					bandLocalIndices_[n] = bandGroupColCounts_[group]++;
 
-			/* Steps 1 and 2a */
-			for (col = 0; col<nOfColumns; col++)
-				for (row = 0; row<nOfRows; row++)
-					if (fabs(distMatrix[row + nOfRows*col]) < DBL_EPSILON)
-						if (!coveredRows[row])
-						{
-							starMatrix[row + nOfRows*col] = true;
-							coveredColumns[col] = true;
-							coveredRows[row] = true;
-							break;
-						}
-			for (row = 0; row<nOfRows; row++)
-				coveredRows[row] = false;
+				if (bandGroupRowCounts_[group] + bandGroupColCounts_[group] > cfg_->gap_assoc.assoc_band_max_points)
+				{
+					// ROS_INFO_STREAM_NAMED("GapAssociator", "association band overflow, falling back to full association");
+					return associateGaps(obtainDistMatrix(currentGaps, previousGaps));
+				}
+			}
 
-		}
+			const int nGroups = bandGroupRowCounts_.size();
+			bandGroupCostOffsets_.resize(nGroups + 1);
+			bandGroupRowOffsets_.resize(nGroups + 1);
+			bandGroupColOffsets_.resize(nGroups + 1);
+			bandGroupCostOffsets_[0] = 0;
+			bandGroupRowOffsets_[0] = 0;
+			bandGroupColOffsets_[0] = 0;
+			for (int g = 0; g < nGroups; g++)
+			{
+				bandGroupCostOffsets_[g + 1] = bandGroupCostOffsets_[g] + bandGroupRowCounts_[g] * bandGroupColCounts_[g];
+				bandGroupRowOffsets_[g + 1] = bandGroupRowOffsets_[g] + bandGroupRowCounts_[g];
+				bandGroupColOffsets_[g + 1] = bandGroupColOffsets_[g] + bandGroupColCounts_[g];
+			}
 
-		/* move to step 2b */
-		step2b(assignment, distMatrix, starMatrix, newStarMatrix, primeMatrix, coveredColumns, coveredRows, nOfRows, nOfColumns, minDim);
+			// pairs outside of band are left forbidden
+			bandCosts_.assign(bandGroupCostOffsets_[nGroups], FLT_MAX);
+			for (int e = 0; e < bandEdgeRows_.size(); e++)
+			{
+				int group = bandGroupIDs_[bandEdgeRows_[e]];
+				int localRow = bandLocalIndices_[bandEdgeRows_[e]];
+				int localCol = bandLocalIndices_[nRows + bandEdgeCols_[e]];
+				bandCosts_[bandGroupCostOffsets_[group] + localRow + bandGroupRowCounts_[group] * localCol] = bandEdgeDists_[e];
+			}
 
-		/* compute cost and remove invalid assignments */
-		computeassignmentcost(assignment, cost, distMatrixIn, nOfRows);
+			bandGroupRows_.resize(nRows);
+			for (int i = 0; i < nRows; i++)
+				bandGroupRows_[bandGroupRowOffsets_[bandGroupIDs_[i]] + bandLocalIndices_[i]] = i;
 
-		/* free allocated memory */
-		free(distMatrix);
-		free(coveredColumns);
-		free(coveredRows);
-		free(starMatrix);
-		free(primeMatrix);
-		free(newStarMatrix);
+			bandGroupCols_.resize(nCols);
+			for (int j = 0; j < nCols; j++)
+				bandGroupCols_[bandGroupColOffsets_[bandGroupIDs_[nRows + j]] + bandLocalIndices_[nRows + j]] = j;
 
-		return;
-	}
+			association.assign(nRows, -1);
+			for (int g = 0; g < nGroups; g++)
+			{
+				int groupRows = bandGroupRowCounts_[g];
+				int groupColumns = bandGroupColCounts_[g];
+				if (groupRows == 0 || groupColumns == 0)
+					continue;
 
-	/********************************************************/
-	void GapAssociator::buildassignmentvector(int *assignment, bool *starMatrix, int nOfRows, int nOfColumns)
-	{
-		int row, col;
+				bandAssignment_.resize(groupRows);
+				solveAssignment(bandCosts_.data() + bandGroupCostOffsets_[g], groupRows, groupColumns, bandAssignment_.data());
 
-		for (row = 0; row<nOfRows; row++)
-			for (col = 0; col<nOfColumns; col++)
-				if (starMatrix[row + nOfRows*col])
+				for (int localRow = 0; localRow < groupRows; localRow++)
 				{
-	#ifdef ONE_INDEXING
-					assignment[row] = col + 1; /* MATLAB-Indexing */
-	#else
-					assignment[row] = col;
-	#endif
-					break;
+					if (bandAssignment_[localRow] >= 0)
+						association[bandGroupRows_[bandGroupRowOffsets_[g] + localRow]] = bandGroupCols_[bandGroupColOffsets_[g] + bandAssignment_[localRow]];
 				}
+			}
+		} catch (...)
+		{
+			ROS_WARN_STREAM_NAMED("GapAssociator", "associateGapsBanded failed");
+		}
+
+		return association;
 	}
 
-	/********************************************************/
-	void GapAssociator::computeassignmentcost(int *assignment, float *cost, float *distMatrix, int nOfRows)
+	float GapAssociator::Solve(const Eigen::MatrixXf & distMatrix, std::vector<int> & assignment)
 	{
-		int row, col;
-
-		for (row = 0; row<nOfRows; row++)
-		{
-			col = assignment[row];
-			if (col >= 0)
-				*cost += distMatrix[row + nOfRows*col];
-		}
+		assignment.resize(distMatrix.rows());
+		return solveAssignment(distMatrix.data(), distMatrix.rows(), distMatrix.cols(), assignment.data());
 	}
 
-	/********************************************************/
-	void GapAssociator::step2a(int *assignment, float *distMatrix, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, int nOfRows, int nOfColumns, int minDim)
+	float GapAssociator::solveAssignment(const float * costs, const int & nOfRows, const int & nOfColumns, int * assignment)
 	{
-		bool *starMatrixTemp, *columnEnd;
-		int col;
+		// costs are column-major, entry (i, j) lives at i + nOfRows * j
+		std::fill(assignment, assignment + nOfRows, -1);
+
+		if (nOfRows <= nOfColumns)
+			return solveShortestAugmentingPaths(costs, 1, nOfRows, nOfRows, nOfColumns, assignment);
 
-		/* cover every column containing a starred zero */
-		for (col = 0; col<nOfColumns; col++)
+		// more rows than columns: solve on transposed view, then invert assignment
+		reserveWorkspace(nOfColumns, nOfRows);
+		std::vector<int> & rowForCol = colForRow_; // reuse workspace, already sized for nOfColumns
+		float cost = solveShortestAugmentingPaths(costs, nOfRows, 1, nOfColumns, nOfRows, rowForCol.data());
+		for (int j = 0; j < nOfColumns; j++)
 		{
-			starMatrixTemp = starMatrix + nOfRows*col;
-			columnEnd = starMatrixTemp + nOfRows;
-			while (starMatrixTemp < columnEnd){
-				if (*starMatrixTemp++)
-				{
-					coveredColumns[col] = true;
-					break;
-				}
-			}
+			if (rowForCol[j] >= 0)
+				assignment[rowForCol[j]] = j;
 		}
 
-		/* move to step 3 */
-		step2b(assignment, distMatrix, starMatrix, newStarMatrix, primeMatrix, coveredColumns, coveredRows, nOfRows, nOfColumns, minDim);
+		return cost;
 	}
 
-	/********************************************************/
-	void GapAssociator::step2b(int *assignment, float *distMatrix, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, int nOfRows, int nOfColumns, int minDim)
+	void GapAssociator::reserveWorkspace(const int & nOfRows, const int & nOfColumns)
 	{
-		int col, nOfCoveredColumns;
-
-		/* count covered columns */
-		nOfCoveredColumns = 0;
-		for (col = 0; col<nOfColumns; col++)
-			if (coveredColumns[col])
-				nOfCoveredColumns++;
-
-		if (nOfCoveredColumns == minDim)
+		if (rowPotentials_.size() < nOfRows)
 		{
-			/* algorithm finished */
-			buildassignmentvector(assignment, starMatrix, nOfRows, nOfColumns);
+			rowPotentials_.resize(nOfRows);
+			colForRow_.resize(nOfRows);
+			scannedRows_.resize(nOfRows);
 		}
-		else
+
+		if (colPotentials_.size() < nOfColumns)
 		{
-			/* move to step 3 */
-			step3(assignment, distMatrix, starMatrix, newStarMatrix, primeMatrix, coveredColumns, coveredRows, nOfRows, nOfColumns, minDim);
+			colPotentials_.resize(nOfColumns);
+			shortestPathCosts_.resize(nOfColumns);
+			pathRows_.resize(nOfColumns);
+			rowForCol_.resize(nOfColumns);
+			remainingCols_.resize(nOfColumns);
+			scannedCols_.resize(nOfColumns);
 		}
-
 	}
 
-	/********************************************************/
-	void GapAssociator::step3(int *assignment, float *distMatrix, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, int nOfRows, int nOfColumns, int minDim)
+	float GapAssociator::solveShortestAugmentingPaths(const float * costs, const int & rowStride, const int & colStride, 
+													  const int & nOfRows, const int & nOfColumns, int * colForRow)
 	{
-		bool zerosFound;
-		int row, col, starCol;
+		reserveWorkspace(nOfRows, nOfColumns);
+
+		// forbidden entries are priced so that any assignment using fewer of them is cheaper,
+		// so the solver first maximizes the number of allowed pairs and then minimizes their distance
+		const float forbiddenCost = assocThresh * (nOfRows + 1) + 1.0;
 
-		zerosFound = true;
-		while (zerosFound)
+		std::fill(rowPotentials_.begin(), rowPotentials_.begin() + nOfRows, 0.0);
+		std::fill(colPotentials_.begin(), colPotentials_.begin() + nOfColumns, 0.0);
+		std::fill(colForRow, colForRow + nOfRows, -1);
+		std::fill(rowForCol_.begin(), rowForCol_.begin() + nOfColumns, -1);
+
+		for (int currentRow = 0; currentRow < nOfRows; currentRow++)
 		{
-			zerosFound = false;
-			for (col = 0; col<nOfColumns; col++)
-				if (!coveredColumns[col])
-					for (row = 0; row<nOfRows; row++)
-						if ((!coveredRows[row]) && (fabs(distMatrix[row + nOfRows*col]) < DBL_EPSILON))
-						{
-							/* prime zero */
-							primeMatrix[row + nOfRows*col] = true;
-
-							/* find starred zero in current row */
-							for (starCol = 0; starCol<nOfColumns; starCol++)
-								if (starMatrix[row + nOfRows*starCol])
-									break;
-
-							if (starCol == nOfColumns) /* no starred zero found */
-							{
-								/* move to step 4 */
-								step4(assignment, distMatrix, starMatrix, newStarMatrix, primeMatrix, coveredColumns, coveredRows, nOfRows, nOfColumns, minDim, row, col);
-								return;
-							}
-							else
-							{
-								coveredRows[row] = true;
-								coveredColumns[starCol] = false;
-								zerosFound = true;
-								break;
-							}
-						}
-		}
+			// Dijkstra over alternating paths from currentRow to an unassigned column
+			std::fill(scannedRows_.begin(), scannedRows_.begin() + nOfRows, false);
+			std::fill(scannedCols_.begin(), scannedCols_.begin() + nOfColumns, false);
+			std::fill(shortestPathCosts_.begin(), shortestPathCosts_.begin() + nOfColumns, FLT_MAX);
+
+			int nOfRemaining = nOfColumns;
+			for (int it = 0; it < nOfColumns; it++)
+				remainingCols_[it] = nOfColumns - it - 1;
+
+			float minValue = 0.0;
+			int sink = -1;
+			int row = currentRow;
+			while (sink == -1)
+			{
+				scannedRows_[row] = true;
 
-		/* move to step 5 */
-		step5(assignment, distMatrix, starMatrix, newStarMatrix, primeMatrix, coveredColumns, coveredRows, nOfRows, nOfColumns, minDim);
-	}
+				int lowestIt = -1;
+				float lowestCost = FLT_MAX;
+				for (int it = 0; it < nOfRemaining; it++)
+				{
+					int col = remainingCols_[it];
 
-	/********************************************************/
-	void GapAssociator::step4(int *assignment, float *distMatrix, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, int nOfRows, int nOfColumns, int minDim, int row, int col)
-	{
-		int n, starRow, starCol, primeRow, primeCol;
-		int nOfElements = nOfRows*nOfColumns;
+					float cost = costs[row * rowStride + col * colStride];
+					if (cost > assocThresh)
+						cost = forbiddenCost;
 
-		/* generate temporary copy of starMatrix */
-		for (n = 0; n<nOfElements; n++)
-			newStarMatrix[n] = starMatrix[n];
+					float reducedPathCost = minValue + cost - rowPotentials_[row] - colPotentials_[col];
+					if (reducedPathCost < shortestPathCosts_[col])
+					{
+						pathRows_[col] = row;
+						shortestPathCosts_[col] = reducedPathCost;
+					}
 
-		/* star current zero */
-		newStarMatrix[row + nOfRows*col] = true;
+					// prefer unassigned columns on ties to finish augmentation early
+					if (shortestPathCosts_[col] < lowestCost || 
+						(shortestPathCosts_[col] == lowestCost && rowForCol_[col] == -1))
+					{
+						lowestCost = shortestPathCosts_[col];
+						lowestIt = it;
+					}
+				}
 
-		/* find starred zero in current column */
-		starCol = col;
-		for (starRow = 0; starRow<nOfRows; starRow++)
-			if (starMatrix[starRow + nOfRows*starCol])
-				break;
+				minValue = lowestCost;
+				int col = remainingCols_[lowestIt];
+				scannedCols_[col] = true;
+				remainingCols_[lowestIt] = remainingCols_[--nOfRemaining];
 
-		while (starRow<nOfRows)
-		{
-			/* unstar the starred zero */
-			newStarMatrix[starRow + nOfRows*starCol] = false;
+				if (rowForCol_[col] == -1)
+					sink = col;
+				else
+					row = rowForCol_[col];
+			}
 
-			/* find primed zero in current row */
-			primeRow = starRow;
-			for (primeCol = 0; primeCol<nOfColumns; primeCol++)
-				if (primeMatrix[primeRow + nOfRows*primeCol])
-					break;
+			// update dual variables
+			rowPotentials_[currentRow] += minValue;
+			for (int i = 0; i < nOfRows; i++)
+			{
+				if (scannedRows_[i] && i != currentRow)
+					rowPotentials_[i] += minValue - shortestPathCosts_[colForRow[i]];
+			}
 
-			/* star the primed zero */
-			newStarMatrix[primeRow + nOfRows*primeCol] = true;
+			for (int j = 0; j < nOfColumns; j++)
+			{
+				if (scannedCols_[j])
+					colPotentials_[j] -= minValue - shortestPathCosts_[j];
+			}
 
-			/* find starred zero in current column */
-			starCol = primeCol;
-			for (starRow = 0; starRow<nOfRows; starRow++)
-				if (starMatrix[starRow + nOfRows*starCol])
+			// augment along path back to currentRow
+			int col = sink;
+			while (true)
+			{
+				row = pathRows_[col];
+				rowForCol_[col] = row;
+				std::swap(colForRow[row], col);
+				if (row == currentRow)
 					break;
+			}
 		}
 
-		/* use temporary copy as new starMatrix */
-		/* delete all primes, uncover all rows */
-		for (n = 0; n<nOfElements; n++)
+		float totalCost = 0.0;
+		for (int row = 0; row < nOfRows; row++)
 		{
-			primeMatrix[n] = false;
-			starMatrix[n] = newStarMatrix[n];
+			float cost = costs[row * rowStride + colForRow[row] * colStride];
+			if (cost > assocThresh)
+				colForRow[row] = -1;
+			else
+				totalCost += cost;
 		}
-		for (n = 0; n<nOfRows; n++)
-			coveredRows[n] = false;
-
-		/* move to step 2a */
-		step2a(assignment, distMatrix, starMatrix, newStarMatrix, primeMatrix, coveredColumns, coveredRows, nOfRows, nOfColumns, minDim);
-	}
-
-	/********************************************************/
-	void GapAssociator::step5(int *assignment, float *distMatrix, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, int nOfRows, int nOfColumns, int minDim)
-	{
-		float h, value;
-		int row, col;
-
-		/* find smallest uncovered element h */
-		h = DBL_MAX;
-		for (row = 0; row<nOfRows; row++)
-			if (!coveredRows[row])
-				for (col = 0; col<nOfColumns; col++)
-					if (!coveredColumns[col])
-					{
-						value = distMatrix[row + nOfRows*col];
-						if (value < h)
-							h = value;
-					}
-
-		/* add h to each covered row */
-		for (row = 0; row<nOfRows; row++)
-			if (coveredRows[row])
-				for (col = 0; col<nOfColumns; col++)
-					distMatrix[row + nOfRows*col] += h;
-
-		/* subtract h from each uncovered column */
-		for (col = 0; col<nOfColumns; col++)
-			if (!coveredColumns[col])
-				for (row = 0; row<nOfRows; row++)
-					distMatrix[row + nOfRows*col] -= h;
 
-		/* move to step 3 */
-		step3(assignment, distMatrix, starMatrix, newStarMatrix, primeMatrix, coveredColumns, coveredRows, nOfRows, nOfColumns, minDim);
+		return totalCost;
 	}
 }
@@ -0,0 +1,71 @@
+#include <dynamic_gap/gap_estimation/GapTrackRegistry.h>
+
+namespace dynamic_gap
+{
+    void GapTrackRegistry::registerTracks(const std::vector<dynamic_gap::Gap *> & rawGaps)
+    {
+        try
+        {
+            // clear out previous scan's entries only
+            for (const int & idx : registeredIndices_)
+            {
+                leftTracks_.at(idx) = NULL;
+                rightTracks_.at(idx) = NULL;
+            }
+            registeredIndices_.clear();
+
+            int trackCount = std::max(cfg_->scan.full_scan, int(leftTracks_.size()));
+            for (dynamic_gap::Gap * rawGap : rawGaps)
+                trackCount = std::max(trackCount, std::max(rawGap->LIdx(), rawGap->RIdx()) + 1);
+            
+            if (trackCount > leftTracks_.size())
+            {
+                leftTracks_.resize(trackCount, NULL);
+                rightTracks_.resize(trackCount, NULL);
+            }
+
+            for (dynamic_gap::Gap * rawGap : rawGaps)
+            {
+                leftTracks_.at(rawGap->LIdx()) = rawGap->leftGapPtModel_;
+                rightTracks_.at(rawGap->RIdx()) = rawGap->rightGapPtModel_;
+                registeredIndices_.push_back(rawGap->LIdx());
+                registeredIndices_.push_back(rawGap->RIdx());
+            }
+        } catch (...)
+        {
+            ROS_WARN_STREAM_NAMED("GapEstimation", "registerTracks failed");
+        }
+    }
+
+    void GapTrackRegistry::bindTracks(const std::vector<dynamic_gap::Gap *> & simplifiedGaps)
+    {
+        try
+        {
+            Estimator * leftTrack = NULL;
+            Estimator * rightTrack = NULL;
+            for (dynamic_gap::Gap * simplifiedGap : simplifiedGaps)
+            {
+                leftTrack = (simplifiedGap->LIdx() < leftTracks_.size()) ? leftTracks_.at(simplifiedGap->LIdx()) : NULL;
+                rightTrack = (simplifiedGap->RIdx() < rightTracks_.size()) ? rightTracks_.at(simplifiedGap->RIdx()) : NULL;
+
+                // simplified gap points always come from raw gap points, but keep existing models if not
+                if (!leftTrack)
+                {
+                    ROS_WARN_STREAM_NAMED("GapEstimation", "no tracked left gap point at index " << simplifiedGap->LIdx());
+                    leftTrack = simplifiedGap->leftGapPtModel_;
+                }
+
+                if (!rightTrack)
+                {
+                    ROS_WARN_STREAM_NAMED("GapEstimation", "no tracked right gap point at index " << simplifiedGap->RIdx());
+                    rightTrack = simplifiedGap->rightGapPtModel_;
+                }
+
+                simplifiedGap->shareModels(leftTrack, rightTrack);
+            }
+        } catch (...)
+        {
+            ROS_WARN_STREAM_NAMED("GapEstimation", "bindTracks failed");
+        }
+    }
+}
@@ -0,0 +1,223 @@
+#include <dynamic_gap/gap_estimation/KalmanFilterBatch.h>
+
+namespace dynamic_gap
+{
+    void KalmanFilterBatch::add(RotatingFrameCartesianKalmanFilter * filter, const Eigen::Vector2f & measurement)
+    {
+        filters_.push_back(filter);
+        measurements_.push_back(measurement);
+    }
+
+    void KalmanFilterBatch::update(const EgoMotionTimeline & egoMotionTimeline, const ros::Time & tUpdate, WorkerPool * workerPool)
+    {
+        int nFilters = filters_.size();
+
+        if (nFilters > 0)
+        {
+            reserveWorkspace(nFilters);
+
+            // each chunk of rows runs the whole update on its own, rows never mix
+            workerPool->parallelFor(nFilters, rowsPerChunk_, [&](const int & begin, const int & end)
+            {
+                int nRows = end - begin;
+
+                gather(begin, nRows);
+
+                predict(egoMotionTimeline, begin, nRows);
+
+                correct(begin, nRows);
+
+                scatter(egoMotionTimeline, tUpdate, begin, nRows);
+            });
+        }
+
+        clear();
+    }
+
+    void KalmanFilterBatch::clear()
+    {
+        filters_.clear();
+        measurements_.clear();
+    }
+
+    void KalmanFilterBatch::reserveWorkspace(const int & nFilters)
+    {
+        if (predictedStates_.rows() >= nFilters)
+            return;
+
+        predictedStates_.resize(nFilters, 4);
+        correctedStates_.resize(nFilters, 4);
+        stateScratch_.resize(nFilters, 4);
+        predictedCovariances_.resize(nFilters, 16);
+        correctedCovariances_.resize(nFilters, 16);
+        covarianceScratch_.resize(nFilters, 16);
+        gains_.resize(nFilters, 8);
+        measurementNoises_.resize(nFilters, 4);
+        noisyMeasurements_.resize(nFilters, 2);
+        innovationInverses_.resize(nFilters, 4);
+        josephForms_.resize(nFilters);
+    }
+
+    void KalmanFilterBatch::gather(const int & begin, const int & nRows)
+    {
+        for (int j = begin; j < begin + nRows; j++)
+        {
+            RotatingFrameCartesianKalmanFilter * filter = filters_[j];
+
+            filter->xTilde_ = measurements_[j];
+            Eigen::Vector2f noisyMeasurement = filter->perturbMeasurement(filter->xTilde_);
+
+            josephForms_[j] = filter->josephForm_;
+
+            for (int r = 0; r < 4; r++)
+            {
+                predictedStates_(j, r) = filter->x_hat_kmin1_plus_[r];
+
+                for (int c = 0; c < 4; c++)
+                    predictedCovariances_(j, r + 4*c) = filter->P_kmin1_plus_(r, c);
+
+                for (int c = 0; c < 2; c++)
+                    gains_(j, r + 4*c) = filter->G_k_(r, c);
+            }
+
+            for (int r = 0; r < 2; r++)
+            {
+                noisyMeasurements_(j, r) = noisyMeasurement[r];
+
+                for (int c = 0; c < 2; c++)
+                    measurementNoises_(j, r + 2*c) = filter->R_k_(r, c);
+            }
+        }
+    }
+
+    void KalmanFilterBatch::predict(const EgoMotionTimeline & egoMotionTimeline, const int & begin, const int & nRows)
+    {
+        auto x = [&](Eigen::ArrayXXf & states, const int & r) { return states.col(r).segment(begin, nRows); };
+        auto P = [&](Eigen::ArrayXXf & covariances, const int & r, const int & c) { return covariances.col(r + 4*c).segment(begin, nRows); };
+
+        const std::vector<geometry_msgs::TwistStamped> & rbtVels = egoMotionTimeline.rbtVels();
+        const std::vector<geometry_msgs::TwistStamped> & rbtAccs = egoMotionTimeline.rbtAccs();
+
+        for (int i = 0; i < (egoMotionTimeline.size() - 1); i++)
+        {
+            float dt = egoMotionTimeline.dt(i);
+            float ang_vel_ego = rbtVels[i].twist.angular.z;
+            float vdot_x_body = rbtAccs[i].twist.linear.x;
+            float vdot_y_body = rbtAccs[i].twist.linear.y;
+
+            // discrete euler update of states
+            x(stateScratch_, 0) = x(predictedStates_, 0) + (x(predictedStates_, 2) + ang_vel_ego*x(predictedStates_, 1))*dt;
+            x(stateScratch_, 1) = x(predictedStates_, 1) + (x(predictedStates_, 3) - ang_vel_ego*x(predictedStates_, 0))*dt;
+            x(stateScratch_, 2) = x(predictedStates_, 2) + (x(predictedStates_, 3)*ang_vel_ego - vdot_x_body)*dt;
+            x(stateScratch_, 3) = x(predictedStates_, 3) + (-x(predictedStates_, 2)*ang_vel_ego - vdot_y_body)*dt;
+            for (int r = 0; r < 4; r++)
+                x(predictedStates_, r) = x(stateScratch_, r);
+
+            // P = STM * P * STM^T + dQ
+            const Eigen::Matrix4f & STM = egoMotionTimeline.STM(i);
+            const Eigen::Matrix4f & dQ = egoMotionTimeline.dQ(i);
+
+            for (int r = 0; r < 4; r++)
+            {
+                for (int c = 0; c < 4; c++)
+                {
+                    P(covarianceScratch_, r, c) = STM(r, 0)*P(predictedCovariances_, 0, c) + STM(r, 1)*P(predictedCovariances_, 1, c) +
+                                                  STM(r, 2)*P(predictedCovariances_, 2, c) + STM(r, 3)*P(predictedCovariances_, 3, c);
+                }
+            }
+
+            for (int r = 0; r < 4; r++)
+            {
+                for (int c = 0; c < 4; c++)
+                {
+                    P(predictedCovariances_, r, c) = P(covarianceScratch_, r, 0)*STM(c, 0) + P(covarianceScratch_, r, 1)*STM(c, 1) +
+                                                     P(covarianceScratch_, r, 2)*STM(c, 2) + P(covarianceScratch_, r, 3)*STM(c, 3) + dQ(r, c);
+                }
+            }
+        }
+    }
+
+    void KalmanFilterBatch::correct(const int & begin, const int & nRows)
+    {
+        auto col = [&](Eigen::ArrayXXf & entries, const int & idx) { return entries.col(idx).segment(begin, nRows); };
+
+        // innovation (H selects position), scratch states are free after prediction
+        col(stateScratch_, 0) = col(noisyMeasurements_, 0) - col(predictedStates_, 0);
+        col(stateScratch_, 1) = col(noisyMeasurements_, 1) - col(predictedStates_, 1);
+
+        // state is corrected with gain from previous update, as in scalar filter
+        for (int r = 0; r < 4; r++)
+            col(correctedStates_, r) = col(predictedStates_, r) + col(gains_, r)*col(stateScratch_, 0) + col(gains_, r + 4)*col(stateScratch_, 1);
+
+        // closed-form inverse of innovation covariance S = H P H^T + R
+        col(stateScratch_, 2) = 1.0f / ((col(predictedCovariances_, 0) + col(measurementNoises_, 0))*(col(predictedCovariances_, 5) + col(measurementNoises_, 3)) - 
+                                       (col(predictedCovariances_, 4) + col(measurementNoises_, 2))*(col(predictedCovariances_, 1) + col(measurementNoises_, 1)));
+        col(innovationInverses_, 0) = (col(predictedCovariances_, 5) + col(measurementNoises_, 3))*col(stateScratch_, 2);
+        col(innovationInverses_, 1) = -(col(predictedCovariances_, 1) + col(measurementNoises_, 1))*col(stateScratch_, 2);
+        col(innovationInverses_, 2) = -(col(predictedCovariances_, 4) + col(measurementNoises_, 2))*col(stateScratch_, 2);
+        col(innovationInverses_, 3) = (col(predictedCovariances_, 0) + col(measurementNoises_, 0))*col(stateScratch_, 2);
+
+        // G = P H^T S^-1
+        for (int r = 0; r < 4; r++)
+        {
+            for (int c = 0; c < 2; c++)
+                col(gains_, r + 4*c) = col(predictedCovariances_, r)*col(innovationInverses_, 2*c) + col(predictedCovariances_, r + 4)*col(innovationInverses_, 1 + 2*c);
+        }
+
+        // P = (I - G H) P
+        for (int r = 0; r < 4; r++)
+        {
+            for (int c = 0; c < 4; c++)
+                col(correctedCovariances_, r + 4*c) = col(predictedCovariances_, r + 4*c) - col(gains_, r)*col(predictedCovariances_, 4*c) - col(gains_, r + 4)*col(predictedCovariances_, 1 + 4*c);
+        }
+
+        // Joseph form: P = (I - G H) P (I - G H)^T + G R G^T, where (I - G H) P is already held in corrected covariances.
+        // Covariance mode is set per filter, so Joseph covariances are only kept in rows of filters that use it
+        auto josephForms = josephForms_.segment(begin, nRows);
+        if (josephForms.any())
+        {
+            for (int r = 0; r < 4; r++)
+            {
+                for (int c = 0; c < 4; c++)
+                {
+                    col(covarianceScratch_, r + 4*c) = col(correctedCovariances_, r + 4*c) - col(correctedCovariances_, r)*col(gains_, c) - col(correctedCovariances_, r + 4)*col(gains_, c + 4) +
+                                                       col(gains_, r)*(col(measurementNoises_, 0)*col(gains_, c) + col(measurementNoises_, 2)*col(gains_, c + 4)) +
+                                                       col(gains_, r + 4)*(col(measurementNoises_, 1)*col(gains_, c) + col(measurementNoises_, 3)*col(gains_, c + 4));
+                }
+            }
+
+            for (int idx = 0; idx < 16; idx++)
+                col(correctedCovariances_, idx) = josephForms.select(col(covarianceScratch_, idx), col(correctedCovariances_, idx));
+        }
+    }
+
+    void KalmanFilterBatch::scatter(const EgoMotionTimeline & egoMotionTimeline, const ros::Time & tUpdate, const int & begin, const int & nRows)
+    {
+        for (int j = begin; j < begin + nRows; j++)
+        {
+            RotatingFrameCartesianKalmanFilter * filter = filters_[j];
+
+            for (int r = 0; r < 4; r++)
+            {
+                filter->x_hat_k_minus_[r] = predictedStates_(j, r);
+                filter->x_hat_k_plus_[r] = correctedStates_(j, r);
+
+                for (int c = 0; c < 4; c++)
+                {
+                    filter->P_k_minus_(r, c) = predictedCovariances_(j, r + 4*c);
+                    filter->P_k_plus_(r, c) = correctedCovariances_(j, r + 4*c);
+                }
+
+                for (int c = 0; c < 2; c++)
+                    filter->G_k_(r, c) = gains_(j, r + 4*c);
+            }
+
+            filter->x_hat_kmin1_plus_ = filter->x_hat_k_plus_;
+            filter->P_kmin1_plus_ = filter->P_k_plus_;
+            filter->tLastUpdate_ = tUpdate;
+
+            filter->lastRbtVel_ = egoMotionTimeline.rbtVels().back();
+            filter->lastRbtAcc_ = egoMotionTimeline.rbtAccs().back();
+        }
+    }
+}
@@ -57,37 +57,32 @@ namespace dynamic_gap
     }
 
     void PerfectEstimator::update(const Eigen::Vector2f & measurement, 
-                                    const std::vector<geometry_msgs::TwistStamped> & intermediateRbtVels, 
-                                    const std::vector<geometry_msgs::TwistStamped> & intermediateRbtAccs, 
-                                    const std::map<std::string, geometry_msgs::Pose> & agentPoses,
-                                    const std::map<std::string, geometry_msgs::Vector3Stamped> & agentVels,
+                                    const EgoMotionTimeline & egoMotionTimeline, 
+                                    const AgentTable & agents,
                                     const ros::Time & tUpdate)
         {
-        
-        agentPoses_ = agentPoses;
-        agentVels_ = agentVels;
 
         // acceleration and velocity come in wrt robot frame
-        intermediateRbtVels_ = intermediateRbtVels;
-        intermediateRbtAccs_ = intermediateRbtAccs;
+        const std::vector<geometry_msgs::TwistStamped> & intermediateRbtVels = egoMotionTimeline.rawRbtVels();
+        const std::vector<geometry_msgs::TwistStamped> & intermediateRbtAccs = egoMotionTimeline.rawRbtAccs();
         // lastRbtVel_ = _current_rbt_vel;
         // lastRbtAcc_ = _current_rbt_acc;
 
         // dt = scan_dt;
         // life_time += dt;
 
-        // inter_dt = (dt / intermediateRbtVels_.size());
+        // inter_dt = (dt / intermediateRbtVels.size());
 
-        if (intermediateRbtVels_.size() == 0 || intermediateRbtAccs_.size() == 0)
+        if (intermediateRbtVels.size() == 0 || intermediateRbtAccs.size() == 0)
         {
-            ROS_WARN_STREAM_COND_NAMED(intermediateRbtVels_.size() == 0, "    GapEstimation", "intermediateRbtVels_ is empty, no update");
-            ROS_WARN_STREAM_COND_NAMED(intermediateRbtAccs_.size() == 0, "    GapEstimation", "intermediateRbtAccs_ is empty, no update");
+            ROS_WARN_STREAM_COND_NAMED(intermediateRbtVels.size() == 0, "    GapEstimation", "intermediateRbtVels is empty, no update");
+            ROS_WARN_STREAM_COND_NAMED(intermediateRbtAccs.size() == 0, "    GapEstimation", "intermediateRbtAccs is empty, no update");
             return;
         }
 
-        if (intermediateRbtVels_.size() != intermediateRbtAccs_.size())
+        if (intermediateRbtVels.size() != intermediateRbtAccs.size())
         {
-            // ROS_INFO_STREAM_NAMED("GapEstimation", "intermediateRbtVels_ is of size " << intermediateRbtVels_.size() << " while intermediateRbtAccs_ is of size " << intermediateRbtAccs_.size());
+            // ROS_INFO_STREAM_NAMED("GapEstimation", "intermediateRbtVels is of size " << intermediateRbtVels.size() << " while intermediateRbtAccs is of size " << intermediateRbtAccs.size());
             return;
         }
 
@@ -95,24 +90,21 @@ namespace dynamic_gap
         // ROS_INFO_STREAM_NAMED("GapEstimation", "x_hat_kmin1_plus_: " << x_hat_kmin1_plus_[0] << ", " << x_hat_kmin1_plus_[1] << ", " << x_hat_kmin1_plus_[2] << ", " << x_hat_kmin1_plus_[3]);
         // ROS_INFO_STREAM_NAMED("GapEstimation", "current_rbt_vel, x_lin: " << lastRbtVel_.twist.linear.x << ", y_lin: " << lastRbtVel_.twist.linear.y << ", z_ang: " << lastRbtVel_.twist.angular.z);
 
-        processEgoRobotVelsAndAccs(tUpdate);
+        const EgoMotionTimeline & timeline = alignEgoMotionTimeline(egoMotionTimeline, tUpdate);
 
         xTilde_ = measurement;
 
         // ROS_INFO_STREAM_NAMED("GapEstimation", "linear ego vel: " << lastRbtVel_.twist.linear.x << ", " << lastRbtVel_.twist.linear.y << ", angular ego vel: " << lastRbtVel_.twist.angular.z);
         // ROS_INFO_STREAM_NAMED("GapEstimation", "linear ego acceleration: " << lastRbtAcc_.twist.linear.x << ", " << lastRbtAcc_.twist.linear.y << ", angular ego acc: " << lastRbtAcc_.twist.angular.z);
 
-        x_hat_k_plus_ = updateStateFromEnv();
+        x_hat_k_plus_ = updateStateFromEnv(agents);
 
         x_hat_kmin1_plus_ = x_hat_k_plus_;
         P_kmin1_plus_ = P_k_plus_;
         tLastUpdate_ = tUpdate;
         
-        if (intermediateRbtVels_.size() > 0)
-            lastRbtVel_ = intermediateRbtVels_.back();
-        
-        if (intermediateRbtAccs_.size() > 0)
-            lastRbtAcc_ = intermediateRbtAccs_.back();
+        lastRbtVel_ = timeline.rbtVels().back();
+        lastRbtAcc_ = timeline.rbtAccs().back();
 
         // ROS_INFO_STREAM_NAMED("GapEstimation", "x_hat_k_plus_: " << x_hat_k_plus_[0] << ", " << x_hat_k_plus_[1] << ", " << x_hat_k_plus_[2] << ", " << x_hat_k_plus_[3]);       
         // ROS_INFO_STREAM_NAMED("GapEstimation", "-----------");
@@ -120,7 +112,7 @@ namespace dynamic_gap
         return;
     }    
 
-    Eigen::Vector4f PerfectEstimator::updateStateFromEnv() 
+    Eigen::Vector4f PerfectEstimator::updateStateFromEnv(const AgentTable & agents) 
     {
         // x state:
         // [r_x, r_y, v_x, v_y]
@@ -134,27 +126,12 @@ namespace dynamic_gap
         return_x[0] = xTilde_[0];
         return_x[1] = xTilde_[1];
         
-        float robot_i_odom_dist = 0.0;
-        float min_dist = std::numeric_limits<float>::infinity();
-        std::string min_key = "N/A";
-        std::map<std::string, geometry_msgs::Pose>::iterator itr;
-        for (itr = agentPoses_.begin(); itr != agentPoses_.end(); ++itr) 
-        {
-            geometry_msgs::Pose agentPose = itr->second;
-            robot_i_odom_dist = sqrt(pow(agentPose.position.x - x_hat_kmin1_plus_[0], 2) + 
-                                     pow(agentPose.position.y - x_hat_kmin1_plus_[1], 2));
-            
-            if (robot_i_odom_dist < min_dist) 
-            {
-                min_dist = robot_i_odom_dist;
-                min_key = itr->first;
-            }
-        }
+        int nearestAgent = agents.findNearestAgent(x_hat_kmin1_plus_[0], x_hat_kmin1_plus_[1], min_dist_thresh);
         
-        ROS_INFO_STREAM_COND_NAMED(agentPoses_.size() > 0, "GapEstimation", "closest odom: " << agentPoses_[min_key].position.x << ", " 
-                                                                                             << agentPoses_[min_key].position.y);
+        ROS_INFO_STREAM_COND_NAMED(nearestAgent >= 0, "GapEstimation", "closest odom: " << agents.pose(nearestAgent).position.x << ", " 
+                                                                                         << agents.pose(nearestAgent).position.y);
         
-        if (min_dist < min_dist_thresh) 
+        if (nearestAgent >= 0) 
         {    
             // ROS_INFO_STREAM_NAMED("GapEstimation", "attaching to odom");
             
@@ -163,8 +140,8 @@ namespace dynamic_gap
             // xTilde_[1] = agentPoses_[min_idx].position.y;
             // return_x[0] = xTilde_[0];
             // return_x[1] = xTilde_[1];
-            return_x[2] = agentVels_[min_key].vector.x - lastRbtVel_.twist.linear.x;
-            return_x[3] = agentVels_[min_key].vector.y - lastRbtVel_.twist.linear.y;
+            return_x[2] = agents.vel(nearestAgent).vector.x - lastRbtVel_.twist.linear.x;
+            return_x[3] = agents.vel(nearestAgent).vector.y - lastRbtVel_.twist.linear.y;
         } else 
         {    
             // ROS_INFO_STREAM_NAMED("GapEstimation", "attaching to nothing");
@@ -9,12 +9,9 @@ namespace dynamic_gap
         H_transpose_ = H_.transpose();
         
         R_scalar = 0.1; // low value: velocities become very sensitive
-        Q_scalar = 0.5;
 
-        Q_temp_ << 0.0, 0.0, 0.0, 0.0,
-               0.0, 0.0, 0.0, 0.0,
-               0.0, 0.0, Q_scalar, 0.0,
-               0.0, 0.0, 0.0, Q_scalar;
+        Q_temp_ = initialQ();
+        Q_scalar = Q_temp_(2, 2);
         Q_k_ = Q_temp_;
         R_temp_ << R_scalar, 0.0,
                 0.0, R_scalar;
@@ -25,18 +22,24 @@ namespace dynamic_gap
                 1.0, 1.0,
                 1.0, 1.0;
 
-        A_ << 0.0, 0.0, 0.0, 0.0,
-              0.0, 0.0, 0.0, 0.0,
-              0.0, 0.0, 0.0, 0.0,
-              0.0, 0.0, 0.0, 0.0;
-        STM_ = A_;
-
-        eyes = Eigen::MatrixXf::Identity(4,4);
+        eyes = Eigen::Matrix4f::Identity();
 
         // xTildeDistribution = std::uniform_real_distribution<double>(0.9, 1.1);
 
     }
 
+    Eigen::Matrix4f RotatingFrameCartesianKalmanFilter::initialQ()
+    {
+        float Q_scalar = 0.5;
+
+        Eigen::Matrix4f Q;
+        Q << 0.0, 0.0, 0.0, 0.0,
+             0.0, 0.0, 0.0, 0.0,
+             0.0, 0.0, Q_scalar, 0.0,
+             0.0, 0.0, 0.0, Q_scalar;
+        return Q;
+    }
+
     // For initializing a new model
     void RotatingFrameCartesianKalmanFilter::initialize(const std::string & side, const int & modelID,
                                                         const float & gapPtX, const float & gapPtY,
@@ -107,8 +110,6 @@ namespace dynamic_gap
         this->Q_k_ = model.Q_k_;
         this->Q_temp_ = model.Q_temp_;
 
-        this->intermediateRbtVels_ = model.intermediateRbtVels_;
-        this->intermediateRbtAccs_ = model.intermediateRbtAccs_;
         this->lastRbtVel_ = model.lastRbtVel_;
         this->lastRbtAcc_ = model.lastRbtAcc_;
 
@@ -116,6 +117,7 @@ namespace dynamic_gap
         this->tLastUpdate_ = model.tLastUpdate_;
 
         this->manip_ = false; // will set to true if we do need to manip
+        this->josephForm_ = model.josephForm_;
 
         // From RotatingFrameCartesianKalmanFilter.h
         // this->H_ = model.H_;
@@ -149,21 +151,24 @@ namespace dynamic_gap
         return;
     }
 
-    Eigen::Vector4f RotatingFrameCartesianKalmanFilter::integrate() 
+    Eigen::Vector4f RotatingFrameCartesianKalmanFilter::integrate(const EgoMotionTimeline & egoMotionTimeline) 
     {
         // ROS_INFO_STREAM("    [integrate()]");
         Eigen::Vector4f x_intermediate = x_hat_kmin1_plus_;
         Eigen::Vector4f new_x = x_hat_kmin1_plus_;
 
-        for (int i = 0; i < (intermediateRbtVels_.size() - 1); i++) 
+        const std::vector<geometry_msgs::TwistStamped> & rbtVels = egoMotionTimeline.rbtVels();
+        const std::vector<geometry_msgs::TwistStamped> & rbtAccs = egoMotionTimeline.rbtAccs();
+
+        for (int i = 0; i < (rbtVels.size() - 1); i++) 
         {
             // ROS_INFO_STREAM("        intermediate step " << i);
             
-            float dt = (intermediateRbtVels_[i + 1].header.stamp - intermediateRbtVels_[i].header.stamp).toSec();
+            float dt = egoMotionTimeline.dt(i);
 
             // ROS_INFO_STREAM("        dt " << dt);
 
-            float ang_vel_ego = intermediateRbtVels_[i].twist.angular.z;
+            float ang_vel_ego = rbtVels[i].twist.angular.z;
             
             // ROS_INFO_STREAM("        ang_vel_ego: " << ang_vel_ego);
 
@@ -171,8 +176,8 @@ namespace dynamic_gap
             float p_dot_y = (x_intermediate[3] - ang_vel_ego*x_intermediate[0]);
             // ROS_INFO_STREAM("        p_dot_x: " << p_dot_x << ", p_dot_y: " << p_dot_y);
 
-            float vdot_x_body = intermediateRbtAccs_[i].twist.linear.x;
-            float vdot_y_body = intermediateRbtAccs_[i].twist.linear.y;
+            float vdot_x_body = rbtAccs[i].twist.linear.x;
+            float vdot_y_body = rbtAccs[i].twist.linear.y;
             // ROS_INFO_STREAM("        vdot_x_body: " << vdot_x_body << ", vdot_y_body: " << vdot_y_body);
 
             float v_dot_x = (x_intermediate[3]*ang_vel_ego - vdot_x_body);
@@ -192,65 +197,69 @@ namespace dynamic_gap
         return x_intermediate;
     }
 
-    void RotatingFrameCartesianKalmanFilter::linearize(const int & idx) 
+    void RotatingFrameCartesianKalmanFilter::propagateCovariance(const EgoMotionTimeline & egoMotionTimeline)
     {
-        float dt = (intermediateRbtVels_[idx + 1].header.stamp - intermediateRbtVels_[idx].header.stamp).toSec();    
-        float ang_vel_ego = intermediateRbtVels_[idx].twist.angular.z;
-        
-        A_ << 0.0, ang_vel_ego, 1.0, 0.0,
-             -ang_vel_ego, 0.0, 0.0, 1.0,
-             0.0, 0.0, 0.0, ang_vel_ego,
-             0.0, 0.0, -ang_vel_ego, 0.0;
+        P_intermediate = P_kmin1_plus_;
+        new_P = P_kmin1_plus_;
+        for (int i = 0; i < (egoMotionTimeline.size() - 1); i++) 
+        {
+            const Eigen::Matrix4f & STM = egoMotionTimeline.STM(i);
+            const Eigen::Matrix4f & dQ = egoMotionTimeline.dQ(i);
 
-        STM_ = (A_*dt).exp();
-    }
 
-    void RotatingFrameCartesianKalmanFilter::discretizeQ(const int & idx) 
-    {
-        float dt = (intermediateRbtVels_[idx + 1].header.stamp - intermediateRbtVels_[idx].header.stamp).toSec();
+            // ROS_INFO_STREAM("    STM: " << STM(0, 0) << ", " << STM(0, 1) << ", " << STM(0, 2) << ", " << STM(0, 3));
+            // ROS_INFO_STREAM("          " << STM(1, 0) << ", " << STM(1, 1) << ", " << STM(1, 2) << ", " << STM(1, 3));
+            // ROS_INFO_STREAM("          " << STM(2, 0) << ", " << STM(2, 1) << ", " << STM(2, 2) << ", " << STM(2, 3));
+            // ROS_INFO_STREAM("          " << STM(3, 0) << ", " << STM(3, 1) << ", " << STM(3, 2) << ", " << STM(3, 3));     
+
+            // ROS_INFO_STREAM("    dQ: " << dQ(0, 0) << ", " << dQ(0, 1) << ", " << dQ(0, 2) << ", " << dQ(0, 3));
+            // ROS_INFO_STREAM("         " << dQ(1, 0) << ", " << dQ(1, 1) << ", " << dQ(1, 2) << ", " << dQ(1, 3));
+            // ROS_INFO_STREAM("         " << dQ(2, 0) << ", " << dQ(2, 1) << ", " << dQ(2, 2) << ", " << dQ(2, 3));
+            // ROS_INFO_STREAM("         " << dQ(3, 0) << ", " << dQ(3, 1) << ", " << dQ(3, 2) << ", " << dQ(3, 3));     
+
+            // ROS_INFO_STREAM("    P_intermediate: " << P_intermediate(0, 0) << ", " << P_intermediate(0, 1) << ", " << P_intermediate(0, 2) << ", " << P_intermediate(0, 3));
+            // ROS_INFO_STREAM("                    " << P_intermediate(1, 0) << ", " << P_intermediate(1, 1) << ", " << P_intermediate(1, 2) << ", " << P_intermediate(1, 3));
+            // ROS_INFO_STREAM("                    " << P_intermediate(2, 0) << ", " << P_intermediate(2, 1) << ", " << P_intermediate(2, 2) << ", " << P_intermediate(2, 3));
+            // ROS_INFO_STREAM("                    " << P_intermediate(3, 0) << ", " << P_intermediate(3, 1) << ", " << P_intermediate(3, 2) << ", " << P_intermediate(3, 3));     
 
-        Q_1_ = Q_k_;
-        Q_2_ = A_ * Q_1_ + Q_1_ * A_.transpose();
-        Q_3_ = A_ * Q_2_ + Q_2_ * A_.transpose();
+            new_P = STM * P_intermediate * STM.transpose() + dQ;
 
-        dQ_ = (Q_1_ * dt) + (Q_2_ * dt * dt / 2.0) + (Q_3_ * dt * dt * dt / 6.0);
+            P_intermediate = new_P;
+        }
+        P_k_minus_ = new_P;
     }
 
     void RotatingFrameCartesianKalmanFilter::update(const Eigen::Vector2f & measurement, 
-                                                    const std::vector<geometry_msgs::TwistStamped> & intermediateRbtVels, 
-                                                    const std::vector<geometry_msgs::TwistStamped> & intermediateRbtAccs, 
-                                                    const std::map<std::string, geometry_msgs::Pose> & agentPoses,
-                                                    const std::map<std::string, geometry_msgs::Vector3Stamped> & agentVels,
+                                                    const EgoMotionTimeline & egoMotionTimeline, 
+                                                    const AgentTable & agents,
                                                     const ros::Time & t_update)
     {    
         // acceleration and velocity come in wrt robot frame
-        intermediateRbtVels_ = intermediateRbtVels;
-        intermediateRbtAccs_ = intermediateRbtAccs;
 
         // ROS_INFO_STREAM("    update for model: " << getID()); // << ", life_time: " << life_time << ", dt: " << dt << ", inter_dt: " << inter_dt);
         // ROS_INFO_STREAM("    t_update: " << t_update); // << ", life_time: " << life_time << ", dt: " << dt << ", inter_dt: " << inter_dt);
         // ROS_INFO_STREAM("    tLastUpdate_: " << tLastUpdate_); // << ", life_time: " << life_time << ", dt: " << dt << ", inter_dt: " << inter_dt);
 
-        // ROS_INFO_STREAM("    intermediateRbtVels_.size(): " << intermediateRbtVels_.size());
-        // ROS_INFO_STREAM("    intermediateRbtAccs_.size(): " << intermediateRbtAccs_.size());
+        const std::vector<geometry_msgs::TwistStamped> & intermediateRbtVels = egoMotionTimeline.rawRbtVels();
+        const std::vector<geometry_msgs::TwistStamped> & intermediateRbtAccs = egoMotionTimeline.rawRbtAccs();
 
-        if (intermediateRbtVels_.size() == 0 || intermediateRbtAccs_.size() == 0)
+        // ROS_INFO_STREAM("    intermediateRbtVels.size(): " << intermediateRbtVels.size());
+        // ROS_INFO_STREAM("    intermediateRbtAccs.size(): " << intermediateRbtAccs.size());
+
+        if (intermediateRbtVels.size() == 0 || intermediateRbtAccs.size() == 0)
         {
-            ROS_WARN_STREAM_COND_NAMED(intermediateRbtVels_.size() == 0, "    GapEstimation", "intermediateRbtVels_ is empty, no update");
-            ROS_WARN_STREAM_COND_NAMED(intermediateRbtAccs_.size() == 0, "    GapEstimation", "intermediateRbtAccs_ is empty, no update");
+            ROS_WARN_STREAM_COND_NAMED(intermediateRbtVels.size() == 0, "    GapEstimation", "intermediateRbtVels is empty, no update");
+            ROS_WARN_STREAM_COND_NAMED(intermediateRbtAccs.size() == 0, "    GapEstimation", "intermediateRbtAccs is empty, no update");
             return;
         }
 
         // ROS_INFO_STREAM("    x_hat_kmin1_plus_: " << x_hat_kmin1_plus_[0] << ", " << x_hat_kmin1_plus_[1] << ", " << x_hat_kmin1_plus_[2] << ", " << x_hat_kmin1_plus_[3]);
         // ROS_INFO_STREAM("    current_rbt_vel, x_lin: " << lastRbtVel_.twist.linear.x << ", y_lin: " << lastRbtVel_.twist.linear.y << ", z_ang: " << lastRbtVel_.twist.angular.z);
 
-        processEgoRobotVelsAndAccs(t_update);
+        const EgoMotionTimeline & timeline = alignEgoMotionTimeline(egoMotionTimeline, t_update);
 
-        if (intermediateRbtVels_.size() != intermediateRbtAccs_.size())
-        {
-            // ROS_INFO_STREAM("    intermediateRbtVels_ is of size " << intermediateRbtVels_.size() << " while intermediateRbtAccs_ is of size " << intermediateRbtAccs_.size());
+        if (!timeline.valid())
             return;
-        }
 
         // get_intermediateRbtVels__accs();
 
@@ -261,43 +270,11 @@ namespace dynamic_gap
         // ROS_INFO_STREAM("    linear ego vel: " << lastRbtVel_.twist.linear.x << ", " << lastRbtVel_.twist.linear.y << ", angular ego vel: " << lastRbtVel_.twist.angular.z);
         // ROS_INFO_STREAM("    linear ego acceleration: " << lastRbtAcc_.twist.linear.x << ", " << lastRbtAcc_.twist.linear.y << ", angular ego acc: " << lastRbtAcc_.twist.angular.z);        
 
-        x_hat_k_minus_ = integrate();
+        x_hat_k_minus_ = integrate(timeline);
         
         // ROS_INFO_STREAM("    x_hat_k_minus_: " << x_hat_k_minus_.transpose());
 
-        P_intermediate = P_kmin1_plus_;
-        new_P = P_kmin1_plus_;
-        for (int i = 0; i < (intermediateRbtVels_.size() - 1); i++) 
-        {
-            linearize(i);
-
-            // ROS_INFO_STREAM("    A_: " << A_(0, 0) << ", " << A_(0, 1) << ", " << A_(0, 2) << ", " << A_(0, 3));
-            // ROS_INFO_STREAM("        " << A_(1, 0) << ", " << A_(1, 1) << ", " << A_(1, 2) << ", " << A_(1, 3));
-            // ROS_INFO_STREAM("        " << A_(2, 0) << ", " << A_(2, 1) << ", " << A_(2, 2) << ", " << A_(2, 3));
-            // ROS_INFO_STREAM("        " << A_(3, 0) << ", " << A_(3, 1) << ", " << A_(3, 2) << ", " << A_(3, 3));     
-
-            // ROS_INFO_STREAM("    STM_: " << STM_(0, 0) << ", " << STM_(0, 1) << ", " << STM_(0, 2) << ", " << STM_(0, 3));
-            // ROS_INFO_STREAM("          " << STM_(1, 0) << ", " << STM_(1, 1) << ", " << STM_(1, 2) << ", " << STM_(1, 3));
-            // ROS_INFO_STREAM("          " << STM_(2, 0) << ", " << STM_(2, 1) << ", " << STM_(2, 2) << ", " << STM_(2, 3));
-            // ROS_INFO_STREAM("          " << STM_(3, 0) << ", " << STM_(3, 1) << ", " << STM_(3, 2) << ", " << STM_(3, 3));     
-
-            discretizeQ(i);
-
-            // ROS_INFO_STREAM("    dQ_: " << dQ_(0, 0) << ", " << dQ_(0, 1) << ", " << dQ_(0, 2) << ", " << dQ_(0, 3));
-            // ROS_INFO_STREAM("         " << dQ_(1, 0) << ", " << dQ_(1, 1) << ", " << dQ_(1, 2) << ", " << dQ_(1, 3));
-            // ROS_INFO_STREAM("         " << dQ_(2, 0) << ", " << dQ_(2, 1) << ", " << dQ_(2, 2) << ", " << dQ_(2, 3));
-            // ROS_INFO_STREAM("         " << dQ_(3, 0) << ", " << dQ_(3, 1) << ", " << dQ_(3, 2) << ", " << dQ_(3, 3));     
-
-            // ROS_INFO_STREAM("    P_intermediate: " << P_intermediate(0, 0) << ", " << P_intermediate(0, 1) << ", " << P_intermediate(0, 2) << ", " << P_intermediate(0, 3));
-            // ROS_INFO_STREAM("                    " << P_intermediate(1, 0) << ", " << P_intermediate(1, 1) << ", " << P_intermediate(1, 2) << ", " << P_intermediate(1, 3));
-            // ROS_INFO_STREAM("                    " << P_intermediate(2, 0) << ", " << P_intermediate(2, 1) << ", " << P_intermediate(2, 2) << ", " << P_intermediate(2, 3));
-            // ROS_INFO_STREAM("                    " << P_intermediate(3, 0) << ", " << P_intermediate(3, 1) << ", " << P_intermediate(3, 2) << ", " << P_intermediate(3, 3));     
-
-            new_P = STM_ * P_intermediate * STM_.transpose() + dQ_;
-
-            P_intermediate = new_P;
-        }
-        P_k_minus_ = new_P;
+        propagateCovariance(timeline);
         
 
         // ROS_INFO_STREAM("    P_k_minus_: " << P_k_minus_(0, 0) << ", " << P_k_minus_(0, 1) << ", " << P_k_minus_(0, 2) << ", " << P_k_minus_(0, 3));
@@ -307,9 +284,7 @@ namespace dynamic_gap
 
         // ROS_INFO_STREAM("    xTilde_: " << xTilde_[0] << ", " << xTilde_[1]);
         
-        Eigen::Vector2f noisyXTilde_ = xTilde_;
-        noisyXTilde_[0] += xTildeDistribution(generator);
-        noisyXTilde_[1] += xTildeDistribution(generator);
+        Eigen::Vector2f noisyXTilde_ = perturbMeasurement(xTilde_);
 
         innovation_ = noisyXTilde_ - H_*x_hat_k_minus_;
         x_hat_k_plus_ = x_hat_k_minus_ + G_k_*innovation_;
@@ -334,7 +309,12 @@ namespace dynamic_gap
 
         tmp_mat = H_*P_k_minus_*H_transpose_ + R_k_;
 
-        G_k_ = P_k_minus_ * H_transpose_ * tmp_mat.inverse();
+        // closed-form 2x2 inverse
+        float tmp_mat_inv_det = 1.0 / (tmp_mat(0, 0) * tmp_mat(1, 1) - tmp_mat(0, 1) * tmp_mat(1, 0));
+        tmp_mat_inverse << tmp_mat(1, 1) * tmp_mat_inv_det, -tmp_mat(0, 1) * tmp_mat_inv_det,
+                           -tmp_mat(1, 0) * tmp_mat_inv_det, tmp_mat(0, 0) * tmp_mat_inv_det;
+
+        G_k_ = P_k_minus_ * H_transpose_ * tmp_mat_inverse;
 
         // ROS_INFO_STREAM("G_k_: " << G_k_(0, 0) << ", " << G_k_(0, 1));
         // ROS_INFO_STREAM("      " << G_k_(1, 0) << ", " << G_k_(1, 1));
@@ -349,7 +329,11 @@ namespace dynamic_gap
         // ROS_INFO_STREAM("H_: " << H_(0, 0) << ", " << H_(0, 1) << ", " << H_(0, 2) << ", " << H_(0, 3));
         // ROS_INFO_STREAM("    " << H_(1, 0) << ", " << H_(1, 1) << ", " << H_(1, 2) << ", " << H_(1, 3));
         
-        P_k_plus_ = (eyes - G_k_*H_)*P_k_minus_;
+        I_minus_GH = eyes - G_k_*H_;
+        if (josephForm_)
+            P_k_plus_ = I_minus_GH*P_k_minus_*I_minus_GH.transpose() + G_k_*R_k_*G_k_.transpose();
+        else
+            P_k_plus_ = I_minus_GH*P_k_minus_;
     
         // Q_temp_ = (alpha_Q * Q_k_) + (1.0 - alpha_Q) * (G_k_ * residual_ * residual_.transpose() * G_k_.transpose());
         // Q_k_ = Q_temp_;
@@ -362,14 +346,8 @@ namespace dynamic_gap
 
         // ROS_INFO_STREAM("3");
 
-        // ROS_INFO_STREAM("    intermediateRbtVels_ size: " << intermediateRbtVels_.size());
-        // ROS_INFO_STREAM("    intermediateRbtAccs_ size: " << intermediateRbtAccs_.size());
-        
-        if (intermediateRbtVels_.size() > 0)
-            lastRbtVel_ = intermediateRbtVels_.back();
-        
-        if (intermediateRbtAccs_.size() > 0)
-            lastRbtAcc_ = intermediateRbtAccs_.back();
+        lastRbtVel_ = timeline.rbtVels().back();
+        lastRbtAcc_ = timeline.rbtAccs().back();
 
         // ROS_INFO_STREAM("4");
 
@@ -383,6 +361,70 @@ namespace dynamic_gap
         return;
     }    
 
+    void RotatingFrameCartesianKalmanFilter::predict(const EgoMotionTimeline & egoMotionTimeline, const ros::Time & tPredict)
+    {
+        const EgoMotionTimeline & timeline = alignEgoMotionTimeline(egoMotionTimeline, tPredict);
+
+        if (!timeline.valid())
+            return;
+
+        x_hat_k_minus_ = integrate(timeline);
+        propagateCovariance(timeline);
+
+        // measurement that gap dynamics are pinned to moves along with predicted position
+        xTilde_ += x_hat_k_minus_.head(2) - x_hat_kmin1_plus_.head(2);
+
+        x_hat_k_plus_ = x_hat_k_minus_;
+        P_k_plus_ = P_k_minus_;
+
+        x_hat_kmin1_plus_ = x_hat_k_plus_;
+        P_kmin1_plus_ = P_k_plus_;
+        tLastUpdate_ = tPredict;
+
+        lastRbtVel_ = timeline.rbtVels().back();
+        lastRbtAcc_ = timeline.rbtAccs().back();
+    }
+
+    void RotatingFrameCartesianKalmanFilter::writeCheckpoint(CheckpointWriter & writer) const
+    {
+        Estimator::writeCheckpoint(writer);
+
+        writer.write(R_scalar);
+        writer.write(Q_scalar);
+        writer.write(lifetimeThreshold_);
+        writer.write(innovation_);
+        writer.write(residual_);
+
+        // measurement noise stream picks up where it left off
+        std::ostringstream generatorState;
+        generatorState << generator << " " << xTildeDistribution;
+        writer.write(generatorState.str());
+    }
+
+    void RotatingFrameCartesianKalmanFilter::readCheckpoint(CheckpointReader & reader)
+    {
+        Estimator::readCheckpoint(reader);
+
+        reader.read(R_scalar);
+        reader.read(Q_scalar);
+        reader.read(lifetimeThreshold_);
+        reader.read(innovation_);
+        reader.read(residual_);
+
+        std::string generatorState;
+        reader.read(generatorState);
+        std::istringstream generatorStream(generatorState);
+        generatorStream >> generator >> xTildeDistribution;
+    }
+
+    Eigen::Vector2f RotatingFrameCartesianKalmanFilter::perturbMeasurement(const Eigen::Vector2f & measurement)
+    {
+        Eigen::Vector2f noisyMeasurement = measurement;
+        noisyMeasurement[0] += xTildeDistribution(generator);
+        noisyMeasurement[1] += xTildeDistribution(generator);
+        return noisyMeasurement;
+    }
+
     Eigen::Vector4f RotatingFrameCartesianKalmanFilter::getState()
     { 
         // // ROS_INFO_STREAM("[getState()]");
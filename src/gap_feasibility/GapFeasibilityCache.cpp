@@ -0,0 +1,184 @@
+#include <dynamic_gap/gap_feasibility/GapFeasibilityCache.h>
+
+namespace dynamic_gap
+{
+    bool GapFeasibilityCache::lookupLifespan(dynamic_gap::Gap * gap)
+    {
+        gap->leftGapPtModel_->isolateGapDynamics();
+        gap->rightGapPtModel_->isolateGapDynamics();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        lifespanLookups_++;
+
+        auto entryIter = entries_.find(std::make_pair(gap->leftGapPtModel_->getID(), gap->rightGapPtModel_->getID()));
+        if (entryIter == entries_.end() || !matchesGapDynamics(entryIter->second, gap))
+            return false;
+
+        Entry & entry = entryIter->second;
+        entry.lastUsedCycle = cycle_;
+
+        gap->setGapLifespan(entry.gapLifespan);
+        gap->end_condition = entry.endCondition;
+
+        lifespanHits_++;
+        return true;
+    }
+
+    void GapFeasibilityCache::storeLifespan(dynamic_gap::Gap * gap)
+    {
+        // stepping gap points forward moves frozen states, so freeze them again to key entry on initial states
+        gap->leftGapPtModel_->isolateGapDynamics();
+        gap->rightGapPtModel_->isolateGapDynamics();
+
+        Entry entry;
+        entry.leftGapState = gap->leftGapPtModel_->getGapState();
+        entry.rightGapState = gap->rightGapPtModel_->getGapState();
+        entry.leftIdx = gap->LIdx();
+        entry.rightIdx = gap->RIdx();
+        entry.gapLifespan = gap->gapLifespan_;
+        entry.endCondition = gap->end_condition;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        entry.lastUsedCycle = cycle_;
+        entries_[std::make_pair(gap->leftGapPtModel_->getID(), gap->rightGapPtModel_->getID())] = entry;
+    }
+
+    bool GapFeasibilityCache::lookupFeasibility(dynamic_gap::Gap * gap,
+                                                const sensor_msgs::LaserScan & scan,
+                                                bool & isGapFeasible)
+    {
+        gap->leftGapPtModel_->isolateGapDynamics();
+        gap->rightGapPtModel_->isolateGapDynamics();
+
+        Eigen::Vector4f goal(gap->goal.x_, gap->goal.y_, gap->goal.vx_, gap->goal.vy_);
+        float tolerance = cfg_->planning.gap_feasibility_cache_tolerance;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        feasibilityLookups_++;
+
+        auto entryIter = entries_.find(std::make_pair(gap->leftGapPtModel_->getID(), gap->rightGapPtModel_->getID()));
+        if (entryIter == entries_.end())
+            return false;
+
+        Entry & entry = entryIter->second;
+        if (!entry.hasFeasibility ||
+            !matchesGapDynamics(entry, gap) ||
+            entry.gapLifespan != gap->gapLifespan_ ||
+            entry.endCondition != gap->end_condition ||
+            entry.rgc != gap->rgc_ ||
+            (entry.manipLeftPt - gap->getManipulatedLPosition()).cwiseAbs().maxCoeff() > tolerance ||
+            (entry.manipRightPt - gap->getManipulatedRPosition()).cwiseAbs().maxCoeff() > tolerance ||
+            (entry.goal - goal).cwiseAbs().maxCoeff() > tolerance)
+        {
+            return false;
+        }
+
+        // terminal goal is clipped at scan, so local clearance around it has to hold still as well
+        if (entry.isGapFeasible && std::abs(terminalGoalRange(entry.terminalGoal, scan) - entry.terminalGoalRange) > tolerance)
+            return false;
+
+        entry.lastUsedCycle = cycle_;
+
+        gap->t_intercept_left = entry.tInterceptLeft;
+        gap->gamma_intercept_left = entry.gammaInterceptLeft;
+        gap->t_intercept_right = entry.tInterceptRight;
+        gap->gamma_intercept_right = entry.gammaInterceptRight;
+
+        if (entry.isGapFeasible)
+        {
+            gap->t_intercept_goal = entry.tInterceptGoal;
+            gap->gamma_intercept_goal = entry.gammaInterceptGoal;
+            gap->setTerminalGoal(entry.terminalGoal);
+        }
+
+        isGapFeasible = entry.isGapFeasible;
+        feasibilityHits_++;
+        return true;
+    }
+
+    void GapFeasibilityCache::storeFeasibility(dynamic_gap::Gap * gap,
+                                                const sensor_msgs::LaserScan & scan,
+                                                const bool & isGapFeasible)
+    {
+        Eigen::Vector2f terminalGoal(gap->terminalGoal.x_, gap->terminalGoal.y_);
+        float terminalGoalScanRange = isGapFeasible ? terminalGoalRange(terminalGoal, scan) : 0.0;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // feasibility is only cached on top of the lifespan it was checked with
+        auto entryIter = entries_.find(std::make_pair(gap->leftGapPtModel_->getID(), gap->rightGapPtModel_->getID()));
+        if (entryIter == entries_.end() ||
+            entryIter->second.gapLifespan != gap->gapLifespan_ ||
+            entryIter->second.endCondition != gap->end_condition)
+        {
+            return;
+        }
+
+        Entry & entry = entryIter->second;
+        entry.hasFeasibility = true;
+        entry.manipLeftPt = gap->getManipulatedLPosition();
+        entry.manipRightPt = gap->getManipulatedRPosition();
+        entry.goal << gap->goal.x_, gap->goal.y_, gap->goal.vx_, gap->goal.vy_;
+        entry.rgc = gap->rgc_;
+        entry.terminalGoalRange = terminalGoalScanRange;
+
+        entry.isGapFeasible = isGapFeasible;
+        entry.tInterceptLeft = gap->t_intercept_left;
+        entry.gammaInterceptLeft = gap->gamma_intercept_left;
+        entry.tInterceptRight = gap->t_intercept_right;
+        entry.gammaInterceptRight = gap->gamma_intercept_right;
+        entry.tInterceptGoal = gap->t_intercept_goal;
+        entry.gammaInterceptGoal = gap->gamma_intercept_goal;
+        entry.terminalGoal = terminalGoal;
+
+        entry.lastUsedCycle = cycle_;
+    }
+
+    void GapFeasibilityCache::endCycle()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        totalLifespanLookups_ += lifespanLookups_;
+        totalLifespanHits_ += lifespanHits_;
+        totalFeasibilityLookups_ += feasibilityLookups_;
+        totalFeasibilityHits_ += feasibilityHits_;
+
+        ROS_INFO_STREAM_NAMED("GapFeasibility", "    [feasibility cache: lifespan hits " << lifespanHits_ << " of " << lifespanLookups_ <<
+                                                ", feasibility hits " << feasibilityHits_ << " of " << feasibilityLookups_ <<
+                                                ", " << entries_.size() << " entries]");
+        ROS_INFO_STREAM_NAMED("GapFeasibility", "    [feasibility cache hit rates: lifespan " <<
+                                                (totalLifespanHits_ / std::max(1.0, double(totalLifespanLookups_))) << ", feasibility " <<
+                                                (totalFeasibilityHits_ / std::max(1.0, double(totalFeasibilityLookups_))) << "]");
+
+        // models that did not bound any gap in this planning loop are gone or have moved on
+        for (auto entryIter = entries_.begin(); entryIter != entries_.end(); )
+        {
+            if (entryIter->second.lastUsedCycle != cycle_)
+                entryIter = entries_.erase(entryIter);
+            else
+                entryIter++;
+        }
+
+        lifespanLookups_ = 0;
+        lifespanHits_ = 0;
+        feasibilityLookups_ = 0;
+        feasibilityHits_ = 0;
+        cycle_++;
+    }
+
+    bool GapFeasibilityCache::matchesGapDynamics(const Entry & entry, dynamic_gap::Gap * gap)
+    {
+        float tolerance = cfg_->planning.gap_feasibility_cache_tolerance;
+
+        return entry.leftIdx == gap->LIdx() &&
+               entry.rightIdx == gap->RIdx() &&
+               (entry.leftGapState - gap->leftGapPtModel_->getGapState()).cwiseAbs().maxCoeff() <= tolerance &&
+               (entry.rightGapState - gap->rightGapPtModel_->getGapState()).cwiseAbs().maxCoeff() <= tolerance;
+    }
+
+    float GapFeasibilityCache::terminalGoalRange(const Eigen::Vector2f & terminalGoal, const sensor_msgs::LaserScan & scan)
+    {
+        int terminalGoalScanIdx = theta2idx(std::atan2(terminalGoal[1], terminalGoal[0]));
+        return scan.ranges.at(terminalGoalScanIdx);
+    }
+}
@@ -3,6 +3,15 @@
 
 namespace dynamic_gap 
 {
+    GapFeasibilityChecker::GapFeasibilityChecker(const dynamic_gap::DynamicGapConfig& cfg) : feasibilityCache_(cfg)
+    {
+        cfg_ = &cfg;
+
+        // count steps the same way that stepGapPoints accumulates time
+        for (float t = cfg_->traj.integrate_stept; t < cfg_->traj.integrate_maxt; t += cfg_->traj.integrate_stept)
+            propagationStepCount_++;
+    }
+
     void GapFeasibilityChecker::updateEgoCircle(boost::shared_ptr<sensor_msgs::LaserScan const> scan) 
     {
         scan_ = scan;
@@ -12,6 +21,59 @@ namespace dynamic_gap
     {
         ROS_INFO_STREAM("                [propagateGapPoints()]");
 
+        if (!cfg_->planning.gap_feasibility_cache)
+        {
+            estimateGapLifespan(gap);
+            return;
+        }
+
+        if (feasibilityCache_.lookupLifespan(gap))
+        {
+            ROS_INFO_STREAM("                    cached end condition " << gap->end_condition << ", setting gap lifespan to " << gap->gapLifespan_); 
+            return;
+        }
+
+        estimateGapLifespan(gap);
+        feasibilityCache_.storeLifespan(gap);
+    }
+
+    void GapFeasibilityChecker::estimateGapLifespan(dynamic_gap::Gap * gap) 
+    {
+        if (!cfg_->planning.analytic_gap_lifespan)
+        {
+            stepGapPoints(gap);
+            return;
+        }
+
+        float gapLifespan = 0.0;
+        int endCondition = -1;
+        solveGapLifespan(gap, gapLifespan, endCondition);
+
+        if (cfg_->planning.validate_gap_lifespan)
+        {
+            stepGapPoints(gap);
+
+            // stepping accumulates time in floats, so allow for rounding within a step
+            if (gap->end_condition != endCondition || std::abs(gap->gapLifespan_ - gapLifespan) > 0.5 * cfg_->traj.integrate_stept)
+            {
+                ROS_WARN_STREAM_NAMED("GapFeasibility", "    closed-form gap lifespan " << gapLifespan << " (end condition " << endCondition << 
+                                                        ") disagrees with stepped gap lifespan " << gap->gapLifespan_ << " (end condition " << gap->end_condition << ")");
+            }
+
+            // stepped result stands while validating
+            return;
+        }
+
+        gap->setGapLifespan(gapLifespan);
+        gap->end_condition = endCondition;
+
+        ROS_INFO_STREAM("                    end condition " << endCondition << ", setting gap lifespan to " << gap->gapLifespan_); 
+    }
+
+    void GapFeasibilityChecker::stepGapPoints(dynamic_gap::Gap * gap) 
+    {
+        ROS_INFO_STREAM("                [stepGapPoints()]");
+
         Eigen::Vector2f crossingPt(0.0, 0.0);
 
         gap->leftGapPtModel_->isolateGapDynamics();
@@ -165,6 +227,218 @@ namespace dynamic_gap
         return;
     }
 
+    void GapFeasibilityChecker::solveGapLifespan(dynamic_gap::Gap * gap, float & gapLifespan, int & endCondition)
+    {
+        gap->leftGapPtModel_->isolateGapDynamics();
+        gap->rightGapPtModel_->isolateGapDynamics();
+
+        Eigen::Vector4f leftGapState = gap->leftGapPtModel_->getGapState();
+        Eigen::Vector4f rightGapState = gap->rightGapPtModel_->getGapState();
+
+        Eigen::Vector2f leftPt = leftGapState.head(2), leftVel = leftGapState.tail(2);
+        Eigen::Vector2f rightPt = rightGapState.head(2), rightVel = rightGapState.tail(2);
+
+        // cross(left(t), right(t)) = a t^2 + b t + c changes sign wherever swept left to right angle passes through 0 or pi
+        auto cross = [](const Eigen::Vector2f & u, const Eigen::Vector2f & v) { return u[0]*v[1] - u[1]*v[0]; };
+        float a = cross(leftVel, rightVel);
+        float b = cross(leftPt, rightVel) + cross(leftVel, rightPt);
+        float c = cross(leftPt, rightPt);
+
+        std::vector<float> roots;
+        if (std::abs(a) > eps)
+        {
+            float discriminant = b*b - 4*a*c;
+            if (discriminant >= 0.0)
+            {
+                // numerically stable quadratic roots
+                float q = -0.5 * (b + (b >= 0.0 ? 1.0 : -1.0) * std::sqrt(discriminant));
+                roots.push_back(q / a);
+                if (std::abs(q) > eps)
+                    roots.push_back(c / q);
+            }
+        } else if (std::abs(b) > eps)
+        {
+            roots.push_back(-c / b);
+        }
+
+        // end conditions compare against central bearing of previous step, so they can only
+        // trigger at first step, at first steps after sign changes of cross product, or at steps
+        // over which a gap point swings far enough to leave or enter half plane of that bearing
+        float dt = cfg_->traj.integrate_stept;
+        std::vector<int> candidateSteps(1, 1);
+        for (float root : roots)
+        {
+            if (root <= 0.0 || root > propagationStepCount_ * dt)
+                continue;
+
+            int rootStep = std::max(1, int(std::ceil(root / dt)));
+            candidateSteps.push_back(rootStep);
+            candidateSteps.push_back(rootStep + 1);
+        }
+
+        // without a root, end conditions still trigger if a gap point's bearing swings a quarter turn or more
+        // within one step. p(t - dt) . p(t) = |p(t - dt/2)|^2 - |v dt/2|^2 is quadratic in t and only
+        // non-positive while step midpoint passes within |v dt/2| of robot, which spans at most a couple of steps
+        for (const Eigen::Vector4f & gapState : {leftGapState, rightGapState})
+        {
+            Eigen::Vector2f pt = gapState.head(2), vel = gapState.tail(2);
+            float swingA = vel.squaredNorm();
+            float swingB = 2 * pt.dot(vel) - swingA * dt;
+            float swingC = pt.squaredNorm() - pt.dot(vel) * dt;
+            if (swingA <= eps)
+                continue;
+
+            float discriminant = swingB*swingB - 4*swingA*swingC;
+            if (discriminant < 0.0)
+                continue;
+
+            float tSwingStart = (-swingB - std::sqrt(discriminant)) / (2*swingA);
+            float tSwingEnd = (-swingB + std::sqrt(discriminant)) / (2*swingA);
+            if (tSwingEnd <= 0.0 || tSwingStart > propagationStepCount_ * dt)
+                continue;
+
+            // padded by a step on either side against rounding
+            int firstSwingStep = std::max(1, int(std::floor(tSwingStart / dt)));
+            int lastSwingStep = std::min(propagationStepCount_, int(std::ceil(tSwingEnd / dt)) + 1);
+            for (int step = firstSwingStep; step <= lastSwingStep; step++)
+                candidateSteps.push_back(step);
+        }
+
+        std::sort(candidateSteps.begin(), candidateSteps.end());
+        candidateSteps.erase(std::unique(candidateSteps.begin(), candidateSteps.end()), candidateSteps.end());
+
+        for (int step : candidateSteps)
+        {
+            if (step > propagationStepCount_)
+                break;
+
+            int stepEndCondition = checkEndConditionAtStep(gap, leftGapState, rightGapState, step);
+            if (stepEndCondition == 1)
+            {
+                gapLifespan = solveRewindTime(leftGapState, rightGapState, step);
+                endCondition = 1;
+                return;
+            } else if (stepEndCondition == 2)
+            {
+                gapLifespan = (step - 1) * dt;
+                endCondition = 2;
+                return;
+            }
+        }
+
+        gapLifespan = cfg_->traj.integrate_maxt;
+        endCondition = 3;
+    }
+
+    int GapFeasibilityChecker::checkEndConditionAtStep(dynamic_gap::Gap * gap,
+                                                       const Eigen::Vector4f & leftGapState,
+                                                       const Eigen::Vector4f & rightGapState,
+                                                       const int & step)
+    {
+        float dt = cfg_->traj.integrate_stept;
+
+        // central bearing of previous step, first step compares against gap's scan indices
+        Eigen::Vector2f prevCentralBearingVect;
+        if (step == 1)
+        {
+            float thetaLeft = idx2theta(gap->LIdx());
+            float thetaRight = idx2theta(gap->RIdx());
+            Eigen::Vector2f leftBearingVect(cos(thetaLeft), sin(thetaLeft)); 
+            Eigen::Vector2f rightBearingVect(cos(thetaRight), sin(thetaRight));
+            float thetaCenter = (thetaLeft - (getSweptLeftToRightAngle(leftBearingVect, rightBearingVect) / 2.0));
+            prevCentralBearingVect << std::cos(thetaCenter), std::sin(thetaCenter);
+        } else
+        {
+            float tPrev = (step - 1) * dt;
+            Eigen::Vector2f prevLeftPt = leftGapState.head(2) + tPrev * leftGapState.tail(2);
+            Eigen::Vector2f prevRightPt = rightGapState.head(2) + tPrev * rightGapState.tail(2);
+            float thetaLeft = std::atan2(prevLeftPt[1], prevLeftPt[0]);
+            float leftToRightAngle = getSweptLeftToRightAngle(prevLeftPt / prevLeftPt.norm(), prevRightPt / prevRightPt.norm());
+            float thetaCenter = (thetaLeft - 0.5 * leftToRightAngle);
+            prevCentralBearingVect << std::cos(thetaCenter), std::sin(thetaCenter);
+        }
+
+        float t = step * dt;
+        Eigen::Vector2f leftPt = leftGapState.head(2) + t * leftGapState.tail(2);
+        Eigen::Vector2f rightPt = rightGapState.head(2) + t * rightGapState.tail(2);
+        Eigen::Vector2f leftBearingVect = leftPt / leftPt.norm();
+        Eigen::Vector2f rightBearingVect = rightPt / rightPt.norm();
+        float leftToRightAngle = getSweptLeftToRightAngle(leftBearingVect, rightBearingVect);
+
+        float leftBearingDotCentBearing = leftBearingVect.dot(prevCentralBearingVect);
+        float rightBearingDotCentBearing = rightBearingVect.dot(prevCentralBearingVect);
+
+        if (leftToRightAngle > M_PI && leftBearingDotCentBearing > 0.0 && rightBearingDotCentBearing > 0.0)
+            return 1;
+
+        if (leftToRightAngle < M_PI && leftBearingDotCentBearing < 0.0 && rightBearingDotCentBearing < 0.0)
+            return 2;
+
+        return -1;
+    }
+
+    float GapFeasibilityChecker::solveRewindTime(const Eigen::Vector4f & leftGapState,
+                                                 const Eigen::Vector4f & rightGapState,
+                                                 const int & crossingStep)
+    {
+        float dt = cfg_->traj.integrate_stept;
+        float inflRbtDiam = 2 * cfg_->rbt.r_inscr * cfg_->traj.inf_ratio;
+
+        // |left(t) - right(t)|^2 = inflRbtDiam^2 is quadratic, and the open check measures gap points
+        // at their shorter range, which is never wider than their separation, so the step at which
+        // separation closes through the diameter is a close upper guess for the last open step
+        Eigen::Vector2f relPt = leftGapState.head(2) - rightGapState.head(2);
+        Eigen::Vector2f relVel = leftGapState.tail(2) - rightGapState.tail(2);
+        float a = relVel.squaredNorm();
+        float b = 2 * relPt.dot(relVel);
+        float c = relPt.squaredNorm() - inflRbtDiam * inflRbtDiam;
+
+        int lastStep = crossingStep - 1;
+        int guessStep = lastStep;
+        if (a > eps)
+        {
+            float discriminant = b*b - 4*a*c;
+            if (discriminant >= 0.0)
+            {
+                // separation is below diameter between roots, guess only matters if gap crossed while that narrow
+                float tClose = (-b - std::sqrt(discriminant)) / (2*a);
+                float tReopen = (-b + std::sqrt(discriminant)) / (2*a);
+                float tCross = crossingStep * dt;
+                if (tClose <= tCross && tCross <= tReopen)
+                    guessStep = std::max(0, std::min(lastStep, int(std::floor(tClose / dt))));
+            }
+        }
+
+        // settle on last open step before crossing, same as stepping backwards from crossing (start is always open)
+        if (guessStep == 0 || isGapOpenAtTime(leftGapState, rightGapState, guessStep * dt))
+        {
+            while (guessStep < lastStep && isGapOpenAtTime(leftGapState, rightGapState, (guessStep + 1) * dt))
+                guessStep++;
+        } else
+        {
+            while (guessStep > 0 && !isGapOpenAtTime(leftGapState, rightGapState, guessStep * dt))
+                guessStep--;
+        }
+
+        return guessStep * dt;
+    }
+
+    bool GapFeasibilityChecker::isGapOpenAtTime(const Eigen::Vector4f & leftGapState,
+                                                const Eigen::Vector4f & rightGapState,
+                                                const float & t)
+    {
+        Eigen::Vector2f leftPt = leftGapState.head(2) + t * leftGapState.tail(2);
+        Eigen::Vector2f rightPt = rightGapState.head(2) + t * rightGapState.tail(2);
+
+        Eigen::Vector2f leftBearingVect = leftPt / leftPt.norm();
+        Eigen::Vector2f rightBearingVect = rightPt / rightPt.norm();
+
+        float r_min = std::min(leftPt.norm(), rightPt.norm());
+
+        return getSweptLeftToRightAngle(leftBearingVect, rightBearingVect) < M_PI &&
+               (r_min * leftBearingVect - r_min * rightBearingVect).norm() > 2 * cfg_->rbt.r_inscr * cfg_->traj.inf_ratio;
+    }
+
     float GapFeasibilityChecker::rewindGapPoints(const float & t, dynamic_gap::Gap * gap) 
     {    
         // ROS_INFO_STREAM("                   [rewindGapPoints()]");
@@ -233,6 +507,26 @@ namespace dynamic_gap
     }
 
     bool GapFeasibilityChecker::pursuitGuidanceAnalysis(dynamic_gap::Gap * gap)
+    {
+        if (!cfg_->planning.gap_feasibility_cache)
+            return runPursuitGuidance(gap);
+
+        bool isGapFeasible = false;
+        if (feasibilityCache_.lookupFeasibility(gap, *scan_, isGapFeasible))
+            return isGapFeasible;
+
+        isGapFeasible = runPursuitGuidance(gap);
+        feasibilityCache_.storeFeasibility(gap, *scan_, isGapFeasible);
+        return isGapFeasible;
+    }
+
+    void GapFeasibilityChecker::endCacheCycle()
+    {
+        if (cfg_->planning.gap_feasibility_cache)
+            feasibilityCache_.endCycle();
+    }
+
+    bool GapFeasibilityChecker::runPursuitGuidance(dynamic_gap::Gap * gap)
     {
         // check what method we are using
         if (cfg_->planning.pursuit_guidance_method == 0)
@@ -23,23 +23,23 @@ namespace dynamic_gap
 
     }
 
-    std::vector<sensor_msgs::LaserScan> DynamicScanPropagator::propagateCurrentLaserScan(const std::vector<dynamic_gap::Gap *> & rawGaps)
+    std::shared_ptr<const FutureEgoCircle> DynamicScanPropagator::propagateCurrentLaserScan(const std::vector<dynamic_gap::Gap *> & rawGaps)
     {
         // ROS_INFO_STREAM_NAMED("DynamicScanPropagator", " [propagateCurrentLaserScan]: ");
 
-        sensor_msgs::LaserScan tmpScan = sensor_msgs::LaserScan();
-        std::vector<sensor_msgs::LaserScan> futureScans(int(cfg_->traj.integrate_maxt/cfg_->traj.integrate_stept) + 1, tmpScan);
-    
-        // set first scan to current scan
-        sensor_msgs::LaserScan scan = *scan_.get();
+        int sliceCount = int(cfg_->traj.integrate_maxt/cfg_->traj.integrate_stept) + 1;
+        std::shared_ptr<FutureEgoCircle> futureEgoCircle = std::make_shared<FutureEgoCircle>(scan_, sliceCount, 
+                                                                                             cfg_->traj.integrate_stept,
+                                                                                             cfg_->scan.range_max);
 
-        futureScans.at(0) = scan; // at t = 0.0
+        const sensor_msgs::LaserScan & scan = *scan_.get();
 
         sensor_msgs::LaserScan visPropScan = scan;
         visPropScan.intensities.resize(visPropScan.ranges.size());
 
-        // order models by index
-        std::map<int, dynamic_gap::Estimator *> rawModels;
+        // order models by index, first model found at an index takes it
+        std::vector<std::pair<int, dynamic_gap::Estimator *>> indexedModels;
+        indexedModels.reserve(2 * rawGaps.size());
         for (const dynamic_gap::Gap * rawGap : rawGaps)
         {
             // left
@@ -48,7 +48,7 @@ namespace dynamic_gap
             int leftGapPtIdx = theta2idx(leftGapPtTheta);
 
             if (leftGapPtIdx >= 0 && leftGapPtIdx < scan.ranges.size())
-                rawModels.insert(std::pair<int, dynamic_gap::Estimator *>(leftGapPtIdx, rawGap->leftGapPtModel_));
+                indexedModels.push_back(std::make_pair(leftGapPtIdx, rawGap->leftGapPtModel_));
             else
                 ROS_WARN_STREAM_NAMED("DynamicScanPropagator", "        left gap pt idx out of bounds");
 
@@ -58,107 +58,79 @@ namespace dynamic_gap
             int rightGapPtIdx = theta2idx(rightGapPtTheta);
 
             if (rightGapPtIdx >= 0 && rightGapPtIdx < scan.ranges.size())
-                rawModels.insert(std::pair<int, dynamic_gap::Estimator *>(rightGapPtIdx, rawGap->rightGapPtModel_));
+                indexedModels.push_back(std::make_pair(rightGapPtIdx, rawGap->rightGapPtModel_));
             else
                 ROS_WARN_STREAM_NAMED("DynamicScanPropagator", "        right gap pt idx out of bounds");
 
         }
 
+        std::stable_sort(indexedModels.begin(), indexedModels.end(),
+                         [](const std::pair<int, dynamic_gap::Estimator *> & a, const std::pair<int, dynamic_gap::Estimator *> & b)
+                         { return a.first < b.first; });
+        indexedModels.erase(std::unique(indexedModels.begin(), indexedModels.end(),
+                                        [](const std::pair<int, dynamic_gap::Estimator *> & a, const std::pair<int, dynamic_gap::Estimator *> & b)
+                                        { return a.first == b.first; }),
+                            indexedModels.end());
+
+        // flat model handles: scan index, gap-only position, and gap-only velocity of each model
+        int modelCount = indexedModels.size();
+        std::vector<int> modelScanIndices(modelCount);
+        std::vector<Eigen::Vector2f> modelPositions(modelCount);
+        std::vector<Eigen::Vector2f> modelVelocities(modelCount);
+        for (int m = 0; m < modelCount; m++)
+        {
+            modelScanIndices[m] = indexedModels[m].first;
+            modelPositions[m] = indexedModels[m].second->getGapPosition();
+            modelVelocities[m] = indexedModels[m].second->getGapVelocity();
+        }
+
         // ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "    rawModels: ");
-        // for (std::map<int, dynamic_gap::Estimator *>::iterator iter = rawModels.begin();
-        //             iter != rawModels.end();
-        //             ++iter)
+        // for (int m = 0; m < modelCount; m++)
         // {
-        //     ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "        idx: " << iter->first << ", ID: " << iter->second->getID());
-        //     ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "            model state: " << iter->second->getGapState().transpose());
+        //     ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "        idx: " << modelScanIndices[m] << ", ID: " << indexedModels[m].second->getID());
+        //     ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "            model state: " << indexedModels[m].second->getGapState().transpose());
         // }
 
-        sensor_msgs::LaserScan defaultScan = scan;
-        sensor_msgs::LaserScan wipedScan = scan;
+        // attached rays in scan order, kept for fitting moving segments
+        std::vector<int> attachedRayIndices;
+        std::vector<int> attachedRayModels;
+        std::vector<Eigen::Vector2f> attachedRayPts;
 
-        // indices for each point
-        std::vector<int> pointwiseModelIndices(defaultScan.ranges.size());
-
-        // for each point in scan
-        // ROS_INFO_STREAM("defaultScan");
-        for (int i = 0; i < defaultScan.ranges.size(); i++)
+        // sweep scan points and sorted models together, nextModel is first model at or after scan index
+        int nextModel = 0;
+        for (int i = 0; modelCount > 0 && i < scan.ranges.size(); i++)
         {
-            // ROS_INFO_STREAM("       i: " << i);
-            // get right hand side model (model idx should be less than scan idx)
-            int rightHandSideModelIdx = -1;
-            std::map<int, dynamic_gap::Estimator *>::iterator right_iter;
-            for (right_iter = rawModels.begin(); right_iter != rawModels.end(); ++right_iter)
-            {
-                // ROS_INFO_STREAM("           checking righthand model : " << right_iter->first);
-                if (right_iter->first <= i)
-                {
-                    // ROS_INFO_STREAM("               replacing");
-                    rightHandSideModelIdx = right_iter->first;
-                    // no break, keep going
-                }
-            }
-            
-            if (rightHandSideModelIdx == -1) // no attachment
-            {
-                // ROS_INFO_STREAM("           no attachments for righthand model");            
-                rightHandSideModelIdx = prev(rawModels.end())->first;
-            }
+            while (nextModel < modelCount && modelScanIndices[nextModel] < i)
+                nextModel++;
 
-            // get left hand side model
-            int leftHandSideModelIdx = -1;
-            std::map<int, dynamic_gap::Estimator *>::iterator left_iter;
-            for (left_iter = rawModels.begin(); left_iter != rawModels.end(); ++left_iter)
-            {
-                // ROS_INFO_STREAM("           checking lefthand model : " << left_iter->first);
+            // left hand side model: first model at or after scan index, wrapping around to first model
+            int leftHandSideModel = (nextModel < modelCount) ? nextModel : 0;
 
-                if (left_iter->first >= i)
-                {
-                    // ROS_INFO_STREAM("           setting");
-                    leftHandSideModelIdx = left_iter->first;
-                    break;
-                }
-            }
-            
-            if (leftHandSideModelIdx == -1) // no attachment
-            {
-                // ROS_INFO_STREAM("           no attachments for lefthand model");                        
-                leftHandSideModelIdx = rawModels.begin()->first;
-            }
-            // ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "        at scan idx: " << i << ", LHS model idx: " << leftHandSideModelIdx << ", RHS model idx: " << rightHandSideModelIdx);
+            // right hand side model: last model at or before scan index, wrapping around to last model
+            int rightHandSideModel = -1;
+            if (nextModel < modelCount && modelScanIndices[nextModel] == i)
+                rightHandSideModel = nextModel;
+            else
+                rightHandSideModel = (nextModel > 0) ? nextModel - 1 : modelCount - 1;
+
+            // ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "        at scan idx: " << i << ", LHS model idx: " << modelScanIndices[leftHandSideModel] << ", RHS model idx: " << modelScanIndices[rightHandSideModel]);
 
             // run distance check on LHS and RHS model positions
-            float range = defaultScan.ranges.at(i);
+            float range = scan.ranges.at(i);
             float theta = idx2theta(i);
-
             Eigen::Vector2f scanPt(range*cos(theta), range*sin(theta));
 
-            // ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "        scanPt: " << scanPt.transpose());
-
-            Eigen::Vector2f lhsPt = rawModels.at(leftHandSideModelIdx)->getGapPosition();
-            Eigen::Vector2f lhsVel = rawModels.at(leftHandSideModelIdx)->getGapVelocity();
-            Eigen::Vector2f rhsPt = rawModels.at(rightHandSideModelIdx)->getGapPosition();
-            Eigen::Vector2f rhsVel = rawModels.at(rightHandSideModelIdx)->getGapVelocity();
-
-            // ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "        lhsPt: " << lhsPt.transpose());
-            // ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "        lhsVel: " << lhsVel.transpose());
-            // ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "        rhsPt: " << rhsPt.transpose());
-            // ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "        rhsVel: " << rhsVel.transpose());
-
-            // float scanToLHSDist = (scanPt - lhsPt).norm();
-            // float scanToRHSDist = (scanPt - rhsPt).norm();
-
-            // ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "        LHS model dist: " << scanToLHSDist << 
-            //                                                      ", RHS model dist: " << scanToRHSDist);
+            const Eigen::Vector2f & lhsPt = modelPositions[leftHandSideModel];
+            const Eigen::Vector2f & lhsVel = modelVelocities[leftHandSideModel];
+            const Eigen::Vector2f & rhsPt = modelPositions[rightHandSideModel];
+            const Eigen::Vector2f & rhsVel = modelVelocities[rightHandSideModel];
 
             // bit hacky, we just know moving obstacles will be roughly robot sized
-            // bool distCheck = (scanToLHSDist < 3 * cfg_->rbt.r_inscr * cfg_->traj.inf_ratio && 
-            //                   scanToRHSDist < 3 * cfg_->rbt.r_inscr * cfg_->traj.inf_ratio);
             bool distCheck = (lhsPt - rhsPt).norm() < 4 * cfg_->rbt.r_inscr * cfg_->traj.inf_ratio;
             bool speedCheck = (lhsVel.norm() >= 0.10 && rhsVel.norm() >= 0.10);
             // run angle check on LHS and RHS model velocities
 
             float vectorProj = lhsVel.dot(rhsVel) / (lhsVel.norm() * rhsVel.norm() + eps);
-            // ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "        vectorProj: " << vectorProj);
             bool angleCheck = (vectorProj > 0.0);
 
             // ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "        distCheck: " << distCheck << ", speedCheck: " << speedCheck << ", angleCheck: " << angleCheck);
@@ -166,85 +138,37 @@ namespace dynamic_gap
             // if attached
             if (distCheck && speedCheck && angleCheck)
             {
-                // set default scan range to max
-                wipedScan.ranges.at(i) = cfg_->scan.range_max; // set to max range
+                // wipe point from static part of scan and propagate it with closer model
                 visPropScan.intensities.at(i) = 255;
 
-                // set pointwise model index
-                if ( (scanPt - lhsPt).norm() < (scanPt - rhsPt).norm())
-                    pointwiseModelIndices.at(i) = leftHandSideModelIdx; // attach model
-                else
-                    pointwiseModelIndices.at(i) = rightHandSideModelIdx; // attach model
-                // ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "        attaching scan idx: " << i << " to model position :" << lhsPt.transpose() << " and velocity: " << lhsVel.transpose());
+                int attachedModel = ( (scanPt - lhsPt).norm() < (scanPt - rhsPt).norm()) ? leftHandSideModel : rightHandSideModel;
+                futureEgoCircle->addDynamicRay(i, scanPt, modelVelocities[attachedModel]);
 
-            } else
-            {
-                // set pointwise model index
-                pointwiseModelIndices.at(i) = -1; // attach no model
+                attachedRayIndices.push_back(i);
+                attachedRayModels.push_back(attachedModel);
+                attachedRayPts.push_back(scanPt);
             }
-    
         }
 
-        // for each timestep
-        float t_i = 0.0, t_iplus1 = 0.0;
-        for (int futureScanTimeIdx = 1; futureScanTimeIdx < futureScans.size(); futureScanTimeIdx++) 
-        {        
-            t_iplus1 = t_i + cfg_->traj.integrate_stept;
-            // ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "        propagating scan at t: " << t_iplus1);
-
-            sensor_msgs::LaserScan propagatedScan = wipedScan;
+        if (cfg_->planning.dynamic_segment_clearance)
+        {
+            // each run of neighboring rays attached to the same model moves as one piece
+            int runStart = 0;
+            for (int r = 1; r <= attachedRayIndices.size(); r++)
+            {
+                if (r < attachedRayIndices.size() && 
+                    attachedRayIndices[r] == attachedRayIndices[r - 1] + 1 && 
+                    attachedRayModels[r] == attachedRayModels[runStart])
+                    continue;
 
-            // for each point in scan
-            for (int i = 0; i < defaultScan.ranges.size(); i++)
-            {            
-                if (pointwiseModelIndices.at(i) > 0)
-                {
-                    // polar to cartesian
-                    float range = defaultScan.ranges.at(i);
-                    float theta = idx2theta(i);
-
-                    Eigen::Vector2f scanPt(range*cos(theta), range*sin(theta));
-                    Eigen::Vector2f attachedPos = rawModels[pointwiseModelIndices.at(i)]->getGapPosition();
-                    Eigen::Vector2f attachedVel = rawModels[pointwiseModelIndices.at(i)]->getGapVelocity();
-                    // ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "            pointwiseModelIndices.at(i): " << pointwiseModelIndices.at(i));
-                    // ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "            attachedPos: " << attachedPos.transpose());
-                    // ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "            attachedVel: " << attachedVel.transpose());
-
-                    // propagate in cartesian
-                    Eigen::Vector2f propagatedPt = scanPt + t_iplus1 * attachedVel;
-                    // ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "            propagating scan point: " << scanPt.transpose() << " to " << propagatedPt.transpose());
-
-                    // cartesian to polar
-                    float propagatedTheta = std::atan2(propagatedPt[1], propagatedPt[0]);
-                    int propagatedIdx = theta2idx(propagatedTheta);
-                    float propagatedNorm = propagatedPt.norm();
-
-                    if (propagatedIdx >= 0 && propagatedIdx < propagatedScan.ranges.size())
-                    {
-                        // if (propagated range at theta is shorter than existing range at theta)
-                        if (propagatedScan.ranges.at(propagatedIdx) > propagatedNorm)
-                        {
-                            // update
-                            // ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "            at idx: " << i << ", replacing range " << propagatedScan.ranges.at(propagatedIdx) << " with " << propagatedNorm);
-                            propagatedScan.ranges.at(propagatedIdx) = propagatedNorm;
-                        }
-                    } else
-                    {
-                        // ROS_WARN_STREAM_NAMED("DynamicScanPropagator", "            propagated index out of bounds");
-                        // ROS_WARN_STREAM_NAMED("DynamicScanPropagator", "                propagated point" << propagatedPt.transpose());
-                        // ROS_WARN_STREAM_NAMED("DynamicScanPropagator", "                propagated theta" << propagatedTheta);
-                        // ROS_WARN_STREAM_NAMED("DynamicScanPropagator", "                propagated idx" << propagatedIdx);
-                    
-                    }
-                }
+                fitDynamicSegments(*futureEgoCircle, attachedRayPts, runStart, r - 1, modelVelocities[attachedRayModels[runStart]]);
+                runStart = r;
             }
 
-            futureScans.at(futureScanTimeIdx) = propagatedScan;
-
-            t_i = t_iplus1;
+            // ROS_INFO_STREAM_NAMED("DynamicScanPropagator", "    fit " << futureEgoCircle->segmentCount() << " segments to " << attachedRayIndices.size() << " dynamic rays");
         }
 
-        // for the *first* entry to futureScans, we set the intensity values
+        // for the first slice of the future egocircle, we set the intensity values
         // to max for the scan points that *are* attached to models, meaning the
         // scan points that we estimate to be dynamic, we then visualize this scan
         // to verify what portions of the scan are being estimated as dynamic
@@ -252,6 +176,92 @@ namespace dynamic_gap
 
         visualizePropagatedEgocircle(visPropScan);        
 
-        return futureScans;
+        return futureEgoCircle;
+    }
+
+    std::shared_ptr<const FutureEgoCircle> DynamicScanPropagator::propagateCurrentLaserScanCheat(const dynamic_gap::AgentTable & agents)
+    {
+        // ROS_INFO_STREAM_NAMED("DynamicScanPropagator", " [propagateCurrentLaserScanCheat]: ");
+
+        int sliceCount = int(cfg_->traj.integrate_maxt/cfg_->traj.integrate_stept) + 1;
+        std::shared_ptr<FutureEgoCircle> futureEgoCircle = std::make_shared<FutureEgoCircle>(scan_, sliceCount, 
+                                                                                             cfg_->traj.integrate_stept,
+                                                                                             cfg_->scan.range_max);
+
+        const sensor_msgs::LaserScan & scan = *scan_.get();
+
+        sensor_msgs::LaserScan visPropScan = scan;
+        visPropScan.intensities.resize(visPropScan.ranges.size());
+
+        float agentRadius = cfg_->planning.cheat_agent_radius;
+
+        // scan returns off of an agent can land a little outside of its nominal disc
+        float wipeDist = 1.5 * agentRadius;
+
+        for (int i = 0; i < scan.ranges.size(); i++)
+        {
+            float range = scan.ranges.at(i);
+            float theta = idx2theta(i);
+
+            if (agents.findNearestAgent(range*cos(theta), range*sin(theta), wipeDist) >= 0)
+            {
+                futureEgoCircle->wipeRay(i);
+                visPropScan.intensities.at(i) = 255;
+            }
+        }
+
+        for (int slot = 0; slot < agents.size(); slot++)
+        {
+            Eigen::Vector2f agentPos(agents.pose(slot).position.x, agents.pose(slot).position.y);
+            Eigen::Vector2f agentVel(agents.vel(slot).vector.x, agents.vel(slot).vector.y);
+
+            futureEgoCircle->addDynamicDisc(agentPos, agentVel, agentRadius);
+        }
+
+        visualizePropagatedEgocircle(visPropScan);        
+
+        return futureEgoCircle;
+    }
+
+    void DynamicScanPropagator::fitDynamicSegments(FutureEgoCircle & futureEgoCircle,
+                                                   const std::vector<Eigen::Vector2f> & runPts,
+                                                   const int & firstPt,
+                                                   const int & lastPt,
+                                                   const Eigen::Vector2f & vel)
+    {
+        // split run at its farthest point from the chord until every point is within tolerance
+        std::vector<std::pair<int, int>> pendingRuns(1, std::make_pair(firstPt, lastPt));
+        while (!pendingRuns.empty())
+        {
+            int first = pendingRuns.back().first, last = pendingRuns.back().second;
+            pendingRuns.pop_back();
+
+            const Eigen::Vector2f & start = runPts[first];
+            Eigen::Vector2f chord = runPts[last] - start;
+            float chordSqNorm = chord.squaredNorm();
+
+            int farthestPt = -1;
+            float maxDist = cfg_->planning.dynamic_segment_tolerance;
+            for (int i = first + 1; i < last; i++)
+            {
+                Eigen::Vector2f relPt = runPts[i] - start;
+                float proj = (chordSqNorm > 0.0) ? std::max(0.0f, std::min(1.0f, relPt.dot(chord) / chordSqNorm)) : 0.0f;
+                float dist = (relPt - proj * chord).norm();
+                if (dist > maxDist)
+                {
+                    maxDist = dist;
+                    farthestPt = i;
+                }
+            }
+
+            if (farthestPt < 0)
+            {
+                futureEgoCircle.addDynamicSegment(start, runPts[last], vel);
+            } else
+            {
+                pendingRuns.push_back(std::make_pair(farthestPt, last));
+                pendingRuns.push_back(std::make_pair(first, farthestPt));
+            }
+        }
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,201 @@
+#include <dynamic_gap/scan_processing/FutureEgoCircle.h>
+#include <dynamic_gap/utils/Utils.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace dynamic_gap
+{
+    FutureEgoCircle::FutureEgoCircle(const boost::shared_ptr<sensor_msgs::LaserScan const> & scan,
+                                     const int & sliceCount,
+                                     const float & timeStep,
+                                     const float & wipedRange)
+    {
+        scan_ = scan;
+        sliceCount_ = sliceCount;
+        timeStep_ = timeStep;
+        wipedRange_ = wipedRange;
+
+        slices_.resize(sliceCount_);
+        sliceFlags_.reset(new std::once_flag[sliceCount_]);
+    }
+
+    void FutureEgoCircle::wipeRay(const int & scanIdx)
+    {
+        if (staticRanges_.empty())
+            staticRanges_ = scan_->ranges;
+
+        staticRanges_.at(scanIdx) = wipedRange_;
+    }
+
+    void FutureEgoCircle::addDynamicRay(const int & scanIdx, const Eigen::Vector2f & pt, const Eigen::Vector2f & vel)
+    {
+        wipeRay(scanIdx);
+        dynamicXs_.push_back(pt[0]);
+        dynamicYs_.push_back(pt[1]);
+        dynamicVxs_.push_back(vel[0]);
+        dynamicVys_.push_back(vel[1]);
+    }
+
+    void FutureEgoCircle::addDynamicSegment(const Eigen::Vector2f & start, const Eigen::Vector2f & end, const Eigen::Vector2f & vel)
+    {
+        segmentStarts_.push_back(start);
+        segmentEnds_.push_back(end);
+        segmentVels_.push_back(vel);
+    }
+
+    void FutureEgoCircle::addDynamicDisc(const Eigen::Vector2f & center, const Eigen::Vector2f & vel, const float & radius)
+    {
+        if (staticRanges_.empty())
+            staticRanges_ = scan_->ranges;
+
+        discCenters_.push_back(center);
+        discVels_.push_back(vel);
+        discRadii_.push_back(radius);
+    }
+
+    const std::vector<float> & FutureEgoCircle::ranges(const int & timeIdx) const
+    {
+        if (timeIdx < 0 || timeIdx >= sliceCount_)
+            throw std::out_of_range("time index " + std::to_string(timeIdx) + " is outside of future egocircle");
+
+        // current scan is the first slice, and every slice when nothing is moving
+        if (timeIdx == 0 || (dynamicXs_.empty() && discCenters_.empty()))
+            return scan_->ranges;
+
+        std::call_once(sliceFlags_[timeIdx], &FutureEgoCircle::buildSlice, this, timeIdx);
+        return slices_[timeIdx];
+    }
+
+    void FutureEgoCircle::buildSlices(dynamic_gap::WorkerPool * pool) const
+    {
+        if ((dynamicXs_.empty() && discCenters_.empty()) || !segmentStarts_.empty())
+            return;
+
+        // slices only share read-only inputs, and each one is built exactly once
+        pool->parallelFor(sliceCount_ - 1, slicesPerBuildChunk_, [&](const int & begin, const int & end)
+        {
+            for (int timeIdx = begin + 1; timeIdx < end + 1; timeIdx++)
+                std::call_once(sliceFlags_[timeIdx], &FutureEgoCircle::buildSlice, this, timeIdx);
+        });
+    }
+
+    void FutureEgoCircle::buildSlice(const int & timeIdx) const
+    {
+        float t = timeIdx * timeStep_;
+        int dynamicCount = dynamicXs_.size();
+
+        std::vector<float> propagatedXs(dynamicCount), propagatedYs(dynamicCount), propagatedNorms(dynamicCount);
+        std::vector<int> propagatedIdxs(dynamicCount);
+
+        // propagate in cartesian, branch-free over flat arrays so that it vectorizes
+        for (int i = 0; i < dynamicCount; i++)
+        {
+            propagatedXs[i] = dynamicXs_[i] + t * dynamicVxs_[i];
+            propagatedYs[i] = dynamicYs_[i] + t * dynamicVys_[i];
+            propagatedNorms[i] = std::sqrt(propagatedXs[i] * propagatedXs[i] + propagatedYs[i] * propagatedYs[i]);
+        }
+
+        // cartesian to polar
+        for (int i = 0; i < dynamicCount; i++)
+            propagatedIdxs[i] = theta2idx(std::atan2(propagatedYs[i], propagatedXs[i]));
+
+        std::vector<float> & slice = slices_[timeIdx];
+        slice = staticRanges_;
+
+        // keep closer of propagated point and existing range at theta, min does not depend on scatter order
+        for (int i = 0; i < dynamicCount; i++)
+        {
+            int propagatedIdx = propagatedIdxs[i];
+            if (propagatedIdx >= 0 && propagatedIdx < slice.size() && slice[propagatedIdx] > propagatedNorms[i])
+                slice[propagatedIdx] = propagatedNorms[i];
+        }
+
+        castDiscs(t, slice);
+    }
+
+    void FutureEgoCircle::castDiscs(const float & t, std::vector<float> & slice) const
+    {
+        int rayCount = slice.size();
+        if (rayCount == 0)
+            return;
+
+        for (int d = 0; d < discCenters_.size(); d++)
+        {
+            Eigen::Vector2f center = discCenters_[d] + t * discVels_[d];
+            float centerDist = center.norm();
+            float radius = discRadii_[d];
+
+            // disc covering sensor cannot be seen along any ray
+            if (centerDist <= radius)
+                continue;
+
+            // rays that can hit disc lie within its angular half-width around its center bearing,
+            // padded by a ray on each side to cover rounding of ray bearings
+            float centerTheta = std::atan2(center[1], center[0]);
+            float halfWidth = std::asin(radius / centerDist);
+            int firstRay = int(std::floor((centerTheta - halfWidth + M_PI) / angle_increment)) - 1;
+            int lastRay = std::min(firstRay + rayCount - 1, int(std::ceil((centerTheta + halfWidth + M_PI) / angle_increment)) + 1);
+
+            for (int j = firstRay; j <= lastRay; j++)
+            {
+                int i = ((j % rayCount) + rayCount) % rayCount;
+
+                // ray-circle intersection along ray at theta: range^2 - 2 range (c . u) + |c|^2 - r^2 = 0
+                float relTheta = idx2theta(i) - centerTheta;
+                float alongRay = centerDist * std::cos(relTheta);
+                float acrossRay = centerDist * std::sin(relTheta);
+                float discriminant = radius * radius - acrossRay * acrossRay;
+                if (alongRay <= 0.0 || discriminant < 0.0)
+                    continue;
+
+                float hitRange = alongRay - std::sqrt(discriminant);
+                if (slice[i] > hitRange)
+                    slice[i] = hitRange;
+            }
+        }
+    }
+
+    float FutureEgoCircle::clearance(const int & timeIdx, const geometry_msgs::Pose & pose) const
+    {
+        if (!segmentStarts_.empty())
+            return segmentClearance(timeIdx, pose);
+
+        const std::vector<float> & sliceRanges = ranges(timeIdx);
+
+        float minDist = std::numeric_limits<float>::infinity();
+        for (int i = 0; i < sliceRanges.size(); i++)
+            minDist = std::min(minDist, dist2Pose(idx2theta(i), sliceRanges[i], pose));
+
+        return minDist;
+    }
+
+    float FutureEgoCircle::segmentClearance(const int & timeIdx, const geometry_msgs::Pose & pose) const
+    {
+        if (timeIdx < 0 || timeIdx >= sliceCount_)
+            throw std::out_of_range("time index " + std::to_string(timeIdx) + " is outside of future egocircle");
+
+        float minDist = std::numeric_limits<float>::infinity();
+        for (int i = 0; i < staticRanges_.size(); i++)
+            minDist = std::min(minDist, dist2Pose(idx2theta(i), staticRanges_[i], pose));
+
+        // moving the pose backwards is the same as moving every segment forwards
+        float t = timeIdx * timeStep_;
+        Eigen::Vector2f rbtPt(pose.position.x, pose.position.y);
+        for (int s = 0; s < segmentStarts_.size(); s++)
+        {
+            Eigen::Vector2f relPt = rbtPt - t * segmentVels_[s] - segmentStarts_[s];
+            Eigen::Vector2f segment = segmentEnds_[s] - segmentStarts_[s];
+
+            // closest point on segment, clamped to its end points
+            float segmentSqNorm = segment.squaredNorm();
+            float proj = (segmentSqNorm > 0.0) ? std::max(0.0f, std::min(1.0f, relPt.dot(segment) / segmentSqNorm)) : 0.0f;
+
+            minDist = std::min(minDist, (relPt - proj * segment).norm());
+        }
+
+        return minDist;
+    }
+}
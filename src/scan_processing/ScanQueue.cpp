@@ -0,0 +1,106 @@
+#include <dynamic_gap/scan_processing/ScanQueue.h>
+
+#include <algorithm>
+#include <chrono>
+
+namespace dynamic_gap
+{
+    ScanQueue::ScanQueue(const DynamicGapConfig& cfg)
+    {
+        cfg_ = &cfg;
+
+        capacity_ = std::max(1, cfg_->scan.queue_size);
+        slots_.reset(new std::atomic<ScanNode *>[capacity_]);
+        for (int i = 0; i < capacity_; i++)
+            slots_[i] = NULL;
+
+        head_ = 0;
+        droppedScans_ = 0;
+        stopping_ = false;
+    }
+
+    ScanQueue::~ScanQueue()
+    {
+        for (int i = 0; i < capacity_; i++)
+            delete slots_[i].exchange(NULL);
+    }
+
+    void ScanQueue::push(const boost::shared_ptr<sensor_msgs::LaserScan> & scan)
+    {
+        uint64_t seq = head_.load(std::memory_order_relaxed);
+
+        // slot still holds scan from capacity_ pushes ago if perception has not taken it yet
+        ScanNode * staleNode = slots_[seq % capacity_].exchange(new ScanNode{seq, scan}, std::memory_order_acq_rel);
+        if (staleNode)
+        {
+            delete staleNode;
+            droppedScans_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        head_.store(seq + 1, std::memory_order_release);
+
+        // perception thread re-checks queue periodically, so wake up is not taken under wait mutex
+        scanCondition_.notify_one();
+    }
+
+    bool ScanQueue::tryPop(boost::shared_ptr<sensor_msgs::LaserScan> & scan)
+    {
+        uint64_t head = head_.load(std::memory_order_acquire);
+
+        // scans more than capacity_ behind head have been overwritten
+        if (head > tail_ + capacity_)
+            tail_ = head - capacity_;
+
+        while (tail_ < head)
+        {
+            ScanNode * node = slots_[tail_ % capacity_].exchange(NULL, std::memory_order_acq_rel);
+
+            if (!node)
+            {
+                tail_++;
+                continue;
+            }
+
+            // scan left behind after an earlier scan was overwritten, newer scans have already been taken
+            if (node->seq < tail_)
+            {
+                delete node;
+                droppedScans_.fetch_add(1, std::memory_order_relaxed);
+                tail_++;
+                continue;
+            }
+
+            // scan callback may have overwritten this slot with a newer scan since head was read
+            tail_ = node->seq + 1;
+            scan = node->scan;
+            delete node;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool ScanQueue::pop(boost::shared_ptr<sensor_msgs::LaserScan> & scan)
+    {
+        while (!stopping_.load())
+        {
+            if (tryPop(scan))
+                return true;
+
+            std::unique_lock<std::mutex> lock(waitMutex_);
+            scanCondition_.wait_for(lock, std::chrono::milliseconds(5),
+                                    [this]{ return stopping_.load() || head_.load(std::memory_order_acquire) != tail_; });
+        }
+
+        return false;
+    }
+
+    void ScanQueue::shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> lock(waitMutex_);
+            stopping_ = true;
+        }
+        scanCondition_.notify_all();
+    }
+}
@@ -24,7 +24,7 @@ namespace dynamic_gap
     void TrajectoryEvaluator::evaluateTrajectory(const dynamic_gap::Trajectory & traj,
                                                 std::vector<float> & posewiseCosts,
                                                 float & terminalPoseCost,
-                                                const std::vector<sensor_msgs::LaserScan> & futureScans) 
+                                                const dynamic_gap::FutureEgoCircle & futureEgoCircle) 
     {    
         ROS_INFO_STREAM_NAMED("GapTrajectoryGenerator", "         [evaluateTrajectory()]");
         // Requires LOCAL FRAME
@@ -37,7 +37,7 @@ namespace dynamic_gap
         for (int i = 0; i < posewiseCosts.size(); i++) 
         {
             // std::cout << "regular range at " << i << ": ";
-            posewiseCosts.at(i) = evaluatePose(path.poses.at(i), futureScans.at(i)); //  / posewiseCosts.size()
+            posewiseCosts.at(i) = evaluatePose(path.poses.at(i), futureEgoCircle, i); //  / posewiseCosts.size()
             ROS_INFO_STREAM_NAMED("GapTrajectoryGenerator", "           pose " << i << " score: " << posewiseCosts.at(i));
         }
         float totalTrajCost = std::accumulate(posewiseCosts.begin(), posewiseCosts.end(), float(0));
@@ -55,6 +55,28 @@ namespace dynamic_gap
         return;
     }
 
+    std::vector<float> TrajectoryEvaluator::trajectoryCostLowerBounds(const std::vector<float> & reaches,
+                                                                      const dynamic_gap::FutureEgoCircle & futureEgoCircle)
+    {
+        // processed trajectories always start at robot's current pose
+        geometry_msgs::Pose originPose;
+        originPose.orientation.w = 1.0;
+        float originPoseCost = evaluatePose(originPose, futureEgoCircle, 0);
+
+        float waypointDist = 0.0;
+        {
+            boost::mutex::scoped_lock planlock(globalPlanMutex_);
+            waypointDist = sqrt(pow(globalPathLocalWaypointRobotFrame_.pose.position.x, 2) + 
+                                pow(globalPathLocalWaypointRobotFrame_.pose.position.y, 2));
+        }
+
+        std::vector<float> lowerBounds(reaches.size());
+        for (int i = 0; i < reaches.size(); i++)
+            lowerBounds.at(i) = originPoseCost + cfg_->traj.Q_f * std::max(0.0f, waypointDist - reaches.at(i));
+
+        return lowerBounds;
+    }
+
     float TrajectoryEvaluator::terminalGoalCost(const geometry_msgs::Pose & pose) 
     {
         boost::mutex::scoped_lock planlock(globalPlanMutex_);
@@ -66,33 +88,17 @@ namespace dynamic_gap
     }
 
     float TrajectoryEvaluator::evaluatePose(const geometry_msgs::Pose & pose,
-                                      const sensor_msgs::LaserScan scan_k) 
+                                            const dynamic_gap::FutureEgoCircle & futureEgoCircle,
+                                            const int & timeIdx) 
     {
-        boost::mutex::scoped_lock lock(scanMutex_);
-        // sensor_msgs::LaserScan scan = *scan_.get();
-
-        // obtain orientation and idx of pose
-
-        // dist is size of scan
-        std::vector<float> scan2RbtDists(scan_k.ranges.size());
-
-        // iterate through ranges and obtain the distance from the egocircle point and the pose
-        // Meant to find where is really small
-        // float currScan2RbtDist = 0.0;
-        for (int i = 0; i < scan2RbtDists.size(); i++) 
-        {
-            scan2RbtDists.at(i) = dist2Pose(idx2theta(i), scan_k.ranges.at(i), pose);
-        }
+        // future egocircle view is immutable, so poses of different trajectories can be scored at once
 
-        auto iter = std::min_element(scan2RbtDists.begin(), scan2RbtDists.end());
-        // std::cout << "robot pose: " << pose.position.x << ", " << pose.position.y << ")" << std::endl;
-        int minDistIdx = std::distance(scan2RbtDists.begin(), iter);
-        float range = scan_k.ranges.at(minDistIdx);
-        float theta = idx2theta(minDistIdx);
-        float cost = chapterCost(*iter);
-        //std::cout << *iter << ", regular cost: " << cost << std::endl;
+        // distance from pose to closest point of scan at pose's time index
+        float rbtToScanDist = futureEgoCircle.clearance(timeIdx, pose);
+        float cost = chapterCost(rbtToScanDist);
+        //std::cout << rbtToScanDist << ", regular cost: " << cost << std::endl;
         ROS_INFO_STREAM_NAMED("TrajectoryEvaluator", "            robot pose: " << pose.position.x << ", " << pose.position.y << 
-                    ", closest scan point: " << range * std::cos(theta) << ", " << range * std::sin(theta) << ", static cost: " << cost);
+                    ", distance to scan: " << rbtToScanDist << ", static cost: " << cost);
         return cost;
     }
 
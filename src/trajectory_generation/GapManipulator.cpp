@@ -1,11 +1,28 @@
 #include <dynamic_gap/trajectory_generation/GapManipulator.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
 namespace dynamic_gap 
 {
     void GapManipulator::updateEgoCircle(boost::shared_ptr<sensor_msgs::LaserScan const> scan) 
     {
         boost::mutex::scoped_lock lock(scanMutex_);
         scan_ = scan;
+
+        minScanRange_ = scan_->ranges.empty() ? 0.0 : *std::min_element(scan_->ranges.begin(), scan_->ranges.end());
+
+        // window searches look up cosines by index span rather than computing one per ray
+        int spanCount = 2 * cfg_->scan.full_scan + 1;
+        if (spanCos_.size() != spanCount || spanCosAngleIncrement_ != cfg_->scan.angle_increment)
+        {
+            spanCosAngleIncrement_ = cfg_->scan.angle_increment;
+            spanCos_.resize(spanCount);
+            for (int idxSpan = 0; idxSpan < spanCount; idxSpan++)
+                spanCos_[idxSpan] = std::cos(idxSpan * spanCosAngleIncrement_);
+        }
     }
 
     void GapManipulator::setGapGoal(dynamic_gap::Gap * gap, 
@@ -163,13 +180,17 @@ namespace dynamic_gap
                                                     const Eigen::Vector2f & rightPt,
                                                     const Eigen::Vector2f & globalGoal) 
     {
-        boost::mutex::scoped_lock lock(scanMutex_);
+        boost::shared_ptr<sensor_msgs::LaserScan const> scan;
+        float minScanRange = 0.0;
+        {
+            boost::mutex::scoped_lock lock(scanMutex_);
+            scan = scan_;
+            minScanRange = minScanRange_;
+        }
+
         // with robot as 0,0 (globalGoal in robot frame as well)
         float dist2goal = globalGoal.norm(); // sqrt(pow(globalGoal.pose.position.x, 2) + pow(globalGoal.pose.position.y, 2));
 
-        sensor_msgs::LaserScan scan = *scan_.get();
-        auto minScanRange = *std::min_element(scan.ranges.begin(), scan.ranges.end());
-
         // If sufficiently close to robot
         if (dist2goal < 2 * cfg_->rbt.r_inscr)
             return true;
@@ -190,11 +211,62 @@ namespace dynamic_gap
         // float leftToWaypointAngle = getSweptLeftToRightAngle(leftPt, globalGoal);
         // float gapGoalRange = (rightPt.norm() - leftPt.norm()) * epsilonDivide(leftToWaypointAngle, leftToRightAngle) + leftPt.norm();
 
-        float rangeAtGoalIdx = scan.ranges.at(globalGoalIdx);
+        float rangeAtGoalIdx = scan->ranges.at(globalGoalIdx);
 
         return dist2goal < rangeAtGoalIdx;
     }
 
+    int GapManipulator::findClosestScanIdx(const std::vector<float> & ranges,
+                                            const float & nearRange,
+                                            const int & scanSearchStartIdx,
+                                            const int & scanSearchSize,
+                                            const int & startIdxSpan,
+                                            float & minDist)
+    {
+        int fullScan = ranges.size();
+        if (fullScan == 0 || scanSearchSize <= 0)
+            throw std::out_of_range("scan search window is empty");
+        if (startIdxSpan - scanSearchSize + 1 < 0 || startIdxSpan >= spanCos_.size())
+            throw std::out_of_range("index span " + std::to_string(startIdxSpan) + " is outside of index span cosines");
+
+        float nearRangeSq = nearRange * nearRange;
+        float twoNearRange = 2.0 * nearRange;
+
+        float blockSqDists[scanSearchBlockSize_];
+        float minSqDist = std::numeric_limits<float>::infinity();
+        int minSqDistOffset = 0;
+
+        // index span shrinks by one per ray across window, so cosines are read backwards from start span
+        for (int blockStart = 0; blockStart < scanSearchSize; )
+        {
+            // blocks stop at end of scan so that rays within a block are contiguous
+            int blockScanIdx = (scanSearchStartIdx + blockStart) % fullScan;
+            int blockSize = std::min(scanSearchBlockSize_, std::min(scanSearchSize - blockStart, fullScan - blockScanIdx));
+
+            const float * blockRanges = ranges.data() + blockScanIdx;
+            const float * blockSpanCos = spanCos_.data() + (startIdxSpan - blockStart);
+
+            for (int j = 0; j < blockSize; j++)
+                blockSqDists[j] = nearRangeSq + blockRanges[j] * blockRanges[j] - twoNearRange * blockRanges[j] * blockSpanCos[-j];
+
+            // strict comparison keeps first closest ray, like std::min_element
+            for (int j = 0; j < blockSize; j++)
+            {
+                if (blockSqDists[j] < minSqDist)
+                {
+                    minSqDist = blockSqDists[j];
+                    minSqDistOffset = blockStart + j;
+                }
+            }
+
+            blockStart += blockSize;
+        }
+
+        // only closest ray needs a square root
+        minDist = std::sqrt(std::max(0.0f, minSqDist));
+        return (scanSearchStartIdx + minSqDistOffset) % fullScan;
+    }
+
     void GapManipulator::radialExtendGap(dynamic_gap::Gap * gap) 
     {
         try
@@ -262,7 +334,6 @@ namespace dynamic_gap
             if (!gap->isRadial()) 
                 return;
 
-            sensor_msgs::LaserScan desScan = *scan_.get();
             int leftIdx = gap->manipLeftIdx();
             int rightIdx = gap->manipRightIdx();
             float leftRange = gap->manipLeftRange();
@@ -401,24 +472,9 @@ namespace dynamic_gap
 
             // using the law of cosines to find the index between init/final indices
             // that's shortest distance between near point and laser scan
-            // // ROS_INFO_STREAM("ranges size: " << stored_scan_msgs.ranges.size());
-            std::vector<float> nearPtToScanDists(scanSearchSize);
-
-            int checkIdx = 0;
-            float checkRange = 0.0, checkIdxSpan = 0.0;
-            for (int i = 0; i < nearPtToScanDists.size(); i++) 
-            {
-                checkIdx = (i + scanSearchStartIdx) % cfg_->scan.full_scan; // int(2 * gap->half_scan);
-                checkRange = desScan.ranges.at(checkIdx);
-                checkIdxSpan = gapIdxSpan + (scanSearchSize - i);
-                nearPtToScanDists.at(i) = sqrt(pow(nearRange, 2) + pow(checkRange, 2) -
-                                            2.0 * nearRange * checkRange * cos(checkIdxSpan * cfg_->scan.angle_increment));
-                // // ROS_INFO_STREAM("checking idx: " << checkIdx << ", range of: " << range << ", diff in idx: " << checkIdxSpan << ", dist of " << dist.at(i));
-            }
-
-            auto minDistIter = std::min_element(nearPtToScanDists.begin(), nearPtToScanDists.end());
-            int minDistIdx = (scanSearchStartIdx + std::distance(nearPtToScanDists.begin(), minDistIter)) % cfg_->scan.full_scan; // int(2*gap->half_scan);
-            float minDistRange = *minDistIter;
+            float minDistRange = 0.0;
+            int minDistIdx = findClosestScanIdx(scan_->ranges, nearRange, scanSearchStartIdx, scanSearchSize, 
+                                                gapIdxSpan + scanSearchSize, minDistRange);
 
             // ROS_INFO_STREAM("from " << scanSearchStartIdx << " to " << scanSearchEndIdx << ", min dist of " << minDistRange << " at " << minDistIdx);         
 
@@ -480,8 +536,6 @@ namespace dynamic_gap
         try 
         {
             // get points
-
-            sensor_msgs::LaserScan desScan = *scan_.get();
             int leftIdx = gap->manipLeftIdx();
             int rightIdx = gap->manipRightIdx();
             float leftRange = gap->manipLeftRange();
@@ -0,0 +1,131 @@
+#include <dynamic_gap/utils/AgentTable.h>
+
+#include <cmath>
+
+namespace dynamic_gap
+{
+    AgentTable::AgentTable(const float & cellSize)
+    {
+        cellSize_ = cellSize;
+    }
+
+    void AgentTable::addAgent(const int & id,
+                              const geometry_msgs::Pose & pose,
+                              const geometry_msgs::Vector3Stamped & vel)
+    {
+        if (id < 0)
+            return;
+
+        if (id >= idSlots_.size())
+            idSlots_.resize(id + 1, -1);
+
+        // agent listed twice in a message keeps its latest state
+        int slot = idSlots_[id];
+        if (slot < 0)
+        {
+            slot = ids_.size();
+            idSlots_[id] = slot;
+            ids_.push_back(id);
+            poses_.push_back(pose);
+            vels_.push_back(vel);
+        } else
+        {
+            poses_[slot] = pose;
+            vels_[slot] = vel;
+        }
+    }
+
+    int AgentTable::cellCoord(const float & coord) const
+    {
+        return static_cast<int>(std::floor(coord / cellSize_));
+    }
+
+    int AgentTable::bucketIdx(const int & cellX, const int & cellY) const
+    {
+        // bucket count is a power of two
+        unsigned int hash = (static_cast<unsigned int>(cellX) * 73856093u) ^ (static_cast<unsigned int>(cellY) * 19349663u);
+        return hash & (bucketStarts_.size() - 2);
+    }
+
+    void AgentTable::buildSpatialHash()
+    {
+        // about two buckets per agent keeps collisions between occupied cells rare
+        int nBuckets = 1;
+        while (nBuckets < 2 * size())
+            nBuckets *= 2;
+
+        bucketStarts_.assign(nBuckets + 1, 0);
+        bucketSlots_.resize(size());
+
+        // counting sort of slots by bucket
+        std::vector<int> slotBuckets(size());
+        for (int slot = 0; slot < size(); slot++)
+        {
+            slotBuckets[slot] = bucketIdx(cellCoord(poses_[slot].position.x), cellCoord(poses_[slot].position.y));
+            bucketStarts_[slotBuckets[slot] + 1]++;
+        }
+
+        for (int bucket = 0; bucket < nBuckets; bucket++)
+            bucketStarts_[bucket + 1] += bucketStarts_[bucket];
+
+        std::vector<int> bucketFill(bucketStarts_.begin(), bucketStarts_.end() - 1);
+        for (int slot = 0; slot < size(); slot++)
+            bucketSlots_[bucketFill[slotBuckets[slot]]++] = slot;
+    }
+
+    int AgentTable::findNearestAgent(const float & x, const float & y, const float & maxDist) const
+    {
+        if (size() == 0 || bucketStarts_.size() < 2)
+            return -1;
+
+        int minCellX = cellCoord(x - maxDist), maxCellX = cellCoord(x + maxDist);
+        int minCellY = cellCoord(y - maxDist), maxCellY = cellCoord(y + maxDist);
+
+        int nearestSlot = -1;
+        float minDistSq = maxDist * maxDist;
+        auto checkSlot = [&](const int & slot)
+        {
+            float dx = poses_[slot].position.x - x;
+            float dy = poses_[slot].position.y - y;
+            float distSq = dx*dx + dy*dy;
+
+            // ties go to lowest slot so that result does not depend on cell visiting order
+            if (distSq < minDistSq || (distSq == minDistSq && nearestSlot >= 0 && slot < nearestSlot))
+            {
+                minDistSq = distSq;
+                nearestSlot = slot;
+            }
+        };
+
+        // query region covering more cells than there are agents is cheaper to scan directly
+        double nCells = (double(maxCellX) - minCellX + 1) * (double(maxCellY) - minCellY + 1);
+        if (nCells >= size())
+        {
+            for (int slot = 0; slot < size(); slot++)
+                checkSlot(slot);
+
+            return nearestSlot;
+        }
+
+        for (int cellX = minCellX; cellX <= maxCellX; cellX++)
+        {
+            for (int cellY = minCellY; cellY <= maxCellY; cellY++)
+            {
+                // buckets shared with other cells are filtered by true distance
+                int bucket = bucketIdx(cellX, cellY);
+                for (int i = bucketStarts_[bucket]; i < bucketStarts_[bucket + 1]; i++)
+                    checkSlot(bucketSlots_[i]);
+            }
+        }
+
+        return nearestSlot;
+    }
+
+    int AgentTable::findAgent(const int & id) const
+    {
+        if (id < 0 || id >= idSlots_.size())
+            return -1;
+
+        return idSlots_[id];
+    }
+}
@@ -0,0 +1,95 @@
+#include <dynamic_gap/utils/Checkpoint.h>
+
+#include <stdexcept>
+
+namespace dynamic_gap
+{
+    namespace
+    {
+        const uint32_t checkpointMagic = 0x50434744; /**< "DGCP" */
+        const uint32_t checkpointVersion = 1; /**< bumped whenever checkpoint layout changes */
+    }
+
+    CheckpointWriter::CheckpointWriter(const std::string & path)
+    {
+        stream_.open(path, std::ios::binary | std::ios::trunc);
+        if (!stream_)
+            throw std::runtime_error("could not open checkpoint " + path + " for writing");
+
+        write(checkpointMagic);
+        write(checkpointVersion);
+    }
+
+    void CheckpointWriter::close()
+    {
+        stream_.flush();
+        if (!stream_)
+            throw std::runtime_error("failed to write checkpoint");
+        stream_.close();
+    }
+
+    void CheckpointWriter::write(const std::string & value)
+    {
+        write(static_cast<uint32_t>(value.size()));
+        stream_.write(value.data(), value.size());
+    }
+
+    void CheckpointWriter::write(const ros::Time & value)
+    {
+        write(value.sec);
+        write(value.nsec);
+    }
+
+    CheckpointReader::CheckpointReader(const std::string & path)
+    {
+        stream_.open(path, std::ios::binary | std::ios::ate);
+        if (!stream_)
+            throw std::runtime_error("could not open checkpoint " + path + " for reading");
+
+        remaining_ = stream_.tellg();
+        stream_.seekg(0);
+
+        uint32_t magic = 0, version = 0;
+        read(magic);
+        read(version);
+
+        if (magic != checkpointMagic)
+            throw std::runtime_error(path + " is not a checkpoint");
+
+        if (version != checkpointVersion)
+            throw std::runtime_error("checkpoint " + path + " has version " + std::to_string(version) +
+                                     ", expected version " + std::to_string(checkpointVersion));
+    }
+
+    void CheckpointReader::readBytes(char * data, const std::streamsize & size)
+    {
+        if (size > remaining_ || !stream_.read(data, size))
+            throw std::runtime_error("checkpoint is truncated");
+
+        remaining_ -= size;
+    }
+
+    uint32_t CheckpointReader::readCount()
+    {
+        uint32_t count = 0;
+        read(count);
+
+        // every element takes at least one byte
+        if (count > remaining_)
+            throw std::runtime_error("checkpoint is corrupted");
+
+        return count;
+    }
+
+    void CheckpointReader::read(std::string & value)
+    {
+        value.resize(readCount());
+        readBytes(&value[0], value.size());
+    }
+
+    void CheckpointReader::read(ros::Time & value)
+    {
+        read(value.sec);
+        read(value.nsec);
+    }
+}
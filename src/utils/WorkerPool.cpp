@@ -0,0 +1,114 @@
+#include <dynamic_gap/utils/WorkerPool.h>
+
+#include <algorithm>
+
+namespace dynamic_gap
+{
+    WorkerPool::WorkerPool(const int & nThreads)
+    {
+        nextChunk_ = 0;
+
+        for (int i = 1; i < nThreads; i++)
+            workers_.emplace_back(&WorkerPool::workerLoop, this);
+    }
+
+    WorkerPool::~WorkerPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        jobCondition_.notify_all();
+
+        for (std::thread & worker : workers_)
+            worker.join();
+    }
+
+    void WorkerPool::parallelFor(const int & nItems,
+                                 const int & chunkSize,
+                                 const std::function<void(const int &, const int &)> & job)
+    {
+        if (nItems <= 0)
+            return;
+
+        int nChunks = (nItems + chunkSize - 1) / chunkSize;
+
+        // same chunks as parallel run, only on calling thread
+        if (workers_.empty() || nChunks == 1)
+        {
+            for (int chunk = 0; chunk < nChunks; chunk++)
+                job(chunk * chunkSize, std::min(nItems, (chunk + 1) * chunkSize));
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &job;
+            nItems_ = nItems;
+            chunkSize_ = chunkSize;
+            nChunks_ = nChunks;
+            nextChunk_ = 0;
+            busyWorkers_ = workers_.size();
+            jobException_ = nullptr;
+            jobCount_++;
+        }
+        jobCondition_.notify_all();
+
+        runChunks();
+
+        std::exception_ptr jobException;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            doneCondition_.wait(lock, [this]{ return busyWorkers_ == 0; });
+            job_ = NULL;
+            jobException = jobException_;
+            jobException_ = nullptr;
+        }
+
+        if (jobException)
+            std::rethrow_exception(jobException);
+    }
+
+    void WorkerPool::workerLoop()
+    {
+        unsigned long jobsSeen = 0;
+
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                jobCondition_.wait(lock, [&]{ return stopping_ || jobCount_ != jobsSeen; });
+
+                if (stopping_)
+                    return;
+
+                jobsSeen = jobCount_;
+            }
+
+            runChunks();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                busyWorkers_--;
+            }
+            doneCondition_.notify_one();
+        }
+    }
+
+    void WorkerPool::runChunks()
+    {
+        int chunk = 0;
+        while ((chunk = nextChunk_.fetch_add(1)) < nChunks_)
+        {
+            try
+            {
+                (*job_)(chunk * chunkSize_, std::min(nItems_, (chunk + 1) * chunkSize_));
+            } catch (...)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!jobException_)
+                    jobException_ = std::current_exception();
+            }
+        }
+    }
+}
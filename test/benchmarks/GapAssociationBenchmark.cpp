@@ -0,0 +1,85 @@
+#include <ros/ros.h>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <dynamic_gap/gap_estimation/GapAssociator.h>
+
+// Times GapAssociator::associateGaps on distance matrices between consecutive sets of 10 to 400 gap points.
+// Current gap points are previous gap points that moved slightly, with some points vanishing and some appearing.
+
+namespace
+{
+    Eigen::MatrixXf gapPointDistMatrix(std::mt19937 & rng, const int & pointCount)
+    {
+        std::uniform_real_distribution<float> bearingDist(-M_PI, M_PI);
+        std::uniform_real_distribution<float> rangeDist(0.5, 5.0);
+        std::normal_distribution<float> motionDist(0.0, 0.05);
+        std::uniform_real_distribution<float> unitDist(0.0, 1.0);
+
+        std::vector<Eigen::Vector2f> previousPts(pointCount);
+        for (Eigen::Vector2f & previousPt : previousPts)
+        {
+            float bearing = bearingDist(rng), range = rangeDist(rng);
+            previousPt << range * std::cos(bearing), range * std::sin(bearing);
+        }
+
+        std::vector<Eigen::Vector2f> currentPts;
+        for (const Eigen::Vector2f & previousPt : previousPts)
+        {
+            if (unitDist(rng) < 0.1)
+                continue;
+
+            currentPts.push_back(previousPt + Eigen::Vector2f(motionDist(rng), motionDist(rng)));
+        }
+
+        while (currentPts.size() < pointCount)
+        {
+            float bearing = bearingDist(rng), range = rangeDist(rng);
+            currentPts.push_back(Eigen::Vector2f(range * std::cos(bearing), range * std::sin(bearing)));
+        }
+
+        Eigen::MatrixXf distMatrix(currentPts.size(), previousPts.size());
+        for (int i = 0; i < currentPts.size(); i++)
+            for (int j = 0; j < previousPts.size(); j++)
+                distMatrix(i, j) = (currentPts[i] - previousPts[j]).norm();
+
+        return distMatrix;
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    dynamic_gap::DynamicGapConfig cfg;
+    dynamic_gap::GapAssociator gapAssociator(cfg);
+
+    std::mt19937 rng(27);
+    const int matrixCount = 20;
+
+    std::cout << std::setw(14) << "gap points" << std::setw(18) << "mean solve (us)" << std::endl;
+
+    for (int pointCount : {10, 25, 50, 100, 200, 400})
+    {
+        std::vector<Eigen::MatrixXf> distMatrices;
+        for (int m = 0; m < matrixCount; m++)
+            distMatrices.push_back(gapPointDistMatrix(rng, pointCount));
+
+        // warm up solver workspace
+        gapAssociator.associateGaps(distMatrices.front());
+
+        int repetitions = std::max(1, 4000 / pointCount);
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        for (int r = 0; r < repetitions; r++)
+            for (const Eigen::MatrixXf & distMatrix : distMatrices)
+                gapAssociator.associateGaps(distMatrix);
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - startTime;
+
+        std::cout << std::setw(14) << pointCount << std::setw(18) << (elapsed.count() / (repetitions * matrixCount)) << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include <ros/ros.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <dynamic_gap/gap_estimation/EgoMotionTimeline.h>
+#include <dynamic_gap/gap_estimation/KalmanFilterBatch.h>
+#include <dynamic_gap/gap_estimation/RotatingFrameCartesianKalmanFilter.h>
+#include <dynamic_gap/utils/WorkerPool.h>
+
+// Times KalmanFilterBatch::update on crowded-scene inputs (hundreds to thousands of gap point models)
+// for 1 to N threads, N being the first argument or the number of hardware threads.
+
+namespace
+{
+    void buildTimeline(std::mt19937 & rng, const ros::Time & tStart, const ros::Time & tEnd,
+                       dynamic_gap::EgoMotionTimeline & timeline)
+    {
+        std::uniform_real_distribution<float> angVelDist(-1.5, 1.5);
+        std::uniform_real_distribution<float> linVelDist(-1.0, 1.0);
+
+        geometry_msgs::TwistStamped startRbtVel, startRbtAcc;
+
+        // odometry at 200 Hz between scans
+        std::vector<geometry_msgs::TwistStamped> rbtVels, rbtAccs;
+        for (double t = tStart.toSec() + 0.005; t < tEnd.toSec(); t += 0.005)
+        {
+            geometry_msgs::TwistStamped rbtVel, rbtAcc;
+            rbtVel.header.stamp = ros::Time(t);
+            rbtVel.twist.linear.x = linVelDist(rng);
+            rbtVel.twist.angular.z = angVelDist(rng);
+            rbtAcc.header.stamp = rbtVel.header.stamp;
+            rbtVels.push_back(rbtVel);
+            rbtAccs.push_back(rbtAcc);
+        }
+
+        timeline.build(rbtVels, rbtAccs, tStart, startRbtVel, startRbtAcc, tEnd, 
+                       dynamic_gap::RotatingFrameCartesianKalmanFilter::initialQ());
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    ros::Time::init();
+
+    int maxThreads = (argc > 1) ? std::atoi(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+
+    dynamic_gap::DynamicGapConfig cfg;
+    dynamic_gap::KalmanFilterBatch batch(cfg);
+
+    std::mt19937 rng(36);
+    std::uniform_real_distribution<float> bearingDist(-M_PI, M_PI);
+    std::uniform_real_distribution<float> rangeDist(0.5, 8.0);
+    std::normal_distribution<float> motionDist(0.0, 0.1);
+
+    ros::Time tStart(10.0);
+    ros::Time tUpdate(10.1);
+    dynamic_gap::EgoMotionTimeline timeline;
+    buildTimeline(rng, tStart, tUpdate, timeline);
+
+    geometry_msgs::TwistStamped startRbtVel, startRbtAcc;
+
+    std::cout << std::setw(14) << "gap points" << std::setw(10) << "threads" 
+              << std::setw(18) << "mean update (us)" << std::setw(10) << "speedup" << std::endl;
+
+    for (int nFilters : {250, 1000, 4000})
+    {
+        std::vector<std::unique_ptr<dynamic_gap::RotatingFrameCartesianKalmanFilter>> filters;
+        std::vector<Eigen::Vector2f> measurements;
+        for (int i = 0; i < nFilters; i++)
+        {
+            float bearing = bearingDist(rng), range = rangeDist(rng);
+            filters.emplace_back(new dynamic_gap::RotatingFrameCartesianKalmanFilter());
+            measurements.push_back(Eigen::Vector2f(range * std::cos(bearing), range * std::sin(bearing)));
+        }
+
+        double serialTime = 0.0;
+        for (int nThreads = 1; nThreads <= maxThreads; nThreads++)
+        {
+            dynamic_gap::WorkerPool workerPool(nThreads);
+
+            int repetitions = std::max(5, 100000 / nFilters);
+            double elapsedTime = 0.0;
+            for (int r = 0; r <= repetitions; r++)
+            {
+                // every repetition starts from the same models so that it runs along the same timeline
+                for (int i = 0; i < nFilters; i++)
+                {
+                    filters[i]->initialize("left", i, measurements[i][0], measurements[i][1], tStart, startRbtVel, startRbtAcc);
+                    batch.add(filters[i].get(), measurements[i] + Eigen::Vector2f(motionDist(rng), motionDist(rng)));
+                }
+
+                std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+                batch.update(timeline, tUpdate, &workerPool);
+                std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - startTime;
+
+                // first repetition warms up batch workspace
+                if (r > 0)
+                    elapsedTime += elapsed.count();
+            }
+
+            double meanTime = elapsedTime / repetitions;
+            if (nThreads == 1)
+                serialTime = meanTime;
+
+            std::cout << std::setw(14) << nFilters << std::setw(10) << nThreads 
+                      << std::setw(18) << meanTime << std::setw(10) << (serialTime / meanTime) << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <dynamic_gap/gap_detection/GapDetector.h>
+
+namespace dynamic_gap
+{
+    namespace
+    {
+        // Gap simplification as it was before merge candidates and intergap range queries,
+        // kept here as the reference that GapDetector::gapSimplification must agree with
+
+        int referenceMergeability(dynamic_gap::Gap * rawGap, 
+                                    const std::vector<dynamic_gap::Gap *> & simplifiedGaps,
+                                    const sensor_msgs::LaserScan & scan,
+                                    const DynamicGapConfig & cfg)
+        {
+            int lastMergeable = -1;
+
+            for (int j = (simplifiedGaps.size() - 1); j >= 0; j--)
+            {
+                int startIdx = std::min(simplifiedGaps.at(j)->LIdx(), rawGap->RIdx());
+                int endIdx = std::max(simplifiedGaps.at(j)->LIdx(), rawGap->RIdx());
+                float minIntergapRange = *std::min_element(scan.ranges.begin() + startIdx, scan.ranges.begin() + endIdx);
+                float inflatedMinIntergapRange = minIntergapRange - 2 * cfg.rbt.r_inscr;
+
+                bool intergapDistTest = rawGap->LRange() <= inflatedMinIntergapRange && 
+                                        simplifiedGaps.at(j)->RRange() <= inflatedMinIntergapRange;
+                bool rightTypeOrSweptGap = simplifiedGaps.at(j)->isRightType() || !simplifiedGaps.at(j)->isRadial();
+
+                if (intergapDistTest && rightTypeOrSweptGap)
+                    lastMergeable = j;
+            }
+
+            return lastMergeable;
+        }
+
+        std::vector<dynamic_gap::Gap *> referenceSimplification(const std::vector<dynamic_gap::Gap *> & rawGaps,
+                                                                const sensor_msgs::LaserScan & scan,
+                                                                const DynamicGapConfig & cfg)
+        {
+            std::vector<dynamic_gap::Gap *> simplifiedGaps;
+            bool markToStart = true;
+
+            for (dynamic_gap::Gap * rawGap : rawGaps)
+            {
+                if (markToStart)
+                {
+                    if (rawGap->isRadial() && rawGap->isRightType())
+                        markToStart = false;
+
+                    simplifiedGaps.push_back(new dynamic_gap::Gap(*rawGap, true));
+                } else if (rawGap->isRadial())
+                {
+                    if (rawGap->isRightType())
+                    {
+                        simplifiedGaps.push_back(new dynamic_gap::Gap(*rawGap, true));
+                    } else
+                    {
+                        int lastMergeable = referenceMergeability(rawGap, simplifiedGaps, scan, cfg);
+
+                        if (lastMergeable != -1)
+                        {
+                            for (auto gapIter = simplifiedGaps.begin() + lastMergeable + 1; gapIter != simplifiedGaps.end(); gapIter++)
+                                delete *gapIter;
+                            simplifiedGaps.erase(simplifiedGaps.begin() + lastMergeable + 1, simplifiedGaps.end());
+
+                            simplifiedGaps.back()->addLeftInformation(rawGap->LIdx(), rawGap->LRange());
+                        } else
+                        {
+                            simplifiedGaps.push_back(new dynamic_gap::Gap(*rawGap, true));
+                        }
+                    }
+                } else
+                {
+                    bool adjacentGapPtDistDiffCheck = std::abs(rawGap->LRange() - simplifiedGaps.back()->RRange()) < 3 * cfg.rbt.r_inscr;
+
+                    if (adjacentGapPtDistDiffCheck && simplifiedGaps.back()->isRadial() && simplifiedGaps.back()->isRightType())
+                        simplifiedGaps.back()->addLeftInformation(rawGap->LIdx(), rawGap->LRange());
+                    else
+                        simplifiedGaps.push_back(new dynamic_gap::Gap(*rawGap, true));
+                }
+            }
+
+            return simplifiedGaps;
+        }
+
+        // cluttered scan made of flat runs at random ranges, some of them out of range
+        boost::shared_ptr<sensor_msgs::LaserScan> randomScan(std::mt19937 & rng, const DynamicGapConfig & cfg)
+        {
+            boost::shared_ptr<sensor_msgs::LaserScan> scan(new sensor_msgs::LaserScan());
+            scan->header.frame_id = "base_link";
+            scan->angle_increment = cfg.scan.angle_increment;
+
+            std::uniform_int_distribution<int> runLengthDist(1, 40);
+            std::uniform_real_distribution<float> rangeDist(0.5, 5.0);
+            std::uniform_real_distribution<float> unitDist(0.0, 1.0);
+
+            float maxRange = 5.0;
+            float openProbability = unitDist(rng) * 0.5;
+
+            while (scan->ranges.size() < cfg.scan.full_scan)
+            {
+                int runLength = runLengthDist(rng);
+                float range = (unitDist(rng) < openProbability) ? maxRange : rangeDist(rng);
+                float slope = (unitDist(rng) - 0.5) * 0.05;
+
+                for (int i = 0; i < runLength && scan->ranges.size() < cfg.scan.full_scan; i++)
+                    scan->ranges.push_back(range < maxRange ? std::min(maxRange - 0.01f, std::max(0.3f, range + i * slope)) : maxRange);
+            }
+
+            return scan;
+        }
+
+        void deleteGaps(std::vector<dynamic_gap::Gap *> & gaps)
+        {
+            for (dynamic_gap::Gap * gap : gaps)
+                delete gap;
+            gaps.clear();
+        }
+    }
+
+    TEST(GapSimplificationTest, MatchesQuadraticReferenceOnRandomScans)
+    {
+        DynamicGapConfig cfg;
+        GapDetector gapDetector(cfg);
+        geometry_msgs::PoseStamped globalGoalRbtFrame;
+
+        std::mt19937 rng(26);
+        int mergedScanCount = 0;
+
+        for (int trial = 0; trial < 2000; trial++)
+        {
+            boost::shared_ptr<sensor_msgs::LaserScan> scan = randomScan(rng, cfg);
+
+            std::vector<dynamic_gap::Gap *> rawGaps = gapDetector.gapDetection(scan, globalGoalRbtFrame);
+            std::vector<dynamic_gap::Gap *> simplifiedGaps = gapDetector.gapSimplification(rawGaps);
+            std::vector<dynamic_gap::Gap *> referenceGaps = referenceSimplification(rawGaps, *scan, cfg);
+
+            ASSERT_EQ(simplifiedGaps.size(), referenceGaps.size()) << "trial " << trial;
+            for (int i = 0; i < simplifiedGaps.size(); i++)
+            {
+                EXPECT_EQ(simplifiedGaps[i]->RIdx(), referenceGaps[i]->RIdx()) << "trial " << trial << ", gap " << i;
+                EXPECT_EQ(simplifiedGaps[i]->LIdx(), referenceGaps[i]->LIdx()) << "trial " << trial << ", gap " << i;
+                EXPECT_EQ(simplifiedGaps[i]->RRange(), referenceGaps[i]->RRange()) << "trial " << trial << ", gap " << i;
+                EXPECT_EQ(simplifiedGaps[i]->LRange(), referenceGaps[i]->LRange()) << "trial " << trial << ", gap " << i;
+                EXPECT_EQ(simplifiedGaps[i]->isRadial(), referenceGaps[i]->isRadial()) << "trial " << trial << ", gap " << i;
+            }
+
+            if (simplifiedGaps.size() < rawGaps.size())
+                mergedScanCount++;
+
+            deleteGaps(simplifiedGaps);
+            deleteGaps(referenceGaps);
+            deleteGaps(rawGaps);
+        }
+
+        // scans have to exercise merging for the comparison to mean anything
+        EXPECT_GT(mergedScanCount, 100);
+    }
+}
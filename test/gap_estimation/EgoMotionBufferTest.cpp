@@ -0,0 +1,256 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include <dynamic_gap/gap_estimation/EgoMotionBuffer.h>
+
+namespace dynamic_gap
+{
+    namespace
+    {
+        ros::Time sampleStamp(const int & i)
+        {
+            return ros::Time(1.0 + 0.01 * i);
+        }
+
+        // every field is tied to sample index, so that torn or overwritten samples stand out
+        EgoMotionSample makeSample(const int & i)
+        {
+            EgoMotionSample sample;
+            sample.velStamp = sampleStamp(i);
+            sample.vx = i;
+            sample.vy = -i;
+            sample.omega = 0.5 * i;
+            sample.accStamp = sampleStamp(i);
+            sample.ax = 2 * i;
+            sample.ay = -2 * i;
+            return sample;
+        }
+
+        // samples must run on from a first index (or from whichever index comes first, if negative) without gaps, each one intact
+        ::testing::AssertionResult contiguousSamples(const std::vector<EgoMotionSample> & samples, const int & firstIdx)
+        {
+            for (int k = 0; k < samples.size(); k++)
+            {
+                const EgoMotionSample & sample = samples.at(k);
+                int idx = (firstIdx < 0 ? int(samples.front().vx) : firstIdx) + k;
+
+                if (sample.vx != idx || sample.vy != -idx || sample.ax != 2 * idx || sample.ay != -2 * idx ||
+                    sample.velStamp != sampleStamp(idx) || sample.accStamp != sampleStamp(idx))
+                    return ::testing::AssertionFailure() << "sample " << k << " holds index " << sample.vx << ", expected " << idx;
+            }
+
+            return ::testing::AssertionSuccess();
+        }
+
+        ::testing::AssertionResult contiguousTwists(const std::vector<geometry_msgs::TwistStamped> & rbtVels,
+                                                    const std::vector<geometry_msgs::TwistStamped> & rbtAccs,
+                                                    const int & firstIdx)
+        {
+            if (rbtVels.size() != rbtAccs.size())
+                return ::testing::AssertionFailure() << rbtVels.size() << " velocities, but " << rbtAccs.size() << " accelerations";
+
+            for (int k = 0; k < rbtVels.size(); k++)
+            {
+                int idx = (firstIdx < 0 ? int(rbtVels.front().twist.linear.x) : firstIdx) + k;
+                if (rbtVels.at(k).twist.linear.x != idx || rbtVels.at(k).twist.linear.y != -idx ||
+                    rbtAccs.at(k).twist.linear.x != 2 * idx || rbtAccs.at(k).twist.linear.y != -2 * idx ||
+                    rbtVels.at(k).header.stamp != sampleStamp(idx) || rbtAccs.at(k).header.stamp != sampleStamp(idx))
+                    return ::testing::AssertionFailure() << "twist " << k << " holds index " << rbtVels.at(k).twist.linear.x << ", expected " << idx;
+            }
+
+            return ::testing::AssertionSuccess();
+        }
+    }
+
+    class EgoMotionBufferTest : public ::testing::Test
+    {
+        protected:
+            static const int capacity_ = EgoMotionBuffer::capacity_;
+
+            static uint64_t readableTail(const EgoMotionBuffer & buffer)
+            {
+                return buffer.readableTail(buffer.head_.load());
+            }
+
+            static bool readIntact(const EgoMotionBuffer & buffer, const uint64_t & tail)
+            {
+                return buffer.readIntact(tail);
+            }
+
+            DynamicGapConfig cfg_;
+    };
+
+    TEST_F(EgoMotionBufferTest, ReadsNewestHalfOfRingAfterWrapAround)
+    {
+        EgoMotionBuffer buffer(cfg_);
+
+        int nSamples = 2 * capacity_ + 100;
+        for (int i = 0; i < nSamples; i++)
+            buffer.push(makeSample(i));
+
+        int oldestIdx = nSamples - capacity_ / 2;
+
+        std::vector<EgoMotionSample> samples;
+        buffer.copySamples(samples);
+        ASSERT_EQ(samples.size(), capacity_ / 2);
+        EXPECT_TRUE(contiguousSamples(samples, oldestIdx));
+
+        // samples after given time, spanning the end of the ring
+        std::vector<geometry_msgs::TwistStamped> rbtVels, rbtAccs;
+        int sinceIdx = nSamples - 100;
+        buffer.copySince(sampleStamp(sinceIdx), rbtVels, rbtAccs);
+        ASSERT_EQ(rbtVels.size(), nSamples - sinceIdx - 1);
+        EXPECT_TRUE(contiguousTwists(rbtVels, rbtAccs, sinceIdx + 1));
+
+        // time older than readable samples only gets as far back as readable samples
+        buffer.copySince(sampleStamp(10), rbtVels, rbtAccs);
+        ASSERT_EQ(rbtVels.size(), capacity_ / 2);
+        EXPECT_TRUE(contiguousTwists(rbtVels, rbtAccs, oldestIdx));
+
+        // time newer than all samples
+        buffer.copySince(sampleStamp(nSamples), rbtVels, rbtAccs);
+        EXPECT_TRUE(rbtVels.empty());
+        EXPECT_TRUE(rbtAccs.empty());
+    }
+
+    TEST_F(EgoMotionBufferTest, SkipsRepeatedStamps)
+    {
+        EgoMotionBuffer buffer(cfg_);
+
+        for (int i = 0; i < 10; i++)
+        {
+            buffer.push(makeSample(i));
+            buffer.push(makeSample(i));
+        }
+
+        std::vector<geometry_msgs::TwistStamped> rbtVels, rbtAccs;
+        buffer.copySince(ros::Time(0.0), rbtVels, rbtAccs);
+        ASSERT_EQ(rbtVels.size(), 10);
+        EXPECT_TRUE(contiguousTwists(rbtVels, rbtAccs, 0));
+    }
+
+    TEST_F(EgoMotionBufferTest, DetectsReaderLappedByProducer)
+    {
+        EgoMotionBuffer buffer(cfg_);
+
+        // nothing has been overwritten before ring fills up
+        for (int i = 0; i < capacity_ - 1; i++)
+            buffer.push(makeSample(i));
+        EXPECT_TRUE(readIntact(buffer, 0));
+
+        for (int i = capacity_ - 1; i < capacity_ + 100; i++)
+            buffer.push(makeSample(i));
+        uint64_t tail = readableTail(buffer);
+        EXPECT_TRUE(readIntact(buffer, tail));
+
+        // producer may write up to half a ring past the readable samples before it reaches the oldest of them
+        int nSamples = capacity_ + 100;
+        for (int i = 0; i < capacity_ / 2 - 1; i++)
+            buffer.push(makeSample(nSamples++));
+        EXPECT_TRUE(readIntact(buffer, tail));
+
+        buffer.push(makeSample(nSamples++));
+        EXPECT_FALSE(readIntact(buffer, tail));
+    }
+
+    TEST_F(EgoMotionBufferTest, InterpolatesWithinAndHoldsBeyondEnds)
+    {
+        EgoMotionBuffer buffer(cfg_);
+        EgoMotionSample sample;
+
+        EXPECT_FALSE(buffer.interpolate(sampleStamp(0), sample));
+
+        int nSamples = capacity_ + 100;
+        for (int i = 0; i < nSamples; i++)
+            buffer.push(makeSample(i));
+
+        int oldestIdx = nSamples - capacity_ / 2;
+        int newestIdx = nSamples - 1;
+
+        // halfway between two samples
+        ASSERT_TRUE(buffer.interpolate(ros::Time(0.5 * (sampleStamp(oldestIdx + 10).toSec() + sampleStamp(oldestIdx + 11).toSec())), sample));
+        EXPECT_NEAR(sample.vx, oldestIdx + 10.5, 1e-2);
+        EXPECT_NEAR(sample.omega, 0.5 * (oldestIdx + 10.5), 1e-2);
+        EXPECT_NEAR(sample.ax, 2 * (oldestIdx + 10.5), 1e-2);
+
+        // at and beyond each end, end sample is held
+        for (const ros::Time & t : {sampleStamp(oldestIdx), sampleStamp(oldestIdx - 50), sampleStamp(0)})
+        {
+            ASSERT_TRUE(buffer.interpolate(t, sample));
+            EXPECT_EQ(sample.velStamp, t);
+            EXPECT_FLOAT_EQ(sample.vx, oldestIdx);
+            EXPECT_FLOAT_EQ(sample.ax, 2 * oldestIdx);
+        }
+
+        for (const ros::Time & t : {sampleStamp(newestIdx), sampleStamp(newestIdx + 50)})
+        {
+            ASSERT_TRUE(buffer.interpolate(t, sample));
+            EXPECT_EQ(sample.velStamp, t);
+            EXPECT_FLOAT_EQ(sample.vx, newestIdx);
+            EXPECT_FLOAT_EQ(sample.ax, 2 * newestIdx);
+        }
+    }
+
+    TEST_F(EgoMotionBufferTest, ReadersRetryRatherThanReturnOverwrittenSamples)
+    {
+        EgoMotionBuffer buffer(cfg_);
+
+        int nSamples = 200 * capacity_;
+        std::atomic<int> pushedCount(0);
+
+        // producer writes in bursts longer than the readable half of the ring, so readers keep getting lapped
+        std::thread producer([&]()
+        {
+            for (int i = 0; i < nSamples; i++)
+            {
+                buffer.push(makeSample(i));
+                pushedCount.store(i + 1);
+                if (i % capacity_ == 0)
+                    std::this_thread::yield();
+            }
+        });
+
+        std::vector<std::thread> readers;
+        std::vector<int> failures(2, 0);
+        for (int r = 0; r < failures.size(); r++)
+        {
+            readers.emplace_back([&, r]()
+            {
+                std::vector<EgoMotionSample> samples;
+                std::vector<geometry_msgs::TwistStamped> rbtVels, rbtAccs;
+                EgoMotionSample sample;
+                while (pushedCount.load() < nSamples)
+                {
+                    int pushedBefore = pushedCount.load();
+
+                    buffer.copySamples(samples);
+                    if (!contiguousSamples(samples, -1))
+                        failures.at(r)++;
+
+                    int sinceIdx = std::max(0, pushedBefore - capacity_ / 4);
+                    buffer.copySince(sampleStamp(sinceIdx), rbtVels, rbtAccs);
+                    if (!contiguousTwists(rbtVels, rbtAccs, -1) ||
+                        (!rbtVels.empty() && rbtVels.front().header.stamp <= sampleStamp(sinceIdx)))
+                        failures.at(r)++;
+
+                    // velocity and acceleration are read from the same window, so they stay tied together
+                    if (buffer.interpolate(sampleStamp(sinceIdx), sample) &&
+                        std::abs(sample.ax - 2 * sample.vx) > 1e-5 * std::abs(sample.ax))
+                        failures.at(r)++;
+                }
+            });
+        }
+
+        producer.join();
+        for (std::thread & reader : readers)
+            reader.join();
+
+        for (int r = 0; r < failures.size(); r++)
+            EXPECT_EQ(failures.at(r), 0) << "reader " << r;
+    }
+}
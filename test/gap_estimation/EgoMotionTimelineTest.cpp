@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include <unsupported/Eigen/MatrixFunctions>
+
+#include <dynamic_gap/gap_estimation/EgoMotionTimeline.h>
+#include <dynamic_gap/gap_estimation/RotatingFrameCartesianKalmanFilter.h>
+
+namespace dynamic_gap
+{
+    namespace
+    {
+        Eigen::Matrix4f rotatingFrameDynamics(const float & ang_vel_ego)
+        {
+            Eigen::Matrix4f A;
+            A << 0.0, ang_vel_ego, 1.0, 0.0,
+                 -ang_vel_ego, 0.0, 0.0, 1.0,
+                 0.0, 0.0, 0.0, ang_vel_ego,
+                 0.0, 0.0, -ang_vel_ego, 0.0;
+            return A;
+        }
+
+        // third order series that discretized covariance noise used to be computed with for every Q
+        Eigen::Matrix4f seriesDiscretizedNoise(const Eigen::Matrix4f & A, const Eigen::Matrix4f & Q, const float & dt)
+        {
+            Eigen::Matrix4f Q_2 = A * Q + Q * A.transpose();
+            Eigen::Matrix4f Q_3 = A * Q_2 + Q_2 * A.transpose();
+            return (Q * dt) + (Q_2 * dt * dt / 2.0) + (Q_3 * dt * dt * dt / 6.0);
+        }
+
+        // odometry at irregular times between scans, spinning in either direction
+        void randomOdometry(std::mt19937 & rng, const ros::Time & tStart, const ros::Time & tEnd,
+                            std::vector<geometry_msgs::TwistStamped> & rbtVels,
+                            std::vector<geometry_msgs::TwistStamped> & rbtAccs)
+        {
+            std::uniform_real_distribution<float> angVelDist(-3.0, 3.0);
+            std::uniform_real_distribution<float> linVelDist(-1.0, 1.0);
+            std::uniform_real_distribution<float> stepDist(0.005, 0.03);
+
+            rbtVels.clear();
+            rbtAccs.clear();
+
+            for (double t = tStart.toSec() + stepDist(rng); t < tEnd.toSec(); t += stepDist(rng))
+            {
+                geometry_msgs::TwistStamped rbtVel, rbtAcc;
+                rbtVel.header.stamp = ros::Time(t);
+                rbtVel.twist.linear.x = linVelDist(rng);
+                rbtVel.twist.linear.y = linVelDist(rng);
+                rbtVel.twist.angular.z = angVelDist(rng);
+                rbtAcc.header.stamp = rbtVel.header.stamp;
+                rbtVels.push_back(rbtVel);
+                rbtAccs.push_back(rbtAcc);
+            }
+        }
+    }
+
+    TEST(EgoMotionTimelineTest, ClosedFormMatchesMatrixExponentialAndSeries)
+    {
+        std::mt19937 rng(32);
+        Eigen::Matrix4f Q = RotatingFrameCartesianKalmanFilter::initialQ();
+
+        geometry_msgs::TwistStamped startRbtVel, startRbtAcc;
+        startRbtVel.twist.angular.z = 0.7;
+
+        int stepCount = 0;
+        for (int trial = 0; trial < 200; trial++)
+        {
+            ros::Time tStart(100.0 + trial);
+            ros::Time tEnd(100.0 + trial + 0.1);
+
+            std::vector<geometry_msgs::TwistStamped> rbtVels, rbtAccs;
+            randomOdometry(rng, tStart, tEnd, rbtVels, rbtAccs);
+
+            EgoMotionTimeline timeline;
+            timeline.build(rbtVels, rbtAccs, tStart, startRbtVel, startRbtAcc, tEnd, Q);
+            ASSERT_TRUE(timeline.valid()) << "trial " << trial;
+
+            for (int i = 0; i < timeline.size() - 1; i++)
+            {
+                float dt = timeline.dt(i);
+                Eigen::Matrix4f A = rotatingFrameDynamics(timeline.rbtVels()[i].twist.angular.z);
+
+                Eigen::Matrix4f expectedSTM = (A * dt).exp();
+                EXPECT_LT((timeline.STM(i) - expectedSTM).cwiseAbs().maxCoeff(), 1e-6) 
+                    << "trial " << trial << ", step " << i << "\n" << timeline.STM(i) << "\n" << expectedSTM;
+
+                Eigen::Matrix4f expectedDQ = seriesDiscretizedNoise(A, Q, dt);
+                EXPECT_LT((timeline.dQ(i) - expectedDQ).cwiseAbs().maxCoeff(), 1e-6)
+                    << "trial " << trial << ", step " << i << "\n" << timeline.dQ(i) << "\n" << expectedDQ;
+
+                stepCount++;
+            }
+        }
+
+        EXPECT_GT(stepCount, 1000);
+    }
+
+    TEST(EgoMotionTimelineTest, AnisotropicNoiseFallsBackToSeries)
+    {
+        std::mt19937 rng(33);
+        Eigen::Matrix4f Q = RotatingFrameCartesianKalmanFilter::initialQ();
+        Q(3, 3) *= 2.0;
+
+        geometry_msgs::TwistStamped startRbtVel, startRbtAcc;
+        ros::Time tStart(10.0), tEnd(10.1);
+
+        std::vector<geometry_msgs::TwistStamped> rbtVels, rbtAccs;
+        randomOdometry(rng, tStart, tEnd, rbtVels, rbtAccs);
+
+        EgoMotionTimeline timeline;
+        timeline.build(rbtVels, rbtAccs, tStart, startRbtVel, startRbtAcc, tEnd, Q);
+        ASSERT_TRUE(timeline.valid());
+
+        for (int i = 0; i < timeline.size() - 1; i++)
+        {
+            Eigen::Matrix4f A = rotatingFrameDynamics(timeline.rbtVels()[i].twist.angular.z);
+            EXPECT_LT((timeline.dQ(i) - seriesDiscretizedNoise(A, Q, timeline.dt(i))).cwiseAbs().maxCoeff(), 1e-6) << "step " << i;
+        }
+    }
+}
@@ -0,0 +1,440 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <dynamic_gap/utils/Gap.h>
+
+#include <dynamic_gap/gap_estimation/GapAssociator.h>
+
+namespace dynamic_gap
+{
+    namespace
+    {
+        // best assignment under the solver's contract: as many pairs within threshold as possible,
+        // then lowest total distance over those pairs
+        void bruteForceAssignment(const Eigen::MatrixXf & distMatrix, const float & assocThresh, 
+                                  int row, std::vector<char> & usedCols, 
+                                  int pairCount, float cost, 
+                                  int & bestPairCount, float & bestCost)
+        {
+            if (row == distMatrix.rows())
+            {
+                if (pairCount > bestPairCount || (pairCount == bestPairCount && cost < bestCost))
+                {
+                    bestPairCount = pairCount;
+                    bestCost = cost;
+                }
+                return;
+            }
+
+            // leave row unassigned
+            bruteForceAssignment(distMatrix, assocThresh, row + 1, usedCols, pairCount, cost, bestPairCount, bestCost);
+
+            for (int col = 0; col < distMatrix.cols(); col++)
+            {
+                if (usedCols[col] || distMatrix(row, col) > assocThresh)
+                    continue;
+
+                usedCols[col] = true;
+                bruteForceAssignment(distMatrix, assocThresh, row + 1, usedCols, pairCount + 1, cost + distMatrix(row, col), bestPairCount, bestCost);
+                usedCols[col] = false;
+            }
+        }
+
+        Eigen::MatrixXf randomDistMatrix(std::mt19937 & rng, const int & rows, const int & cols, const float & forbiddenFraction, const float & assocThresh)
+        {
+            std::uniform_real_distribution<float> distDist(0.0, assocThresh);
+            std::uniform_real_distribution<float> unitDist(0.0, 1.0);
+            std::uniform_int_distribution<int> levelDist(0, 3);
+
+            Eigen::MatrixXf distMatrix(rows, cols);
+            for (int i = 0; i < rows; i++)
+            {
+                for (int j = 0; j < cols; j++)
+                {
+                    if (unitDist(rng) < forbiddenFraction)
+                        distMatrix(i, j) = assocThresh * (1.0 + 10.0 * unitDist(rng));
+                    else if (unitDist(rng) < 0.3)
+                        distMatrix(i, j) = 0.25 * assocThresh * levelDist(rng); // repeated values to force ties
+                    else
+                        distMatrix(i, j) = distDist(rng);
+                }
+            }
+
+            return distMatrix;
+        }
+
+        dynamic_gap::Gap * makeGap(const int & rightIdx, const float & rightRange, const int & leftIdx, const float & leftRange)
+        {
+            dynamic_gap::Gap * gap = new dynamic_gap::Gap("", rightIdx, rightRange, false, 0.2);
+            gap->addLeftInformation(leftIdx, leftRange);
+            return gap;
+        }
+
+        void deleteGaps(std::vector<dynamic_gap::Gap *> & gaps)
+        {
+            for (dynamic_gap::Gap * gap : gaps)
+                delete gap;
+            gaps.clear();
+        }
+
+        // number of associated pairs and their total distance
+        void associationCost(const std::vector<int> & association, const Eigen::MatrixXf & distMatrix, 
+                             int & pairCount, float & cost)
+        {
+            pairCount = 0;
+            cost = 0.0;
+            for (int i = 0; i < association.size(); i++)
+            {
+                if (association.at(i) < 0)
+                    continue;
+
+                pairCount++;
+                cost += distMatrix(i, association.at(i));
+            }
+        }
+    }
+
+    TEST(GapAssociatorTest, MatchesBruteForceOnRectangularMatricesWithForbiddenEntries)
+    {
+        DynamicGapConfig cfg;
+        GapAssociator gapAssociator(cfg);
+        float assocThresh = cfg.gap_assoc.assoc_thresh;
+
+        std::mt19937 rng(27);
+        std::uniform_int_distribution<int> sizeDist(1, 6);
+        std::uniform_real_distribution<float> unitDist(0.0, 1.0);
+
+        for (int trial = 0; trial < 5000; trial++)
+        {
+            int rows = sizeDist(rng);
+            int cols = sizeDist(rng);
+            Eigen::MatrixXf distMatrix = randomDistMatrix(rng, rows, cols, unitDist(rng), assocThresh);
+
+            std::vector<int> association = gapAssociator.associateGaps(distMatrix);
+            ASSERT_EQ(association.size(), rows) << "trial " << trial;
+
+            // association has to be a valid matching over allowed entries
+            std::vector<char> usedCols(cols, false);
+            int pairCount = 0;
+            float cost = 0.0;
+            for (int i = 0; i < rows; i++)
+            {
+                int j = association[i];
+                if (j < 0)
+                    continue;
+
+                ASSERT_LT(j, cols) << "trial " << trial;
+                ASSERT_FALSE(usedCols[j]) << "trial " << trial << ", column " << j << " assigned twice";
+                ASSERT_LE(distMatrix(i, j), assocThresh) << "trial " << trial << ", forbidden entry assigned";
+                usedCols[j] = true;
+                pairCount++;
+                cost += distMatrix(i, j);
+            }
+
+            int bestPairCount = -1;
+            float bestCost = 0.0;
+            std::vector<char> bruteForceUsedCols(cols, false);
+            bruteForceAssignment(distMatrix, assocThresh, 0, bruteForceUsedCols, 0, 0.0, bestPairCount, bestCost);
+
+            EXPECT_EQ(pairCount, bestPairCount) << "trial " << trial << "\n" << distMatrix;
+            EXPECT_NEAR(cost, bestCost, 1e-4) << "trial " << trial << "\n" << distMatrix;
+        }
+    }
+
+    TEST(GapAssociatorTest, HandlesEmptyMatrices)
+    {
+        DynamicGapConfig cfg;
+        GapAssociator gapAssociator(cfg);
+
+        EXPECT_TRUE(gapAssociator.associateGaps(Eigen::MatrixXf(0, 4)).empty());
+        EXPECT_TRUE(gapAssociator.associateGaps(Eigen::MatrixXf(4, 0)).empty());
+    }
+
+    TEST(GapAssociatorTest, BandedAssociatesAcrossPlusMinusPi)
+    {
+        DynamicGapConfig cfg;
+        GapAssociator gapAssociator(cfg);
+
+        // scene turned by a few scan indices, so that points near -pi end up near +pi
+        std::vector<dynamic_gap::Gap *> previousGaps{makeGap(2, 3.0, 40, 3.5), makeGap(470, 4.0, 509, 3.0)};
+        std::vector<dynamic_gap::Gap *> currentGaps{makeGap(510, 3.0, 36, 3.5), makeGap(466, 4.0, 505, 3.0)};
+
+        std::vector<int> bandedAssociation = gapAssociator.associateGapsBanded(currentGaps, previousGaps);
+        std::vector<int> association = gapAssociator.associateGaps(gapAssociator.obtainDistMatrix(currentGaps, previousGaps));
+
+        EXPECT_EQ(bandedAssociation, association);
+        EXPECT_EQ(bandedAssociation, std::vector<int>({0, 1, 2, 3}));
+
+        deleteGaps(previousGaps);
+        deleteGaps(currentGaps);
+    }
+
+    TEST(GapAssociatorTest, BandedFallsBackToFullAssociationOnOverflow)
+    {
+        DynamicGapConfig cfg;
+
+        // points close to robot that are within distance threshold of each other, but not within band
+        std::vector<dynamic_gap::Gap *> previousGaps{makeGap(100, 0.3, 120, 0.3)};
+        std::vector<dynamic_gap::Gap *> currentGaps{makeGap(160, 0.3, 180, 0.3)};
+
+        // tight cluster of gaps further out that forms one large group of candidates
+        for (int i = 0; i < 2; i++)
+        {
+            previousGaps.push_back(makeGap(300 + 6 * i, 3.0, 303 + 6 * i, 3.0));
+            currentGaps.push_back(makeGap(301 + 6 * i, 3.0, 304 + 6 * i, 3.0));
+        }
+
+        GapAssociator bandedAssociator(cfg);
+        std::vector<int> bandedAssociation = bandedAssociator.associateGapsBanded(currentGaps, previousGaps);
+        EXPECT_EQ(bandedAssociation.at(0), -1);
+        EXPECT_EQ(bandedAssociation.at(1), -1);
+
+        cfg.gap_assoc.assoc_band_max_points = 4;
+        GapAssociator overflowingAssociator(cfg);
+        std::vector<int> overflowAssociation = overflowingAssociator.associateGapsBanded(currentGaps, previousGaps);
+        std::vector<int> association = overflowingAssociator.associateGaps(overflowingAssociator.obtainDistMatrix(currentGaps, previousGaps));
+
+        EXPECT_EQ(overflowAssociation, association);
+        EXPECT_GE(overflowAssociation.at(0), 0);
+        EXPECT_GE(overflowAssociation.at(1), 0);
+
+        deleteGaps(previousGaps);
+        deleteGaps(currentGaps);
+    }
+
+    TEST(GapAssociatorTest, BandedMatchesFullAssociationWhenPairsLieWithinBand)
+    {
+        DynamicGapConfig cfg;
+        // large enough that groups are always solved within band
+        cfg.gap_assoc.assoc_band_max_points = 1000;
+        GapAssociator gapAssociator(cfg);
+
+        // at this range, any pair within distance threshold is also within band
+        float minRange = cfg.gap_assoc.assoc_thresh / std::sin(cfg.gap_assoc.assoc_band_angle);
+
+        std::mt19937 rng(28);
+        std::uniform_int_distribution<int> gapCountDist(1, 25);
+        std::uniform_int_distribution<int> idxDist(0, 511);
+        std::uniform_int_distribution<int> widthDist(2, 40);
+        std::uniform_int_distribution<int> idxJitterDist(-3, 3);
+        std::uniform_real_distribution<float> rangeDist(minRange, 8.0);
+        std::uniform_real_distribution<float> rangeJitterDist(-0.2, 0.2);
+        std::uniform_real_distribution<float> unitDist(0.0, 1.0);
+
+        auto wrapIdx = [](const int & idx) { return (idx + 512) % 512; };
+        auto jitterRange = [&](const float & range) { return std::max(minRange, range + rangeJitterDist(rng)); };
+
+        for (int trial = 0; trial < 300; trial++)
+        {
+            std::vector<dynamic_gap::Gap *> previousGaps, currentGaps;
+            int nGaps = gapCountDist(rng);
+            for (int g = 0; g < nGaps; g++)
+            {
+                int rightIdx = idxDist(rng);
+                dynamic_gap::Gap * gap = makeGap(rightIdx, rangeDist(rng), wrapIdx(rightIdx + widthDist(rng)), rangeDist(rng));
+                previousGaps.push_back(gap);
+
+                // most gaps persist with a small shift, some vanish and some new ones appear
+                if (unitDist(rng) < 0.8)
+                    currentGaps.push_back(makeGap(wrapIdx(gap->RIdx() + idxJitterDist(rng)), jitterRange(gap->RRange()), 
+                                                  wrapIdx(gap->LIdx() + idxJitterDist(rng)), jitterRange(gap->LRange())));
+                if (unitDist(rng) < 0.2)
+                {
+                    int newRightIdx = idxDist(rng);
+                    currentGaps.push_back(makeGap(newRightIdx, rangeDist(rng), wrapIdx(newRightIdx + widthDist(rng)), rangeDist(rng)));
+                }
+            }
+
+            std::vector<int> bandedAssociation = gapAssociator.associateGapsBanded(currentGaps, previousGaps);
+            Eigen::MatrixXf distMatrix = gapAssociator.obtainDistMatrix(currentGaps, previousGaps);
+            std::vector<int> association = gapAssociator.associateGaps(distMatrix);
+
+            // ties may be broken either way, so compare quality of assignments rather than assignments themselves
+            int bandedPairCount, pairCount;
+            float bandedCost, cost;
+            associationCost(bandedAssociation, distMatrix, bandedPairCount, bandedCost);
+            associationCost(association, distMatrix, pairCount, cost);
+
+            EXPECT_EQ(bandedPairCount, pairCount) << "trial " << trial;
+            EXPECT_NEAR(bandedCost, cost, 1e-4) << "trial " << trial;
+
+            std::vector<char> usedCols(distMatrix.cols(), false);
+            for (int i = 0; i < bandedAssociation.size(); i++)
+            {
+                int j = bandedAssociation.at(i);
+                if (j < 0)
+                    continue;
+
+                EXPECT_FALSE(usedCols[j]) << "trial " << trial << ", previous gap point " << j << " assigned twice";
+                EXPECT_LE(distMatrix(i, j), cfg.gap_assoc.assoc_thresh) << "trial " << trial;
+                usedCols[j] = true;
+            }
+
+            deleteGaps(previousGaps);
+            deleteGaps(currentGaps);
+        }
+    }
+
+    class GapAssociatorHandOffTest : public ::testing::Test
+    {
+        protected:
+            void SetUp() override
+            {
+                scanTime_ = ros::Time(10.0);
+                intermediateRbtVels_.resize(1);
+                intermediateRbtAccs_.resize(1);
+                intermediateRbtVels_.at(0).header.stamp = scanTime_;
+                intermediateRbtAccs_.at(0).header.stamp = scanTime_;
+            }
+
+            void TearDown() override
+            {
+                for (dynamic_gap::Gap * gap : previousGaps_)
+                    delete gap;
+                for (dynamic_gap::Gap * gap : currentGaps_)
+                    delete gap;
+            }
+
+            // previous gaps get fresh models, as they would on first scan
+            void initializePreviousGaps(GapAssociator & gapAssociator)
+            {
+                for (int i = 0; i < 3; i++)
+                {
+                    dynamic_gap::Gap * gap = new dynamic_gap::Gap("", 100 + 150 * i, 2.0 + 0.5 * i, false, 0.2);
+                    gap->addLeftInformation(150 + 150 * i, 2.5 + 0.5 * i);
+                    previousGaps_.push_back(gap);
+                }
+
+                std::vector<dynamic_gap::Gap *> noGaps;
+                gapAssociator.obtainDistMatrix(previousGaps_, noGaps);
+                gapAssociator.assignModels(std::vector<int>(), previousGaps_, noGaps, true, currentModelIdx_, 
+                                           scanTime_, intermediateRbtVels_, intermediateRbtAccs_);
+
+                for (dynamic_gap::Gap * gap : previousGaps_)
+                {
+                    for (Estimator * model : {gap->leftGapPtModel_, gap->rightGapPtModel_})
+                    {
+                        previousModels_.push_back(model);
+                        previousModelIDs_.push_back(model->getID());
+                        previousStates_.push_back(model->getState());
+                    }
+                }
+            }
+
+            // current gaps are slightly shifted copies of given previous gaps
+            void makeCurrentGaps(const std::vector<int> & previousGapIndices)
+            {
+                for (int i : previousGapIndices)
+                {
+                    dynamic_gap::Gap * gap = new dynamic_gap::Gap("", 102 + 150 * i, 2.05 + 0.5 * i, false, 0.2);
+                    gap->addLeftInformation(152 + 150 * i, 2.55 + 0.5 * i);
+                    currentGaps_.push_back(gap);
+                }
+            }
+
+            void associateAndAssign(GapAssociator & gapAssociator, const bool & ownsPreviousGaps)
+            {
+                Eigen::MatrixXf distMatrix = gapAssociator.obtainDistMatrix(currentGaps_, previousGaps_);
+                std::vector<int> association = gapAssociator.associateGaps(distMatrix);
+                gapAssociator.assignModels(association, currentGaps_, previousGaps_, ownsPreviousGaps, currentModelIdx_, 
+                                           scanTime_, intermediateRbtVels_, intermediateRbtAccs_);
+            }
+
+            void expectCarriesPreviousModel(Estimator * model, const int & previousPtIdx)
+            {
+                EXPECT_EQ(model->getID(), previousModelIDs_.at(previousPtIdx));
+                EXPECT_EQ(model->getState(), previousStates_.at(previousPtIdx));
+            }
+
+            ros::Time scanTime_;
+            std::vector<geometry_msgs::TwistStamped> intermediateRbtVels_, intermediateRbtAccs_;
+            int currentModelIdx_ = 0;
+
+            std::vector<dynamic_gap::Gap *> previousGaps_, currentGaps_;
+            std::vector<Estimator *> previousModels_;
+            std::vector<int> previousModelIDs_;
+            std::vector<Eigen::Vector4f> previousStates_;
+    };
+
+    TEST_F(GapAssociatorHandOffTest, LeavesPreviousGapsUntouchedWhileShared)
+    {
+        DynamicGapConfig cfg;
+        GapAssociator gapAssociator(cfg);
+
+        initializePreviousGaps(gapAssociator);
+        makeCurrentGaps({0, 1, 2});
+        associateAndAssign(gapAssociator, false);
+
+        // previous gaps may still be read by planning loop, so their models must stay as they were
+        for (int i = 0; i < previousGaps_.size(); i++)
+        {
+            EXPECT_EQ(previousGaps_.at(i)->leftGapPtModel_, previousModels_.at(2 * i));
+            EXPECT_EQ(previousGaps_.at(i)->rightGapPtModel_, previousModels_.at(2 * i + 1));
+            expectCarriesPreviousModel(previousGaps_.at(i)->leftGapPtModel_, 2 * i);
+            expectCarriesPreviousModel(previousGaps_.at(i)->rightGapPtModel_, 2 * i + 1);
+        }
+
+        // current gaps carry on previous models in their own estimators
+        for (int i = 0; i < currentGaps_.size(); i++)
+        {
+            EXPECT_NE(currentGaps_.at(i)->leftGapPtModel_, previousModels_.at(2 * i));
+            EXPECT_NE(currentGaps_.at(i)->rightGapPtModel_, previousModels_.at(2 * i + 1));
+            expectCarriesPreviousModel(currentGaps_.at(i)->leftGapPtModel_, 2 * i);
+            expectCarriesPreviousModel(currentGaps_.at(i)->rightGapPtModel_, 2 * i + 1);
+        }
+        EXPECT_EQ(currentModelIdx_, 2 * previousGaps_.size());
+    }
+
+    TEST_F(GapAssociatorHandOffTest, MovesPreviousModelsOnceOwned)
+    {
+        DynamicGapConfig cfg;
+        GapAssociator gapAssociator(cfg);
+
+        initializePreviousGaps(gapAssociator);
+        makeCurrentGaps({0, 1, 2});
+        associateAndAssign(gapAssociator, true);
+
+        // current gaps take over previous estimators, previous gaps are left with current gaps' unused ones
+        for (int i = 0; i < currentGaps_.size(); i++)
+        {
+            EXPECT_EQ(currentGaps_.at(i)->leftGapPtModel_, previousModels_.at(2 * i));
+            EXPECT_EQ(currentGaps_.at(i)->rightGapPtModel_, previousModels_.at(2 * i + 1));
+            EXPECT_NE(previousGaps_.at(i)->leftGapPtModel_, previousModels_.at(2 * i));
+            EXPECT_NE(previousGaps_.at(i)->rightGapPtModel_, previousModels_.at(2 * i + 1));
+            expectCarriesPreviousModel(currentGaps_.at(i)->leftGapPtModel_, 2 * i);
+            expectCarriesPreviousModel(currentGaps_.at(i)->rightGapPtModel_, 2 * i + 1);
+        }
+        EXPECT_EQ(currentModelIdx_, 2 * previousGaps_.size());
+    }
+
+    TEST_F(GapAssociatorHandOffTest, CopiesPreviousModelOnSplit)
+    {
+        DynamicGapConfig cfg;
+        GapAssociator gapAssociator(cfg);
+
+        initializePreviousGaps(gapAssociator);
+
+        // both current gaps sit on first previous gap, so each of its points feeds two current points
+        makeCurrentGaps({0, 0});
+        gapAssociator.obtainDistMatrix(currentGaps_, previousGaps_);
+        std::vector<int> association{0, 1, 0, 1};
+        gapAssociator.assignModels(association, currentGaps_, previousGaps_, true, currentModelIdx_, 
+                                   scanTime_, intermediateRbtVels_, intermediateRbtAccs_);
+
+        // first current gap takes over previous estimators, second one gets its own copies
+        EXPECT_EQ(currentGaps_.at(0)->leftGapPtModel_, previousModels_.at(0));
+        EXPECT_EQ(currentGaps_.at(0)->rightGapPtModel_, previousModels_.at(1));
+        EXPECT_NE(currentGaps_.at(1)->leftGapPtModel_, previousModels_.at(0));
+        EXPECT_NE(currentGaps_.at(1)->rightGapPtModel_, previousModels_.at(1));
+        for (dynamic_gap::Gap * gap : currentGaps_)
+        {
+            expectCarriesPreviousModel(gap->leftGapPtModel_, 0);
+            expectCarriesPreviousModel(gap->rightGapPtModel_, 1);
+        }
+        EXPECT_EQ(currentModelIdx_, 2 * previousGaps_.size());
+    }
+}
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <dynamic_gap/gap_estimation/EgoMotionTimeline.h>
+#include <dynamic_gap/gap_estimation/KalmanFilterBatch.h>
+#include <dynamic_gap/gap_estimation/RotatingFrameCartesianKalmanFilter.h>
+#include <dynamic_gap/utils/AgentTable.h>
+#include <dynamic_gap/utils/WorkerPool.h>
+
+namespace dynamic_gap
+{
+    namespace
+    {
+        // odometry at fixed rate between two scans, turning and accelerating
+        void buildTimeline(const ros::Time & tStart, const ros::Time & tEnd,
+                           const geometry_msgs::TwistStamped & startRbtVel,
+                           const geometry_msgs::TwistStamped & startRbtAcc,
+                           EgoMotionTimeline & timeline)
+        {
+            std::vector<geometry_msgs::TwistStamped> rbtVels, rbtAccs;
+            for (int i = 1; i < 5; i++)
+            {
+                geometry_msgs::TwistStamped rbtVel, rbtAcc;
+                rbtVel.header.stamp = ros::Time(tStart.toSec() + 0.02 * i);
+                rbtVel.twist.linear.x = 0.5 + 0.05 * i;
+                rbtVel.twist.linear.y = -0.1;
+                rbtVel.twist.angular.z = 0.3 * i;
+                rbtAcc.header.stamp = rbtVel.header.stamp;
+                rbtAcc.twist.linear.x = 0.2;
+                rbtVels.push_back(rbtVel);
+                rbtAccs.push_back(rbtAcc);
+            }
+
+            timeline.build(rbtVels, rbtAccs, tStart, startRbtVel, startRbtAcc, tEnd, RotatingFrameCartesianKalmanFilter::initialQ());
+        }
+
+        void initializeFilter(RotatingFrameCartesianKalmanFilter & filter, const int & modelID, const bool & josephForm,
+                              const ros::Time & tStart, const geometry_msgs::TwistStamped & startRbtVel,
+                              const geometry_msgs::TwistStamped & startRbtAcc)
+        {
+            filter.initialize("left", modelID, 2.0 + 0.01 * modelID, -1.0 + 0.02 * modelID, tStart, startRbtVel, startRbtAcc);
+            filter.josephForm_ = josephForm;
+        }
+
+        // odometry at irregular times between two scans
+        void randomTimeline(std::mt19937 & rng, const ros::Time & tStart, const ros::Time & tEnd,
+                            const geometry_msgs::TwistStamped & startRbtVel,
+                            const geometry_msgs::TwistStamped & startRbtAcc,
+                            EgoMotionTimeline & timeline)
+        {
+            std::uniform_real_distribution<float> angVelDist(-1.5, 1.5);
+            std::uniform_real_distribution<float> linVelDist(-1.0, 1.0);
+            std::uniform_real_distribution<float> stepDist(0.005, 0.02);
+
+            std::vector<geometry_msgs::TwistStamped> rbtVels, rbtAccs;
+            for (double t = tStart.toSec() + stepDist(rng); t < tEnd.toSec(); t += stepDist(rng))
+            {
+                geometry_msgs::TwistStamped rbtVel, rbtAcc;
+                rbtVel.header.stamp = ros::Time(t);
+                rbtVel.twist.linear.x = linVelDist(rng);
+                rbtVel.twist.linear.y = linVelDist(rng);
+                rbtVel.twist.angular.z = angVelDist(rng);
+                rbtAcc.header.stamp = rbtVel.header.stamp;
+                rbtAcc.twist.linear.x = linVelDist(rng);
+                rbtVels.push_back(rbtVel);
+                rbtAccs.push_back(rbtAcc);
+            }
+
+            timeline.build(rbtVels, rbtAccs, tStart, startRbtVel, startRbtAcc, tEnd, RotatingFrameCartesianKalmanFilter::initialQ());
+        }
+
+        // runs a crowded scene's worth of gap point models through several batched updates on given number of threads
+        std::vector<std::unique_ptr<RotatingFrameCartesianKalmanFilter>> runCrowdedScene(const int & nThreads)
+        {
+            DynamicGapConfig cfg;
+            WorkerPool workerPool(nThreads);
+            KalmanFilterBatch batch(cfg);
+
+            std::mt19937 rng(36);
+            std::uniform_real_distribution<float> bearingDist(-M_PI, M_PI);
+            std::uniform_real_distribution<float> rangeDist(0.5, 8.0);
+            std::normal_distribution<float> motionDist(0.0, 0.1);
+
+            geometry_msgs::TwistStamped startRbtVel, startRbtAcc;
+            startRbtVel.twist.linear.x = 0.5;
+
+            ros::Time tStart(10.0);
+
+            int nFilters = 1000;
+            std::vector<std::unique_ptr<RotatingFrameCartesianKalmanFilter>> filters;
+            for (int i = 0; i < nFilters; i++)
+            {
+                float bearing = bearingDist(rng), range = rangeDist(rng);
+                filters.emplace_back(new RotatingFrameCartesianKalmanFilter());
+                filters.back()->initialize((i % 2 == 0) ? "left" : "right", i, range * std::cos(bearing), range * std::sin(bearing), 
+                                           tStart, startRbtVel, startRbtAcc);
+                filters.back()->josephForm_ = (i % 2 == 0);
+            }
+
+            for (int scan = 0; scan < 5; scan++)
+            {
+                ros::Time tUpdate(tStart.toSec() + 0.1);
+                EgoMotionTimeline timeline;
+                randomTimeline(rng, tStart, tUpdate, filters.front()->lastRbtVel_, filters.front()->lastRbtAcc_, timeline);
+
+                for (std::unique_ptr<RotatingFrameCartesianKalmanFilter> & filter : filters)
+                    batch.add(filter.get(), filter->x_hat_k_plus_.head(2) + Eigen::Vector2f(motionDist(rng), motionDist(rng)));
+
+                batch.update(timeline, tUpdate, &workerPool);
+
+                tStart = tUpdate;
+            }
+
+            return filters;
+        }
+    }
+
+    TEST(KalmanFilterBatchTest, IdenticalAcrossThreadCounts)
+    {
+        std::vector<std::unique_ptr<RotatingFrameCartesianKalmanFilter>> serialFilters = runCrowdedScene(1);
+
+        for (int nThreads : {2, 3, 4, 8})
+        {
+            std::vector<std::unique_ptr<RotatingFrameCartesianKalmanFilter>> parallelFilters = runCrowdedScene(nThreads);
+            ASSERT_EQ(parallelFilters.size(), serialFilters.size());
+
+            for (int i = 0; i < serialFilters.size(); i++)
+            {
+                // bitwise, not approximate
+                EXPECT_TRUE(parallelFilters[i]->x_hat_k_plus_ == serialFilters[i]->x_hat_k_plus_) << nThreads << " threads, filter " << i;
+                EXPECT_TRUE(parallelFilters[i]->P_k_plus_ == serialFilters[i]->P_k_plus_) << nThreads << " threads, filter " << i;
+                EXPECT_TRUE(parallelFilters[i]->G_k_ == serialFilters[i]->G_k_) << nThreads << " threads, filter " << i;
+            }
+        }
+    }
+
+    TEST(KalmanFilterBatchTest, MatchesScalarUpdateWithMixedCovarianceModes)
+    {
+        DynamicGapConfig cfg;
+        // global flag must not override covariance mode of each filter
+        cfg.gap_est.joseph_form = false;
+
+        geometry_msgs::TwistStamped startRbtVel, startRbtAcc;
+        startRbtVel.twist.linear.x = 0.5;
+        startRbtVel.twist.angular.z = 0.1;
+
+        ros::Time tStart(10.0);
+
+        AgentTable agents(0.5);
+        WorkerPool workerPool(2);
+        KalmanFilterBatch batch(cfg);
+
+        // enough filters to span several row chunks
+        int nFilters = 150;
+        std::vector<RotatingFrameCartesianKalmanFilter> scalarFilters(nFilters), batchFilters(nFilters);
+        for (int i = 0; i < nFilters; i++)
+        {
+            bool josephForm = (i % 3 == 0);
+            initializeFilter(scalarFilters[i], i, josephForm, tStart, startRbtVel, startRbtAcc);
+            initializeFilter(batchFilters[i], i, josephForm, tStart, startRbtVel, startRbtAcc);
+        }
+
+        // two rounds so that the second correction uses gains from the first
+        for (int round = 0; round < 2; round++)
+        {
+            ros::Time tUpdate(tStart.toSec() + 0.1);
+            EgoMotionTimeline timeline;
+            buildTimeline(tStart, tUpdate, batchFilters[0].lastRbtVel_, batchFilters[0].lastRbtAcc_, timeline);
+
+            for (int i = 0; i < nFilters; i++)
+            {
+                Eigen::Vector2f measurement(2.0 + 0.01 * i - 0.05 * round, -1.0 + 0.02 * i + 0.03 * round);
+                scalarFilters[i].update(measurement, timeline, agents, tUpdate);
+                batch.add(&batchFilters[i], measurement);
+            }
+            batch.update(timeline, tUpdate, &workerPool);
+
+            tStart = tUpdate;
+        }
+
+        for (int i = 0; i < nFilters; i++)
+        {
+            EXPECT_TRUE(batchFilters[i].x_hat_k_plus_.isApprox(scalarFilters[i].x_hat_k_plus_, 1e-4)) << "filter " << i;
+            EXPECT_TRUE(batchFilters[i].P_k_plus_.isApprox(scalarFilters[i].P_k_plus_, 1e-4)) << "filter " << i;
+        }
+    }
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include <dynamic_gap/gap_estimation/EgoMotionTimeline.h>
+#include <dynamic_gap/gap_estimation/RotatingFrameCartesianKalmanFilter.h>
+#include <dynamic_gap/utils/AgentTable.h>
+
+namespace
+{
+    std::atomic<bool> countingAllocations(false);
+    std::atomic<int> allocationCount(0);
+}
+
+// heap allocations are only counted while a test has counting switched on
+void * operator new(std::size_t size)
+{
+    if (countingAllocations)
+        allocationCount++;
+
+    void * ptr = std::malloc(size == 0 ? 1 : size);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void operator delete(void * ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void * ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace dynamic_gap
+{
+    namespace
+    {
+        void startCountingAllocations()
+        {
+            allocationCount = 0;
+            countingAllocations = true;
+        }
+
+        int stopCountingAllocations()
+        {
+            countingAllocations = false;
+            return allocationCount;
+        }
+
+        // odometry at fixed rate between two scans, turning and accelerating
+        void buildTimeline(const ros::Time & tStart, const ros::Time & tEnd,
+                           const geometry_msgs::TwistStamped & startRbtVel,
+                           const geometry_msgs::TwistStamped & startRbtAcc,
+                           EgoMotionTimeline & timeline)
+        {
+            std::vector<geometry_msgs::TwistStamped> rbtVels, rbtAccs;
+            for (int i = 1; i < 5; i++)
+            {
+                geometry_msgs::TwistStamped rbtVel, rbtAcc;
+                rbtVel.header.stamp = ros::Time(tStart.toSec() + 0.02 * i);
+                rbtVel.twist.linear.x = 0.5 + 0.05 * i;
+                rbtVel.twist.linear.y = -0.1;
+                rbtVel.twist.angular.z = 0.3 * i;
+                rbtAcc.header.stamp = rbtVel.header.stamp;
+                rbtAcc.twist.linear.x = 0.2;
+                rbtVels.push_back(rbtVel);
+                rbtAccs.push_back(rbtAcc);
+            }
+
+            timeline.build(rbtVels, rbtAccs, tStart, startRbtVel, startRbtAcc, tEnd, RotatingFrameCartesianKalmanFilter::initialQ());
+        }
+
+        void initializeFilter(RotatingFrameCartesianKalmanFilter & filter, const int & modelID, const bool & josephForm,
+                              const ros::Time & tStart, const geometry_msgs::TwistStamped & startRbtVel,
+                              const geometry_msgs::TwistStamped & startRbtAcc)
+        {
+            filter.initialize("left", modelID, 2.0 + 0.01 * modelID, -1.0 + 0.02 * modelID, tStart, startRbtVel, startRbtAcc);
+            filter.josephForm_ = josephForm;
+        }
+    }
+
+    class KalmanFilterUpdateTest : public ::testing::TestWithParam<bool> {};
+
+    TEST_P(KalmanFilterUpdateTest, UpdateTransferAndGetStateDoNotAllocate)
+    {
+        bool josephForm = GetParam();
+
+        geometry_msgs::TwistStamped startRbtVel, startRbtAcc;
+        startRbtVel.twist.linear.x = 0.5;
+        startRbtVel.twist.angular.z = 0.1;
+
+        AgentTable agents(0.5);
+
+        RotatingFrameCartesianKalmanFilter filter, transferredFilter;
+        ros::Time tStart(10.0);
+        initializeFilter(filter, 0, josephForm, tStart, startRbtVel, startRbtAcc);
+
+        for (int scan = 0; scan < 5; scan++)
+        {
+            // timeline is built once per scan ahead of the models, so it is not counted
+            ros::Time tUpdate(tStart.toSec() + 0.1);
+            EgoMotionTimeline timeline;
+            buildTimeline(tStart, tUpdate, filter.lastRbtVel_, filter.lastRbtAcc_, timeline);
+            ASSERT_TRUE(filter.sharesEgoMotionTimeline(timeline, tUpdate));
+
+            Eigen::Vector2f measurement(2.0 - 0.05 * scan, -1.0 + 0.03 * scan);
+
+            startCountingAllocations();
+            filter.update(measurement, timeline, agents, tUpdate);
+            transferredFilter.transfer(filter);
+            Eigen::Vector4f state = transferredFilter.getState();
+            int allocations = stopCountingAllocations();
+
+            EXPECT_EQ(allocations, 0) << "scan " << scan << ", joseph form " << josephForm;
+            EXPECT_TRUE(state.allFinite());
+
+            tStart = tUpdate;
+        }
+    }
+
+    INSTANTIATE_TEST_CASE_P(CovarianceModes, KalmanFilterUpdateTest, ::testing::Values(false, true));
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+
+#include <dynamic_gap/gap_feasibility/GapFeasibilityChecker.h>
+
+namespace dynamic_gap
+{
+    namespace
+    {
+        void initializeGapPoint(Estimator * model, const std::string & side, const int & modelID,
+                                const Eigen::Vector2f & pt, const Eigen::Vector2f & vel)
+        {
+            geometry_msgs::TwistStamped rbtVel, rbtAcc;
+            model->initialize(side, modelID, pt[0], pt[1], ros::Time(10.0), rbtVel, rbtAcc);
+
+            // robot is at rest, so relative velocity is gap point velocity
+            model->x_hat_k_plus_.tail(2) = vel;
+        }
+
+        dynamic_gap::Gap * makeGap(const Eigen::Vector2f & leftPt, const Eigen::Vector2f & leftVel,
+                                   const Eigen::Vector2f & rightPt, const Eigen::Vector2f & rightVel)
+        {
+            dynamic_gap::Gap * gap = new dynamic_gap::Gap("", theta2idx(std::atan2(rightPt[1], rightPt[0])), rightPt.norm(), false, 0.2);
+            gap->addLeftInformation(theta2idx(std::atan2(leftPt[1], leftPt[0])), leftPt.norm());
+
+            initializeGapPoint(gap->leftGapPtModel_, "left", 0, leftPt, leftVel);
+            initializeGapPoint(gap->rightGapPtModel_, "right", 1, rightPt, rightVel);
+            return gap;
+        }
+
+        // lifespan and end condition from stepping gap points forward and from solving in closed form
+        void estimateBothWays(const Eigen::Vector2f & leftPt, const Eigen::Vector2f & leftVel,
+                              const Eigen::Vector2f & rightPt, const Eigen::Vector2f & rightVel,
+                              float & steppedLifespan, int & steppedEndCondition,
+                              float & solvedLifespan, int & solvedEndCondition)
+        {
+            DynamicGapConfig steppedCfg, solvedCfg;
+            steppedCfg.planning.analytic_gap_lifespan = false;
+            solvedCfg.planning.analytic_gap_lifespan = true;
+
+            GapFeasibilityChecker steppedChecker(steppedCfg), solvedChecker(solvedCfg);
+
+            dynamic_gap::Gap * steppedGap = makeGap(leftPt, leftVel, rightPt, rightVel);
+            steppedChecker.propagateGapPoints(steppedGap);
+            steppedLifespan = steppedGap->gapLifespan_;
+            steppedEndCondition = steppedGap->end_condition;
+            delete steppedGap;
+
+            dynamic_gap::Gap * solvedGap = makeGap(leftPt, leftVel, rightPt, rightVel);
+            solvedChecker.propagateGapPoints(solvedGap);
+            solvedLifespan = solvedGap->gapLifespan_;
+            solvedEndCondition = solvedGap->end_condition;
+            delete solvedGap;
+        }
+    }
+
+    TEST(GapFeasibilityCheckerTest, SolvedLifespanMatchesSteppedWhenBearingsSwingWithinStep)
+    {
+        float dt = DynamicGapConfig().traj.integrate_stept;
+
+        // both points pass close by robot within one step, at 4 m/s and at 1.5 m/s
+        std::vector<std::pair<Eigen::Vector2f, Eigen::Vector2f>> gapPts{{Eigen::Vector2f(2.8, 0.5), Eigen::Vector2f(3.0, 0.5)},
+                                                                        {Eigen::Vector2f(1.1, 0.3), Eigen::Vector2f(1.2, 0.3)}};
+        std::vector<Eigen::Vector2f> gapVels{Eigen::Vector2f(-4.0, 0.0), Eigen::Vector2f(-1.5, 0.0)};
+
+        for (int i = 0; i < gapPts.size(); i++)
+        {
+            float steppedLifespan, solvedLifespan;
+            int steppedEndCondition, solvedEndCondition;
+            estimateBothWays(gapPts.at(i).first, gapVels.at(i), gapPts.at(i).second, gapVels.at(i),
+                             steppedLifespan, steppedEndCondition, solvedLifespan, solvedEndCondition);
+
+            EXPECT_EQ(steppedEndCondition, 2) << "case " << i;
+            EXPECT_NEAR(steppedLifespan, dt, 1e-4) << "case " << i;
+            EXPECT_EQ(solvedEndCondition, steppedEndCondition) << "case " << i;
+            EXPECT_NEAR(solvedLifespan, steppedLifespan, 0.5 * dt) << "case " << i;
+        }
+    }
+
+    TEST(GapFeasibilityCheckerTest, SolvedLifespanMatchesSteppedOnRandomGaps)
+    {
+        float dt = DynamicGapConfig().traj.integrate_stept;
+
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> bearingDist(-M_PI, M_PI);
+        std::uniform_real_distribution<float> gapAngleDist(0.05, M_PI - 0.05);
+        std::uniform_real_distribution<float> rangeDist(0.3, 5.0);
+        std::uniform_real_distribution<float> velDist(-3.0, 3.0);
+
+        int nMismatches = 0;
+        for (int i = 0; i < 2000; i++)
+        {
+            float leftTheta = bearingDist(rng);
+            float rightTheta = leftTheta - gapAngleDist(rng);
+            float leftRange = rangeDist(rng), rightRange = rangeDist(rng);
+
+            Eigen::Vector2f leftPt(leftRange * std::cos(leftTheta), leftRange * std::sin(leftTheta));
+            Eigen::Vector2f rightPt(rightRange * std::cos(rightTheta), rightRange * std::sin(rightTheta));
+            Eigen::Vector2f leftVel(velDist(rng), velDist(rng)), rightVel(velDist(rng), velDist(rng));
+
+            float steppedLifespan, solvedLifespan;
+            int steppedEndCondition, solvedEndCondition;
+            estimateBothWays(leftPt, leftVel, rightPt, rightVel,
+                             steppedLifespan, steppedEndCondition, solvedLifespan, solvedEndCondition);
+
+            if (solvedEndCondition != steppedEndCondition || std::abs(solvedLifespan - steppedLifespan) > 0.5 * dt)
+            {
+                nMismatches++;
+                ADD_FAILURE() << "case " << i << ": stepped (" << steppedEndCondition << ", " << steppedLifespan <<
+                                 "), solved (" << solvedEndCondition << ", " << solvedLifespan << ")";
+            }
+        }
+
+        EXPECT_EQ(nMismatches, 0);
+    }
+}
@@ -0,0 +1,9 @@
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+
+int main(int argc, char ** argv)
+{
+    testing::InitGoogleTest(&argc, argv);
+    ros::Time::init();
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <dynamic_gap/trajectory_evaluation/TrajectoryEvaluator.h>
+
+namespace dynamic_gap
+{
+    namespace
+    {
+        boost::shared_ptr<sensor_msgs::LaserScan const> makeScan(std::mt19937 & rng, const DynamicGapConfig & cfg)
+        {
+            std::uniform_real_distribution<float> rangeDist(2.0, cfg.scan.range_max);
+
+            sensor_msgs::LaserScan scan;
+            scan.angle_min = -M_PI;
+            scan.angle_increment = cfg.scan.angle_increment;
+            scan.range_max = cfg.scan.range_max;
+            scan.ranges.resize(cfg.scan.full_scan);
+            for (float & range : scan.ranges)
+                range = rangeDist(rng);
+
+            return boost::shared_ptr<sensor_msgs::LaserScan const>(new sensor_msgs::LaserScan(scan));
+        }
+
+        void setLocalWaypoint(TrajectoryEvaluator & trajEvaluator, const float & x, const float & y)
+        {
+            geometry_msgs::PoseStamped waypoint;
+            waypoint.pose.position.x = x;
+            waypoint.pose.position.y = y;
+            waypoint.pose.orientation.w = 1.0;
+
+            geometry_msgs::TransformStamped identity;
+            identity.transform.rotation.w = 1.0;
+
+            trajEvaluator.transformGlobalPathLocalWaypointToRbtFrame(waypoint, identity);
+        }
+
+        // straight trajectory from robot's current pose that ends somewhere within reach of robot
+        dynamic_gap::Trajectory makeTrajectory(std::mt19937 & rng, const float & reach, const float & heading, const int & poseCount)
+        {
+            std::uniform_real_distribution<float> unitDist(0.0, 1.0);
+            float endRange = reach * unitDist(rng);
+
+            geometry_msgs::PoseArray path;
+            std::vector<float> pathTiming;
+            for (int i = 0; i < poseCount; i++)
+            {
+                float range = endRange * i / (poseCount - 1);
+
+                geometry_msgs::Pose pose;
+                pose.orientation.w = 1.0;
+                pose.position.x = range * std::cos(heading);
+                pose.position.y = range * std::sin(heading);
+                path.poses.push_back(pose);
+                pathTiming.push_back(i);
+            }
+
+            return dynamic_gap::Trajectory(path, pathTiming);
+        }
+
+        float trajectoryCost(TrajectoryEvaluator & trajEvaluator, const dynamic_gap::Trajectory & traj,
+                             const dynamic_gap::FutureEgoCircle & futureEgoCircle)
+        {
+            std::vector<float> poseCosts;
+            float terminalPoseCost = 0.0;
+            trajEvaluator.evaluateTrajectory(traj, poseCosts, terminalPoseCost, futureEgoCircle);
+            return terminalPoseCost + std::accumulate(poseCosts.begin(), poseCosts.end(), float(0));
+        }
+    }
+
+    class TrajectoryEvaluatorTest : public ::testing::Test
+    {
+        protected:
+            void SetUp() override
+            {
+                // normally set from first scan
+                cfg_.scan.range_max = 8.0;
+                poseCount_ = int(cfg_.traj.integrate_maxt / cfg_.traj.integrate_stept) + 1;
+            }
+
+            DynamicGapConfig cfg_;
+            int poseCount_ = 0;
+    };
+
+    TEST_F(TrajectoryEvaluatorTest, LowerBoundsNeverExceedTrajectoryCost)
+    {
+        std::mt19937 rng(3);
+        std::uniform_real_distribution<float> waypointDist(-6.0, 6.0);
+        std::uniform_real_distribution<float> reachDist(0.1, 8.0);
+        std::normal_distribution<float> headingNoiseDist(0.0, 0.5);
+
+        TrajectoryEvaluator trajEvaluator(cfg_);
+
+        for (int scenario = 0; scenario < 50; scenario++)
+        {
+            boost::shared_ptr<sensor_msgs::LaserScan const> scan = makeScan(rng, cfg_);
+            dynamic_gap::FutureEgoCircle futureEgoCircle(scan, poseCount_, cfg_.traj.integrate_stept, cfg_.scan.range_max);
+            trajEvaluator.updateEgoCircle(scan);
+            float waypointX = waypointDist(rng), waypointY = waypointDist(rng);
+            setLocalWaypoint(trajEvaluator, waypointX, waypointY);
+
+            std::vector<float> reaches;
+            std::vector<dynamic_gap::Trajectory> trajs;
+            for (int i = 0; i < 20; i++)
+            {
+                reaches.push_back(reachDist(rng));
+                trajs.push_back(makeTrajectory(rng, reaches.back(), std::atan2(waypointY, waypointX) + headingNoiseDist(rng), poseCount_));
+            }
+
+            std::vector<float> lowerBounds = trajEvaluator.trajectoryCostLowerBounds(reaches, futureEgoCircle);
+            ASSERT_EQ(lowerBounds.size(), reaches.size());
+
+            for (int i = 0; i < trajs.size(); i++)
+                EXPECT_LE(lowerBounds.at(i), trajectoryCost(trajEvaluator, trajs.at(i), futureEgoCircle)) << "scenario " << scenario << ", trajectory " << i;
+        }
+    }
+
+    TEST_F(TrajectoryEvaluatorTest, BoundedPickMatchesUnboundedPick)
+    {
+        std::mt19937 rng(5);
+        std::uniform_real_distribution<float> waypointDist(-6.0, 6.0);
+        std::uniform_real_distribution<float> reachDist(0.1, 8.0);
+        std::normal_distribution<float> headingNoiseDist(0.0, 0.5);
+
+        TrajectoryEvaluator trajEvaluator(cfg_);
+
+        int prunedCount = 0;
+        for (int scenario = 0; scenario < 200; scenario++)
+        {
+            boost::shared_ptr<sensor_msgs::LaserScan const> scan = makeScan(rng, cfg_);
+            dynamic_gap::FutureEgoCircle futureEgoCircle(scan, poseCount_, cfg_.traj.integrate_stept, cfg_.scan.range_max);
+            trajEvaluator.updateEgoCircle(scan);
+            float waypointX = waypointDist(rng), waypointY = waypointDist(rng);
+            setLocalWaypoint(trajEvaluator, waypointX, waypointY);
+
+            std::vector<float> reaches;
+            std::vector<dynamic_gap::Trajectory> trajs;
+            for (int i = 0; i < 8; i++)
+            {
+                reaches.push_back(reachDist(rng));
+                trajs.push_back(makeTrajectory(rng, reaches.back(), std::atan2(waypointY, waypointX) + headingNoiseDist(rng), poseCount_));
+            }
+
+            // idling trajectory goes last, as planner pushes it after gap trajectories
+            float idlingCost = trajectoryCost(trajEvaluator, makeTrajectory(rng, 0.0, 0.0, poseCount_), futureEgoCircle);
+
+            std::vector<float> unboundedCosts;
+            for (const dynamic_gap::Trajectory & traj : trajs)
+                unboundedCosts.push_back(trajectoryCost(trajEvaluator, traj, futureEgoCircle));
+            unboundedCosts.push_back(idlingCost);
+
+            // gaps in order of their bounds, pruned once bound exceeds lowest cost so far, as in planner
+            std::vector<float> lowerBounds = trajEvaluator.trajectoryCostLowerBounds(reaches, futureEgoCircle);
+            std::vector<int> candidateOrder(trajs.size());
+            std::iota(candidateOrder.begin(), candidateOrder.end(), 0);
+            std::stable_sort(candidateOrder.begin(), candidateOrder.end(), [&](const int & a, const int & b)
+            {
+                return lowerBounds.at(a) < lowerBounds.at(b);
+            });
+
+            // pruned gaps have no trajectory, which planner scores as infinitely costly
+            std::vector<float> boundedCosts(trajs.size(), std::numeric_limits<float>::infinity());
+            boundedCosts.push_back(idlingCost);
+            float lowestCost = idlingCost;
+            for (int i : candidateOrder)
+            {
+                if (lowerBounds.at(i) > lowestCost)
+                {
+                    prunedCount++;
+                    continue;
+                }
+
+                boundedCosts.at(i) = trajectoryCost(trajEvaluator, trajs.at(i), futureEgoCircle);
+                lowestCost = std::min(lowestCost, boundedCosts.at(i));
+            }
+
+            int unboundedPick = std::distance(unboundedCosts.begin(), std::min_element(unboundedCosts.begin(), unboundedCosts.end()));
+            int boundedPick = std::distance(boundedCosts.begin(), std::min_element(boundedCosts.begin(), boundedCosts.end()));
+            EXPECT_EQ(boundedPick, unboundedPick) << "scenario " << scenario;
+        }
+
+        // bounds have to actually prune for comparison to mean anything
+        EXPECT_GT(prunedCount, 0);
+    }
+}
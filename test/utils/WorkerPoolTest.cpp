@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <dynamic_gap/utils/WorkerPool.h>
+
+namespace dynamic_gap
+{
+    TEST(WorkerPoolTest, ChunksAreSameForAnyThreadCount)
+    {
+        for (int nThreads : {1, 2, 3, 8})
+        {
+            WorkerPool workerPool(nThreads);
+
+            for (int nItems : {0, 1, 63, 64, 65, 1000})
+            {
+                std::mutex chunksMutex;
+                std::vector<std::pair<int, int>> chunks;
+                std::vector<int> visitCounts(nItems, 0);
+
+                workerPool.parallelFor(nItems, 64, [&](const int & begin, const int & end)
+                {
+                    for (int i = begin; i < end; i++)
+                        visitCounts[i]++;
+
+                    std::lock_guard<std::mutex> lock(chunksMutex);
+                    chunks.push_back(std::make_pair(begin, end));
+                });
+
+                std::sort(chunks.begin(), chunks.end());
+
+                std::vector<std::pair<int, int>> expectedChunks;
+                for (int begin = 0; begin < nItems; begin += 64)
+                    expectedChunks.push_back(std::make_pair(begin, std::min(nItems, begin + 64)));
+
+                EXPECT_EQ(chunks, expectedChunks) << nThreads << " threads, " << nItems << " items";
+                EXPECT_TRUE(std::all_of(visitCounts.begin(), visitCounts.end(), [](const int & count) { return count == 1; }))
+                    << nThreads << " threads, " << nItems << " items";
+            }
+        }
+    }
+
+    TEST(WorkerPoolTest, RethrowsChunkExceptionOnCallingThread)
+    {
+        WorkerPool workerPool(4);
+
+        EXPECT_THROW(workerPool.parallelFor(1000, 10, [](const int & begin, const int & end)
+                     {
+                         if (begin <= 500 && 500 < end)
+                             throw std::runtime_error("chunk failed");
+                     }), std::runtime_error);
+
+        // pool is still usable after a failed job
+        std::vector<int> visitCounts(100, 0);
+        workerPool.parallelFor(100, 10, [&](const int & begin, const int & end)
+        {
+            for (int i = begin; i < end; i++)
+                visitCounts[i]++;
+        });
+        EXPECT_EQ(std::count(visitCounts.begin(), visitCounts.end(), 1), 100);
+    }
+}